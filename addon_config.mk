@@ -0,0 +1,39 @@
+# All variables and this file are optional, if they are not present the PG and the
+# makefiles will try to parse the correct values from the file system.
+#
+# Variables that specify exclusions can use % as a wildcard to specify that anything in
+# that position will match. A partial path can also be specified to, for example, exclude
+# a whole folder from the parsed paths from the file system
+#
+# Variables can be specified using = or +=
+# = will clear the contents of that variable both specified from the file or the ones parsed
+# from the file system
+# += will add the values to the previous ones in the file or the ones parsed from the file
+# system
+#
+# The PG can be used to detect errors in this file, just create a new project with this addon
+# and the PG will write to the console the kind of error and in which line it is
+
+meta:
+	ADDON_NAME = ofxKuZed
+	ADDON_DESCRIPTION = Addon for working with Stereolabs ZED camera
+	ADDON_AUTHOR = Kuflex lab
+	ADDON_TAGS = "computer vision" "3D sensing" "depth camera"
+	ADDON_URL = https://github.com/kuflex/ofxKuZed
+
+common:
+	# benchmark is a standalone CMake project, it's not a part of the addon
+	ADDON_SOURCES_EXCLUDE = benchmark/%
+
+linux64:
+	# Build without ZED SDK and CUDA: ofxKuZedCameraSource can't open the camera,
+	# and ofxKuZed uses mock camera (see ofxKuZed::setMockCamera)
+	ADDON_DEFINES = OFXKUZED_NO_SDK
+
+	# To use ZED SDK, remove the line above and set paths to SDK and CUDA:
+	# ADDON_INCLUDES += /usr/local/zed/include /usr/local/cuda/include
+	# ADDON_LDFLAGS = -L/usr/local/zed/lib -L/usr/local/cuda/lib64
+	# ADDON_LIBS = -lsl_zed -lcudart
+
+vs:
+	# Visual Studio uses settings of zedExample.vcxproj: ZED_SDK_DIR and CUDA_DIR
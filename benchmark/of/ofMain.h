@@ -0,0 +1,374 @@
+#pragma once
+
+//Minimal subset of openFrameworks 0.9 API used by ofxKuZed, so the benchmark can build and check the addon
+//without openFrameworks. Only behavior needed by the addon is implemented: ofSaveImage() stores raw pixels
+//instead of compressing, and OpenGL is emulated in memory: buffer objects are host arrays and textures keep
+//their pixels, which are read back by ofTexture::readToPixels(), so texture uploads are checked without GPU.
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <cstddef>
+#include <map>
+
+using namespace std;
+
+//------------------------------------------------------------------------------------------------------
+template<class T> class ofPixels_ {
+public:
+	void allocate(int w, int h, int channels) {
+		w_ = w;
+		h_ = h;
+		channels_ = channels;
+		data_.resize(size_t(w) * h * channels);
+	}
+	void clear() { allocate(0, 0, 0); }
+	bool isAllocated() const { return !data_.empty(); }
+	T *getData() { return (data_.empty()) ? 0 : &data_[0]; }
+	const T *getData() const { return (data_.empty()) ? 0 : &data_[0]; }
+	int getWidth() const { return w_; }
+	int getHeight() const { return h_; }
+	int getNumChannels() const { return channels_; }
+	size_t size() const { return data_.size(); }
+	size_t getTotalBytes() const { return data_.size() * sizeof(T); }
+	void set(T value) { std::fill(data_.begin(), data_.end(), value); }
+	void setFromPixels(const T *data, int w, int h, int channels) {
+		allocate(w, h, channels);
+		if (!data_.empty()) memcpy(&data_[0], data, getTotalBytes());
+	}
+private:
+	vector<T> data_;
+	int w_ = 0, h_ = 0, channels_ = 0;
+};
+typedef ofPixels_<unsigned char> ofPixels;
+typedef ofPixels_<float> ofFloatPixels;
+typedef ofPixels_<unsigned short> ofShortPixels;
+
+//------------------------------------------------------------------------------------------------------
+//Messages are printed to stderr
+class ofLog {
+public:
+	ofLog() {}
+	~ofLog() { if (!message_.str().empty()) cerr << message_.str(); }
+	template<class T> ofLog &operator<<(const T &value) { message_ << value; return *this; }
+	ofLog &operator<<(ostream &(*manipulator)(ostream &)) { message_ << manipulator; return *this; }
+private:
+	ostringstream message_;
+};
+class ofLogError : public ofLog {};
+class ofLogWarning : public ofLog {};
+class ofLogNotice : public ofLog {};
+class ofLogVerbose : public ofLog {};
+
+//------------------------------------------------------------------------------------------------------
+class ofThread {
+public:
+	virtual ~ofThread() { waitForThread(true); }
+	void startThread(bool mutexBlocks = true) {
+		waitForThread(true);
+		running_ = true;
+		thread_ = std::thread([this]() { threadedFunction(); });
+	}
+	void stopThread() { running_ = false; }
+	void waitForThread(bool callStopThread = true) {
+		if (callStopThread) stopThread();
+		if (thread_.joinable()) thread_.join();
+	}
+	bool isThreadRunning() const { return running_; }
+	bool lock() { mutex.lock(); return true; }
+	void unlock() { mutex.unlock(); }
+	void sleep(long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+	void yield() { std::this_thread::yield(); }
+protected:
+	virtual void threadedFunction() {}
+	std::mutex mutex;
+private:
+	std::atomic<bool> running_{ false };
+	std::thread thread_;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofBuffer {
+public:
+	ofBuffer() {}
+	ofBuffer(const char *data, size_t size) { set(data, size); }
+	void set(const char *data, size_t size) { data_.assign(data, data + size); }
+	void clear() { data_.clear(); }
+	char *getData() { return (data_.empty()) ? 0 : &data_[0]; }
+	const char *getData() const { return (data_.empty()) ? 0 : &data_[0]; }
+	size_t size() const { return data_.size(); }
+private:
+	vector<char> data_;
+};
+
+enum ofImageQualityType { OF_IMAGE_QUALITY_BEST, OF_IMAGE_QUALITY_HIGH, OF_IMAGE_QUALITY_MEDIUM, OF_IMAGE_QUALITY_LOW, OF_IMAGE_QUALITY_WORST };
+enum ofImageFormat { OF_IMAGE_FORMAT_BMP = 0, OF_IMAGE_FORMAT_JPEG = 2, OF_IMAGE_FORMAT_PNG = 13 };
+
+//Raw pixels with width, height and channels, lossless
+inline bool ofSaveImage(const ofPixels &pixels, ofBuffer &buffer, ofImageFormat format = OF_IMAGE_FORMAT_PNG,
+	ofImageQualityType quality = OF_IMAGE_QUALITY_BEST) {
+	int32_t size[3] = { pixels.getWidth(), pixels.getHeight(), pixels.getNumChannels() };
+	vector<char> data((const char *)size, (const char *)size + sizeof(size));
+	data.insert(data.end(), (const char *)pixels.getData(), (const char *)pixels.getData() + pixels.size());
+	buffer.set(&data[0], data.size());
+	return true;
+}
+
+inline bool ofLoadImage(ofPixels &pixels, const ofBuffer &buffer) {
+	int32_t size[3];
+	if (buffer.size() < sizeof(size)) return false;
+	memcpy(size, buffer.getData(), sizeof(size));
+	if (size[0] < 0 || size[1] < 0 || size[2] < 0
+		|| buffer.size() != sizeof(size) + size_t(size[0]) * size[1] * size[2]) return false;
+	pixels.setFromPixels((const unsigned char *)buffer.getData() + sizeof(size), size[0], size[1], size[2]);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+#define PI 3.14159265358979323846
+#define TWO_PI 6.28318530717958647693
+
+inline string ofToDataPath(const string &path, bool absolute = false) { return path; }
+template<class T> string ofToString(const T &value) { ostringstream s; s << value; return s.str(); }
+inline float ofClamp(float value, float min, float max) { return (value < min) ? min : ((value > max) ? max : value); }
+inline void ofSleepMillis(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+//------------------------------------------------------------------------------------------------------
+template<class T> struct ofColor_ {
+	ofColor_(T gray = 0) : r(gray), g(gray), b(gray), a(limit()) {}
+	ofColor_(T r, T g, T b, T a = limit()) : r(r), g(g), b(b), a(a) {}
+	static T limit();
+	T r, g, b, a;
+};
+template<> inline unsigned char ofColor_<unsigned char>::limit() { return 255; }
+template<> inline float ofColor_<float>::limit() { return 1; }
+typedef ofColor_<unsigned char> ofColor;
+typedef ofColor_<float> ofFloatColor;
+
+struct ofVec3f {
+	ofVec3f(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+	float x, y, z;
+};
+typedef ofVec3f ofPoint;
+
+struct ofRectangle {
+	ofRectangle(float x = 0, float y = 0, float width = 0, float height = 0) : x(x), y(y), width(width), height(height) {}
+	float getWidth() const { return width; }
+	float getHeight() const { return height; }
+	float x, y, width, height;
+};
+
+//------------------------------------------------------------------------------------------------------
+//OpenGL in memory
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef unsigned int GLbitfield;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+typedef unsigned int ofIndexType;
+
+const GLenum GL_POINTS = 0x0000;
+const GLenum GL_TRIANGLES = 0x0004;
+const GLenum GL_UNSIGNED_BYTE = 0x1401;
+const GLenum GL_RED = 0x1903;
+const GLenum GL_RGB = 0x1907;
+const GLenum GL_RGBA = 0x1908;
+const GLenum GL_LUMINANCE = 0x1909;
+const GLenum GL_TEXTURE_2D = 0x0DE1;
+const GLenum GL_TEXTURE_RECTANGLE = 0x84F5;
+const GLenum GL_UNPACK_ROW_LENGTH = 0x0CF2;
+const GLenum GL_UNPACK_ALIGNMENT = 0x0CF5;
+const GLenum GL_PIXEL_UNPACK_BUFFER = 0x88EC;
+const GLenum GL_STREAM_DRAW = 0x88E0;
+const GLenum GL_STATIC_DRAW = 0x88E4;
+const GLenum GL_DYNAMIC_DRAW = 0x88E8;
+const GLbitfield GL_MAP_WRITE_BIT = 0x0002;
+const GLbitfield GL_MAP_INVALIDATE_BUFFER_BIT = 0x0008;
+const GLboolean GL_FALSE = 0;
+const GLboolean GL_TRUE = 1;
+
+inline int ofGetNumChannelsFromGLFormat(GLint format) {
+	return (format == GL_RGBA) ? 4 : ((format == GL_RGB) ? 3 : 1);
+}
+inline GLint ofGetGLFormatFromInternal(GLint internalFormat) { return internalFormat; }
+
+//Buffers and textures by id, rows of textures are packed
+struct ofGLState {
+	struct Texture {
+		int w = 0, h = 0, channels = 0;
+		vector<unsigned char> pixels;
+	};
+	map<GLuint, vector<unsigned char> > buffers;
+	map<GLuint, Texture> textures;
+	GLuint nextId = 1;
+	GLuint unpackBuffer = 0;
+	GLuint texture = 0;
+	int unpackAlignment = 4;
+	int uploads = 0;			//glTexSubImage2D calls
+	static ofGLState &get() {
+		static ofGLState state;
+		return state;
+	}
+};
+
+inline void glGenBuffers(GLsizei n, GLuint *ids) {
+	for (int i = 0; i < n; i++) {
+		ids[i] = ofGLState::get().nextId++;
+		ofGLState::get().buffers[ids[i]];
+	}
+}
+inline void glDeleteBuffers(GLsizei n, const GLuint *ids) {
+	for (int i = 0; i < n; i++) ofGLState::get().buffers.erase(ids[i]);
+}
+inline void glBindBuffer(GLenum target, GLuint id) { ofGLState::get().unpackBuffer = id; }
+inline void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+	vector<unsigned char> &buffer = ofGLState::get().buffers[ofGLState::get().unpackBuffer];
+	buffer.assign(size, 0);
+	if (data && size > 0) memcpy(&buffer[0], data, size);
+}
+inline void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+	vector<unsigned char> &buffer = ofGLState::get().buffers[ofGLState::get().unpackBuffer];
+	return (offset + length <= GLsizeiptr(buffer.size()) && length > 0) ? &buffer[offset] : 0;
+}
+inline GLboolean glUnmapBuffer(GLenum target) { return GL_TRUE; }
+inline void glPixelStorei(GLenum name, GLint value) {
+	if (name == GL_UNPACK_ALIGNMENT) ofGLState::get().unpackAlignment = value;
+}
+inline void glBindTexture(GLenum target, GLuint id) { ofGLState::get().texture = id; }
+
+//Pixels come from the bound unpack buffer (then 'pixels' is offset) or from memory, rows are aligned by unpack alignment
+inline void glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei w, GLsizei h, GLenum format,
+	GLenum type, const void *pixels) {
+	ofGLState &gl = ofGLState::get();
+	ofGLState::Texture &texture = gl.textures[gl.texture];
+	int channels = ofGetNumChannelsFromGLFormat(format);
+	int rowBytes = w * channels;
+	int step = (rowBytes + gl.unpackAlignment - 1) / gl.unpackAlignment * gl.unpackAlignment;
+	const unsigned char *src = (const unsigned char *)pixels;
+	if (gl.unpackBuffer) src = &gl.buffers[gl.unpackBuffer][0] + (size_t)pixels;
+	for (int row = 0; row < h; row++) {
+		memcpy(&texture.pixels[(size_t(y + row) * texture.w + x) * texture.channels], src + size_t(step) * row, rowBytes);
+	}
+	gl.uploads++;
+}
+
+//------------------------------------------------------------------------------------------------------
+struct ofTextureData {
+	GLuint textureID = 0;
+	GLenum textureTarget = GL_TEXTURE_RECTANGLE;
+	GLint glInternalFormat = GL_RGB;
+	float width = 0, height = 0;
+	bool bAllocated = false;
+};
+
+class ofTexture {
+public:
+	ofTexture() {}
+	ofTexture(const ofTexture &) = delete;
+	ofTexture &operator=(const ofTexture &) = delete;
+	~ofTexture() { clear(); }
+	void allocate(int w, int h, int glInternalFormat, bool useARBExtension = true) {
+		clear();
+		data_.textureID = ofGLState::get().nextId++;
+		data_.textureTarget = (useARBExtension) ? GL_TEXTURE_RECTANGLE : GL_TEXTURE_2D;
+		data_.glInternalFormat = glInternalFormat;
+		data_.width = float(w);
+		data_.height = float(h);
+		data_.bAllocated = true;
+		ofGLState::Texture &texture = ofGLState::get().textures[data_.textureID];
+		texture.w = w;
+		texture.h = h;
+		texture.channels = ofGetNumChannelsFromGLFormat(glInternalFormat);
+		texture.pixels.assign(size_t(w) * h * texture.channels, 0);
+	}
+	void clear() {
+		if (data_.bAllocated) ofGLState::get().textures.erase(data_.textureID);
+		data_ = ofTextureData();
+	}
+	bool isAllocated() const { return data_.bAllocated; }
+	float getWidth() const { return data_.width; }
+	float getHeight() const { return data_.height; }
+	ofTextureData &getTextureData() { return data_; }
+	const ofTextureData &getTextureData() const { return data_; }
+	void loadData(const ofPixels &pixels) {
+		if (!isAllocated() || pixels.getWidth() != int(data_.width) || pixels.getHeight() != int(data_.height)) {
+			allocate(pixels.getWidth(), pixels.getHeight(), (pixels.getNumChannels() == 3) ? GL_RGB : GL_LUMINANCE, false);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindTexture(data_.textureTarget, data_.textureID);
+		glTexSubImage2D(data_.textureTarget, 0, 0, 0, pixels.getWidth(), pixels.getHeight(),
+			ofGetGLFormatFromInternal(data_.glInternalFormat), GL_UNSIGNED_BYTE, pixels.getData());
+		glBindTexture(data_.textureTarget, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	void readToPixels(ofPixels &pixels) const {
+		pixels.clear();
+		if (!isAllocated()) return;
+		const ofGLState::Texture &texture = ofGLState::get().textures[data_.textureID];
+		pixels.setFromPixels((texture.pixels.empty()) ? 0 : &texture.pixels[0], texture.w, texture.h, texture.channels);
+	}
+	void draw(float x, float y, float w, float h) const {}
+private:
+	ofTextureData data_;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofBufferObject {
+public:
+	void allocate(GLsizeiptr bytes, GLenum usage) { data_.assign(bytes, 0); }
+	void allocate(GLsizeiptr bytes, const void *data, GLenum usage) {
+		allocate(bytes, usage);
+		if (data && bytes > 0) memcpy(&data_[0], data, bytes);
+	}
+	void updateData(GLintptr offset, GLsizeiptr bytes, const void *data) {
+		if (bytes > 0) memcpy(&data_[offset], data, bytes);
+	}
+	GLsizeiptr size() const { return GLsizeiptr(data_.size()); }
+	const unsigned char *getData() const { return (data_.empty()) ? 0 : &data_[0]; }
+private:
+	vector<unsigned char> data_;
+};
+
+//Keeps numbers of vertices and indices and which attributes are used, drawing does nothing
+class ofVbo {
+public:
+	void setVertexData(const float *vertices, int numCoords, int total, int usage, int stride = 0) { vertices_ = total; }
+	void setColorData(const float *colors, int total, int usage, int stride = 0) { colors_ = true; }
+	void setNormalData(const float *normals, int total, int usage, int stride = 0) { normals_ = true; }
+	void setIndexData(const ofIndexType *indices, int total, int usage) { indices_ = total; }
+	void setVertexBuffer(ofBufferObject &buffer, int numCoords, int stride, int offset = 0) { vertices_ = -1; }
+	void setColorBuffer(ofBufferObject &buffer, int stride, int offset = 0) { colors_ = true; }
+	void setNormalBuffer(ofBufferObject &buffer, int stride, int offset = 0) { normals_ = true; }
+	void setIndexBuffer(ofBufferObject &buffer) { indices_ = -1; }
+	void enableColors() { colors_ = true; }
+	void disableColors() { colors_ = false; }
+	void enableNormals() { normals_ = true; }
+	void disableNormals() { normals_ = false; }
+	bool getUsingColors() const { return colors_; }
+	bool getUsingNormals() const { return normals_; }
+	int getNumVertices() const { return vertices_; }	//-1 for buffer objects
+	int getNumIndices() const { return indices_; }
+	void draw(int mode, int first, int total) const {}
+	void drawElements(int mode, int total) const {}
+	void clear() { *this = ofVbo(); }
+private:
+	int vertices_ = 0;
+	int indices_ = 0;
+	bool colors_ = false;
+	bool normals_ = false;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+//Helpers for ofxKuZedBenchmark
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+
+struct BenchSize {
+	const char *name;
+	int w, h;
+};
+
+//Resolutions of ZED camera
+const BenchSize benchSizes[] = {
+	{ "VGA", 672, 376 },
+	{ "HD720", 1280, 720 },
+	{ "HD1080", 1920, 1080 },
+	{ "HD2K", 2208, 1242 }
+};
+const int benchSizesCount = sizeof(benchSizes) / sizeof(benchSizes[0]);
+
+//SDK buffers have padded rows, use the same in synthetic data
+inline int benchStep(int w, int bytesPerPixel) {
+	int step = w * bytesPerPixel;
+	return (step + 127) / 128 * 128;
+}
+
+//Quick mode for CI: each test runs once, only results are checked
+inline bool &benchQuick() {
+	static bool quick = false;
+	return quick;
+}
+
+//Runs 'f' several times, returns the best time in milliseconds
+template<typename F>
+double benchMs(F f, int iterations = 10) {
+	f();	//warm up
+	if (benchQuick()) iterations = 1;
+	double best = 1e30;
+	for (int i = 0; i < iterations; i++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		f();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+		if (ms < best) best = ms;
+	}
+	return best;
+}
+
+//Time per pixel, and memory throughput if bytes read and written per pixel are given
+inline void benchPrint(const char *test, const BenchSize &size, double ms, double bytesPerPixel = 0) {
+	double pixels = double(size.w) * size.h;
+	double ns = ms * 1e6 / pixels;
+	if (bytesPerPixel > 0) {
+		printf("  %-28s %-7s %9.3f ms %8.3f ns/px %7.2f GB/s\n", test, size.name, ms, ns, bytesPerPixel / ns);
+	}
+	else {
+		printf("  %-28s %-7s %9.3f ms %8.3f ns/px\n", test, size.name, ms, ns);
+	}
+}
+
+//Number of failed checks, it's the exit code of benchmark
+inline int &benchFailures() {
+	static int failures = 0;
+	return failures;
+}
+
+inline void benchCheck(bool ok, const char *what) {
+	if (!ok) {
+		printf("  ERROR: %s differs from reference\n", what);
+		benchFailures()++;
+	}
+}
+
+//Time limit of 'f': the best of 3 runs should fit limitMs. It runs the same way in quick mode, so CI checks it,
+//and limits should have a margin for slower and shared machines. Returns the best time in milliseconds
+template<typename F>
+double benchBudget(F f, double limitMs, const char *what) {
+	f();	//warm up
+	double best = 1e30;
+	for (int i = 0; i < 3; i++) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		f();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+	}
+	if (best > limitMs) {
+		printf("  ERROR: %s takes %.3f ms, limit is %.1f ms\n", what, best, limitMs);
+		benchFailures()++;
+	}
+	return best;
+}
+
+void benchFillDepth(std::vector<float> &depth, int w, int h, int step);
+void benchFillXYZRGBA(std::vector<float> &xyz, int w, int h, int step);
+
+void benchColor();
+void benchDepth();
+void benchPointCloud();
+void benchThreads();
+void benchCodec();
+void benchMask();
+void benchTemporal();
+void benchSpatial();
+void benchVoxel();
+void benchNormals();
+void benchMesh();
+void benchForeground();
+void benchUpload();
+void benchRegion();
+void benchStats();
+void benchDepthFile();
+void benchStream();
+void benchCapture();
+void benchRecording();
+//ofxKuZedAddon
+void benchAddon();
+void benchPaths();
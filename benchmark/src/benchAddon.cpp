@@ -0,0 +1,330 @@
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include "bench.h"
+#include "ofxKuZed.h"
+
+//ofxKuZed with mock camera (ofxKuZedSyntheticSource), GL is emulated by of/ofMain.h.
+//Getters are checked against channels of the current frame, extractFrame() against getters,
+//textures against pixels in both upload modes, threaded mode against frame ids, timestamps and stats,
+//and depth filters against filters applied to the same frames of another synthetic source.
+
+//Mock camera of VGA size, fps is high so tests don't wait for frames
+static void addonSetup(ofxKuZed &zed, bool threaded) {
+	zed.setMockCamera(true);
+	zed.setResolution(ZED_RESOLUTION_VGA);
+	zed.setFps(100);
+	zed.setThreaded(threaded);
+	zed.init();
+}
+
+//Equal values, or both are NaN
+static bool addonSame(float a, float b) {
+	return (a == b) || (a != a && b != b);
+}
+
+template<class T>
+static bool addonSame(const ofPixels_<T> &a, const ofPixels_<T> &b) {
+	return a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() && a.getNumChannels() == b.getNumChannels()
+		&& (a.size() == 0 || memcmp(a.getData(), b.getData(), a.getTotalBytes()) == 0);
+}
+
+template<class T>
+static bool addonSame(const vector<T> &a, const vector<T> &b) {
+	return a.size() == b.size() && (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(T)) == 0);
+}
+
+static ofPixels addonTexture(ofTexture &texture) {
+	ofPixels pixels;
+	texture.readToPixels(pixels);
+	return pixels;
+}
+
+//Number of conversions measured by stats
+static int addonConversions(ofxKuZed &zed, int stat) {
+	return zed.getStats().get(stat).size();
+}
+
+//------------------------------------------------------------------------------------------------------
+//Getters of the current frame against its channels
+static void addonCheckFrame(ofxKuZed &zed, const char *mode) {
+	int w = zed.getWidth(), h = zed.getHeight();
+	const ofxKuZedBuffer &leftView = zed.getChannelView(ZED_CHANNEL_LEFT);
+	const ofxKuZedBuffer &rightView = zed.getChannelView(ZED_CHANNEL_RIGHT);
+	const ofxKuZedBuffer &depthView = zed.getChannelView(ZED_CHANNEL_DEPTH);
+	const ofxKuZedBuffer &xyzView = zed.getChannelView(ZED_CHANNEL_XYZRGBA);
+	char what[96];
+
+	//BGRA -> RGB
+	const ofxKuZedBuffer *views[2] = { &leftView, &rightView };
+	ofPixels *images[2] = { &zed.getLeftPixels(), &zed.getRightPixels() };
+	for (int i = 0; i < 2; i++) {
+		const ofxKuZedBuffer &view = *views[i];
+		const ofPixels &image = *images[i];
+		bool ok = view.width == w && view.height == h && image.getWidth() == w && image.getHeight() == h;
+		for (int y = 0; y < h && ok; y++) {
+			const unsigned char *p = view.row<unsigned char>(y);
+			const unsigned char *q = image.getData() + size_t(w) * 3 * y;
+			for (int x = 0; x < w && ok; x++) {
+				ok = q[3 * x] == p[4 * x + 2] && q[3 * x + 1] == p[4 * x + 1] && q[3 * x + 2] == p[4 * x];
+			}
+		}
+		snprintf(what, sizeof(what), "%s: %s pixels", mode, (i == 0) ? "left" : "right");
+		benchCheck(ok, what);
+	}
+
+	//Depth
+	ofFloatPixels &depth = zed.getDepthPixels_mm();
+	ofxKuZedDepthView depthMm = zed.getDepthView_mm();
+	bool ok = depthView.width == w && depthView.height == h && depth.getWidth() == w && depth.getHeight() == h
+		&& depthMm.data == (const float *)depthView.data && depthMm.frameId == zed.getFrameId();
+	for (int y = 0; y < h && ok; y++) {
+		ok = memcmp(depthView.row<float>(y), depth.getData() + size_t(w) * y, w * sizeof(float)) == 0;
+	}
+	snprintf(what, sizeof(what), "%s: depth mm", mode);
+	benchCheck(ok, what);
+
+	ofPixels &gray = zed.getDepthPixels_grayscale(500, 4500);
+	ofPixels grayRef;
+	grayRef.allocate(w, h, 1);
+	ofxKuZedConvert::depthToGray(depthView.data, depthView.step, grayRef.getData(), w, w, h, 500, 4500);
+	snprintf(what, sizeof(what), "%s: depth grayscale", mode);
+	benchCheck(addonSame(gray, grayRef), what);
+
+	//Point cloud is flipped by Y and Z, color is in the 4th float
+	vector<ofPoint> &points = zed.getPointCloud();
+	vector<ofColor> &colors = zed.getPointCloudColors();
+	ok = !xyzView.empty() && points.size() == size_t(w) * h && colors.size() == points.size();
+	int valid = 0;
+	for (int y = 0; y < h && ok; y++) {
+		const float *v = xyzView.row<float>(y);
+		for (int x = 0; x < w && ok; x++, v += 4) {
+			const ofPoint &p = points[size_t(w) * y + x];
+			ok = addonSame(p.x, v[0]) && addonSame(p.y, -v[1]) && addonSame(p.z, -v[2])
+				&& memcmp(&colors[size_t(w) * y + x], &v[3], 4) == 0;
+			if (std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2])) valid++;
+		}
+	}
+	snprintf(what, sizeof(what), "%s: point cloud", mode);
+	benchCheck(ok, what);
+
+	//Compact interleaved cloud keeps valid points
+	ofxKuZedPointCloud &data = zed.getPointCloudData();
+	snprintf(what, sizeof(what), "%s: point cloud data", mode);
+	benchCheck(data.size() == valid && valid > 0 && data.hasColors(), what);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Non-threaded mode: getters, caching, extractFrame() and textures
+static void addonGetters() {
+	ofxKuZed zed;
+	addonSetup(zed, false);
+	benchCheck(zed.started() && zed.isMockCamera() && zed.getWidth() == 672 && zed.getHeight() == 376, "mock camera size");
+	for (int frame = 1; frame <= 3; frame++) {
+		zed.update();
+		benchCheck(zed.isFrameNew() && zed.getFrameId() == (unsigned long long)frame
+			&& zed.getTimestamp() == (unsigned long long)(frame * 1e9 / 100), "frame id and timestamp");
+		addonCheckFrame(zed, "getters");
+
+		//The second call returns the same data without converting it
+		ofPixels left = zed.getLeftPixels();
+		ofFloatPixels depth = zed.getDepthPixels_mm();
+		vector<ofPoint> points = zed.getPointCloud();
+		zed.getLeftPixels();
+		zed.getDepthPixels_mm();
+		zed.getPointCloud();
+		benchCheck(addonConversions(zed, ZED_STAT_LEFT_PIXELS) == frame && addonConversions(zed, ZED_STAT_DEPTH_MM) == frame
+			&& addonConversions(zed, ZED_STAT_POINTCLOUD) == frame, "cached getters");
+
+		//The same outputs from one pass, whole-frame regions are set again to mark outputs dirty
+		ofPixels right = zed.getRightPixels();
+		ofPixels gray = zed.getDepthPixels_grayscale(500, 4500);
+		vector<ofColor> colors = zed.getPointCloudColors();
+		int compact = zed.getPointCloudData().size();
+		zed.resetOutputRegion();
+		zed.extractFrame(ZED_EXTRACT_ALL, 500, 4500);
+		benchCheck(addonConversions(zed, ZED_STAT_LEFT_PIXELS) == frame, "extractFrame() outputs are cached");
+		benchCheck(addonSame(left, zed.getLeftPixels()) && addonSame(right, zed.getRightPixels())
+			&& addonSame(depth, zed.getDepthPixels_mm()) && addonSame(gray, zed.getDepthPixels_grayscale(500, 4500))
+			&& addonSame(points, zed.getPointCloud()) && addonSame(colors, zed.getPointCloudColors())
+			&& zed.getPointCloudData().size() == compact, "extractFrame()");
+	}
+
+	//Textures are loaded from pixels, or converted directly into PBO
+	const int modes[2] = { ZED_TEXTURE_UPLOAD_SYNC, ZED_TEXTURE_UPLOAD_PBO };
+	for (int m = 0; m < 2; m++) {
+		zed.setTextureUpload(modes[m]);
+		for (int frame = 0; frame < 4; frame++) {
+			zed.update();
+			int uploads = ofGLState::get().uploads;
+			ofPixels left = addonTexture(zed.getLeftTexture());
+			ofPixels right = addonTexture(zed.getRightTexture());
+			ofPixels depth = addonTexture(zed.getDepthTexture(500, 4500));
+			bool sent = ofGLState::get().uploads == uploads + 3;
+			zed.getLeftTexture();
+			zed.getRightTexture();
+			zed.getDepthTexture(500, 4500);
+			bool cached = ofGLState::get().uploads == uploads + 3;
+			bool ok = addonSame(left, zed.getLeftPixels()) && addonSame(right, zed.getRightPixels())
+				&& addonSame(depth, zed.getDepthPixels_grayscale(500, 4500));
+			benchCheck(ok && sent && cached, (m == 0) ? "textures, sync upload" : "textures, PBO upload");
+		}
+	}
+	zed.close();
+	benchCheck(!zed.started() && zed.getFrameId() == 0, "close()");
+	printf("  getters, extractFrame(), sync and PBO textures: %d frames\n", 3 + 2 * 4);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Threaded mode: update() takes the newest frame, frames replaced before update() are dropped
+static void addonThreaded() {
+	ofxKuZed zed;
+	addonSetup(zed, true);
+	const int frames = 10;
+	int newFrames = 0;
+	unsigned long long firstId = 0, lastId = 0;
+	bool ok = true;
+	for (int i = 0; i < 400 && newFrames < frames; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(25));	//2-3 frames of the camera
+		zed.update();
+		if (!zed.isFrameNew()) continue;
+		newFrames++;
+		unsigned long long id = zed.getFrameId();
+		ok = ok && id > lastId && zed.getTimestamp() == (unsigned long long)(id * 1e9 / 100);
+		if (firstId == 0) firstId = id;
+		lastId = id;
+		addonCheckFrame(zed, "threaded");
+
+		//update() right after it usually gets no new frame, then getters keep the current one
+		zed.update();
+		if (!zed.isFrameNew()) {
+			zed.getDepthPixels_mm();
+			ok = ok && zed.getFrameId() == lastId && addonConversions(zed, ZED_STAT_DEPTH_MM) == newFrames;
+		}
+		else {
+			newFrames++;
+			ok = ok && zed.getFrameId() > lastId;
+			lastId = zed.getFrameId();
+			addonCheckFrame(zed, "threaded");
+		}
+	}
+	benchCheck(ok && newFrames >= frames, "threaded frame ids");
+	benchCheck(addonConversions(zed, ZED_STAT_DEPTH_MM) == newFrames && addonConversions(zed, ZED_STAT_GRAB) == newFrames
+		&& addonConversions(zed, ZED_STAT_FRAME_AGE) == newFrames, "threaded stats");
+	//Camera timestamps have no gaps, so all dropped frames are replaced in the capture thread
+	benchCheck(zed.getDroppedFrames() == lastId - firstId + 1 - newFrames && zed.getDroppedFrames() > 0, "threaded dropped frames");
+	printf("  threaded: %d frames in update(), %d dropped, measured fps %.1f\n", newFrames, int(zed.getDroppedFrames()),
+		zed.getMeasuredFps());
+	zed.close();
+}
+
+//------------------------------------------------------------------------------------------------------
+//Depth of the current frame equals depth filtered by reference
+static bool addonSameDepth(ofxKuZed &zed, const vector<float> &depth) {
+	const ofxKuZedBuffer &view = zed.getChannelView(ZED_CHANNEL_DEPTH);
+	bool ok = !view.empty() && size_t(view.width) * view.height == depth.size();
+	for (int y = 0; y < view.height && ok; y++) {
+		ok = memcmp(view.row<float>(y), &depth[size_t(view.width) * y], view.width * sizeof(float)) == 0;
+	}
+	return ok;
+}
+
+//Depth of frame 'id' of the source, packed rows
+static void addonSourceDepth(ofxKuZedSyntheticSource &source, unsigned long long id, vector<float> &depth) {
+	while (source.getFrameNumber() < id) source.grab(true, false);
+	ofxKuZedBuffer view;
+	source.retrieve(ZED_CHANNEL_DEPTH, view);
+	depth.resize(size_t(view.width) * view.height);
+	ofxKuZedConvert::copyRows(view.data, view.step, (unsigned char *)&depth[0], view.width * sizeof(float),
+		view.width * sizeof(float), view.height);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Filters are applied to a copy of depth, settings changed after init() are used from the next frame
+static void addonFilters() {
+	const int w = 672, h = 376;
+	ofxKuZedSyntheticSource source, raw;
+	vector<float> depth, rawDepth;
+
+	//Non-threaded: both filters, settings are changed in the middle
+	{
+		source.open(w, h, 0);
+		raw.open(w, h, 0);
+		ofxKuZed zed;
+		zed.setSource(&source);
+		zed.setTemporalFilter(true);
+		zed.setSpatialFilter(true);
+		zed.init();
+		ofxKuZedTemporalFilter temporal;
+		ofxKuZedSpatialFilter spatial;
+		bool filtered = true, untouched = true;
+		for (int frame = 1; frame <= 6; frame++) {
+			if (frame == 4) {
+				zed.getTemporalFilter().setHistory(2);
+				zed.getSpatialFilter().setStages({ ofxKuZedSpatialFilter::SMOOTH });
+				temporal.setHistory(2);
+				spatial.setStages({ ofxKuZedSpatialFilter::SMOOTH });
+			}
+			zed.update();
+			addonSourceDepth(raw, zed.getFrameId(), rawDepth);
+			depth = rawDepth;
+			spatial.apply((unsigned char *)&depth[0], w * sizeof(float), w, h);
+			temporal.apply((unsigned char *)&depth[0], w * sizeof(float), w, h);
+			filtered = filtered && addonSameDepth(zed, depth) && depth != rawDepth;
+
+			//Source buffer keeps depth of the camera
+			vector<float> sourceDepth;
+			addonSourceDepth(source, source.getFrameNumber(), sourceDepth);
+			untouched = untouched && sourceDepth == rawDepth;
+		}
+		benchCheck(filtered, "filtered depth");
+		benchCheck(untouched, "source depth after filtering");
+		zed.close();
+	}
+
+	//Threaded: spatial filter, stages are changed while frames are grabbed.
+	//Each frame is filtered by the old or the new stages, and after the first new one all are new
+	{
+		source.open(w, h, 100);
+		raw.open(w, h, 100);	//the scene moves by timestamps
+		ofxKuZed zed;
+		zed.setSource(&source);
+		zed.setThreaded(true);
+		zed.setSpatialFilter(true);
+		zed.init();
+		ofxKuZedSpatialFilter before, after;
+		after.setStages({ ofxKuZedSpatialFilter::SMOOTH });
+		int newFrames = 0;
+		bool changed = false, seenNew = false, ok = true;
+		for (int i = 0; i < 400 && newFrames < 12; i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			if (newFrames == 4 && !changed) {
+				zed.getSpatialFilter().setStages({ ofxKuZedSpatialFilter::SMOOTH });
+				changed = true;
+			}
+			zed.update();
+			if (!zed.isFrameNew()) continue;
+			newFrames++;
+			addonSourceDepth(raw, zed.getFrameId(), rawDepth);
+			depth = rawDepth;
+			before.apply((unsigned char *)&depth[0], w * sizeof(float), w, h);
+			bool old = addonSameDepth(zed, depth);
+			depth = rawDepth;
+			after.apply((unsigned char *)&depth[0], w * sizeof(float), w, h);
+			bool now = addonSameDepth(zed, depth);
+			seenNew = seenNew || now;
+			ok = ok && ((changed) ? (now || (old && !seenNew)) : old);
+		}
+		benchCheck(ok && seenNew && newFrames == 12, "threaded filter settings");
+		zed.close();
+	}
+	printf("  filters: non-threaded and threaded, settings changed after init()\n");
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchAddon() {
+	printf("ofxKuZed with mock camera\n");
+	addonGetters();
+	addonThreaded();
+	addonFilters();
+}
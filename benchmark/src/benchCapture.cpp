@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <atomic>
+#include "bench.h"
+#include "ofxKuZedCaptureThread.h"
+#include "ofxKuZedSource.h"
+
+//Triple buffer of ofxKuZedCaptureThread with a fake camera: frame N has all depth pixels and image bytes
+//equal to N, frames come every 'periodMs' up to 'limit' frames. The main thread checks that frames
+//are not torn while it reads them, that update() gives the newest frame, dropped frames and stopping.
+
+class CaptureSource : public ofxKuZedSource
+{
+public:
+	std::atomic<int> grabbed{ 0 };
+	std::atomic<int> limit{ 0 };
+	int periodMs = 1;
+
+	void close() {}
+	int getWidth() { return 320; }
+	int getHeight() { return 240; }
+	ofxKuZedIntrinsics getIntrinsics() { return ofxKuZedIntrinsics(); }
+	bool grab(bool computeDepth, bool computeXYZ) {
+		if (grabbed >= limit) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+		int n = grabbed + 1;
+		depth_.assign(size_t(getWidth()) * getHeight(), float(n));
+		left_.assign(size_t(getWidth()) * getHeight() * 4, (unsigned char)n);
+		grabbed = n;
+		return true;
+	}
+	void retrieve(int channel, ofxKuZedBuffer &buffer) {
+		if (channel == ZED_CHANNEL_DEPTH) buffer.setView((unsigned char *)&depth_[0], getWidth(), getHeight(), getWidth() * 4, 4);
+		else if (channel == ZED_CHANNEL_LEFT) buffer.setView(&left_[0], getWidth(), getHeight(), getWidth() * 4, 4);
+		else buffer.clear();
+	}
+	unsigned long long getTimestamp() { return (unsigned long long)grabbed * 1000000; }
+
+private:
+	std::vector<float> depth_;
+	std::vector<unsigned char> left_;
+};
+
+//All pixels of frame are from the frame with its id
+static bool captureFrameWhole(const ofxKuZedFrame &frame) {
+	const ofxKuZedBuffer &depth = frame[ZED_CHANNEL_DEPTH];
+	const ofxKuZedBuffer &left = frame[ZED_CHANNEL_LEFT];
+	if (depth.empty() || left.empty() || frame.timestamp != frame.id * 1000000) return false;
+	float d = float(frame.id);
+	unsigned char c = (unsigned char)frame.id;
+	for (int y = 0; y < depth.height; y++) {
+		const float *p = depth.row<float>(y);
+		const unsigned char *q = left.row<unsigned char>(y);
+		for (int x = 0; x < depth.width; x++) {
+			if (p[x] != d) return false;
+		}
+		for (int x = 0; x < left.width * 4; x++) {
+			if (q[x] != c) return false;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchCapture() {
+	printf("capture thread\n");
+	CaptureSource source;
+	ofxKuZedCaptureThread thread;
+	thread.start([&](ofxKuZedFrame &frame) {
+		if (!source.grab(true, false)) return false;
+		frame.timestamp = source.getTimestamp();
+		ofxKuZedBuffer view;
+		for (int c = ZED_CHANNEL_LEFT; c <= ZED_CHANNEL_DEPTH; c++) {
+			source.retrieve(c, view);
+			frame[c].copyFrom(view);
+		}
+		return true;
+	});
+	auto waitGrabbed = [&](int n) {
+		auto start = std::chrono::steady_clock::now();
+		while (source.grabbed < n && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));	//thread publishes the frame
+	};
+
+	//5 frames without reading: update() gives the newest one, 4 are dropped, then no new frame
+	source.limit = 5;
+	waitGrabbed(5);
+	bool ok = thread.update() && thread.frame().id == 5 && captureFrameWhole(thread.frame())
+		&& thread.droppedFrames() == 4 && !thread.update();
+	benchCheck(ok, "capture newest frame and dropped frames");
+
+	//Continuous capture while the main thread reads slower: frames are whole during reading,
+	//ids grow, each frame is either read or dropped
+	source.limit = 300;
+	int read = 1;
+	unsigned long long lastId = 5;
+	bool whole = true;
+	while (source.grabbed < source.limit) {
+		if (thread.update()) {
+			const ofxKuZedFrame &frame = thread.frame();
+			whole = whole && frame.id > lastId && captureFrameWhole(frame);
+			std::this_thread::sleep_for(std::chrono::milliseconds(3));	//capture thread writes meanwhile
+			whole = whole && captureFrameWhole(frame);
+			lastId = frame.id;
+			read++;
+		}
+	}
+	waitGrabbed(source.limit);
+	if (thread.update()) {
+		lastId = thread.frame().id;
+		read++;
+	}
+	ok = whole && lastId == 300 && read + thread.droppedFrames() == 300;
+	printf("  %-36s read %d, dropped %llu of 300 frames\n", "reading slower than capture", read, thread.droppedFrames());
+	benchCheck(ok, "capture frames are whole, newest and counted");
+
+	//Stop: thread doesn't grab anymore
+	source.limit = 1000000;
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	thread.stop();
+	int grabbed = source.grabbed;
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	benchCheck(!thread.isThreadRunning() && source.grabbed == grabbed, "capture thread stop");
+}
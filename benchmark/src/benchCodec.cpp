@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include <cmath>
+#include "bench.h"
+#include "ofxKuZedDepthCodec.h"
+
+//Scene closer to real ZED depth than benchFillDepth: floor, wall and a box, with small noise
+//and holes as regions (occlusions) rather than single pixels
+static void fillScene(std::vector<float> &depth, int w, int h, int step) {
+	int stepFloats = step / sizeof(float);
+	depth.assign(size_t(stepFloats) * h, 0);
+	for (int y = 0; y < h; y++) {
+		float *row = &depth[size_t(stepFloats) * y];
+		for (int x = 0; x < w; x++) {
+			float d = 4000;		//wall
+			if (y > h / 2) d = std::min(d, 1500.0f * h / (y - h / 2 + 1));	//floor
+			if (x > w / 3 && x < w / 2 && y > h / 3 && y < 2 * h / 3) d = 2000 + 0.5f * x;	//box
+			d += (rand() % 8);
+			if ((x / 16 + y / 16 * 7) % 23 == 0) d = std::numeric_limits<float>::quiet_NaN();
+			if (x < w / 20) d = std::numeric_limits<float>::quiet_NaN();	//left border without stereo
+			row[x] = d;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static void benchScene(const char *scene, const BenchSize &size, const std::vector<float> &depth, int step) {
+	int w = size.w;
+	int h = size.h;
+	const unsigned char *src = (const unsigned char *)&depth[0];
+	ofxKuZedDepthCodec codec;
+	std::vector<unsigned char> encoded;
+	std::vector<float> decoded(size_t(w) * h);
+
+	size_t bytes = 0;
+	double encodeMs = benchMs([&]() { bytes = codec.encode(src, step, w, h, encoded); });
+	double decodeMs = benchMs([&]() { codec.decode(&encoded[0], bytes, (unsigned char *)&decoded[0], w * sizeof(float), w, h); });
+
+	double raw = double(w) * h * sizeof(float);
+	printf("  %-28s %-7s ratio %6.2f  encode %8.3f ms %8.1f MB/s  decode %8.3f ms %8.1f MB/s\n",
+		scene, size.name, raw / bytes, encodeMs, raw / (encodeMs * 1000.0), decodeMs, raw / (decodeMs * 1000.0));
+
+	//Decoded depth should be equal to depth rounded to precision, invalid depth is 0
+	bool ok = true;
+	for (int y = 0; y < h && ok; y++) {
+		const float *row = (const float *)(src + size_t(step) * y);
+		for (int x = 0; x < w; x++) {
+			float d = row[x];
+			float expected = (d >= 0.5f && d - d == 0) ? floorf(d + 0.5f) : 0;
+			if (decoded[x + w * y] != expected) {
+				ok = false;
+				break;
+			}
+		}
+	}
+	benchCheck(ok, "decoded depth");
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchCodec() {
+	printf("depth codec (MB/s of float depth)\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int step = benchStep(size.w, 4);
+		std::vector<float> depth;
+		fillScene(depth, size.w, size.h, step);
+		benchScene("scene", size, depth, step);
+		benchFillDepth(depth, size.w, size.h, step);
+		benchScene("noise", size, depth, step);
+	}
+}
@@ -0,0 +1,59 @@
+#include <cstdlib>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Emulation of the previous implementation: a function call per pixel, like sl::zed::Mat::getValue(x, y)
+struct uchar3 {
+	unsigned char c1, c2, c3;
+};
+
+#if defined(_MSC_VER)
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+static uchar3 getValue(const unsigned char *data, int step, int x, int y) {
+	const unsigned char *p = data + step * y + 4 * x;
+	uchar3 v = { p[0], p[1], p[2] };
+	return v;
+}
+
+static void perPixelLoop(const unsigned char *src, int step, unsigned char *pix, int w, int h) {
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			uchar3 pixel = getValue(src, step, x, y);
+			int index = 3 * (x + y * w);
+			pix[index + 0] = pixel.c3;
+			pix[index + 1] = pixel.c2;
+			pix[index + 2] = pixel.c1;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchColor() {
+	printf("BGRA -> RGB\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int w = size.w;
+		int h = size.h;
+		int step = benchStep(w, 4);
+		std::vector<unsigned char> src(size_t(step) * h);
+		for (size_t i = 0; i < src.size(); i++) src[i] = rand() & 255;
+
+		std::vector<unsigned char> reference(size_t(w) * h * 3);
+		std::vector<unsigned char> dst(reference.size());
+
+		benchPrint("per-pixel getValue()", size, benchMs([&]() { perPixelLoop(&src[0], step, &reference[0], w, h); }));
+
+		int supported = ofxKuZedConvert::simdSupported();
+		for (int simd = 0; simd <= supported; simd++) {
+			ofxKuZedConvert::setSimd(simd);
+			std::fill(dst.begin(), dst.end(), 0);
+			double ms = benchMs([&]() { ofxKuZedConvert::bgraToRgb(&src[0], step, &dst[0], w * 3, w, h); });
+			benchPrint((std::string("bgraToRgb ") + ofxKuZedConvert::simdName(simd)).c_str(), size, ms);
+			benchCheck(dst == reference, ofxKuZedConvert::simdName(simd));
+		}
+		ofxKuZedConvert::setSimd(supported);
+	}
+}
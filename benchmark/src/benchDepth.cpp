@@ -0,0 +1,51 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Synthetic depth: smooth ramp with noise and invalid values (NaN, inf, 0, negative), like occlusions in ZED depth
+void benchFillDepth(std::vector<float> &depth, int w, int h, int step) {
+	int stepFloats = step / sizeof(float);
+	depth.assign(size_t(stepFloats) * h, 0);
+	for (int y = 0; y < h; y++) {
+		float *row = &depth[size_t(stepFloats) * y];
+		for (int x = 0; x < w; x++) {
+			float d = 500 + 6000.0f * x / w + 1000.0f * y / h + (rand() % 100);
+			int r = rand() % 100;
+			if (r < 10) d = std::numeric_limits<float>::quiet_NaN();
+			else if (r < 12) d = std::numeric_limits<float>::infinity();
+			else if (r < 14) d = -std::numeric_limits<float>::infinity();
+			else if (r < 16) d = 0;
+			row[x] = d;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchDepth() {
+	printf("depth -> grayscale\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int w = size.w;
+		int h = size.h;
+		int step = benchStep(w, 4);
+		std::vector<float> depth;
+		benchFillDepth(depth, w, h, step);
+		const unsigned char *src = (const unsigned char *)&depth[0];
+
+		std::vector<unsigned char> reference(size_t(w) * h);
+		std::vector<unsigned char> dst(reference.size());
+
+		int supported = ofxKuZedConvert::simdSupported();
+		for (int simd = 0; simd <= supported; simd++) {
+			ofxKuZedConvert::setSimd(simd);
+			std::vector<unsigned char> &out = (simd == 0) ? reference : dst;
+			std::fill(out.begin(), out.end(), 1);
+			double ms = benchMs([&]() { ofxKuZedConvert::depthToGray(src, step, &out[0], w, w, h, 0, 5000); });
+			benchPrint((std::string("depthToGray ") + ofxKuZedConvert::simdName(simd)).c_str(), size, ms);
+			if (simd > 0) benchCheck(dst == reference, ofxKuZedConvert::simdName(simd));
+		}
+		ofxKuZedConvert::setSimd(supported);
+	}
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cstdlib>
+#include "bench.h"
+#include "ofxKuZedDepthFile.h"
+
+//Depth file round trip: frames are written from SDK-like padded depth and RGB images, read back by index,
+//by timestamp, through a small mapping window, and from a file which was not closed (index is restored from slots)
+
+static const char *depthFileName = "ofxKuZedBench.depth";
+
+//Deterministic depth and left image of frame
+static void depthFileFrame(int frame, int w, int h, int step, std::vector<float> &depth, ofPixels &left) {
+	srand(frame + 1);
+	benchFillDepth(depth, w, h, step);
+	int stepFloats = step / sizeof(float);
+	for (int y = 0; y < h; y++) depth[size_t(stepFloats) * y] = float(frame);	//first pixel of row is frame number
+	left.allocate(w, h, 3);
+	unsigned char *p = left.getData();
+	for (size_t i = 0; i < left.size(); i++) p[i] = (unsigned char)(i * 7 + frame * 13);
+}
+
+//All frames of the reader are the written ones
+static bool depthFileSame(ofxKuZedDepthFileReader &reader, int frames, int w, int h, int step, unsigned long long t0, unsigned long long period) {
+	if (reader.getFrameCount() != frames || reader.getWidth() != w || reader.getHeight() != h || !reader.hasLeft()) return false;
+	std::vector<float> depth;
+	ofPixels left;
+	for (int i = 0; i < frames; i++) {
+		depthFileFrame(i, w, h, step, depth, left);
+		ofxKuZedDepthView view = reader.getDepth(i);
+		if (view.empty() || view.frameId != unsigned(i + 1) || view.timestamp != t0 + i * period) return false;
+		for (int y = 0; y < h; y++) {
+			if (memcmp(view.row(y), &depth[size_t(step / sizeof(float)) * y], w * sizeof(float)) != 0) return false;
+		}
+		const unsigned char *image = reader.getLeft(i);
+		if (!image || memcmp(image, left.getData(), left.size()) != 0) return false;
+	}
+	return reader.getDepth(frames).empty() && reader.getLeft(-1) == 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchDepthFile() {
+	printf("depth file\n");
+	const BenchSize &size = benchSizes[0];
+	int w = size.w;
+	int h = size.h;
+	int step = benchStep(w, 4);
+	const int frames = 12;
+	const unsigned long long t0 = 1000000000ULL;
+	const unsigned long long period = 33333333ULL;
+
+	//Writing, frames with wrong sizes are rejected
+	ofxKuZedDepthFileWriter writer;
+	bool ok = writer.open(depthFileName, w, h, true);
+	std::vector<float> depth;
+	ofPixels left;
+	double ms = 0;
+	for (int i = 0; i < frames && ok; i++) {
+		depthFileFrame(i, w, h, step, depth, left);
+		ofxKuZedDepthView view;
+		view.data = &depth[0];
+		view.width = w;
+		view.height = h;
+		view.step = step;
+		view.frameId = i + 1;
+		view.timestamp = t0 + i * period;
+		auto start = std::chrono::high_resolution_clock::now();
+		ok = writer.write(view, &left);
+		ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	benchPrint("write frame", size, ms / frames, 4 + 3);
+	ofPixels rgba, region;
+	rgba.allocate(w, h, 4);
+	region.allocate(w / 2, h / 2, 3);
+	ofxKuZedDepthView view;
+	view.data = &depth[0];
+	view.width = w;
+	view.height = h;
+	view.step = step;
+	ok = ok && !writer.write(view, &rgba) && !writer.write(view, &region);
+	view.width = w / 2;
+	ok = ok && !writer.write(view, 0) && writer.getFrameCount() == frames;
+	writer.close();
+	benchCheck(ok, "depth file writing and size validation");
+
+	//Reading: whole file mapped, then small window which is remapped for each frame
+	ofxKuZedDepthFileReader reader;
+	ok = reader.open(depthFileName) && depthFileSame(reader, frames, w, h, step, t0, period);
+	ok = ok && reader.findFrame(0) == 0 && reader.findFrame(t0 + 5 * period) == 5
+		&& reader.findFrame(t0 + 5 * period + 1) == 6 && reader.findFrame(t0 + 100 * period) == frames - 1;
+	benchCheck(ok, "depth file reading");
+	reader.setWindowSize(1 << 20);
+	benchCheck(depthFileSame(reader, frames, w, h, step, t0, period), "depth file reading by window");
+	reader.close();
+
+	//Unclosed file: header without index, and no index after frames
+	std::vector<char> data;
+	FILE *file = fopen(depthFileName, "rb");
+	if (file) {
+		fseek(file, 0, SEEK_END);
+		data.resize(ftell(file));
+		fseek(file, 0, SEEK_SET);
+		data.resize(fread(&data[0], 1, data.size(), file));
+		fclose(file);
+	}
+	ok = data.size() > sizeof(ofxKuZedDepthFileHeader);
+	if (ok) {
+		ofxKuZedDepthFileHeader header;
+		memcpy(&header, &data[0], sizeof(header));
+		data.resize(size_t(header.indexOffset));
+		header.frameCount = 0;
+		header.indexOffset = 0;
+		memcpy(&data[0], &header, sizeof(header));
+		file = fopen(depthFileName, "wb");
+		ok = file && fwrite(&data[0], 1, data.size(), file) == data.size();
+		if (file) fclose(file);
+	}
+	ok = ok && reader.open(depthFileName) && depthFileSame(reader, frames, w, h, step, t0, period)
+		&& reader.findFrame(t0 + 3 * period) == 3;
+	reader.close();
+	benchCheck(ok, "depth file index recovery");
+	remove(depthFileName);
+}
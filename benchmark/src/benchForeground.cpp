@@ -0,0 +1,162 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedBackground.h"
+#include "ofxKuZedLabeler.h"
+
+//Wall at 3000..3500 mm with 1% noise and holes. If people > 0, ellipses ("people") at 1500..2400 mm
+//and a few single-pixel speckles are in front of it
+static void sceneFrame(std::vector<float> &depth, int w, int h, int step, int people) {
+	int stepFloats = step / sizeof(float);
+	depth.assign(size_t(stepFloats) * h, 0);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float d = 3000 + 500.0f * x / w;
+			for (int i = 0; i < people; i++) {
+				float px = w * (i + 1) / float(people + 1), py = h * 0.55f;
+				float rx = w * 0.06f, ry = h * 0.35f;
+				float dx = (x - px) / rx, dy = (y - py) / ry;
+				if (dx * dx + dy * dy < 1) d = 1500 + 300.0f * i;
+			}
+			float noise = ((rand() % 1000) + (rand() % 1000) - 999) / 999.0f;
+			d *= 1 + 0.01f * noise;
+			if (people > 0 && rand() % 10000 < 5) d = 1000;
+			if (rand() % 100 < 5) d = std::numeric_limits<float>::quiet_NaN();
+			depth[x + size_t(stepFloats) * y] = d;
+		}
+	}
+}
+
+//Pixel flood fill with explicit stack, 8-connectivity: pixel counts and bounding boxes of components
+struct RefBlob {
+	int x0, y0, x1, y1, pixels;
+};
+
+static void referenceBlobs(const std::vector<unsigned char> &mask, int w, int h, int minPixels, std::vector<RefBlob> &blobs) {
+	std::vector<unsigned char> seen(mask.size(), 0);
+	std::vector<int> stack;
+	blobs.clear();
+	for (int start = 0; start < w * h; start++) {
+		if (!mask[start] || seen[start]) continue;
+		RefBlob b = { w, h, 0, 0, 0 };
+		stack.push_back(start);
+		seen[start] = 1;
+		while (!stack.empty()) {
+			int i = stack.back();
+			stack.pop_back();
+			int x = i % w, y = i / w;
+			b.x0 = std::min(b.x0, x);
+			b.y0 = std::min(b.y0, y);
+			b.x1 = std::max(b.x1, x + 1);
+			b.y1 = std::max(b.y1, y + 1);
+			b.pixels++;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					int nx = x + dx, ny = y + dy;
+					if (nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+					int j = nx + w * ny;
+					if (mask[j] && !seen[j]) {
+						seen[j] = 1;
+						stack.push_back(j);
+					}
+				}
+			}
+		}
+		if (b.pixels >= minPixels) blobs.push_back(b);
+	}
+	std::stable_sort(blobs.begin(), blobs.end(), [](const RefBlob &a, const RefBlob &b) { return a.pixels > b.pixels; });
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchForeground() {
+	printf("background model, foreground mask and blobs\n");
+	for (int s = 1; s <= 2; s++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[s];
+		int w = size.w, h = size.h;
+		int step = benchStep(w, 4);
+		srand(2);
+		//Learning frames differ by noise and holes, like camera frames
+		std::vector<float> empty[4], people;
+		for (int i = 0; i < 4; i++) sceneFrame(empty[i], w, h, step, 0);
+		sceneFrame(people, w, h, step, 3);
+
+		ofxKuZedBackground learned;
+		std::vector<unsigned char> mask(size_t(w) * h);
+		for (int i = 0; i < learned.getLearningFrames(); i++) {
+			learned.apply((const unsigned char *)&empty[i % 4][0], step, w, h, &mask[0], w);
+		}
+
+		std::vector<unsigned char> reference;
+		std::vector<float> referenceModel;
+		int supported = ofxKuZedConvert::simdSupported();
+		for (int simd = 0; simd <= supported; simd++) {
+			ofxKuZedConvert::setSimd(simd);
+			ofxKuZedBackground background = learned;
+			double ms = benchMs([&]() { background.apply((const unsigned char *)&people[0], step, w, h, &mask[0], w); });
+			std::string name = std::string("background ") + ofxKuZedConvert::simdName(simd);
+			benchPrint(name.c_str(), size, ms);
+
+			//One frame from the learned model, so all SIMD levels give the same result
+			background = learned;
+			background.apply((const unsigned char *)&people[0], step, w, h, &mask[0], w);
+			std::vector<float> updated(background.getBackground(), background.getBackground() + size_t(w) * h);
+			if (simd == 0) {
+				reference = mask;
+				referenceModel = updated;
+			}
+			else {
+				benchCheck(mask == reference && updated == referenceModel, name.c_str());
+			}
+		}
+
+		//Blobs: 3 people, speckles are dropped by size
+		ofxKuZedLabeler labeler;
+		labeler.setMinPixels(100);
+		const float f = 700;
+		benchPrint("labeling, runs", size, benchMs([&]() {
+			labeler.process(&reference[0], w, w, h, &people[0], step, f, f, w * 0.5f, h * 0.5f);
+		}));
+		std::vector<RefBlob> refBlobs;
+		benchPrint("labeling, pixel flood fill", size, benchMs([&]() {
+			referenceBlobs(reference, w, h, labeler.getMinPixels(), refBlobs);
+		}, 2));
+		const std::vector<ofxKuZedLabeler::Blob> &blobs = labeler.getBlobs();
+		bool same = (blobs.size() == refBlobs.size());
+		for (size_t i = 0; i < blobs.size() && same; i++) {
+			const ofxKuZedLabeler::Blob &a = blobs[i];
+			const RefBlob &b = refBlobs[i];
+			same = a.x0 == b.x0 && a.y0 == b.y0 && a.x1 == b.x1 && a.y1 == b.y1 && a.pixels == b.pixels;
+		}
+		benchCheck(same, "blobs");
+
+		//Labels image agrees with blobs
+		labeler.setUseLabels(true);
+		labeler.process(&reference[0], w, w, h, &people[0], step, f, f, w * 0.5f, h * 0.5f);
+		std::vector<int> count(blobs.size() + 1, 0);
+		for (size_t i = 0; i < size_t(w) * h; i++) count[labeler.getLabels()[i]]++;
+		bool labelsOk = true;
+		for (size_t i = 0; i < blobs.size(); i++) labelsOk = labelsOk && count[i + 1] == blobs[i].pixels;
+		benchCheck(labelsOk, "label image");
+
+		//Target of a frame: background model and blobs of HD720 under 3 ms
+		if (s == 1) {
+			ofxKuZedBackground background = learned;
+			labeler.setUseLabels(false);
+			double ms = benchBudget([&]() {
+				background.apply((const unsigned char *)&people[0], step, w, h, &mask[0], w);
+				labeler.process(&mask[0], w, w, h, &people[0], step, f, f, w * 0.5f, h * 0.5f);
+			}, 3, "background and blobs");
+			benchPrint("background and blobs", size, ms);
+		}
+
+		int fg = 0;
+		for (size_t i = 0; i < reference.size(); i++) fg += (reference[i] != 0);
+		printf("  %-36s foreground %.1f%%, runs %d, blobs %d:", "", 100.0 * fg / (w * h), labeler.getRunCount(), int(blobs.size()));
+		for (size_t i = 0; i < blobs.size(); i++) {
+			printf(" (%.0f, %.0f, %.0f) mm %d px;", blobs[i].x, blobs[i].y, blobs[i].z, blobs[i].pixels);
+		}
+		printf("\n");
+	}
+}
@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Emulation of the masking loop of zedExample before ofxKuZedMask: a branch per pixel
+static void perPixelMask(const float *depth, int depthStep, const unsigned char *bgra, int bgraStep,
+	unsigned char *dst, int w, int h, float thresholdMm) {
+	for (int y = 0; y < h; y++) {
+		const float *d = (const float *)((const unsigned char *)depth + size_t(depthStep) * y);
+		const unsigned char *c = bgra + size_t(bgraStep) * y;
+		unsigned char *out = dst + size_t(w) * 3 * y;
+		for (int x = 0; x < w; x++) {
+			bool keep = (d[x] <= thresholdMm && d[x] > 0);
+			out[3 * x + 0] = (keep) ? c[4 * x + 2] : 0;
+			out[3 * x + 1] = (keep) ? c[4 * x + 1] : 0;
+			out[3 * x + 2] = (keep) ? c[4 * x + 0] : 0;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchMask() {
+	printf("depth mask + masked image\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int w = size.w;
+		int h = size.h;
+		int depthStep = benchStep(w, 4);
+		int bgraStep = benchStep(w, 4);
+		std::vector<float> depth;
+		benchFillDepth(depth, w, h, depthStep);
+		const unsigned char *depthData = (const unsigned char *)&depth[0];
+		std::vector<unsigned char> bgra(size_t(bgraStep) * h);
+		for (size_t i = 0; i < bgra.size(); i++) bgra[i] = rand() & 255;
+
+		std::vector<unsigned char> loop(size_t(w) * h * 3);
+		benchPrint("per-pixel loop", size, benchMs([&]() { perPixelMask(&depth[0], depthStep, &bgra[0], bgraStep, &loop[0], w, h, 3000); }));
+
+		ofxKuZedConvert::MaskParams range;
+		range.farMm = 3000;
+
+		//Two planes: floor-like plane in the lower half and a side wall in a region
+		ofxKuZedConvert::MaskPlane planes[2];
+		planes[0].nx = 0; planes[0].ny = -1; planes[0].nz = 0.2f; planes[0].d = 400;
+		planes[1].nx = -1; planes[1].ny = 0; planes[1].nz = 0.5f; planes[1].d = 0;
+		planes[1].x0 = w / 2; planes[1].y0 = h / 4; planes[1].x1 = w; planes[1].y1 = h * 3 / 4;
+		ofxKuZedConvert::MaskParams cut = range;
+		cut.fx = cut.fy = w * 0.55f;
+		cut.cx = w * 0.5f;
+		cut.cy = h * 0.5f;
+		cut.planes = planes;
+		cut.planeCount = 2;
+
+		std::vector<unsigned char> mask(size_t(w) * h), rgb(size_t(w) * h * 3), rgba(size_t(w) * h * 4);
+		std::vector<unsigned char> refMask, refRgba, refCut;
+
+		int supported = ofxKuZedConvert::simdSupported();
+		for (int simd = 0; simd <= supported; simd++) {
+			ofxKuZedConvert::setSimd(simd);
+			std::string name = ofxKuZedConvert::simdName(simd);
+			double ms = benchMs([&]() {
+				ofxKuZedConvert::depthMask(depthData, depthStep, &bgra[0], bgraStep, &mask[0], w, &rgb[0], w * 3, 3, w, h, range);
+			});
+			benchPrint(("depthMask RGB " + name).c_str(), size, ms);
+			benchCheck(rgb == loop, ("depthMask RGB " + name).c_str());
+
+			ms = benchMs([&]() {
+				ofxKuZedConvert::depthMask(depthData, depthStep, &bgra[0], bgraStep, 0, 0, &rgba[0], w * 4, 4, w, h, range);
+			});
+			benchPrint(("depthMask RGBA " + name).c_str(), size, ms);
+
+			std::vector<unsigned char> cutMask(mask.size());
+			ms = benchMs([&]() {
+				ofxKuZedConvert::depthMask(depthData, depthStep, 0, 0, &cutMask[0], w, 0, 0, 0, w, h, cut);
+			});
+			benchPrint(("depthMask 2 planes " + name).c_str(), size, ms);
+
+			if (simd == 0) {
+				refMask = mask;
+				refRgba = rgba;
+				refCut = cutMask;
+			}
+			else {
+				benchCheck(mask == refMask, ("mask " + name).c_str());
+				benchCheck(rgba == refRgba, ("depthMask RGBA " + name).c_str());
+				benchCheck(cutMask == refCut, ("depthMask planes " + name).c_str());
+			}
+		}
+		ofxKuZedConvert::setSimd(supported);
+	}
+}
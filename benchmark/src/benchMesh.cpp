@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedMesher.h"
+#include "ofxKuZedWorkers.h"
+
+//Organized XYZRGBA of a tilted wavy wall at 1500..2500 mm with a box at 900 mm in the middle,
+//so there is a depth discontinuity around the box. invalidPercent of pixels are NaN
+static void fillScene(std::vector<float> &xyz, int w, int h, int step, int invalidPercent) {
+	int stepFloats = step / sizeof(float);
+	xyz.assign(size_t(stepFloats) * h, 0);
+	srand(5);
+	for (int y = 0; y < h; y++) {
+		float *row = &xyz[size_t(stepFloats) * y];
+		for (int x = 0; x < w; x++) {
+			float *p = row + 4 * x;
+			bool box = (x > w / 3 && x < 2 * w / 3 && y > h / 3 && y < 2 * h / 3);
+			float z = (box) ? 900.0f : 1500.0f + 1000.0f * x / w + 20 * sinf(x * 0.05f) * cosf(y * 0.05f);
+			if (rand() % 100 < invalidPercent) z = std::numeric_limits<float>::quiet_NaN();
+			p[0] = (x - w / 2) * z / 700.0f;
+			p[1] = (y - h / 2) * z / 700.0f;
+			p[2] = z;
+			unsigned char c[4] = { (unsigned char)(x & 255), (unsigned char)(y & 255), 128, 255 };
+			memcpy(p + 3, c, 4);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static bool good(const float *p, const float *q, float maxEdge, float maxJump) {
+	if (p[2] != p[2] || q[2] != q[2]) return false;
+	float dz = p[2] - q[2];
+	if (maxJump > 0 && fabsf(dz) > maxJump * std::max(fabsf(p[2]), fabsf(q[2]))) return false;
+	float dx = p[0] - q[0], dy = p[1] - q[1];
+	return maxEdge <= 0 || sqrtf(dx * dx + dy * dy + dz * dz) <= maxEdge;
+}
+
+//Straightforward mesh building with the same rules: vertex numbering of the whole grid,
+//then cell by cell with growing arrays, like building ofMesh by hand
+static void reference(const std::vector<float> &xyz, int w, int h, int step, int s, float maxEdge, float maxJump,
+	std::vector<float> &vertices, std::vector<unsigned int> &indices) {
+	int stepFloats = step / sizeof(float);
+	int cols = (w + s - 1) / s, rows = (h + s - 1) / s;
+	std::vector<int> number(size_t(cols) * rows, -1);
+	vertices.clear();
+	indices.clear();
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			const float *p = &xyz[size_t(stepFloats) * r * s + 4 * c * s];
+			if (p[0] + p[1] + p[2] != p[0] + p[1] + p[2]) continue;
+			number[c + size_t(cols) * r] = int(vertices.size() / 3);
+			vertices.push_back(p[0]);
+			vertices.push_back(-p[1]);
+			vertices.push_back(-p[2]);
+		}
+	}
+	for (int r = 0; r + 1 < rows; r++) {
+		for (int c = 0; c + 1 < cols; c++) {
+			int k[4] = { number[c + size_t(cols) * r], number[c + 1 + size_t(cols) * r],
+				number[c + size_t(cols) * (r + 1)], number[c + 1 + size_t(cols) * (r + 1)] };
+			const float *p[4];
+			for (int i = 0; i < 4; i++) {
+				p[i] = &xyz[size_t(stepFloats) * (r + i / 2) * s + 4 * (c + i % 2) * s];
+			}
+			//a b c d = 0 1 2 3
+			int tri[4][3] = { { 0, 2, 1 }, { 1, 2, 3 }, { 0, 2, 3 }, { 0, 3, 1 } };
+			bool ok[4];
+			for (int t = 0; t < 4; t++) {
+				ok[t] = true;
+				for (int e = 0; e < 3; e++) {
+					ok[t] = ok[t] && good(p[tri[t][e]], p[tri[t][(e + 1) % 3]], maxEdge, maxJump * s);
+				}
+			}
+			int first = (int(ok[0]) + int(ok[1]) >= int(ok[2]) + int(ok[3])) ? 0 : 2;
+			for (int t = first; t < first + 2; t++) {
+				if (!ok[t]) continue;
+				for (int e = 0; e < 3; e++) indices.push_back(k[tri[t][e]]);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchMesh() {
+	int maxThreads = std::max(int(std::thread::hardware_concurrency()), 2);
+	printf("mesh of organized point cloud (hardware threads: %d)\n", int(std::thread::hardware_concurrency()));
+	ofxKuZedConvert::PointsParams params;
+	params.hasColors = true;
+	params.signY = -1;
+	params.signZ = -1;
+	for (int sz = 1; sz <= 2; sz++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[sz];
+		int step = benchStep(size.w, 16);
+		std::vector<float> xyz;
+		fillScene(xyz, size.w, size.h, step, 3);
+		const unsigned char *src = (const unsigned char *)&xyz[0];
+
+		const int strides[3] = { 1, 2, 4 };
+		for (int k = 0; k < 3; k++) {
+			ofxKuZedMesher mesher;
+			mesher.setStride(strides[k]);
+			mesher.setMaxEdgeLength(50);
+			for (int threads = 1; threads <= maxThreads; threads *= 2) {
+				ofxKuZedWorkers::shared().setThreads(threads);
+				char test[64];
+				snprintf(test, sizeof(test), "stride %d, %dt", strides[k], threads);
+				benchPrint(test, size, benchMs([&]() { mesher.process(src, step, size.w, size.h, params); }));
+			}
+
+			std::vector<float> refVertices;
+			std::vector<unsigned int> refIndices;
+			double refMs = benchMs([&]() {
+				reference(xyz, size.w, size.h, step, strides[k], mesher.getMaxEdgeLength(), mesher.getMaxDepthJump(),
+					refVertices, refIndices);
+			}, 2);
+			if (strides[k] == 1) benchPrint("reference, growing arrays", size, refMs);
+
+			//The same vertices and triangles, no triangle between the box and the wall
+			int n = mesher.getNumVertices();
+			bool same = (size_t(n) * 3 == refVertices.size()) && (size_t(mesher.getNumIndices()) == refIndices.size());
+			const ofxKuZedMesher::Vertex *v = mesher.getVertices();
+			for (int i = 0; i < n && same; i++) {
+				same = v[i].x == refVertices[i * 3] && v[i].y == refVertices[i * 3 + 1] && v[i].z == refVertices[i * 3 + 2];
+			}
+			same = same && std::equal(refIndices.begin(), refIndices.end(), mesher.getIndices());
+			benchCheck(same, "mesh");
+			int crossing = 0;
+			const unsigned int *index = mesher.getIndices();
+			for (int t = 0; t < mesher.getNumIndices(); t += 3) {
+				int onBox = 0;
+				for (int e = 0; e < 3; e++) onBox += (v[index[t + e]].z > -1000);
+				crossing += (onBox == 1 || onBox == 2);
+			}
+			printf("  %-36s vertices %d, triangles %d, across discontinuity %d, %.0f MB\n", "",
+				n, mesher.getNumIndices() / 3, crossing, mesher.getMemoryBytes() / 1048576.0);
+		}
+	}
+
+	//Without invalid points each cell gives two triangles
+	const BenchSize &size = benchSizes[0];
+	int step = benchStep(size.w, 16);
+	std::vector<float> xyz;
+	fillScene(xyz, size.w, size.h, step, 0);
+	ofxKuZedMesher mesher;
+	mesher.setMaxDepthJump(0);
+	mesher.process((const unsigned char *)&xyz[0], step, size.w, size.h, params);
+	benchCheck(mesher.getNumIndices() == 6 * (size.w - 1) * (size.h - 1), "full grid mesh");
+	ofxKuZedWorkers::shared().setThreads(0);
+}
@@ -0,0 +1,148 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedNormals.h"
+
+//Organized XYZ buffer in SDK coordinates (z is depth) of a tilted wall with a sphere in front of it,
+//with analytic normals, 0.2% depth noise and 5% invalid pixels
+struct NormalsScene {
+	int w, h, step;
+	std::vector<float> xyz;
+	std::vector<float> truth;	//3 per pixel
+	std::vector<unsigned char> silhouette;	//pixels near the sphere border
+};
+
+static void makeScene(NormalsScene &scene, int w, int h) {
+	scene.w = w;
+	scene.h = h;
+	scene.step = benchStep(w, 16);
+	scene.xyz.assign(size_t(scene.step / 4) * h, 0);
+	scene.truth.assign(size_t(w) * h * 3, 0);
+	scene.silhouette.assign(size_t(w) * h, 0);
+	float f = w * 0.75f;
+	const float cz = 1600, radius = 400;
+	srand(4);
+	std::vector<unsigned char> onSphere(size_t(w) * h);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float dx = (x - w * 0.5f) / f, dy = (y - h * 0.5f) / f;
+			//Ray (dx, dy, 1) with sphere at (0, 0, cz), then with plane z = 2000 + 0.5 * X
+			float a = dx * dx + dy * dy + 1, b = -2 * cz, c = cz * cz - radius * radius;
+			float disc = b * b - 4 * a * c;
+			float t, n[3];
+			if (disc >= 0) {
+				t = (-b - sqrtf(disc)) / (2 * a);
+				n[0] = t * dx / radius;
+				n[1] = t * dy / radius;
+				n[2] = (t - cz) / radius;
+				onSphere[x + size_t(w) * y] = 1;
+			}
+			else {
+				t = 2000 / (1 - 0.5f * dx);
+				float len = sqrtf(1.25f);
+				n[0] = 0.5f / len;
+				n[1] = 0;
+				n[2] = -1 / len;
+			}
+			float noise = 1 + 0.002f * ((rand() % 1000) / 500.0f - 1);
+			float *p = &scene.xyz[size_t(scene.step / 4) * y + 4 * x];
+			p[0] = t * dx * noise;
+			p[1] = t * dy * noise;
+			p[2] = t * noise;
+			if (rand() % 100 < 5) p[0] = p[1] = p[2] = std::numeric_limits<float>::quiet_NaN();
+			for (int k = 0; k < 3; k++) scene.truth[(x + size_t(w) * y) * 3 + k] = n[k];
+		}
+	}
+	for (int y = 1; y + 1 < h; y++) {
+		for (int x = 1; x + 1 < w; x++) {
+			size_t i = x + size_t(w) * y;
+			scene.silhouette[i] = (onSphere[i] != onSphere[i + 1]) || (onSphere[i] != onSphere[i + w]);
+		}
+	}
+}
+
+//Direct window averaging with the same formula, O(radius^2) per pixel. Discontinuities are not checked
+static void naiveNormals(const NormalsScene &scene, int r, std::vector<float> &out) {
+	int w = scene.w, h = scene.h, stride = scene.step / 4;
+	out.assign(size_t(w) * h * 3, std::numeric_limits<float>::quiet_NaN());
+	for (int y = r; y + r < h; y++) {
+		for (int x = r; x + r < w; x++) {
+			const float *p = &scene.xyz[size_t(stride) * y + 4 * x];
+			if (p[0] != p[0]) continue;
+			double half[4][4] = {};	//left, right, top, bottom: x, y, z, n
+			for (int j = -r; j <= r; j++) {
+				for (int i = -r; i <= r; i++) {
+					const float *q = &scene.xyz[size_t(stride) * (y + j) + 4 * (x + i)];
+					if (q[0] != q[0]) continue;
+					int parts[2] = { (i < 0) ? 0 : ((i > 0) ? 1 : -1), (j < 0) ? 2 : ((j > 0) ? 3 : -1) };
+					for (int k = 0; k < 2; k++) {
+						if (parts[k] < 0) continue;
+						double *s = half[parts[k]];
+						s[0] += q[0];
+						s[1] += q[1];
+						s[2] += q[2];
+						s[3] += 1;
+					}
+				}
+			}
+			double hv[2][3];
+			for (int k = 0; k < 3; k++) {
+				hv[0][k] = half[1][k] / half[1][3] - half[0][k] / half[0][3];
+				hv[1][k] = half[3][k] / half[3][3] - half[2][k] / half[2][3];
+			}
+			double n[3] = { hv[0][1] * hv[1][2] - hv[0][2] * hv[1][1], hv[0][2] * hv[1][0] - hv[0][0] * hv[1][2],
+				hv[0][0] * hv[1][1] - hv[0][1] * hv[1][0] };
+			double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (n[0] * p[0] + n[1] * p[1] + n[2] * p[2] > 0) len = -len;
+			for (int k = 0; k < 3; k++) out[(x + size_t(w) * y) * 3 + k] = float(n[k] / len);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchNormals() {
+	printf("normals from integral images\n");
+	for (int s = 1; s <= 2; s++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[s];
+		NormalsScene scene;
+		makeScene(scene, size.w, size.h);
+		const int radii[3] = { 2, 4, 8 };
+		for (int k = 0; k < 3; k++) {
+			ofxKuZedNormals normals;
+			normals.setRadius(radii[k]);
+			char name[64];
+			snprintf(name, sizeof(name), "integral r%d", radii[k]);
+			benchPrint(name, size, benchMs([&]() {
+				normals.compute((const unsigned char *)&scene.xyz[0], scene.step, size.w, size.h);
+			}));
+
+			//Angular error against analytic normals, and normals kept at depth discontinuities
+			const float *n = normals.getNormals();
+			double errorSum = 0;
+			int valid = 0, atSilhouette = 0, silhouette = 0;
+			for (size_t i = 0; i < size_t(size.w) * size.h; i++) {
+				silhouette += scene.silhouette[i];
+				if (n[i * 3] != n[i * 3]) continue;
+				valid++;
+				atSilhouette += scene.silhouette[i];
+				const float *t = &scene.truth[i * 3];
+				float dot = n[i * 3] * t[0] + n[i * 3 + 1] * t[1] + n[i * 3 + 2] * t[2];
+				errorSum += acos(std::min(std::max(dot, -1.0f), 1.0f)) * 180 / 3.14159265;
+			}
+			printf("  %-36s valid %.1f%%, mean error %.2f deg, at discontinuities %d of %d, %.0f MB\n", "",
+				100.0 * valid / (size.w * size.h), errorSum / std::max(valid, 1), atSilhouette, silhouette,
+				normals.getMemoryBytes() / 1048576.0);
+
+			if (s == 1 && radii[k] == 4) {
+				std::vector<float> naive;
+				benchPrint("direct window r4", size, benchMs([&]() { naiveNormals(scene, 4, naive); }, 2));
+				float maxDiff = 0;
+				for (size_t i = 0; i < naive.size(); i++) {
+					if (n[i] == n[i] && naive[i] == naive[i]) maxDiff = std::max(maxDiff, fabsf(n[i] - naive[i]));
+				}
+				benchCheck(maxDiff < 1e-3f, "integral normals");
+			}
+		}
+	}
+}
@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include "bench.h"
+#include "ofxKuZed.h"
+
+//Conversion paths of ofxKuZed getters, run through ofxKuZed with mock camera at each ZED resolution.
+//A getter converts again after its output region is set again, so each measurement is one conversion.
+//Outputs are checked against kernels applied to channels of the frame, with regions, downscaling,
+//flips and clipping, and getters must return data of the current frame again without converting it.
+//Bytes per pixel are bytes read and written, for GB/s. GL is emulated in memory (of/ofMain.h),
+//so texture times are conversion and copying into emulated texture or PBO
+
+static const int pathResolutions[benchSizesCount] = {
+	ZED_RESOLUTION_VGA, ZED_RESOLUTION_HD720, ZED_RESOLUTION_HD1080, ZED_RESOLUTION_HD2K
+};
+
+//Settings of outputs, applied before update()
+struct PathConfig {
+	const char *name;
+	bool region;		//region with odd position and size, or whole frame
+	int downscale;
+	int reduction;
+	bool flip;			//flipY and flipZ of point cloud
+	float nearMm, farMm;	//clipping of compact point cloud
+};
+
+const PathConfig pathConfigs[] = {
+	{ "whole frame", false, 1, ZED_REDUCE_BOX, true, 0, 0 },
+	{ "region, downscale 2, min, no flips, clipping", true, 2, ZED_REDUCE_MIN, false, 1700.5f, 3500.5f },
+	{ "region, downscale 3, median", true, 3, ZED_REDUCE_MEDIAN, true, 0, 3000.5f }
+};
+
+//Equal values, or both are NaN
+static bool pathSame(float a, float b) {
+	return (a == b) || (a != a && b != b);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Outputs of getters against kernels applied to the region of channels of the frame
+static void pathCheck(ofxKuZed &zed, const PathConfig &config, int x0, int y0, int rw, int rh) {
+	const int ds = config.downscale;
+	const int w = rw / ds, h = rh / ds;
+	const ofxKuZedBuffer &leftView = zed.getChannelView(ZED_CHANNEL_LEFT);
+	const ofxKuZedBuffer &depthView = zed.getChannelView(ZED_CHANNEL_DEPTH);
+	const ofxKuZedBuffer &xyzView = zed.getChannelView(ZED_CHANNEL_XYZRGBA);
+	char what[128];
+
+	//Left image
+	ofPixels left;
+	left.allocate(w, h, 3);
+	const unsigned char *leftRoi = leftView.row<unsigned char>(y0) + 4 * x0;
+	if (ds == 1) ofxKuZedConvert::bgraToRgb(leftRoi, leftView.step, left.getData(), w * 3, w, h);
+	else ofxKuZedConvert::bgraToRgbDownscale(leftRoi, leftView.step, left.getData(), w * 3, w, h, ds);
+	ofPixels &leftPixels = zed.getLeftPixels();
+	snprintf(what, sizeof(what), "%s: left pixels", config.name);
+	benchCheck(zed.getWidth(ZED_EXTRACT_LEFT) == w && zed.getHeight(ZED_EXTRACT_LEFT) == h
+		&& leftPixels.getWidth() == w && leftPixels.getHeight() == h
+		&& memcmp(leftPixels.getData(), left.getData(), left.getTotalBytes()) == 0, what);
+
+	//Depth in mm and grayscale
+	const unsigned char *depthRoi = depthView.row<unsigned char>(y0) + sizeof(float) * x0;
+	ofFloatPixels depth;
+	depth.allocate(w, h, 1);
+	unsigned char *depthDst = (unsigned char *)depth.getData();
+	if (ds == 1) ofxKuZedConvert::copyRows(depthRoi, depthView.step, depthDst, w * sizeof(float), w * sizeof(float), h);
+	else ofxKuZedConvert::downscaleDepth(depthRoi, depthView.step, depthDst, w * sizeof(float), w, h, ds, config.reduction);
+	ofFloatPixels &depthPixels = zed.getDepthPixels_mm();
+	snprintf(what, sizeof(what), "%s: depth mm", config.name);
+	benchCheck(depthPixels.getWidth() == w && depthPixels.getHeight() == h
+		&& memcmp(depthPixels.getData(), depth.getData(), depth.getTotalBytes()) == 0, what);
+
+	ofPixels gray;
+	gray.allocate(w, h, 1);
+	ofxKuZedConvert::depthToGray(depthDst, w * sizeof(float), gray.getData(), w, w, h, 500, 4500);
+	ofPixels &grayPixels = zed.getDepthPixels_grayscale(500, 4500);
+	snprintf(what, sizeof(what), "%s: depth grayscale", config.name);
+	benchCheck(grayPixels.getWidth() == w && grayPixels.getHeight() == h
+		&& memcmp(grayPixels.getData(), gray.getData(), gray.getTotalBytes()) == 0, what);
+
+	//Textures, rows of PBO are aligned to 4 bytes
+	ofPixels leftTexture, depthTexture;
+	zed.getLeftTexture().readToPixels(leftTexture);
+	zed.getDepthTexture(500, 4500).readToPixels(depthTexture);
+	snprintf(what, sizeof(what), "%s: textures", config.name);
+	benchCheck(leftTexture.size() == left.size() && memcmp(leftTexture.getData(), left.getData(), left.size()) == 0
+		&& depthTexture.size() == gray.size() && memcmp(depthTexture.getData(), gray.getData(), gray.size()) == 0, what);
+
+	//Point cloud takes the top-left point of blocks, compact one keeps source pixel indices
+	float sign = (config.flip) ? -1.0f : 1.0f;
+	vector<ofPoint> &points = zed.getPointCloud();
+	vector<ofColor> &colors = zed.getPointCloudColors();
+	vector<ofFloatColor> &floatColors = zed.getPointCloudFloatColors();
+	ofxKuZedPointCloud &data = zed.getPointCloudData();
+	const ofxKuZedPointCloud::Vertex *vertices = data.getVertices();
+	const int *indices = data.getIndices();
+	bool ok = points.size() == size_t(w) * h && colors.size() == points.size() && floatColors.size() == points.size();
+	bool compactOk = vertices && indices;
+	int n = 0;
+	float farMm = (config.farMm > 0) ? config.farMm : 1e30f;
+	for (int y = 0; y < h && (ok || compactOk); y++) {
+		for (int x = 0; x < w && (ok || compactOk); x++) {
+			int sx = x0 + x * ds, sy = y0 + y * ds;
+			const float *v = xyzView.row<float>(sy) + 4 * sx;
+			const unsigned char *c = (const unsigned char *)(v + 3);
+			size_t i = size_t(w) * y + x;
+			ok = ok && pathSame(points[i].x, v[0]) && pathSame(points[i].y, sign * v[1]) && pathSame(points[i].z, sign * v[2])
+				&& memcmp(&colors[i], c, 4) == 0 && floatColors[i].r == c[0] * (1.0f / 255.0f) && floatColors[i].a == c[3] * (1.0f / 255.0f);
+			bool keep = std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2])
+				&& fabsf(v[2]) >= config.nearMm && fabsf(v[2]) <= farMm;
+			if (keep && compactOk) {
+				const ofxKuZedPointCloud::Vertex &p = vertices[n];
+				compactOk = n < data.size() && p.x == v[0] && p.y == sign * v[1] && p.z == sign * v[2]
+					&& p.r == c[0] * (1.0f / 255.0f) && indices[n] == sx + zed.getWidth() * sy;
+				n++;
+			}
+		}
+	}
+	snprintf(what, sizeof(what), "%s: point cloud", config.name);
+	benchCheck(ok, what);
+	snprintf(what, sizeof(what), "%s: compact point cloud", config.name);
+	benchCheck(compactOk && n == data.size() && n > 0, what);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Conversions measured by stats for each getter
+static const int pathStats[] = {
+	ZED_STAT_LEFT_PIXELS, ZED_STAT_LEFT_TEXTURE, ZED_STAT_RIGHT_PIXELS, ZED_STAT_RIGHT_TEXTURE,
+	ZED_STAT_DEPTH_MM, ZED_STAT_DEPTH_GRAYSCALE, ZED_STAT_DEPTH_TEXTURE,
+	ZED_STAT_POINTCLOUD, ZED_STAT_POINTCLOUD_DATA, ZED_STAT_MESH
+};
+const int pathStatsCount = sizeof(pathStats) / sizeof(pathStats[0]);
+
+//Textures go first, so in PBO mode they are converted from channels, not from pixels
+static void pathGetAll(ofxKuZed &zed) {
+	zed.getLeftTexture();
+	zed.getRightTexture();
+	zed.getDepthTexture(500, 4500);
+	zed.getLeftPixels();
+	zed.getRightPixels();
+	zed.getDepthPixels_grayscale(500, 4500);
+	zed.getDepthPixels_mm();
+	zed.getPointCloudFloatColors();
+	zed.getPointCloudData();
+	zed.getMesh();
+}
+
+//Getters convert once per frame: all getters are called twice, each conversion is counted once
+static void pathCheckCached(ofxKuZed &zed, const char *name) {
+	int before[pathStatsCount];
+	for (int i = 0; i < pathStatsCount; i++) before[i] = zed.getStats().get(pathStats[i]).size();
+	pathGetAll(zed);
+	int uploads = ofGLState::get().uploads;
+	pathGetAll(zed);
+	bool ok = ofGLState::get().uploads == uploads;
+	for (int i = 0; i < pathStatsCount; i++) ok = ok && zed.getStats().get(pathStats[i]).size() == before[i] + 1;
+	char what[128];
+	snprintf(what, sizeof(what), "%s: cached getters", name);
+	benchCheck(ok, what);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Times of getters for the whole frame
+static void pathMeasure(ofxKuZed &zed, const BenchSize &size) {
+	benchPrint("left pixels", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_LEFT);
+		zed.getLeftPixels();
+	}), 4 + 3);
+	zed.setTextureUpload(ZED_TEXTURE_UPLOAD_SYNC);
+	benchPrint("left texture, sync", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_LEFT);
+		zed.getLeftTexture();
+	}), 4 + 3 + 3 + 3);
+	zed.setTextureUpload(ZED_TEXTURE_UPLOAD_PBO);
+	benchPrint("left texture, PBO", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_LEFT);
+		zed.getLeftTexture();
+	}), 4 + 3 + 3 + 3);
+	benchPrint("depth mm", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_DEPTH_MM);
+		zed.getDepthPixels_mm();
+	}), 4 + 4);
+	benchPrint("depth grayscale", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_DEPTH_GRAYSCALE);
+		zed.getDepthPixels_grayscale(500, 4500);
+	}), 4 + 1);
+	benchPrint("depth texture, PBO", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_DEPTH_GRAYSCALE);
+		zed.getDepthTexture(500, 4500);
+	}), 4 + 1 + 1 + 1);
+	zed.setTextureUpload(ZED_TEXTURE_UPLOAD_SYNC);
+	benchPrint("point cloud", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_POINTCLOUD);
+		zed.getPointCloud();
+	}), 16 + sizeof(ofPoint) + sizeof(ofColor));
+	benchPrint("point cloud + float colors", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_POINTCLOUD);
+		zed.getPointCloudFloatColors();
+	}), 16 + sizeof(ofPoint) + sizeof(ofColor) + 4 + sizeof(ofFloatColor));
+	int n = zed.getPointCloudData().size();
+	benchPrint("point cloud data: compact", size, benchMs([&]() {
+		zed.resetOutputRegion(ZED_EXTRACT_POINTCLOUD_DATA);
+		zed.getPointCloudData();
+	}), 16 + 28.0 * n / (double(size.w) * size.h));
+	benchPrint("mesh", size, benchMs([&]() {
+		zed.setPointCloudClipping(0, 0);
+		zed.getMesh();
+	}));
+	benchPrint("extractFrame(), all outputs", size, benchMs([&]() {
+		zed.resetOutputRegion();
+		zed.extractFrame(ZED_EXTRACT_ALL, 500, 4500);
+	}));
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchPaths() {
+	printf("conversion paths of ofxKuZed getters, mock camera\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		ofxKuZed zed;
+		zed.setMockCamera(true);
+		zed.setResolution(pathResolutions[s]);
+		zed.setFps(100);
+		zed.setPointCloudIndices(true);
+		zed.init();
+		zed.update();
+		pathMeasure(zed, size);
+
+		//Mesh of the whole frame has all valid points
+		int valid = 0;
+		const ofxKuZedBuffer &xyz = zed.getChannelView(ZED_CHANNEL_XYZRGBA);
+		for (int y = 0; y < xyz.height; y++) {
+			const float *v = xyz.row<float>(y);
+			for (int x = 0; x < xyz.width; x++, v += 4) valid += std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2]);
+		}
+		benchCheck(zed.getMesh().getNumVertices() == valid, "mesh vertex count");
+
+		for (const PathConfig &config : pathConfigs) {
+			int x0 = 0, y0 = 0, rw = size.w, rh = size.h;
+			if (config.region) {
+				x0 = size.w / 8 + 1;
+				y0 = size.h / 6 + 1;
+				rw = size.w / 2 + 5;
+				rh = size.h / 2 + 1;
+			}
+			zed.setOutputRegion(ZED_EXTRACT_ALL, x0, y0, rw, rh, config.downscale, config.reduction);
+			zed.setUsePointCloud(true, true, config.flip, config.flip);
+			zed.setPointCloudClipping(config.nearMm, config.farMm);
+			for (int m = 0; m < 2; m++) {
+				zed.setTextureUpload((m == 0) ? ZED_TEXTURE_UPLOAD_SYNC : ZED_TEXTURE_UPLOAD_PBO);
+				zed.update();
+				pathCheckCached(zed, config.name);
+				pathCheck(zed, config, x0, y0, rw, rh);
+			}
+		}
+		zed.close();
+	}
+}
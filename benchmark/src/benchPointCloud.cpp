@@ -0,0 +1,140 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Types with the same layout as ofPoint, ofColor, ofFloatColor
+struct Point3 { float x, y, z; };
+struct Color4 { unsigned char r, g, b, a; };
+struct FloatColor4 { float r, g, b, a; };
+
+//Synthetic XYZRGBA buffer, a part of points is invalid (NaN), like occluded pixels of ZED
+void benchFillXYZRGBA(std::vector<float> &xyz, int w, int h, int step) {
+	int stepFloats = step / sizeof(float);
+	xyz.assign(size_t(stepFloats) * h, 0);
+	for (int y = 0; y < h; y++) {
+		float *row = &xyz[size_t(stepFloats) * y];
+		for (int x = 0; x < w; x++) {
+			float *p = row + 4 * x;
+			float z = 1000.0f + (rand() % 3000);
+			if (rand() % 100 < 30) z = std::numeric_limits<float>::quiet_NaN();
+			p[0] = (x - w / 2) * z / 700.0f;
+			p[1] = (y - h / 2) * z / 700.0f;
+			p[2] = z;
+			unsigned char c[4] = { (unsigned char)(x & 255), (unsigned char)(y & 255), (unsigned char)((x + y) & 255), 255 };
+			memcpy(p + 3, c, 4);
+		}
+	}
+}
+
+//Equal values, or both are NaN
+static bool benchSame(float a, float b) {
+	return (a == b) || (a != a && b != b);
+}
+
+//Previous implementation: copy points and colors, then flip Y, flip Z, then convert colors to float
+static void fivePasses(const float *src, int step, int w, int h,
+	std::vector<Point3> &points, std::vector<Color4> &colors, std::vector<FloatColor4> &floatColors) {
+	int stepFloats = step / sizeof(float);
+	points.resize(w * h);
+	colors.resize(w * h);
+	for (int y = 0; y < h; y++) {
+		const float *data = src + stepFloats * y;
+		for (int x = 0; x < w; x++) {
+			const unsigned char *c = (const unsigned char *)(data + 4 * x + 3);
+			Point3 p = { data[4 * x], data[4 * x + 1], data[4 * x + 2] };
+			Color4 col = { c[0], c[1], c[2], c[3] };
+			points[x + w * y] = p;
+			colors[x + w * y] = col;
+		}
+	}
+	for (size_t i = 0; i < points.size(); i++) points[i].y = -points[i].y;
+	for (size_t i = 0; i < points.size(); i++) points[i].z = -points[i].z;
+	floatColors.resize(colors.size());
+	for (size_t i = 0; i < colors.size(); i++) {
+		FloatColor4 f = { colors[i].r / 255.0f, colors[i].g / 255.0f, colors[i].b / 255.0f, colors[i].a / 255.0f };
+		floatColors[i] = f;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchPointCloud() {
+	printf("point cloud from XYZRGBA, 30%% invalid points\n");
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int w = size.w;
+		int h = size.h;
+		int step = benchStep(w, 16);
+		std::vector<float> xyz;
+		benchFillXYZRGBA(xyz, w, h, step);
+		const unsigned char *src = (const unsigned char *)&xyz[0];
+
+		std::vector<Point3> points;
+		std::vector<Color4> colors;
+		std::vector<FloatColor4> floatColors;
+		benchPrint("five passes", size, benchMs([&]() { fivePasses(&xyz[0], step, w, h, points, colors, floatColors); }));
+
+		//Interleaved xyz + float rgba
+		std::vector<float> vertices(size_t(w) * h * 7);
+		ofxKuZedConvert::PointsOutput inter;
+		inter.x = &vertices[0];
+		inter.y = &vertices[1];
+		inter.z = &vertices[2];
+		inter.xyzStride = 7;
+		inter.rgbaFloat = &vertices[3];
+		inter.rgbaFloatStride = 7;
+		ofxKuZedConvert::PointsParams params;
+		params.hasColors = true;
+		params.signY = -1;
+		params.signZ = -1;
+		int n = 0;
+		benchPrint("fused interleaved", size, benchMs([&]() {
+			n = ofxKuZedConvert::xyzToPoints(src, step, w, h, params, inter);
+		}));
+		bool same = (n == w * h);
+		for (int i = 0; i < n && same; i++) {
+			const float *v = &vertices[size_t(i) * 7];
+			same = benchSame(v[0], points[i].x) && benchSame(v[1], points[i].y) && benchSame(v[2], points[i].z)
+				&& std::fabs(v[3] - floatColors[i].r) < 1e-6f && std::fabs(v[6] - floatColors[i].a) < 1e-6f;
+		}
+		benchCheck(same, "fused interleaved");
+		ofxKuZedConvert::PointsParams compact = params;
+		compact.dropInvalid = true;
+		benchPrint("fused interleaved, compact", size, benchMs([&]() {
+			ofxKuZedConvert::xyzToPoints(src, step, w, h, compact, inter);
+		}));
+
+		//SoA
+		std::vector<float> x(size_t(w) * h), y(x.size()), z(x.size());
+		std::vector<unsigned char> rgba(x.size() * 4);
+		ofxKuZedConvert::PointsOutput soa;
+		soa.x = &x[0];
+		soa.y = &y[0];
+		soa.z = &z[0];
+		soa.rgba = &rgba[0];
+		benchPrint("fused SoA, compact", size, benchMs([&]() {
+			ofxKuZedConvert::xyzToPoints(src, step, w, h, compact, soa);
+		}));
+
+		//Compact with clipping and index map, check that indices point to valid source pixels
+		std::vector<int> index(x.size());
+		soa.index = &index[0];
+		ofxKuZedConvert::PointsParams clipped = compact;
+		clipped.nearMm = 1500;
+		clipped.farMm = 3000;
+		int m = 0;
+		benchPrint("fused SoA, clip + index", size, benchMs([&]() {
+			m = ofxKuZedConvert::xyzToPoints(src, step, w, h, clipped, soa);
+		}));
+		bool ok = (m > 0 && m < w * h);
+		for (int i = 0; i < m && ok; i++) {
+			int px = index[i] % w;
+			int py = index[i] / w;
+			float sz = xyz[size_t(step / sizeof(float)) * py + 4 * px + 2];
+			ok = (sz == -z[i] && sz >= 1500 && sz <= 3000);
+		}
+		benchCheck(ok, "clip + index");
+	}
+}
@@ -0,0 +1,143 @@
+#include <cstdio>
+#include "bench.h"
+#include "ofxKuZedRecording.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedSyntheticSource.h"
+
+//Recording round trip without camera: synthetic frames are recorded, played back in FAST, STEP
+//and REALTIME modes with seeking, and from a file which was not closed (index is restored by scanning)
+
+static const char *recordingFileName = "ofxKuZedBench.rec";
+static const int recordingFrames = 20;
+
+//Recorded channels of frames, rows packed
+struct RecordingReference {
+	std::vector<unsigned char> channels[3];
+	unsigned long long id = 0;
+	unsigned long long timestamp = 0;
+};
+
+//Player's current frame is recorded frame 'index'
+static bool recordingSame(ofxKuZedPlayer &player, const std::vector<RecordingReference> &frames, int index) {
+	if (player.getFrameIndex() != index || index < 0 || index >= int(frames.size())) return false;
+	const RecordingReference &reference = frames[index];
+	if (player.getTimestamp() != reference.timestamp) return false;
+	for (int c = ZED_CHANNEL_LEFT; c <= ZED_CHANNEL_DEPTH; c++) {
+		ofxKuZedBuffer buffer;
+		player.retrieve(c, buffer);
+		if (buffer.empty() || buffer.width != player.getWidth() || buffer.height != player.getHeight()) return false;
+		size_t rowBytes = size_t(buffer.width) * buffer.bytesPerPixel;
+		for (int y = 0; y < buffer.height; y++) {
+			if (memcmp(buffer.row<unsigned char>(y), &reference.channels[c][rowBytes * y], rowBytes) != 0) return false;
+		}
+	}
+	return true;
+}
+
+//Grab and check frame
+static bool recordingGrab(ofxKuZedPlayer &player, const std::vector<RecordingReference> &frames, int index) {
+	return player.grab(true, false) && recordingSame(player, frames, index);
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchRecording() {
+	printf("recording and playback\n");
+	const int w = 320;
+	const int h = 240;
+	ofxKuZedSyntheticSource source;
+	source.open(w, h, 0);	//timestamps go with 30 fps
+
+	//Recording
+	ofxKuZedRecorder recorder;
+	bool ok = recorder.open(recordingFileName, w, h, source.getIntrinsics(), ZED_RECORD_ALL);
+	std::vector<RecordingReference> frames(recordingFrames);
+	ofxKuZedFrame frame;
+	ofxKuZedBuffer view;
+	for (int i = 0; i < recordingFrames && ok; i++) {
+		source.grab(true, false);
+		frame.id = i + 1;
+		frame.timestamp = source.getTimestamp();
+		frames[i].id = frame.id;
+		frames[i].timestamp = frame.timestamp;
+		for (int c = ZED_CHANNEL_LEFT; c <= ZED_CHANNEL_DEPTH; c++) {
+			source.retrieve(c, view);
+			frame[c].copyFrom(view);
+			int rowBytes = w * view.bytesPerPixel;
+			frames[i].channels[c].resize(size_t(rowBytes) * h);
+			ofxKuZedConvert::copyRows(view.data, view.step, &frames[i].channels[c][0], rowBytes, rowBytes, h);
+		}
+		ok = recorder.write(frame);
+	}
+	ok = ok && recorder.getFrameCount() == recordingFrames;
+	recorder.close();
+	benchCheck(ok, "recording");
+
+	//FAST: each grab gives the next frame, without looping playback finishes
+	ofxKuZedPlayer player;
+	ok = player.open(recordingFileName) && player.getFrameCount() == recordingFrames
+		&& player.getWidth() == w && player.getHeight() == h && player.getIntrinsics().fx == source.getIntrinsics().fx;
+	player.setMode(ZED_PLAYBACK_FAST);
+	player.setLoop(false);
+	for (int i = 0; i < recordingFrames && ok; i++) ok = recordingGrab(player, frames, i);
+	ok = ok && !player.grab(true, false) && player.isFinished();
+	benchCheck(ok, "playback FAST");
+
+	//Seeking by index and time
+	player.seek(7);
+	ok = recordingGrab(player, frames, 7);
+	player.seekTime(frames[12].timestamp);
+	ok = ok && recordingGrab(player, frames, 12);
+	player.seekTime(frames[12].timestamp + 1);
+	ok = ok && recordingGrab(player, frames, 13);
+	benchCheck(ok, "playback seek");
+
+	//STEP: seek gives one frame, then frames are given only by step()
+	player.setMode(ZED_PLAYBACK_STEP);
+	player.seek(3);
+	ok = recordingGrab(player, frames, 3) && !player.grab(true, false);
+	player.step();
+	ok = ok && recordingGrab(player, frames, 4) && !player.grab(true, false);
+	benchCheck(ok, "playback STEP");
+
+	//REALTIME: the first frame at once, the next is not given before its time,
+	//and after waiting for 3.5 frame periods late frames are skipped
+	player.setMode(ZED_PLAYBACK_REALTIME);
+	player.seek(0);
+	ok = recordingGrab(player, frames, 0) && !player.grab(true, false);
+	double period = (frames[1].timestamp - frames[0].timestamp) * 1e-6;	//ms
+	std::this_thread::sleep_for(std::chrono::microseconds(int(3.5 * period * 1000)));
+	ok = ok && recordingGrab(player, frames, 3) && !player.grab(true, false);
+	printf("  %-36s frame period %.2f ms\n", "realtime playback", period);
+	benchCheck(ok, "playback REALTIME");
+	player.close();
+
+	//Unclosed file: header without index, and no index after frames
+	std::vector<char> data;
+	FILE *file = fopen(recordingFileName, "rb");
+	if (file) {
+		fseek(file, 0, SEEK_END);
+		data.resize(ftell(file));
+		fseek(file, 0, SEEK_SET);
+		data.resize(fread(&data[0], 1, data.size(), file));
+		fclose(file);
+	}
+	ok = data.size() > sizeof(ofxKuZedRecordingHeader);
+	if (ok) {
+		ofxKuZedRecordingHeader header;
+		memcpy(&header, &data[0], sizeof(header));
+		data.resize(size_t(header.indexOffset));
+		header.frameCount = 0;
+		header.indexOffset = 0;
+		memcpy(&data[0], &header, sizeof(header));
+		file = fopen(recordingFileName, "wb");
+		ok = file && fwrite(&data[0], 1, data.size(), file) == data.size();
+		if (file) fclose(file);
+	}
+	ok = ok && player.open(recordingFileName) && player.getFrameCount() == recordingFrames;
+	player.setMode(ZED_PLAYBACK_FAST);
+	player.seek(recordingFrames - 1);
+	ok = ok && recordingGrab(player, frames, recordingFrames - 1);
+	player.close();
+	benchCheck(ok, "recording index recovery");
+	remove(recordingFileName);
+}
@@ -0,0 +1,134 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Straightforward reduction of one depth block: valid values are collected and sorted
+static float referenceBlock(const std::vector<float> &depth, int stepFloats, int x0, int y0, int factor, int reduction) {
+	if (reduction == ofxKuZedConvert::REDUCE_SAMPLE) return depth[x0 + size_t(stepFloats) * y0];
+	std::vector<float> values;
+	float sum = 0;
+	for (int x = x0; x < x0 + factor; x++) {
+		float column = 0;	//sums are made by columns
+		for (int y = y0; y < y0 + factor; y++) {
+			float d = depth[x + size_t(stepFloats) * y];
+			if (d > 0 && d <= std::numeric_limits<float>::max()) {
+				values.push_back(d);
+				column += d;
+			}
+		}
+		sum += column;
+	}
+	if (values.empty()) return std::numeric_limits<float>::quiet_NaN();
+	if (reduction == ofxKuZedConvert::REDUCE_BOX) return sum / values.size();
+	std::sort(values.begin(), values.end());
+	if (reduction == ofxKuZedConvert::REDUCE_MIN) return values[0];
+	return values[(values.size() - 1) / 2];
+}
+
+static bool sameDepth(float a, float b) {
+	return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchRegion() {
+	printf("regions and downscaling\n");
+	const char *reductionNames[] = { "sample", "box", "min", "median" };
+	for (int s = 1; s <= 2; s++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[s];
+		int w = size.w, h = size.h;
+		int step = benchStep(w, 4);
+		std::vector<unsigned char> bgra(size_t(step) * h);
+		for (size_t i = 0; i < bgra.size(); i++) bgra[i] = rand() & 255;
+		std::vector<float> depth;
+		benchFillDepth(depth, w, h, step);
+		const unsigned char *depthData = (const unsigned char *)&depth[0];
+		int stepFloats = step / sizeof(float);
+
+		//Images: whole frame, central quarter region, downscaled frame
+		std::vector<unsigned char> rgb(size_t(w) * h * 3);
+		benchPrint("bgraToRgb whole frame", size, benchMs([&]() {
+			ofxKuZedConvert::bgraToRgb(&bgra[0], step, &rgb[0], w * 3, w, h);
+		}));
+		int rx = w / 4, ry = h / 4, rw = w / 2, rh = h / 2;
+		benchPrint("bgraToRgb region 1/4", size, benchMs([&]() {
+			ofxKuZedConvert::bgraToRgb(&bgra[0] + size_t(step) * ry + 4 * rx, step, &rgb[0], rw * 3, rw, rh);
+		}));
+		for (int factor = 2; factor <= 4; factor *= 2) {
+			int ow = w / factor, oh = h / factor;
+			std::vector<unsigned char> small(size_t(ow) * oh * 3);
+			std::string name = "bgraToRgbDownscale " + std::to_string(factor);
+			benchPrint(name.c_str(), size, benchMs([&]() {
+				ofxKuZedConvert::bgraToRgbDownscale(&bgra[0], step, &small[0], ow * 3, ow, oh, factor);
+			}));
+			bool same = true;
+			for (int y = 0; y < oh && same; y++) {
+				for (int x = 0; x < ow && same; x++) {
+					for (int c = 0; c < 3; c++) {
+						int sum = 0;
+						for (int j = 0; j < factor; j++) {
+							for (int i = 0; i < factor; i++) {
+								sum += bgra[size_t(step) * (y * factor + j) + 4 * (x * factor + i) + 2 - c];
+							}
+						}
+						int area = factor * factor;
+						same = same && small[3 * (x + ow * y) + c] == (sum + area / 2) / area;
+					}
+				}
+			}
+			benchCheck(same, name.c_str());
+		}
+
+		//Depth reductions
+		for (int factor = 2; factor <= 4; factor *= 2) {
+			int ow = w / factor, oh = h / factor;
+			std::vector<float> small(size_t(ow) * oh);
+			for (int reduction = 0; reduction < 4; reduction++) {
+				std::string name = std::string("downscaleDepth ") + std::to_string(factor) + " " + reductionNames[reduction];
+				benchPrint(name.c_str(), size, benchMs([&]() {
+					ofxKuZedConvert::downscaleDepth(depthData, step, (unsigned char *)&small[0], ow * sizeof(float), ow, oh,
+						factor, reduction);
+				}));
+				bool same = true;
+				for (int y = 0; y < oh && same; y++) {
+					for (int x = 0; x < ow && same; x++) {
+						same = sameDepth(small[x + ow * y], referenceBlock(depth, stepFloats, x * factor, y * factor, factor, reduction));
+					}
+				}
+				benchCheck(same, name.c_str());
+			}
+		}
+
+		//Point cloud of region keeps pixel indices of the whole frame
+		std::vector<float> xyz;
+		benchFillXYZRGBA(xyz, w, h, benchStep(w, 16));
+		int xyzStep = benchStep(w, 16);
+		int factor = 2;
+		int ow = rw / factor, oh = rh / factor;
+		std::vector<float> px(size_t(ow) * oh), py(px.size()), pz(px.size());
+		std::vector<int> index(px.size());
+		ofxKuZedConvert::PointsOutput out;
+		out.x = &px[0];
+		out.y = &py[0];
+		out.z = &pz[0];
+		out.index = &index[0];
+		ofxKuZedConvert::PointsParams params;
+		params.hasColors = true;
+		params.decimate = factor;
+		params.indexOffset = rx + w * ry;
+		params.indexStep = w;
+		const unsigned char *xyzRegion = (const unsigned char *)&xyz[0] + size_t(xyzStep) * ry + 16 * rx;
+		int n = 0;
+		benchPrint("xyzToPoints region 1/4, 2", size, benchMs([&]() {
+			n = ofxKuZedConvert::xyzToPoints(xyzRegion, xyzStep, rw, rh, params, out);
+		}));
+		bool same = (n == ow * oh);
+		for (int i = 0; i < n && same; i++) {
+			int x = index[i] % w, y = index[i] / w;
+			same = x >= rx && y >= ry && (x - rx) % factor == 0 && (y - ry) % factor == 0
+				&& sameDepth(px[i], xyz[size_t(xyzStep / 4) * y + 4 * x]);
+		}
+		benchCheck(same, "point indices of region");
+	}
+}
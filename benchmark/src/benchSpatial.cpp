@@ -0,0 +1,140 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedSpatialFilter.h"
+
+//Synthetic scene with known defects: two planes with a 1 m step between them, 1% noise,
+//small rectangular holes and isolated outliers (speckles)
+struct SpatialScene {
+	int w, h, step;
+	std::vector<float> truth;		//w * h
+	std::vector<float> depth;		//with step
+	std::vector<unsigned char> kind;	//0 - normal pixel, 1 - hole, 2 - speckle
+};
+
+static void makeScene(SpatialScene &scene, int w, int h) {
+	scene.w = w;
+	scene.h = h;
+	scene.step = benchStep(w, 4);
+	int stride = scene.step / sizeof(float);
+	scene.truth.resize(size_t(w) * h);
+	scene.depth.assign(size_t(stride) * h, 0);
+	scene.kind.assign(size_t(w) * h, 0);
+	srand(2);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float t = (x < w / 2) ? 1500 + 500.0f * y / h : 2500 + 1000.0f * x / w;
+			scene.truth[x + size_t(w) * y] = t;
+			float noise = ((rand() % 1000) + (rand() % 1000) - 999) / 999.0f;
+			scene.depth[x + size_t(stride) * y] = t * (1 + 0.01f * noise);
+		}
+	}
+	//Holes 1..6 pixels wide, not touching each other and the edge
+	for (int y = 8; y + 8 < h; y += 16) {
+		for (int x = 8; x + 8 < w; x += 16) {
+			if (abs(x - w / 2) < 12) continue;
+			int hw = 1 + rand() % 6, hh = 1 + rand() % 6;
+			for (int j = 0; j < hh; j++) {
+				for (int i = 0; i < hw; i++) {
+					scene.depth[x + i + size_t(stride) * (y + j)] = std::numeric_limits<float>::quiet_NaN();
+					scene.kind[x + i + size_t(w) * (y + j)] = 1;
+				}
+			}
+		}
+	}
+	//Speckles: single pixels far from the surface, away from holes
+	for (int y = 4; y < h; y += 16) {
+		for (int x = 4 + rand() % 4; x < w; x += 16) {
+			scene.depth[x + size_t(stride) * y] = scene.truth[x + size_t(w) * y] + 800;
+			scene.kind[x + size_t(w) * y] = 2;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static void checkScene(const SpatialScene &scene, const std::vector<float> &out, int stage) {
+	int stride = scene.step / sizeof(float);
+	size_t holes = 0, filled = 0, speckles = 0, removed = 0, normal = 0, lost = 0;
+	double holeError = 0, error = 0, inputError = 0;
+	float maxEdgeError = 0;
+	for (int y = 0; y < scene.h; y++) {
+		for (int x = 0; x < scene.w; x++) {
+			size_t i = x + size_t(scene.w) * y;
+			float d = out[x + size_t(stride) * y];
+			float in = scene.depth[x + size_t(stride) * y];
+			bool valid = d > 0 && d - d == 0;
+			float t = scene.truth[i];
+			if (scene.kind[i] == 1) {
+				holes++;
+				if (valid) {
+					filled++;
+					holeError += fabs(d - t);
+				}
+			}
+			else if (scene.kind[i] == 2) {
+				speckles++;
+				if (!valid) removed++;
+			}
+			else {
+				normal++;
+				if (!valid) lost++;
+				else {
+					error += (d - t) * (d - t);
+					inputError += (in - t) * (in - t);
+					if (abs(x - scene.w / 2) <= 1) maxEdgeError = std::max(maxEdgeError, fabsf(d - t));
+				}
+			}
+		}
+	}
+	if (stage == ofxKuZedSpatialFilter::FILL_HOLES) {
+		printf("  %-36s filled %.1f%% of hole pixels, mean error %.1f mm\n", "", 100.0 * filled / holes,
+			(filled > 0) ? holeError / filled : 0.0);
+		benchCheck(filled > 0.95 * holes && holeError < 20.0 * filled, "hole filling");
+	}
+	if (stage == ofxKuZedSpatialFilter::REMOVE_SPECKLES) {
+		printf("  %-36s removed %.1f%% of speckles, %.2f%% of good pixels\n", "", 100.0 * removed / speckles, 100.0 * lost / normal);
+		benchCheck(removed > 0.95 * speckles && lost < 0.01 * normal, "speckle removal");
+	}
+	if (stage == ofxKuZedSpatialFilter::SMOOTH) {
+		size_t n = normal - lost;
+		printf("  %-36s noise rms %.1f -> %.1f mm, max error at step edge %.1f mm\n", "",
+			sqrt(inputError / n), sqrt(error / n), maxEdgeError);
+		//Noise is reduced at least 2 times, and the 1 m step is not blurred (error is about the noise level)
+		benchCheck(error < 0.25 * inputError && maxEdgeError < 50, "edge-preserving smoothing");
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchSpatial() {
+	printf("spatial depth filter\n");
+	const int stages[3] = { ofxKuZedSpatialFilter::SMOOTH, ofxKuZedSpatialFilter::REMOVE_SPECKLES, ofxKuZedSpatialFilter::FILL_HOLES };
+	const char *names[3] = { "smooth r2", "speckles r1", "holes 8" };
+	for (int s = 1; s <= 2; s++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[s];
+		SpatialScene scene;
+		makeScene(scene, size.w, size.h);
+		for (int k = 0; k < 3; k++) {
+			ofxKuZedSpatialFilter filter;
+			filter.setStages(std::vector<int>(1, stages[k]));
+			std::vector<float> reference;
+			int supported = ofxKuZedConvert::simdSupported();
+			for (int simd = 0; simd <= supported; simd++) {
+				ofxKuZedConvert::setSimd(simd);
+				std::vector<float> out;
+				double ms = benchMs([&]() {
+					out = scene.depth;
+					filter.apply((unsigned char *)&out[0], scene.step, size.w, size.h);
+				});
+				std::string name = std::string(names[k]) + " " + ofxKuZedConvert::simdName(simd);
+				benchPrint(name.c_str(), size, ms);
+				//Outputs are compared as bytes, because NaN is not equal to itself
+				if (simd == 0) reference = out;
+				else benchCheck(memcmp(&out[0], &reference[0], out.size() * sizeof(float)) == 0, name.c_str());
+			}
+			ofxKuZedConvert::setSimd(supported);
+			checkScene(scene, reference, stages[k]);
+		}
+	}
+}
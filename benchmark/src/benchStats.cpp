@@ -0,0 +1,92 @@
+#include <cstdlib>
+#include <cmath>
+#include "bench.h"
+#include "ofxKuZedStats.h"
+
+//Exact percentile of samples by the same rank as ofxKuZedHistogram, ms
+static double referencePercentile(std::vector<unsigned long long> samples, double p) {
+	std::sort(samples.begin(), samples.end());
+	int n = int(samples.size());
+	int rank = std::max(1, std::min(n, int(std::ceil(p * n))));
+	return samples[rank - 1] * 1e-6;
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchStats() {
+	printf("timing instrumentation\n");
+
+	//Cost of probe: two clock reads and adding a sample
+	ofxKuZedStats stats;
+	const int probes = 100000;
+	double ms = benchMs([&]() {
+		for (int i = 0; i < probes; i++) {
+			ofxKuZedStats::Probe probe(stats, ZED_STAT_LEFT_PIXELS);
+		}
+	});
+	printf("  %-36s %9.1f ns\n", "probe", ms * 1e6 / probes);
+	ms = benchMs([&]() {
+		for (int i = 0; i < probes; i++) stats.add(ZED_STAT_DEPTH_MM, 1000 + i);
+	});
+	printf("  %-36s %9.1f ns\n", "add sample", ms * 1e6 / probes);
+	stats.setEnabled(false);
+	ms = benchMs([&]() {
+		for (int i = 0; i < probes; i++) {
+			ofxKuZedStats::Probe probe(stats, ZED_STAT_LEFT_PIXELS);
+		}
+	});
+	printf("  %-36s %9.1f ns\n", "probe, disabled", ms * 1e6 / probes);
+	ms = benchMs([&]() { stats.get(ZED_STAT_DEPTH_MM).summary(); });
+	printf("  %-36s %9.1f ns\n", "summary", ms * 1e6);
+
+	//Percentiles of rolling window: long-tailed durations (0.5..50 ms), more samples than window
+	srand(3);
+	ofxKuZedHistogram histogram;
+	std::vector<unsigned long long> window;
+	for (int i = 0; i < 3 * ofxKuZedHistogram::WINDOW + 17; i++) {
+		double u = (rand() % 10000) / 10000.0;
+		unsigned long long ns = (unsigned long long)(500000 * std::pow(100.0, u * u * u));
+		histogram.add(ns);
+		window.push_back(ns);
+		if (int(window.size()) > ofxKuZedHistogram::WINDOW) window.erase(window.begin());
+	}
+	ofxKuZedHistogram::Summary s = histogram.summary();
+	double p[3] = { 0.50, 0.95, 0.99 };
+	double got[3] = { s.p50, s.p95, s.p99 };
+	bool close = (s.count == ofxKuZedHistogram::WINDOW);
+	for (int i = 0; i < 3; i++) {
+		double ref = referencePercentile(window, p[i]);
+		close = close && std::fabs(got[i] - ref) <= ref / 16;
+	}
+	double mean = 0, maxMs = 0;
+	for (size_t i = 0; i < window.size(); i++) {
+		mean += window[i] * 1e-6 / window.size();
+		maxMs = std::max(maxMs, window[i] * 1e-6);
+	}
+	close = close && std::fabs(s.mean - mean) < 1e-6 && s.max == maxMs;
+	benchCheck(close, "histogram percentiles");
+	printf("  %-36s p50 %.3f, p95 %.3f, p99 %.3f, max %.3f ms\n", "window of long-tailed durations", s.p50, s.p95, s.p99, s.max);
+
+	//Frames at 30 fps with jitter: camera skips 5 frames, capture thread replaces 7 frames
+	ofxKuZedStats frames;
+	const double period = 1e9 / 30;
+	unsigned long long id = 0;
+	int skipped = 0, replaced = 0;
+	for (int i = 0; i < 300; i++) {
+		bool skip = (i % 60 == 30);
+		if (skip) {
+			skipped++;
+			continue;
+		}
+		id++;
+		if (i % 40 == 20) {
+			replaced++;
+			continue;
+		}
+		unsigned long long timestamp = (unsigned long long)(1e12 + i * period + (rand() % 2000000) - 1000000);
+		frames.addFrame(id, timestamp, 0);
+	}
+	bool framesOk = frames.getDroppedFrames() == (unsigned long long)(skipped + replaced)
+		&& std::fabs(frames.getFps() - 30) < 0.1;
+	benchCheck(framesOk, "dropped frames and fps");
+	printf("  %-36s fps %.2f, dropped %llu (expected %d)\n", "30 fps with gaps", frames.getFps(), frames.getDroppedFrames(), skipped + replaced);
+}
@@ -0,0 +1,224 @@
+#include <cstdio>
+#include <map>
+#include "bench.h"
+#include "ofxKuZedStream.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedSyntheticSource.h"
+
+//Streaming over loopback: synthetic frames are sent by ofxKuZedStreamServer with TCP and UDP,
+//and frames received by ofxKuZedStreamClient are compared with the sent ones: images are raw, so exact,
+//depth is equal to ofxKuZedDepthCodec round trip. Then client gets malformed messages and packets from fake servers.
+
+static const int streamPort = 29517;
+
+//Sent frame: depth after codec, left image
+struct StreamReference {
+	std::vector<float> depth;
+	std::vector<unsigned char> left;
+};
+
+//------------------------------------------------------------------------------------------------------
+static void streamRoundTrip(int protocol) {
+	const char *name = (protocol == ZED_STREAM_TCP) ? "TCP" : "UDP";
+	const int w = 320;
+	const int h = 240;
+	ofxKuZedSyntheticSource source;
+	source.open(w, h, 0);
+
+	ofxKuZedStreamServer server;
+	bool ok = server.setup(streamPort + protocol, protocol);
+	server.setChannels(ZED_STREAM_ALL);
+	server.setImageFormat(ZED_STREAM_FORMAT_RAW);
+	server.setDepthFormat(ZED_STREAM_FORMAT_DEPTH, 1);
+
+	//Server side: frames every 10 ms, references by timestamp
+	std::mutex mutex;
+	std::map<unsigned long long, StreamReference> sent;
+	std::atomic<bool> sending(ok);
+	std::thread sender([&]() {
+		ofxKuZedDepthCodec codec;
+		std::vector<unsigned char> encoded;
+		ofxKuZedFrame frame;
+		ofxKuZedBuffer view;
+		while (sending) {
+			source.grab(true, false);
+			frame.id++;
+			frame.timestamp = source.getTimestamp();
+			for (int c = ZED_CHANNEL_LEFT; c <= ZED_CHANNEL_DEPTH; c++) {
+				source.retrieve(c, view);
+				frame[c].copyFrom(view);
+			}
+			StreamReference reference;
+			reference.depth.resize(size_t(w) * h);
+			const ofxKuZedBuffer &depth = frame[ZED_CHANNEL_DEPTH];
+			size_t size = codec.encode(depth.data, depth.step, w, h, encoded);
+			codec.decode(&encoded[0], size, (unsigned char *)&reference.depth[0], w * sizeof(float), w, h);
+			const ofxKuZedBuffer &left = frame[ZED_CHANNEL_LEFT];
+			reference.left.resize(size_t(w) * h * 4);
+			ofxKuZedConvert::copyRows(left.data, left.step, &reference.left[0], w * 4, w * 4, h);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				sent[frame.timestamp] = reference;
+			}
+			server.send(frame, source.getIntrinsics());
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	});
+
+	//Client side
+	ofxKuZedStreamClient client;
+	ok = ok && client.setup("127.0.0.1", streamPort + protocol, protocol, 5000);
+	ok = ok && client.getWidth() == w && client.getHeight() == h;
+	int received = 0;
+	bool same = true;
+	auto start = std::chrono::steady_clock::now();
+	while (ok && received < 10 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+		if (!client.grab(true, false)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			continue;
+		}
+		received++;
+		ofxKuZedBuffer depth, left;
+		client.retrieve(ZED_CHANNEL_DEPTH, depth);
+		client.retrieve(ZED_CHANNEL_LEFT, left);
+		std::lock_guard<std::mutex> lock(mutex);
+		auto reference = sent.find(client.getTimestamp());
+		same = same && reference != sent.end() && depth.width == w && depth.height == h && left.width == w && left.height == h;
+		for (int y = 0; y < h && same; y++) {
+			same = memcmp(depth.row<float>(y), &reference->second.depth[size_t(w) * y], w * sizeof(float)) == 0;
+			const unsigned char *p = left.row<unsigned char>(y);
+			const unsigned char *q = &reference->second.left[size_t(w) * 4 * y];
+			for (int x = 0; x < w * 4 && same; x++) {
+				same = (x % 4 == 3) || p[x] == q[x];	//alpha is not sent
+			}
+		}
+	}
+	sending = false;
+	sender.join();
+	printf("  %-36s received %d frames, latency %.2f ms, server dropped %llu\n", name, received,
+		client.getLatencyMs(), server.getDroppedFrames());
+	client.close();
+	server.close();
+	benchCheck(ok && received == 10 && same, (protocol == ZED_STREAM_TCP) ? "TCP stream" : "UDP stream");
+}
+
+//------------------------------------------------------------------------------------------------------
+//Fake server sends empty message and a header with huge size, then a valid 2 x 1 raw depth frame.
+//Client should skip bad messages and keep the connection
+static void streamMalformed() {
+	ofxKuZedSocket listener;
+	bool ok = listener.listen(streamPort + 2, false);
+	ofxKuZedStreamClient client;
+	std::atomic<bool> setupOk(false);
+	std::thread connecting([&]() { setupOk = client.setup("127.0.0.1", streamPort + 2, ZED_STREAM_TCP, 3000); });
+
+	ofxKuZedSocket server;
+	ok = ok && listener.wait(3000) && listener.accept(server);
+	std::vector<unsigned char> messages;
+	auto append = [&](const void *data, size_t size) {
+		messages.insert(messages.end(), (const unsigned char *)data, (const unsigned char *)data + size);
+	};
+	uint32_t size = 0;
+	append(&size, sizeof(size));
+
+	ofxKuZedStreamFrameHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "KZSF", 4);
+	header.channels = 1;
+	header.id = 1;
+	ofxKuZedStreamChannelHeader channel;
+	memset(&channel, 0, sizeof(channel));
+	channel.channel = ZED_CHANNEL_DEPTH;
+	channel.format = ZED_STREAM_FORMAT_RAW;
+	float depth[2] = { 1000, 2000 };
+	channel.size = sizeof(depth);
+	size = sizeof(header) + sizeof(channel) + sizeof(depth);
+	unsigned sizes[3][2] = { { 0xFFFFFFFF, 0xFFFFFFFF }, { 0x80000000, 1 }, { 2, 1 } };
+	for (int i = 0; i < 3; i++) {
+		header.width = sizes[i][0];
+		header.height = sizes[i][1];
+		append(&size, sizeof(size));
+		append(&header, sizeof(header));
+		append(&channel, sizeof(channel));
+		append(depth, sizeof(depth));
+	}
+	ok = ok && server.sendAll(&messages[0], messages.size());
+	connecting.join();
+	ok = ok && setupOk && client.getWidth() == 2 && client.getHeight() == 1 && client.grab(true, false);
+	ofxKuZedBuffer buffer;
+	if (ok) client.retrieve(ZED_CHANNEL_DEPTH, buffer);
+	ok = ok && !buffer.empty() && memcmp(buffer.data, depth, sizeof(depth)) == 0;
+	client.close();
+	benchCheck(ok, "malformed stream messages");
+}
+
+//------------------------------------------------------------------------------------------------------
+//Fake UDP server answers the client hello with packets whose headers disagree with the message:
+//huge packet count and wrong data offset, then with the valid packet of the same message.
+//Client should drop bad packets without allocating for them, and assemble the valid one
+static void streamMalformedUdp() {
+	ofxKuZedSocket server;
+	bool ok = server.listen(streamPort + 3, true);
+	ofxKuZedStreamClient client;
+	std::atomic<bool> setupOk(false);
+	std::thread connecting([&]() { setupOk = client.setup("127.0.0.1", streamPort + 3, ZED_STREAM_UDP, 3000); });
+
+	ofxKuZedStreamFrameHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "KZSF", 4);
+	header.channels = 1;
+	header.id = 1;
+	header.width = 2;
+	header.height = 1;
+	ofxKuZedStreamChannelHeader channel;
+	memset(&channel, 0, sizeof(channel));
+	channel.channel = ZED_CHANNEL_DEPTH;
+	channel.format = ZED_STREAM_FORMAT_RAW;
+	float depth[2] = { 1000, 2000 };
+	channel.size = sizeof(depth);
+	std::vector<unsigned char> message;
+	auto append = [&](std::vector<unsigned char> &to, const void *data, size_t size) {
+		to.insert(to.end(), (const unsigned char *)data, (const unsigned char *)data + size);
+	};
+	append(message, &header, sizeof(header));
+	append(message, &channel, sizeof(channel));
+	append(message, depth, sizeof(depth));
+
+	ofxKuZedStreamPacketHeader packet;
+	memset(&packet, 0, sizeof(packet));
+	memcpy(packet.magic, "KZSP", 4);
+	packet.messageSize = uint32_t(message.size());
+	packet.payload = 1400;
+	packet.message = 1;
+	ofxKuZedAddress address;
+	std::vector<unsigned char> hello(64);
+	ok = ok && server.wait(3000) && server.receiveFrom(&hello[0], hello.size(), address) > 0;
+	for (int i = 0; i < 3 && ok; i++) {
+		ofxKuZedStreamPacketHeader p = packet;
+		size_t offset = 0;
+		if (i == 0) p.count = 0xFFFFFFFF;
+		else p.count = 1;
+		if (i == 1) offset = p.offset = 8;
+		std::vector<unsigned char> data;
+		append(data, &p, sizeof(p));
+		append(data, &message[offset], message.size() - offset);
+		ok = server.sendTo(&data[0], data.size(), address);
+	}
+	connecting.join();
+	ok = ok && setupOk && client.getWidth() == 2 && client.getHeight() == 1 && client.grab(true, false);
+	ofxKuZedBuffer buffer;
+	if (ok) client.retrieve(ZED_CHANNEL_DEPTH, buffer);
+	ok = ok && !buffer.empty() && memcmp(buffer.data, depth, sizeof(depth)) == 0;
+	client.close();
+	server.close();
+	benchCheck(ok, "malformed UDP packets");
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchStream() {
+	printf("streaming over loopback\n");
+	streamRoundTrip(ZED_STREAM_TCP);
+	streamRoundTrip(ZED_STREAM_UDP);
+	streamMalformed();
+	streamMalformedUdp();
+}
@@ -0,0 +1,126 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedTemporalFilter.h"
+
+//Synthetic noisy sequence: static ramp scene with per-frame noise (about 1% of depth, like stereo on
+//textureless surfaces) and random holes
+static void noisyFrame(std::vector<float> &depth, const std::vector<float> &truth, int w, int h, int step) {
+	int stepFloats = step / sizeof(float);
+	depth.assign(size_t(stepFloats) * h, 0);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float t = truth[x + size_t(w) * y];
+			float noise = ((rand() % 1000) + (rand() % 1000) - 999) / 999.0f;	//triangular in [-1, 1]
+			float d = t * (1 + 0.01f * noise);
+			if (rand() % 100 < 10) d = std::numeric_limits<float>::quiet_NaN();
+			depth[x + size_t(stepFloats) * y] = d;
+		}
+	}
+}
+
+//RMS error relative to truth over valid pixels, and share of valid pixels
+static void frameError(const std::vector<float> &depth, const std::vector<float> &truth, int w, int h, int step,
+	double &rms, double &valid) {
+	int stepFloats = step / sizeof(float);
+	double sum = 0;
+	size_t n = 0;
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float d = depth[x + size_t(stepFloats) * y];
+			if (!(d > 0 && d - d == 0)) continue;
+			double e = d - truth[x + size_t(w) * y];
+			sum += e * e;
+			n++;
+		}
+	}
+	rms = (n > 0) ? sqrt(sum / n) : 0;
+	valid = double(n) / (double(w) * h);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Hole persistence: after constant depth, pixels of a row become holes. They keep the filtered value
+//for holdFrames frames and are 0 after that. Width is not a multiple of SIMD width, so row tails are checked too
+static bool holdCheck() {
+	const int w = 67;
+	const int h = 3;
+	const int hold = 3;
+	ofxKuZedTemporalFilter filter;
+	filter.setHoldFrames(hold);
+	std::vector<float> depth(size_t(w) * h);
+	bool ok = true;
+	for (int i = 0; i < 5 + hold + 2 && ok; i++) {
+		bool holes = (i >= 5);
+		for (int x = 0; x < w; x++) {
+			depth[x] = 2000;
+			depth[x + w] = (holes) ? std::numeric_limits<float>::quiet_NaN() : 2000;
+			depth[x + 2 * w] = (holes) ? 0 : 2000;
+		}
+		filter.apply((unsigned char *)&depth[0], w * sizeof(float), w, h);
+		float held = (i < 5 + hold) ? 2000.0f : 0.0f;
+		for (int x = 0; x < w; x++) {
+			ok = ok && depth[x] == 2000 && depth[x + w] == held && depth[x + 2 * w] == held;
+		}
+	}
+	return ok;
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchTemporal() {
+	printf("temporal depth filter\n");
+	const int frames = 20;
+	for (int s = 0; s < benchSizesCount; s++) {
+		const BenchSize &size = benchSizes[s];
+		int w = size.w;
+		int h = size.h;
+		int step = benchStep(w, 4);
+		std::vector<float> truth(size_t(w) * h);
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) truth[x + size_t(w) * y] = 1000 + 3000.0f * x / w + 1000.0f * y / h;
+		}
+		srand(1);
+		std::vector<std::vector<float> > sequence(frames);
+		for (int i = 0; i < frames; i++) noisyFrame(sequence[i], truth, w, h, step);
+
+		std::vector<std::vector<float> > reference;
+		int supported = ofxKuZedConvert::simdSupported();
+		for (int simd = 0; simd <= supported; simd++) {
+			ofxKuZedConvert::setSimd(simd);
+			ofxKuZedTemporalFilter filter;
+			std::vector<std::vector<float> > out = sequence;
+			double ms = 0;
+			for (int i = 0; i < frames; i++) {
+				auto t0 = std::chrono::high_resolution_clock::now();
+				filter.apply((unsigned char *)&out[i][0], step, w, h);
+				auto t1 = std::chrono::high_resolution_clock::now();
+				if (i > 0) ms += std::chrono::duration<double, std::milli>(t1 - t0).count();	//first frame allocates state
+			}
+			ms /= frames - 1;
+			std::string name = std::string("temporal ") + ofxKuZedConvert::simdName(simd);
+			benchPrint(name.c_str(), size, ms);
+			if (simd == 0) reference = out;
+			else benchCheck(out == reference, name.c_str());
+
+			if (simd == supported) {
+				double rmsIn, validIn, rmsOut, validOut;
+				frameError(sequence[frames - 1], truth, w, h, step, rmsIn, validIn);
+				frameError(out[frames - 1], truth, w, h, step, rmsOut, validOut);
+				printf("  %-28s %-7s %9.3f ms/Mpix, noise rms %.1f -> %.1f mm, valid %.0f%% -> %.0f%%, state %.1f MB\n",
+					"", size.name, ms * 1e6 / (double(w) * h), rmsIn, rmsOut, validIn * 100, validOut * 100, filter.getStateBytes() / 1e6);
+				//Default history 4 is EMA with weight 0.4, it reduces noise rms about 2 times.
+				//Holes are random 10% of pixels in each frame, so holding for 3 frames fills almost all of them
+				benchCheck(rmsOut < 0.6 * rmsIn, ("temporal noise reduction " + std::string(size.name)).c_str());
+				benchCheck(validOut > 0.99, ("temporal hole filling " + std::string(size.name)).c_str());
+			}
+		}
+		ofxKuZedConvert::setSimd(supported);
+	}
+	int supported = ofxKuZedConvert::simdSupported();
+	for (int simd = 0; simd <= supported; simd++) {
+		ofxKuZedConvert::setSimd(simd);
+		benchCheck(holdCheck(), (std::string("temporal hold frames ") + ofxKuZedConvert::simdName(simd)).c_str());
+	}
+	ofxKuZedConvert::setSimd(supported);
+}
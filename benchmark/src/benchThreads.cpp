@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+
+//------------------------------------------------------------------------------------------------------
+//Scaling of row-band conversions with the number of worker threads, HD2K frame
+void benchThreads() {
+	const BenchSize &size = benchSizes[benchSizesCount - 1];
+	int w = size.w;
+	int h = size.h;
+	printf("thread scaling, %s (hardware threads: %d)\n", size.name, int(std::thread::hardware_concurrency()));
+
+	int stepColor = benchStep(w, 4);
+	std::vector<unsigned char> color(size_t(stepColor) * h);
+	for (size_t i = 0; i < color.size(); i++) color[i] = rand() & 255;
+
+	int stepDepth = benchStep(w, 4);
+	std::vector<float> depth;
+	benchFillDepth(depth, w, h, stepDepth);
+
+	int stepXYZ = benchStep(w, 16);
+	std::vector<float> xyz;
+	benchFillXYZRGBA(xyz, w, h, stepXYZ);
+
+	std::vector<unsigned char> rgb(size_t(w) * h * 3), rgbRef(rgb.size());
+	std::vector<unsigned char> gray(size_t(w) * h), grayRef(gray.size());
+	std::vector<float> depthCopy(size_t(w) * h);
+	std::vector<float> vertices(size_t(w) * h * 7, 0), verticesRef(vertices.size(), 0);
+
+	ofxKuZedConvert::PointsOutput out;
+	out.xyzStride = out.rgbaFloatStride = 7;
+	ofxKuZedConvert::PointsParams params;
+	params.hasColors = true;
+	params.signY = params.signZ = -1;
+	params.dropInvalid = true;
+
+	int counts[] = { 1, 2, 4, 8 };
+	for (int c = 0; c < 4; c++) {
+		int threads = counts[c];
+		ofxKuZedWorkers::shared().setThreads(threads);
+		printf(" %d thread(s)\n", threads);
+		bool reference = (threads == 1);
+
+		unsigned char *dstRgb = (reference) ? &rgbRef[0] : &rgb[0];
+		benchPrint("bgraToRgb", size, benchMs([&]() { ofxKuZedConvert::bgraToRgb(&color[0], stepColor, dstRgb, w * 3, w, h); }));
+
+		unsigned char *dstGray = (reference) ? &grayRef[0] : &gray[0];
+		benchPrint("depthToGray", size, benchMs([&]() {
+			ofxKuZedConvert::depthToGray((const unsigned char*)&depth[0], stepDepth, dstGray, w, w, h, 0, 5000);
+		}));
+
+		benchPrint("copyRows (depth)", size, benchMs([&]() {
+			ofxKuZedConvert::copyRows((const unsigned char*)&depth[0], stepDepth, (unsigned char*)&depthCopy[0], w * 4, w * 4, h);
+		}));
+
+		float *v = (reference) ? &verticesRef[0] : &vertices[0];
+		out.x = v;
+		out.y = v + 1;
+		out.z = v + 2;
+		out.rgbaFloat = v + 3;
+		int n = 0;
+		benchPrint("xyzToPoints, compact", size, benchMs([&]() {
+			n = ofxKuZedConvert::xyzToPoints((const unsigned char*)&xyz[0], stepXYZ, w, h, params, out);
+		}));
+
+		if (!reference) {
+			benchCheck(rgb == rgbRef, "bgraToRgb");
+			benchCheck(gray == grayRef, "depthToGray");
+			benchCheck(memcmp(&vertices[0], &verticesRef[0], size_t(n) * 7 * sizeof(float)) == 0, "xyzToPoints");
+		}
+	}
+	ofxKuZedWorkers::shared().setThreads(0);
+
+	//Restarting pool: each call after setThreads() should process every row exactly once,
+	//and return only when all bands are done
+	ofxKuZedWorkers pool;
+	std::vector<std::atomic<int>> rows(256);
+	bool once = true;
+	for (int i = 0; i < 2000 && once; i++) {
+		if (i % 3 == 0) pool.setThreads(2 + (i / 3) % 4);
+		for (size_t y = 0; y < rows.size(); y++) rows[y] = 0;
+		pool.parallelRows(int(rows.size()), [&](int y0, int y1) {
+			for (int y = y0; y < y1; y++) rows[y]++;
+		}, 1);
+		for (size_t y = 0; y < rows.size(); y++) once = once && (rows[y] == 1);
+	}
+	benchCheck(once, "parallelRows after setThreads");
+}
@@ -0,0 +1,164 @@
+#include <cstdlib>
+#include "bench.h"
+
+#ifndef OFXKUZED_BENCH_GL
+
+//------------------------------------------------------------------------------------------------------
+void benchUpload() {
+	printf("texture upload: skipped, benchmark is built without EGL and OpenGL\n");
+}
+
+#else
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedTextureUpload.h"
+
+//Headless GL context without window: EGL surfaceless platform (Mesa llvmpipe on servers), or default display
+static bool createContext() {
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+	if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) return false;
+	if (!eglBindAPI(EGL_OPENGL_API)) return false;
+	EGLint attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = 0;
+	EGLint configs = 0;
+	eglChooseConfig(display, attributes, &config, 1, &configs);
+	EGLContext context = eglCreateContext(display, (configs > 0) ? config : 0, EGL_NO_CONTEXT, 0);
+	if (context == EGL_NO_CONTEXT) return false;
+	return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+
+static GLuint createTexture(int w, int h, GLenum internalFormat, GLenum format) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, GL_UNSIGNED_BYTE, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+static bool textureEquals(GLuint texture, GLenum format, const std::vector<unsigned char> &expected) {
+	std::vector<unsigned char> data(expected.size());
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexImage(GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, &data[0]);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return data == expected;
+}
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+static double msSince(BenchClock::time_point t0) {
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - t0).count();
+}
+
+//Like ofxKuZed textures: left and right RGB images and grayscale depth, 3 uploads per frame.
+//"Stall" is time spent in GL calls by the application thread, "frame" includes conversions and glFinish
+//------------------------------------------------------------------------------------------------------
+void benchUpload() {
+	if (!createContext()) {
+		printf("texture upload: skipped, no EGL context\n");
+		return;
+	}
+	printf("texture upload, left + right RGB + depth gray per frame (%s)\n", (const char *)glGetString(GL_RENDERER));
+	const int frames = 30;
+	for (int s = 1; s <= 2; s++) {	//HD720, HD1080
+		const BenchSize &size = benchSizes[s];
+		int w = size.w, h = size.h;
+		int imageStep = benchStep(w, 4);
+		int depthStep = benchStep(w, 4);
+		std::vector<unsigned char> left(size_t(imageStep) * h), right(left.size());
+		for (size_t i = 0; i < left.size(); i++) {
+			left[i] = rand() & 255;
+			right[i] = rand() & 255;
+		}
+		std::vector<float> depth;
+		benchFillDepth(depth, w, h, depthStep);
+		const unsigned char *depthData = (const unsigned char *)&depth[0];
+		const float minMm = 0, maxMm = 5000;
+
+		//Expected texture contents
+		std::vector<unsigned char> leftRgb(size_t(w) * h * 3), rightRgb(leftRgb.size()), gray(size_t(w) * h);
+		ofxKuZedConvert::bgraToRgb(&left[0], imageStep, &leftRgb[0], w * 3, w, h);
+		ofxKuZedConvert::bgraToRgb(&right[0], imageStep, &rightRgb[0], w * 3, w, h);
+		ofxKuZedConvert::depthToGray(depthData, depthStep, &gray[0], w, w, h, minMm, maxMm);
+
+		GLuint textures[3] = {
+			createTexture(w, h, GL_RGB8, GL_RGB),
+			createTexture(w, h, GL_RGB8, GL_RGB),
+			createTexture(w, h, GL_R8, GL_RED)
+		};
+
+		//Synchronous: convert into pixels, then glTexSubImage2D from client memory (ofTexture::loadData)
+		std::vector<unsigned char> leftPixels(leftRgb.size()), rightPixels(rightRgb.size()), grayPixels(gray.size());
+		double stall = 0, frame = 1e30;
+		for (int i = 0; i < frames; i++) {
+			BenchClock::time_point t0 = BenchClock::now();
+			ofxKuZedConvert::bgraToRgb(&left[0], imageStep, &leftPixels[0], w * 3, w, h);
+			ofxKuZedConvert::bgraToRgb(&right[0], imageStep, &rightPixels[0], w * 3, w, h);
+			ofxKuZedConvert::depthToGray(depthData, depthStep, &grayPixels[0], w, w, h, minMm, maxMm);
+			BenchClock::time_point t1 = BenchClock::now();
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			const unsigned char *pixels[3] = { &leftPixels[0], &rightPixels[0], &grayPixels[0] };
+			GLenum formats[3] = { GL_RGB, GL_RGB, GL_RED };
+			for (int t = 0; t < 3; t++) {
+				glBindTexture(GL_TEXTURE_2D, textures[t]);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, formats[t], GL_UNSIGNED_BYTE, pixels[t]);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+			stall += msSince(t1);
+			glFinish();
+			frame = std::min(frame, msSince(t0));
+		}
+		printf("  %-28s %-7s %9.3f ms stall %9.3f ms frame\n", "loadData from pixels", size.name, stall / frames, frame);
+		benchCheck(textureEquals(textures[0], GL_RGB, leftRgb) && textureEquals(textures[1], GL_RGB, rightRgb)
+			&& textureEquals(textures[2], GL_RED, gray), "sync upload");
+
+		//Streaming: conversion into mapped PBOs of ring, asynchronous copy into textures
+		for (int ringSize = 1; ringSize <= 3; ringSize += 2) {
+			ofxKuZedTextureUpload uploads[3];
+			uploads[0].setup(w, h, 3, GL_RGB, ringSize);
+			uploads[1].setup(w, h, 3, GL_RGB, ringSize);
+			uploads[2].setup(w, h, 1, GL_RED, ringSize);
+			stall = 0;
+			frame = 1e30;
+			bool mapped = true;
+			for (int i = 0; i < frames; i++) {
+				BenchClock::time_point t0 = BenchClock::now();
+				double calls = 0;
+				for (int t = 0; t < 3; t++) {
+					BenchClock::time_point c0 = BenchClock::now();
+					unsigned char *dst = uploads[t].begin();
+					calls += msSince(c0);
+					if (!dst) {
+						mapped = false;
+						continue;
+					}
+					if (t < 2) ofxKuZedConvert::bgraToRgb((t == 0) ? &left[0] : &right[0], imageStep, dst, uploads[t].getStep(), w, h);
+					else ofxKuZedConvert::depthToGray(depthData, depthStep, dst, uploads[t].getStep(), w, h, minMm, maxMm);
+					BenchClock::time_point c1 = BenchClock::now();
+					uploads[t].end(textures[t], GL_TEXTURE_2D);
+					calls += msSince(c1);
+				}
+				stall += calls;
+				glFinish();
+				frame = std::min(frame, msSince(t0));
+			}
+			std::string name = "PBO ring " + std::to_string(ringSize);
+			printf("  %-28s %-7s %9.3f ms stall %9.3f ms frame\n", name.c_str(), size.name, stall / frames, frame);
+			if (!mapped) printf("  ERROR: %s, mapping failed\n", name.c_str());
+			//Texture contents differ from sync upload by row alignment only, reading back in tight rows
+			benchCheck(textureEquals(textures[0], GL_RGB, leftRgb) && textureEquals(textures[1], GL_RGB, rightRgb)
+				&& textureEquals(textures[2], GL_RED, gray), name.c_str());
+		}
+		glDeleteTextures(3, textures);
+	}
+}
+
+#endif
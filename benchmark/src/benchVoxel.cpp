@@ -0,0 +1,176 @@
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedVoxelGrid.h"
+#include "ofxKuZedWorkers.h"
+
+//Organized cloud of a camera looking at a wall with a bump, in interleaved layout (xyz + float rgba),
+//10% of pixels are invalid in small blocks, like stereo holes
+static void fillSurface(std::vector<float> &vertices, int w, int h) {
+	vertices.resize(size_t(w) * h * 7);
+	float f = w * 0.75f;
+	srand(3);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			float *v = &vertices[(x + size_t(w) * y) * 7];
+			float dx = x - w * 0.5f, dy = y - h * 0.5f;
+			float z = 2500 + 0.3f * dx - 600 * expf(-(dx * dx + dy * dy) / (0.04f * w * w));
+			if (((x / 8 * 7 + y / 8 * 13) % 10) == 0) z = std::numeric_limits<float>::quiet_NaN();
+			v[0] = dx * z / f;
+			v[1] = -dy * z / f;
+			v[2] = -z;
+			v[3] = (x & 255) / 255.0f;
+			v[4] = (y & 255) / 255.0f;
+			v[5] = (rand() & 255) / 255.0f;
+			v[6] = 1;
+		}
+	}
+}
+
+//Random points in a box: no coherence, the worst case for the last voxel cache and the hash table
+static void fillRandom(std::vector<float> &vertices, int n) {
+	vertices.resize(size_t(n) * 7);
+	for (int i = 0; i < n; i++) {
+		float *v = &vertices[size_t(i) * 7];
+		v[0] = (rand() % 40000) * 0.1f - 2000;
+		v[1] = (rand() % 30000) * 0.1f - 1500;
+		v[2] = -1000 - (rand() % 30000) * 0.1f;
+		v[3] = v[4] = v[5] = v[6] = 0.5f;
+	}
+}
+
+//Straightforward implementation with the same voxel coordinates and voxel order (order of the first point),
+//sums in double
+static void reference(const std::vector<float> &vertices, int n, float leaf, int level, bool firstPoint,
+	std::vector<float> &out) {
+	std::unordered_map<uint64_t, size_t> index;
+	std::vector<double> sums;	//x, y, z, count
+	for (int i = 0; i < n; i++) {
+		const float *v = &vertices[size_t(i) * 7];
+		int64_t k[3];
+		bool ok = true;
+		for (int j = 0; j < 3; j++) {
+			//The same coordinates as in ofxKuZedVoxelGrid: shifted by 2^16 before truncation
+			float t = v[j] * (1 / leaf) + 65536.0f;
+			ok = ok && t >= 0 && t < 131072.0f;
+			if (ok) k[j] = int64_t(t) >> level;
+		}
+		if (!ok) continue;
+		uint64_t key = uint64_t(k[0]) | (uint64_t(k[1]) << 21) | (uint64_t(k[2]) << 42);
+		auto it = index.find(key);
+		size_t s;
+		if (it == index.end()) {
+			s = sums.size();
+			index[key] = s;
+			sums.resize(s + 4, 0);
+			for (int j = 0; j < 3; j++) sums[s + j] = v[j];
+		}
+		else {
+			s = it->second;
+			if (!firstPoint) for (int j = 0; j < 3; j++) sums[s + j] += v[j];
+		}
+		sums[s + 3]++;
+	}
+	out.resize(sums.size() / 4 * 3);
+	for (size_t i = 0; i < sums.size() / 4; i++) {
+		for (int j = 0; j < 3; j++) out[i * 3 + j] = float((firstPoint) ? sums[i * 4 + j] : sums[i * 4 + j] / sums[i * 4 + 3]);
+	}
+}
+
+//Points of level, interleaved xyz + float rgba
+static void writeLevel(const ofxKuZedVoxelGrid &grid, int level, std::vector<float> &out) {
+	out.resize(size_t(grid.size(level)) * 7 + 1);
+	ofxKuZedConvert::PointsOutput o;
+	o.x = &out[0];
+	o.y = o.x + 1;
+	o.z = o.x + 2;
+	o.xyzStride = 7;
+	o.rgbaFloat = o.x + 3;
+	o.rgbaFloatStride = 7;
+	out.resize(size_t(grid.write(level, o)) * 7);
+}
+
+//------------------------------------------------------------------------------------------------------
+//limitMs - time limits of one thread for each leaf, or 0
+static void testCloud(const char *name, const std::vector<float> &vertices, int n, int maxThreads, const double *limitMs) {
+	const BenchSize size = { name, n, 1 };
+	ofxKuZedConvert::PointsOutput in;
+	in.x = const_cast<float *>(&vertices[0]);
+	in.y = in.x + 1;
+	in.z = in.x + 2;
+	in.xyzStride = 7;
+	in.rgbaFloat = in.x + 3;
+	in.rgbaFloatStride = 7;
+
+	const float leafs[3] = { 5, 10, 20 };
+	for (int l = 0; l < 3; l++) {
+		for (int policy = 0; policy < 2; policy++) {
+			ofxKuZedVoxelGrid grid;
+			grid.setLeafSize(leafs[l]);
+			grid.setPolicy(policy);
+			grid.setLevels(3);
+			for (int threads = 1; threads <= maxThreads; threads *= 2) {
+				ofxKuZedWorkers::shared().setThreads(threads);
+				char test[64];
+				snprintf(test, sizeof(test), "%s %gmm %dt", (policy) ? "first" : "centroid", leafs[l], threads);
+				auto process = [&]() { grid.process(in, n); };
+				double ms = (threads == 1 && limitMs) ? benchBudget(process, limitMs[l], test) : benchMs(process);
+				benchPrint(test, size, ms);
+			}
+
+			//SIMD and scalar versions give equal points
+			ofxKuZedWorkers::shared().setThreads(1);
+			std::vector<float> simdPoints, scalarPoints;
+			grid.process(in, n);
+			writeLevel(grid, 2, simdPoints);
+			int supported = ofxKuZedConvert::simdSupported();
+			ofxKuZedConvert::setSimd(ofxKuZedConvert::SIMD_SCALAR);
+			grid.process(in, n);
+			writeLevel(grid, 2, scalarPoints);
+			ofxKuZedConvert::setSimd(supported);
+			benchCheck(simdPoints == scalarPoints, "voxel grid SIMD");
+
+			//Compare levels 0 and 1 with the reference
+			for (int level = 0; level < 2; level++) {
+				std::vector<float> ref;
+				reference(vertices, n, leafs[l], level, policy == ofxKuZedVoxelGrid::FIRST_POINT, ref);
+				std::vector<float> out;
+				writeLevel(grid, level, out);
+				int m = int(out.size() / 7);
+				bool same = (size_t(m) * 3 == ref.size());
+				float maxError = 0;
+				for (int i = 0; i < m && same; i++) {
+					for (int j = 0; j < 3; j++) maxError = std::max(maxError, fabsf(out[i * 7 + j] - ref[i * 3 + j]));
+				}
+				same = same && maxError < 0.05f;
+				char what[64];
+				snprintf(what, sizeof(what), "voxel grid level %d", level);
+				benchCheck(same, what);
+			}
+			printf("  %-36s voxels: %d, %d, %d (levels 0..2), %.1f MB\n", "", grid.size(0), grid.size(1), grid.size(2),
+				grid.getMemoryBytes() / 1048576.0);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void benchVoxel() {
+	//At least 2 threads, so merging of thread grids is always checked
+	int maxThreads = std::max(int(std::thread::hardware_concurrency()), 2);
+	printf("voxel grid downsampling, 3 levels of detail (hardware threads: %d)\n", int(std::thread::hardware_concurrency()));
+	const BenchSize &size = benchSizes[2];
+	std::vector<float> vertices;
+	fillSurface(vertices, size.w, size.h);
+	//Limits of one thread for 5, 10 and 20 mm leafs: about three times the time on one core of a 2 GHz machine,
+	//to catch slowdowns on shared CI machines. The 10 ms target of 10 mm leaf is not met on one core, see README
+	const double limitMs[3] = { 150, 60, 45 };
+	testCloud("HD1080", vertices, size.w * size.h, maxThreads, limitMs);
+	//Random cloud is slow, quick mode takes a quarter of it
+	int randomPoints = (benchQuick()) ? size.w * size.h / 4 : size.w * size.h;
+	fillRandom(vertices, randomPoints);
+	testCloud("random", vertices, randomPoints, 1, 0);
+	ofxKuZedWorkers::shared().setThreads(0);
+}
@@ -0,0 +1,39 @@
+#include <cstdio>
+#include <cstring>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Usage: ofxKuZedBenchmark [test] [--quick]
+//Without test runs all tests. --quick runs each measurement once, for checking results in CI.
+//Exit code is the number of failed checks
+int main(int argc, char **argv) {
+	const char *test = "";
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--quick") == 0) benchQuick() = true;
+		else test = argv[i];
+	}
+	bool all = (test[0] == 0);
+
+	printf("ofxKuZed benchmark, CPU SIMD: %s\n", ofxKuZedConvert::simdName(ofxKuZedConvert::simdSupported()));
+	if (all || strcmp(test, "color") == 0) benchColor();
+	if (all || strcmp(test, "depth") == 0) benchDepth();
+	if (all || strcmp(test, "pointcloud") == 0) benchPointCloud();
+	if (all || strcmp(test, "threads") == 0) benchThreads();
+	if (all || strcmp(test, "codec") == 0) benchCodec();
+	if (all || strcmp(test, "mask") == 0) benchMask();
+	if (all || strcmp(test, "temporal") == 0) benchTemporal();
+	if (all || strcmp(test, "spatial") == 0) benchSpatial();
+	if (all || strcmp(test, "voxel") == 0) benchVoxel();
+	if (all || strcmp(test, "normals") == 0) benchNormals();
+	if (all || strcmp(test, "mesh") == 0) benchMesh();
+	if (all || strcmp(test, "foreground") == 0) benchForeground();
+	if (all || strcmp(test, "upload") == 0) benchUpload();
+	if (all || strcmp(test, "region") == 0) benchRegion();
+	if (all || strcmp(test, "stats") == 0) benchStats();
+	if (all || strcmp(test, "depthfile") == 0) benchDepthFile();
+	if (all || strcmp(test, "stream") == 0) benchStream();
+	if (all || strcmp(test, "capture") == 0) benchCapture();
+	if (all || strcmp(test, "recording") == 0) benchRecording();
+	if (benchFailures() > 0) printf("%d checks failed\n", benchFailures());
+	return benchFailures();
+}
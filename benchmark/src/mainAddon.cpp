@@ -0,0 +1,22 @@
+#include <cstdio>
+#include <cstring>
+#include "bench.h"
+#include "ofxKuZedConvert.h"
+
+//Usage: ofxKuZedAddon [test] [--quick]
+//Checks of ofxKuZed built with OFXKUZED_NO_SDK, options are the same as of ofxKuZedBenchmark.
+//Exit code is the number of failed checks
+int main(int argc, char **argv) {
+	const char *test = "";
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--quick") == 0) benchQuick() = true;
+		else test = argv[i];
+	}
+	bool all = (test[0] == 0);
+
+	printf("ofxKuZed addon with mock camera, CPU SIMD: %s\n", ofxKuZedConvert::simdName(ofxKuZedConvert::simdSupported()));
+	if (all || strcmp(test, "addon") == 0) benchAddon();
+	if (all || strcmp(test, "paths") == 0) benchPaths();
+	if (benchFailures() > 0) printf("%d checks failed\n", benchFailures());
+	return benchFailures();
+}
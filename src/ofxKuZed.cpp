@@ -1,4 +1,25 @@
 #include "ofxKuZed.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+
+//------------------------------------------------------------------------------------------------------
+//Reallocate pixels and textures only if output size is changed
+template<typename T>
+static void resizePixels(ofPixels_<T> &pixels, int w, int h, int channels)
+{
+	if (int(pixels.getWidth()) != w || int(pixels.getHeight()) != h || int(pixels.getNumChannels()) != channels) {
+		pixels.allocate(w, h, channels);
+	}
+}
+
+static bool resizeTexture(ofTexture &texture, int w, int h, int glFormat)
+{
+	if (w <= 0 || h <= 0) return false;
+	if (!texture.isAllocated() || int(texture.getWidth()) != w || int(texture.getHeight()) != h) {
+		texture.allocate(w, h, glFormat, false);
+	}
+	return true;
+}
 
 //------------------------------------------------------------------------------------------------------
 ofxKuZed::ofxKuZed()
@@ -21,42 +42,77 @@ void ofxKuZed::init()
 
 //	bUseColorImage = useColorImage;
 //	bUseDepthImage = useDepthImage;
-	ofLog() << "Starting ZED camera..." << endl;
-	zed_ = new sl::zed::Camera(sl::zed::ZEDResolution_mode(resolution_), fps_);
-	sl::zed::ERRCODE zederr = zed_->init(params_);
-
-	if (zederr != sl::zed::SUCCESS)
-	{
-		ofLog() << "ERROR starting ZED: " << sl::zed::errcode2str(zederr) << endl;
-		close();
+	if (externalSource_) {
+		if (externalSource_->getWidth() > 0) {
+			source_ = externalSource_;
+		}
+		else {
+			ofLogError() << "ZED: external source is not opened" << endl;
+		}
+	}
+	else if (!playbackFile_.empty()) {
+		ofLog() << "Opening ZED recording " << playbackFile_ << "..." << endl;
+		if (player_.open(playbackFile_)) {
+			source_ = &player_;
+			ofLog() << "ZED recording opened, frames: " << player_.getFrameCount() << endl;
+		}
 	}
-	else
-	{
-		ofLog() << "ZED started." << endl;
+	else if (isMockCamera()) {
+		int w, h;
+		ofxKuZedCameraSource::resolutionSize(cameraSettings_.resolution, w, h);
+		mock_.open(w, h, (fps_ > 0) ? fps_ : 30);
+		source_ = &mock_;
+		ofLog() << "ZED mock camera started, " << w << "x" << h << endl;
+	}
+	else {
+		ofLog() << "Starting ZED camera..." << endl;
+		cameraSettings_.fps = fps_;
+		if (camera_.open(cameraSettings_)) {
+			source_ = &camera_;
+			ofLog() << "ZED started." << endl;
+		}
 	}
 
 	//We will allocate buffers anyway, even if no camera
-	w_ = (started()) ? zed_->getImageSize().width : 1280;	
-	h_ = (started()) ? zed_->getImageSize().height : 720;
+	w_ = (started()) ? source_->getWidth() : 1280;	
+	h_ = (started()) ? source_->getHeight() : 720;
 
-	depthPixels_grayscale_.allocate(w_, h_, 1);
-	depthPixels_mm_.allocate(w_, h_, 1);
+	//Sizes of outputs are set by their regions
+	ofxKuZedRegion left = region(ZED_EXTRACT_LEFT), right = region(ZED_EXTRACT_RIGHT);
+	ofxKuZedRegion depth = region(ZED_EXTRACT_DEPTH_MM), gray = region(ZED_EXTRACT_DEPTH_GRAYSCALE);
+	resizePixels(depthPixels_grayscale_, gray.outputWidth(), gray.outputHeight(), 1);
+	resizePixels(depthPixels_mm_, depth.outputWidth(), depth.outputHeight(), 1);
 
-	leftPixels_.allocate(w_, h_, 3);
-	rightPixels_.allocate(w_, h_, 3);
+	resizePixels(leftPixels_, left.outputWidth(), left.outputHeight(), 3);
+	resizePixels(rightPixels_, right.outputWidth(), right.outputHeight(), 3);
 
-	leftTexture_.allocate(w_, h_, GL_RGB, false);
-	rightTexture_.allocate(w_, h_, GL_RGB, false);
-	depthTexture_.allocate(w_, h_, GL_LUMINANCE, false);
+	resizeTexture(leftTexture_, left.outputWidth(), left.outputHeight(), GL_RGB);
+	resizeTexture(rightTexture_, right.outputWidth(), right.outputHeight(), GL_RGB);
+	resizeTexture(depthTexture_, gray.outputWidth(), gray.outputHeight(), GL_LUMINANCE);
 
+	resetTemporalFilter_ = true;
+	shareFilterSettings();
+	stats_.reset();
+	stats_.setNominalFps((source_ == &camera_ || source_ == &mock_) ? fps_ : 0);	//recordings and other sources keep their timestamps
+	captureFlags_.images = useImages_;
+	captureFlags_.depth = useDepth_;
+	captureFlags_.pointCloud = usePointCloud_;
+	captureFlags_.pointCloudColors = usePointCloudColors_;
+	if (started() && threaded_) {
+		captureThread_.start([this](ofxKuZedFrame &frame) { return grabFrame(frame); });
+	}
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::close() {
-	if (zed_) {
+	stopRecording();
+	stopStreaming();
+	if (source_) {
 		ofLog() << "Closing ZED..." << endl;
-		delete zed_;
-		zed_ = 0;
+		captureThread_.stop();	//thread uses source_, so stop it first
+		liveFrame_.clear();
+		if (source_ != externalSource_) source_->close();
+		source_ = 0;
 		markBuffersDirty(false);
 	}
 }
@@ -95,32 +151,201 @@ void ofxKuZed::markBuffersDirty(bool dirty) {
 	depthTextureDirty_ = dirty;
 	pointCloudDirty_ = dirty;
 	pointCloudFloatColorsDirty_ = dirty;
+	pointCloudDataDirty_ = dirty;
+	pointCloudDrawDirty_ = dirty;
+	pointCloudLodDirty_ = dirty;
+	normalsDirty_ = dirty;
+	meshDirty_ = dirty;
 }
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::update()
 {
+	frameNew_ = false;
 	if (started()) {
-		if (useImages_ || useDepth_ || usePointCloud_) {
-			//Grab data
-			bool computeDepth = (useDepth_ || usePointCloud_);
-			bool computeXYZ = usePointCloud_;
-			zed_->grab(sl::zed::SENSING_MODE(postprocessMode_), computeDepth, computeDepth, computeXYZ);
-			markBuffersDirty(true);
+		ofxKuZedStats::Probe probe(stats_, ZED_STAT_UPDATE);
+		shareFilterSettings();
+		if (threaded_) {
+			//Just take the newest frame grabbed by the capture thread
+			frameNew_ = captureThread_.update();
+			if (frameNew_) markBuffersDirty(true);
+		}
+		else {
+			if (useImages_ || useDepth_ || usePointCloud_) {
+				//Grab data
+				takeFilterSettings();
+				bool computeDepth = (useDepth_ || usePointCloud_);
+				bool computeXYZ = usePointCloud_ && !filterDepth();
+				liveFrame_.clear();
+				unsigned long long grabStart = ofxKuZedStats::now();
+				frameNew_ = source_->grab(computeDepth, computeXYZ);
+				if (frameNew_) {
+					liveFrame_.id++;
+					liveFrame_.timestamp = source_->getTimestamp();
+					liveFrame_.hostTime = ofxKuZedStats::now();
+					liveFrame_.grabTime = liveFrame_.hostTime - grabStart;
+					markBuffersDirty(true);
+					if (filterDepth()) {
+						//Depth is filtered in a copy owned by the frame, SDK buffer isn't changed.
+						//Point cloud is computed from the copy by request
+						ofxKuZedBuffer view;
+						source_->retrieve(ZED_CHANNEL_DEPTH, view);
+						liveFrame_[ZED_CHANNEL_DEPTH].copyFrom(view);
+						applyDepthFilters(liveFrame_[ZED_CHANNEL_DEPTH]);
+					}
+				}
+			}
+		}
+		if (frameNew_ && stats_.isEnabled()) {
+			const ofxKuZedFrame &f = frame();
+			stats_.add(ZED_STAT_GRAB, f.grabTime);
+			stats_.add(ZED_STAT_FRAME_AGE, ofxKuZedStats::now() - f.hostTime);
+			stats_.addFrame(f.id, f.timestamp, f.hostTime);
+		}
+		if (frameNew_ && recorder_.isOpen()) {
+			recordFrame();
+		}
+		if (frameNew_ && streamServer_.isStarted()) {
+			streamFrame();
 		}
 	}
 
 }
 
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::recordFrame()
+{
+	//Retrieve recorded channels of the current frame
+	if (useImages_) {
+		getBuffer(ZED_CHANNEL_LEFT);
+		getBuffer(ZED_CHANNEL_RIGHT);
+	}
+	if (useDepth_) {
+		getBuffer(ZED_CHANNEL_DEPTH);
+	}
+	if (!recorder_.write(frame())) {
+		stopRecording();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::streamFrame()
+{
+	//Retrieve used channels of the current frame, server selects the streamed ones
+	if (useImages_) {
+		getBuffer(ZED_CHANNEL_LEFT);
+		getBuffer(ZED_CHANNEL_RIGHT);
+	}
+	if (useDepth_) {
+		getBuffer(ZED_CHANNEL_DEPTH);
+	}
+	streamServer_.send(frame(), source_->getIntrinsics());
+}
+
+//------------------------------------------------------------------------------------------------------
+//Grab a frame and copy all used channels into the frame, called from the capture thread
+bool ofxKuZed::grabFrame(ofxKuZedFrame &frame)
+{
+	const CaptureFlags &use = captureFlags_;
+	if (!(use.images || use.depth || use.pointCloud)) {
+		return false;
+	}
+	takeFilterSettings();
+	bool filter = (filters_.temporal || filters_.spatial) && (use.depth || use.pointCloud);
+	bool computeDepth = (use.depth || use.pointCloud);
+	bool computeXYZ = use.pointCloud && !filter;
+	unsigned long long grabStart = ofxKuZedStats::now();
+	if (!source_->grab(computeDepth, computeXYZ)) {
+		return false;
+	}
+	frame.timestamp = source_->getTimestamp();
+	frame.hostTime = ofxKuZedStats::now();
+	frame.grabTime = frame.hostTime - grabStart;
+
+	bool channels[ZED_CHANNEL_COUNT];
+	channels[ZED_CHANNEL_LEFT] = use.images || (filter && use.pointCloud && use.pointCloudColors);
+	channels[ZED_CHANNEL_RIGHT] = use.images;
+	channels[ZED_CHANNEL_DEPTH] = use.depth || filter;
+	channels[ZED_CHANNEL_XYZ] = use.pointCloud && !use.pointCloudColors && !filter;
+	channels[ZED_CHANNEL_XYZRGBA] = use.pointCloud && use.pointCloudColors && !filter;
+
+	ofxKuZedBuffer view;
+	for (int i = 0; i < ZED_CHANNEL_COUNT; i++) {
+		if (channels[i]) {
+			source_->retrieve(i, view);
+			frame[i].copyFrom(view);
+		}
+		else {
+			frame[i].clear();
+		}
+	}
+	if (filter) {
+		applyDepthFilters(frame[ZED_CHANNEL_DEPTH]);
+		if (use.pointCloud) {
+			ofxKuZedIntrinsics intrinsics = source_->getIntrinsics();
+			frame.computeXyz((use.pointCloudColors) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ,
+				intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy);
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedFrame &ofxKuZed::frame()
+{
+	return (threaded_) ? captureThread_.frame() : liveFrame_;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Get channel of the current frame
+ofxKuZedBuffer &ofxKuZed::getBuffer(int channel)
+{
+	if (threaded_) {
+		return captureThread_.frame()[channel];
+	}
+	ofxKuZedBuffer &buffer = liveFrame_[channel];
+	if (buffer.empty() && started()) {
+		if ((channel == ZED_CHANNEL_XYZ || channel == ZED_CHANNEL_XYZRGBA) && filterDepth()) {
+			//Point cloud from filtered depth
+			if (channel == ZED_CHANNEL_XYZRGBA) getBuffer(ZED_CHANNEL_LEFT);
+			getBuffer(ZED_CHANNEL_DEPTH);
+			ofxKuZedIntrinsics intrinsics = source_->getIntrinsics();
+			liveFrame_.computeXyz(channel, intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy);
+		}
+		else {
+			source_->retrieve(channel, buffer);
+		}
+	}
+	return buffer;
+}
+
 //------------------------------------------------------------------------------------------------------
 bool ofxKuZed::started()
 {
-	return (zed_ != 0);
+	return (source_ != 0);
 }
 
 //------------------------------------------------------------------------------------------------------
 bool ofxKuZed::isFrameNew()
 {
-	return true;
+	return frameNew_;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZed::getFrameId()
+{
+	return (started()) ? frame().id : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZed::getTimestamp()
+{
+	return (started()) ? frame().timestamp : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZed::getHostTimestamp()
+{
+	return (started()) ? frame().hostTime : 0;
 }
 
 //------------------------------------------------------------------------------------------------------
@@ -135,47 +360,183 @@ int ofxKuZed::getHeight()
 	return h_;
 }
 
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZed::getIntrinsics()
+{
+	return (started()) ? source_->getIntrinsics() : ofxKuZedIntrinsics();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZed::getWidth(int output)
+{
+	return region(output).outputWidth();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZed::getHeight(int output)
+{
+	return region(output).outputHeight();
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZed::getIntrinsics(int output)
+{
+	ofxKuZedIntrinsics intrinsics = getIntrinsics();
+	ofxKuZedRegion r = region(output);
+	float f = float(r.downscale);
+	//Averaged and reduced blocks are centered, sampled ones start at the top-left pixel
+	bool sampled = (output & (ZED_EXTRACT_POINTCLOUD | ZED_EXTRACT_POINTCLOUD_DATA))
+		|| ((output & (ZED_EXTRACT_DEPTH_MM | ZED_EXTRACT_DEPTH_GRAYSCALE)) && r.reduction == ZED_REDUCE_SAMPLE);
+	float shift = (sampled) ? 0 : 0.5f * (f - 1);
+	intrinsics.fx /= f;
+	intrinsics.fy /= f;
+	intrinsics.cx = (intrinsics.cx - r.x - shift) / f;
+	intrinsics.cy = (intrinsics.cy - r.y - shift) / f;
+	return intrinsics;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedRegion ofxKuZed::region(int output)
+{
+	for (int i = 0; i < OUTPUT_COUNT; i++) {
+		if (output == (1 << i)) return regions_[i].clamped(w_, h_);
+	}
+	ofLogWarning() << "ZED: output " << output << " should be one of ZED_EXTRACT_... flags" << endl;
+	return ofxKuZedRegion().clamped(w_, h_);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setOutputRegion(int outputs, int x, int y, int w, int h, int downscale, int reduction)
+{
+	if (downscale < 1 || downscale > ofxKuZedConvert::DOWNSCALE_MAX) {
+		ofLogWarning() << "ZED: setOutputRegion(), downscale should be in 1.." << int(ofxKuZedConvert::DOWNSCALE_MAX) << endl;
+	}
+	for (int i = 0; i < OUTPUT_COUNT; i++) {
+		if (outputs & (1 << i)) {
+			ofxKuZedRegion &r = regions_[i];
+			r.x = x;
+			r.y = y;
+			r.width = w;
+			r.height = h;
+			r.downscale = downscale;
+			r.reduction = reduction;
+		}
+	}
+	//Outputs are converted again by request
+	if (outputs & ZED_EXTRACT_LEFT) leftPixelsDirty_ = leftTextureDirty_ = true;
+	if (outputs & ZED_EXTRACT_RIGHT) rightPixelsDirty_ = rightTextureDirty_ = true;
+	if (outputs & ZED_EXTRACT_DEPTH_MM) depthPixels_mm_Dirty_ = true;
+	if (outputs & ZED_EXTRACT_DEPTH_GRAYSCALE) depthPixels_grayscale_Dirty_ = depthTextureDirty_ = true;
+	if (outputs & ZED_EXTRACT_POINTCLOUD) pointCloudDirty_ = pointCloudFloatColorsDirty_ = true;
+	if (outputs & ZED_EXTRACT_POINTCLOUD_DATA) pointCloudDataDirty_ = pointCloudLodDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::resetOutputRegion(int outputs)
+{
+	setOutputRegion(outputs, 0, 0, 0, 0, 1, ZED_REDUCE_BOX);
+}
+
+
+//------------------------------------------------------------------------------------------------------
+const ofxKuZedBuffer &ofxKuZed::getChannelView(int channel)
+{
+	return getBuffer(channel);
+}
+
 //------------------------------------------------------------------------------------------------------
 ofFloatPixels & ofxKuZed::getDepthPixels_mm()
 {
 	if (started()) {
 		if (depthPixels_mm_Dirty_) {
+			ofxKuZedStats::Probe probe(stats_, ZED_STAT_DEPTH_MM);
 			depthPixels_mm_Dirty_ = false;
-			sl::zed::Mat zedView = zed_->retrieveMeasure(sl::zed::MEASURE::DEPTH);
-
-			float *pix = depthPixels_mm_.getData();
-			int step = zedView.step / 4;
-			for (int y = 0; y < h_; y++) {
-				for (int x = 0; x < w_; x++) {
-					float pixel = ((float*)(zedView.data))[x + step*y];
-					pix[x + y * w_] = pixel;
-				}
-			}
+			ofxKuZedRegion r = region(ZED_EXTRACT_DEPTH_MM);
+			resizePixels(depthPixels_mm_, r.outputWidth(), r.outputHeight(), 1);
+			convertDepth(getBuffer(ZED_CHANNEL_DEPTH), depthPixels_mm_.getData(), r.outputWidth() * sizeof(float));
 		}
 	}
 
 	return depthPixels_mm_;
 }
 
+//------------------------------------------------------------------------------------------------------
+//Copy or downscale depth region
+void ofxKuZed::convertDepth(const ofxKuZedBuffer &zedView, float *dst, int dstStep)
+{
+	ofxKuZedRegion r = region(ZED_EXTRACT_DEPTH_MM);
+	ofxKuZedBuffer roi;
+	r.view(zedView, roi);
+	if (roi.empty()) return;
+	if (r.downscale == 1) {
+		ofxKuZedConvert::copyRows(roi.data, roi.step, (unsigned char*)dst, dstStep, r.width * sizeof(float), r.height);
+	}
+	else {
+		ofxKuZedConvert::downscaleDepth(roi.data, roi.step, (unsigned char*)dst, dstStep, r.outputWidth(), r.outputHeight(),
+			r.downscale, r.reduction);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Normalize depth region, downscaled depth is normalized in the second pass
+void ofxKuZed::convertDepthGray(const ofxKuZedBuffer &zedView, unsigned char *dst, int dstStep, float min_depth_mm, float max_depth_mm)
+{
+	ofxKuZedRegion r = region(ZED_EXTRACT_DEPTH_GRAYSCALE);
+	ofxKuZedBuffer roi;
+	r.view(zedView, roi);
+	if (roi.empty()) return;
+	int w = r.outputWidth();
+	int h = r.outputHeight();
+	if (r.downscale == 1) {
+		ofxKuZedConvert::depthToGray(roi.data, roi.step, dst, dstStep, w, h, min_depth_mm, max_depth_mm);
+	}
+	else {
+		grayDepth_.resize(size_t(w) * h);
+		unsigned char *depth = (unsigned char*)&grayDepth_[0];
+		ofxKuZedConvert::downscaleDepth(roi.data, roi.step, depth, w * sizeof(float), w, h, r.downscale, r.reduction);
+		ofxKuZedConvert::depthToGray(depth, w * sizeof(float), dst, dstStep, w, h, min_depth_mm, max_depth_mm);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedDepthView ofxKuZed::getDepthView_mm()
+{
+	ofxKuZedDepthView view;
+	if (started()) {
+		if (!useDepth_) {
+			ofLogWarning() << "ZED: trying to access depth buffer. You need to call setUseDepth(true) before it!" << endl;
+		}
+		else {
+			ofxKuZedBuffer &zedView = getBuffer(ZED_CHANNEL_DEPTH);
+			view.data = (const float*)zedView.data;
+			view.width = zedView.width;
+			view.height = zedView.height;
+			view.step = zedView.step;
+			view.frameId = frame().id;
+			view.timestamp = frame().timestamp;
+			view.hostTime = frame().hostTime;
+		}
+	}
+	return view;
+}
+
 //------------------------------------------------------------------------------------------------------
 ofPixels & ofxKuZed::getDepthPixels_grayscale(float min_depth_mm, float max_depth_mm)
 {
 	if (started()) {
-		if (depthPixels_grayscale_Dirty_) {
+		//Result is cached for the current frame and depth range
+		if (depthPixels_grayscale_Dirty_ || min_depth_mm != depthGrayscaleMin_ || max_depth_mm != depthGrayscaleMax_) {
+			ofxKuZedStats::Probe probe(stats_, ZED_STAT_DEPTH_GRAYSCALE);
 			depthPixels_grayscale_Dirty_ = false;
+			depthGrayscaleMin_ = min_depth_mm;
+			depthGrayscaleMax_ = max_depth_mm;
 
-			sl::zed::Mat zedView = zed_->normalizeMeasure(sl::zed::MEASURE::DEPTH, min_depth_mm, max_depth_mm);
-
-			uchar *pix = depthPixels_grayscale_.getData();
-
-			//ofLog() << zedView.width << " // " << zedView.height << endl;
-			for (int y = 0; y < h_; y++) {
-				for (int x = 0; x < w_; x++) {
-					sl::uchar3 pixel = zedView.getValue(x, y);
-					int index = (x + y * w_);
-					pix[index] = pixel.c1;
-				}
-			}
+			//Normalizing is done on CPU from float depth: it's faster than reading back
+			//4-channel SDK image made by normalizeMeasure(), and works in threaded mode too
+			ofxKuZedRegion r = region(ZED_EXTRACT_DEPTH_GRAYSCALE);
+			resizePixels(depthPixels_grayscale_, r.outputWidth(), r.outputHeight(), 1);
+			convertDepthGray(getBuffer(ZED_CHANNEL_DEPTH), depthPixels_grayscale_.getData(), r.outputWidth(),
+				min_depth_mm, max_depth_mm);
 		}
 	}
 
@@ -190,15 +551,81 @@ ofTexture &ofxKuZed::getDepthTexture(float min_depth_mm, float max_depth_mm)
 			ofLogWarning() << "ZED: trying to access depth buffer. You need to call setUseDepth(true) before it!" << endl;
 		}
 		else {
-			if (depthTextureDirty_) {
+			if (depthTextureDirty_ || min_depth_mm != depthTextureMin_ || max_depth_mm != depthTextureMax_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_DEPTH_TEXTURE);
 				depthTextureDirty_ = false;
-				depthTexture_.loadData(getDepthPixels_grayscale(min_depth_mm, max_depth_mm));
+				depthTextureMin_ = min_depth_mm;
+				depthTextureMax_ = max_depth_mm;
+				ofxKuZedRegion r = region(ZED_EXTRACT_DEPTH_GRAYSCALE);
+				int w = r.outputWidth();
+				int h = r.outputHeight();
+				if (resizeTexture(depthTexture_, w, h, GL_LUMINANCE)) {
+					//If grayscale pixels are not used, depth is converted directly into PBO
+					bool streamed = false;
+					ofxKuZedBuffer &zedView = getBuffer(ZED_CHANNEL_DEPTH);
+					if (textureUpload_ == ZED_TEXTURE_UPLOAD_PBO && !zedView.empty()) {
+						bool pixelsReady = !depthPixels_grayscale_Dirty_ && min_depth_mm == depthGrayscaleMin_ && max_depth_mm == depthGrayscaleMax_;
+						streamed = streamTexture(depthTexture_, depthUpload_, w, h, 1, [&](unsigned char *dst, int step) {
+							if (pixelsReady) ofxKuZedConvert::copyRows(depthPixels_grayscale_.getData(), w, dst, step, w, h);
+							else convertDepthGray(zedView, dst, step, min_depth_mm, max_depth_mm);
+						});
+					}
+					if (!streamed) depthTexture_.loadData(getDepthPixels_grayscale(min_depth_mm, max_depth_mm));
+				}
 			}
 		}
 	}
 	return depthTexture_;
 }
 
+//------------------------------------------------------------------------------------------------------
+//Convert region of SDK BGRA image to RGB
+void ofxKuZed::convertImage(const ofxKuZedBuffer &zedView, int output, unsigned char *dst, int dstStep)
+{
+	ofxKuZedRegion r = region(output);
+	ofxKuZedBuffer roi;
+	r.view(zedView, roi);
+	if (roi.empty()) return;
+	if (r.downscale == 1) {
+		ofxKuZedConvert::bgraToRgb(roi.data, roi.step, dst, dstStep, r.width, r.height);
+	}
+	else {
+		ofxKuZedConvert::bgraToRgbDownscale(roi.data, roi.step, dst, dstStep, r.outputWidth(), r.outputHeight(), r.downscale);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Upload image into texture through PBO: from pixels if they are converted already, otherwise from SDK buffer
+bool ofxKuZed::streamImage(ofTexture &texture, ofxKuZedTextureUpload &upload, int channel, int output, ofPixels &pixels, bool pixelsDirty)
+{
+	if (textureUpload_ != ZED_TEXTURE_UPLOAD_PBO) return false;
+	ofxKuZedBuffer &zedView = getBuffer(channel);
+	if (zedView.empty()) return false;
+	ofxKuZedRegion r = region(output);
+	int w = r.outputWidth();
+	int h = r.outputHeight();
+	return streamTexture(texture, upload, w, h, 3, [&](unsigned char *dst, int step) {
+		if (!pixelsDirty) ofxKuZedConvert::copyRows(pixels.getData(), w * 3, dst, step, w * 3, h);
+		else convertImage(zedView, output, dst, step);
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::streamTexture(ofTexture &texture, ofxKuZedTextureUpload &upload, int w, int h, int bytesPerPixel,
+	const std::function<void(unsigned char *, int)> &convert)
+{
+	if (textureUpload_ != ZED_TEXTURE_UPLOAD_PBO || !texture.isAllocated()) return false;
+	const ofTextureData &data = texture.getTextureData();
+	if (upload.getWidth() != w || upload.getHeight() != h || upload.getRingSize() != textureRingSize_) {
+		upload.setup(w, h, bytesPerPixel, ofGetGLFormatFromInternal(data.glInternalFormat), textureRingSize_);
+	}
+	unsigned char *dst = upload.begin();
+	if (!dst) return false;
+	convert(dst, upload.getStep());
+	upload.end(data.textureID, data.textureTarget);
+	return true;
+}
+
 //------------------------------------------------------------------------------------------------------
 ofPixels & ofxKuZed::getLeftPixels()
 {
@@ -208,19 +635,11 @@ ofPixels & ofxKuZed::getLeftPixels()
 		}
 		else {
 			if (leftPixelsDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_LEFT_PIXELS);
 				leftPixelsDirty_ = false;
-				sl::zed::Mat zedView = zed_->retrieveImage(sl::zed::SIDE::LEFT);
-				uchar *pix = leftPixels_.getData();
-
-				for (int y = 0; y < h_; y++) {
-					for (int x = 0; x < w_; x++) {
-						sl::uchar3 pixel = zedView.getValue(x, y);
-						int index = 3 * (x + y * w_);
-						pix[index + 0] = pixel.c3;
-						pix[index + 1] = pixel.c2;
-						pix[index + 2] = pixel.c1;
-					}
-				}
+				ofxKuZedRegion r = region(ZED_EXTRACT_LEFT);
+				resizePixels(leftPixels_, r.outputWidth(), r.outputHeight(), 3);
+				convertImage(getBuffer(ZED_CHANNEL_LEFT), ZED_EXTRACT_LEFT, leftPixels_.getData(), r.outputWidth() * 3);
 			}
 		}
 	}
@@ -237,8 +656,13 @@ ofTexture & ofxKuZed::getLeftTexture()
 		}
 		else {
 			if (leftTextureDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_LEFT_TEXTURE);
 				leftTextureDirty_ = false;
-				leftTexture_.loadData(getLeftPixels());
+				ofxKuZedRegion r = region(ZED_EXTRACT_LEFT);
+				if (resizeTexture(leftTexture_, r.outputWidth(), r.outputHeight(), GL_RGB)
+					&& !streamImage(leftTexture_, leftUpload_, ZED_CHANNEL_LEFT, ZED_EXTRACT_LEFT, leftPixels_, leftPixelsDirty_)) {
+					leftTexture_.loadData(getLeftPixels());
+				}
 			}
 		}
 	}
@@ -254,18 +678,11 @@ ofPixels & ofxKuZed::getRightPixels()
 		}
 		else {
 			if (rightPixelsDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_RIGHT_PIXELS);
 				rightPixelsDirty_ = false;
-				sl::zed::Mat zedView = zed_->retrieveImage(sl::zed::SIDE::RIGHT);
-				uchar *pix = rightPixels_.getData();
-				for (int y = 0; y < h_; y++) {
-					for (int x = 0; x < w_; x++) {
-						sl::uchar3 pixel = zedView.getValue(x, y);
-						int index = 3 * (x + y * w_);
-						pix[index + 0] = pixel.c3;
-						pix[index + 1] = pixel.c2;
-						pix[index + 2] = pixel.c1;
-					}
-				}
+				ofxKuZedRegion r = region(ZED_EXTRACT_RIGHT);
+				resizePixels(rightPixels_, r.outputWidth(), r.outputHeight(), 3);
+				convertImage(getBuffer(ZED_CHANNEL_RIGHT), ZED_EXTRACT_RIGHT, rightPixels_.getData(), r.outputWidth() * 3);
 			}
 		}
 	}
@@ -281,8 +698,13 @@ ofTexture & ofxKuZed::getRightTexture()
 		}
 		else {
 			if (rightTextureDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_RIGHT_TEXTURE);
 				rightTextureDirty_ = false;
-				rightTexture_.loadData(getRightPixels());
+				ofxKuZedRegion r = region(ZED_EXTRACT_RIGHT);
+				if (resizeTexture(rightTexture_, r.outputWidth(), r.outputHeight(), GL_RGB)
+					&& !streamImage(rightTexture_, rightUpload_, ZED_CHANNEL_RIGHT, ZED_EXTRACT_RIGHT, rightPixels_, rightPixelsDirty_)) {
+					rightTexture_.loadData(getRightPixels());
+				}
 			}
 		}
 	}
@@ -297,64 +719,53 @@ void ofxKuZed::fillPointCloud() {
 		}
 		else {
 			if (pointCloudDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_POINTCLOUD);
 				pointCloudDirty_ = false;
-
-				if (!usePointCloudColors_) {
-					sl::zed::Mat zedView = (zed_->retrieveMeasure(sl::zed::MEASURE::XYZ));
-					//XYZ, 3D coordinates of the image points, 4 channels, FLOAT  (the 4th channel may contains the colors)
-
-					int w = zedView.width;
-					int h = zedView.height;
-					int step = zedView.step / 4;
-					pointCloud_.resize(w*h);
-					pointCloudColors_.clear();
-
-					float *data = (float*)(zedView.data);
-					for (int y = 0; y < h; y++) {
-						for (int x = 0; x < w; x++) {
-							int index = x * 4 + step*y;
-							pointCloud_[x+w*y] = ofPoint(data[index], data[index + 1], data[index + 2]);
-						}
-					}
-				}
-				else {
-					sl::zed::Mat zedView = (zed_->retrieveMeasure(sl::zed::MEASURE::XYZRGBA));
-					//XYZRGBA, 3D coordinates and Color of the image , 4 channels, FLOAT (the 4th channel encode 4 UCHAR for color) \ingroup Enumerations*/
-					int w = zedView.width;
-					int h = zedView.height;
-					int step = zedView.step / 4;
-					int step_char = zedView.step;
-					pointCloud_.resize(w*h);
-					pointCloudColors_.resize(w*h);
-
-					float *data = (float*)(zedView.data);
-					uchar *data_char = zedView.data;
-					for (int y = 0; y < h; y++) {
-						for (int x = 0; x < w; x++) {
-							int index = x * 4 + step*y;
-							int index_color = (index+3)*4;
-							pointCloud_[x + w*y] = ofPoint(data[index], data[index + 1], data[index + 2]);
-							pointCloudColors_[x + w*y] = ofColor(data_char[index_color], data_char[index_color + 1], data_char[index_color + 2], data_char[index_color + 3]);
-						}
-					}
-				}
-				//flip points if required
-				if (pointCloudFlipY_) {
-					for (size_t i = 0; i < pointCloud_.size(); i++) {
-						pointCloud_[i].y = -pointCloud_[i].y;
-					}
-				}
-				if (pointCloudFlipZ_) {
-					for (size_t i = 0; i < pointCloud_.size(); i++) {
-						pointCloud_[i].z = -pointCloud_[i].z;
-					}
-				}
+				ofxKuZedBuffer &zedView = getBuffer((usePointCloudColors_) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ);
+				ofxKuZedRegion r = region(ZED_EXTRACT_POINTCLOUD);
+				ofxKuZedBuffer roi;
+				r.view(zedView, roi);
+				resizePointCloud((roi.empty()) ? 0 : r.outputWidth() * r.outputHeight());
+				ofxKuZedWorkers::shared().parallelRows((roi.empty()) ? 0 : r.outputHeight(), [&](int y0, int y1) {
+					fillPointCloudRows(roi, r.downscale, y0, y1);
+				});
 			}
 		}
 	}
 
 }
 
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::resizePointCloud(int n)
+{
+	pointCloud_.resize(n);
+	if (usePointCloudColors_) pointCloudColors_.resize(n);
+	else pointCloudColors_.clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+//Fill rows [y0,y1) of pointCloud_ and pointCloudColors_, they should be resized by resizePointCloud().
+//Each decimate-th point of each decimate-th row of zedView is taken.
+//ofPoint and ofColor are written directly by point cloud kernel, with their strides
+void ofxKuZed::fillPointCloudRows(const ofxKuZedBuffer &zedView, int decimate, int y0, int y1)
+{
+	if (pointCloud_.empty()) return;
+	ofxKuZedConvert::PointsParams params = pointCloudParams(false, decimate);
+	ofxKuZedConvert::PointsOutput out;
+	out.x = &pointCloud_[0].x;
+	out.y = &pointCloud_[0].y;
+	out.z = &pointCloud_[0].z;
+	out.xyzStride = sizeof(ofPoint) / sizeof(float);
+	if (usePointCloudColors_) {
+		out.rgba = &pointCloudColors_[0].r;
+		out.rgbaStride = sizeof(ofColor);
+	}
+	int w = zedView.width / decimate;
+	for (int y = y0; y < y1; y++) {
+		ofxKuZedConvert::xyzToPointsRow(zedView.row<float>(y * decimate), w * decimate, params, out, w * y, 0);
+	}
+}
+
 //------------------------------------------------------------------------------------------------------
 vector<ofPoint>& ofxKuZed::getPointCloud()
 {
@@ -376,37 +787,221 @@ vector<ofFloatColor>& ofxKuZed::getPointCloudFloatColors()
 		pointCloudFloatColorsDirty_ = false;
 		fillPointCloud();
 		//convert pointCloudColors_ to pointCloudFloatColors_
-		size_t n = pointCloudColors_.size();
+		int n = pointCloudColors_.size();
 		pointCloudFloatColors_.resize(n);
-		for (size_t i = 0; i < n; i++) {
-			pointCloudFloatColors_[i] = pointCloudColors_[i];
+		if (n > 0) {
+			ofxKuZedConvert::rgbaToFloat(&pointCloudColors_[0].r, &pointCloudFloatColors_[0].r, n);
 		}
-
 	}
 	return pointCloudFloatColors_;
 }
 
+//------------------------------------------------------------------------------------------------------
+ofxKuZedConvert::PointsParams ofxKuZed::pointCloudParams(bool dropInvalid, int decimate)
+{
+	ofxKuZedConvert::PointsParams params;
+	params.hasColors = usePointCloudColors_;
+	params.signY = (pointCloudFlipY_) ? -1 : 1;
+	params.signZ = (pointCloudFlipZ_) ? -1 : 1;
+	params.dropInvalid = dropInvalid;
+	params.nearMm = pointCloudNear_;
+	params.farMm = pointCloudFar_;
+	params.decimate = decimate;
+	return params;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Parameters for region of frame of width frameWidth: indices are kept in frame pixels, so normals can be taken by them
+ofxKuZedConvert::PointsParams ofxKuZed::pointCloudParams(bool dropInvalid, const ofxKuZedRegion &r, int frameWidth)
+{
+	ofxKuZedConvert::PointsParams params = pointCloudParams(dropInvalid, r.downscale);
+	params.indexOffset = r.x + frameWidth * r.y;
+	params.indexStep = frameWidth;
+	return params;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPointCloud &ofxKuZed::getPointCloudData()
+{
+	if (started()) {
+		if (!usePointCloud_) {
+			ofLogWarning() << "ZED: trying to access point cloud. You need to call setUsePointCloud(true,true|false) before it!" << endl;
+		}
+		else {
+			if (pointCloudDataDirty_) {
+				ofxKuZedStats::Probe probe(stats_, ZED_STAT_POINTCLOUD_DATA);
+				pointCloudDataDirty_ = false;
+				int channel = (usePointCloudColors_) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ;
+				const ofxKuZedBuffer &xyzView = getBuffer(channel);
+				ofxKuZedRegion r = region(ZED_EXTRACT_POINTCLOUD_DATA);
+				ofxKuZedBuffer roi;
+				r.view(xyzView, roi);
+				pointCloudData_.fill(roi, pointCloudParams(pointCloudDropInvalid_, r, xyzView.width));
+				fillNormals(pointCloudData_, xyzView);
+			}
+		}
+	}
+	return pointCloudData_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPointCloud &ofxKuZed::getPointCloudLod(int level)
+{
+	if (started() && usePointCloud_ && pointCloudLodDirty_) {
+		ofxKuZedStats::Probe probe(stats_, ZED_STAT_POINTCLOUD_LOD);
+		pointCloudLodDirty_ = false;
+		ofxKuZedPointCloud &cloud = getPointCloudData();
+		voxelGrid_.process(cloud.getData(), cloud.size());
+		pointCloudLod_.resize(voxelGrid_.getLevels());
+		for (size_t i = 0; i < pointCloudLod_.size(); i++) {
+			pointCloudLod_[i].setLayout(pointCloudData_.getLayout());
+			pointCloudLod_[i].fill(voxelGrid_, int(i));
+		}
+	}
+	if (pointCloudLod_.empty()) {
+		pointCloudLod_.resize(1);
+	}
+	if (level < 0 || level >= int(pointCloudLod_.size())) {
+		ofLogWarning() << "ZED: getPointCloudLod(), level " << level << " is out of range" << endl;
+		level = max(0, min(level, int(pointCloudLod_.size()) - 1));
+	}
+	return pointCloudLod_[level];
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::extractFrame(int flags, float min_depth_mm, float max_depth_mm)
+{
+	if (!started()) return;
+	ofxKuZedStats::Probe probe(stats_, ZED_STAT_EXTRACT);
+
+	//Outputs which are required and not computed yet for this frame
+	bool left = (flags & ZED_EXTRACT_LEFT) && useImages_ && leftPixelsDirty_;
+	bool right = (flags & ZED_EXTRACT_RIGHT) && useImages_ && rightPixelsDirty_;
+	bool depth = (flags & ZED_EXTRACT_DEPTH_MM) && useDepth_ && depthPixels_mm_Dirty_;
+	bool gray = (flags & ZED_EXTRACT_DEPTH_GRAYSCALE) && useDepth_
+		&& (depthPixels_grayscale_Dirty_ || min_depth_mm != depthGrayscaleMin_ || max_depth_mm != depthGrayscaleMax_);
+	bool cloud = (flags & ZED_EXTRACT_POINTCLOUD) && usePointCloud_ && pointCloudDirty_;
+	bool cloudData = (flags & ZED_EXTRACT_POINTCLOUD_DATA) && usePointCloud_ && pointCloudDataDirty_;
+
+	//Retrieve required SDK buffers once
+	ofxKuZedBuffer none;
+	const ofxKuZedBuffer &leftView = (left) ? getBuffer(ZED_CHANNEL_LEFT) : none;
+	const ofxKuZedBuffer &rightView = (right) ? getBuffer(ZED_CHANNEL_RIGHT) : none;
+	const ofxKuZedBuffer &depthView = (depth || gray) ? getBuffer(ZED_CHANNEL_DEPTH) : none;
+	const ofxKuZedBuffer &xyzView = (cloud || cloudData) ? getBuffer((usePointCloudColors_) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ) : none;
+
+	//Views of output regions, each output row is made from downscale rows of its view
+	ofxKuZedRegion leftRegion = region(ZED_EXTRACT_LEFT);
+	ofxKuZedRegion rightRegion = region(ZED_EXTRACT_RIGHT);
+	ofxKuZedRegion depthRegion = region(ZED_EXTRACT_DEPTH_MM);
+	ofxKuZedRegion grayRegion = region(ZED_EXTRACT_DEPTH_GRAYSCALE);
+	ofxKuZedRegion cloudRegion = region(ZED_EXTRACT_POINTCLOUD);
+	ofxKuZedRegion dataRegion = region(ZED_EXTRACT_POINTCLOUD_DATA);
+	ofxKuZedBuffer leftRoi, rightRoi, depthRoi, grayRoi, cloudRoi, dataRoi;
+	leftRegion.view(leftView, leftRoi);
+	rightRegion.view(rightView, rightRoi);
+	depthRegion.view(depthView, depthRoi);
+	grayRegion.view(depthView, grayRoi);
+	cloudRegion.view(xyzView, cloudRoi);
+	dataRegion.view(xyzView, dataRoi);
+	left = left && !leftRoi.empty();
+	right = right && !rightRoi.empty();
+	depth = depth && !depthRoi.empty();
+	gray = gray && !grayRoi.empty();
+	cloud = cloud && !cloudRoi.empty();
+	cloudData = cloudData && !dataRoi.empty();
+	int leftW = leftRegion.outputWidth(), rightW = rightRegion.outputWidth();
+	int depthW = depthRegion.outputWidth(), grayW = grayRegion.outputWidth();
+	int cloudW = cloudRegion.outputWidth(), dataW = dataRegion.outputWidth();
+	if (left) resizePixels(leftPixels_, leftW, leftRegion.outputHeight(), 3);
+	if (right) resizePixels(rightPixels_, rightW, rightRegion.outputHeight(), 3);
+	if (depth) resizePixels(depthPixels_mm_, depthW, depthRegion.outputHeight(), 1);
+	if (gray) resizePixels(depthPixels_grayscale_, grayW, grayRegion.outputHeight(), 1);
+
+	//Organized point cloud data is filled by rows in the same pass,
+	//compact one requires counting points first, so it's filled after the pass
+	bool cloudDataRows = cloudData && !pointCloudDropInvalid_;
+	ofxKuZedConvert::PointsParams params = pointCloudParams(pointCloudDropInvalid_, dataRegion, xyzView.width);
+	ofxKuZedConvert::PointsOutput cloudDataOut;
+	if (cloud) resizePointCloud(cloudW * cloudRegion.outputHeight());
+	if (cloudDataRows) cloudDataOut = pointCloudData_.beginFill(dataW * dataRegion.outputHeight(), params.hasColors);
+
+	//One pass over rows: each band produces all outputs, so depth and XYZ rows are read once while they are in cache
+	int h = max(max(left ? leftRegion.outputHeight() : 0, right ? rightRegion.outputHeight() : 0),
+		max(max(depth ? depthRegion.outputHeight() : 0, gray ? grayRegion.outputHeight() : 0),
+		max(cloud ? cloudRegion.outputHeight() : 0, cloudDataRows ? dataRegion.outputHeight() : 0)));
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		vector<float> grayRow((gray && grayRegion.downscale > 1) ? grayW : 0);	//downscaled depth row
+		for (int y = y0; y < y1; y++) {
+			if (left && y < leftRegion.outputHeight()) {
+				ofxKuZedConvert::bgraToRgbDownscaleRow(leftRoi.row<unsigned char>(y * leftRegion.downscale), leftRoi.step,
+					leftPixels_.getData() + leftW * 3 * y, leftW, leftRegion.downscale);
+			}
+			if (right && y < rightRegion.outputHeight()) {
+				ofxKuZedConvert::bgraToRgbDownscaleRow(rightRoi.row<unsigned char>(y * rightRegion.downscale), rightRoi.step,
+					rightPixels_.getData() + rightW * 3 * y, rightW, rightRegion.downscale);
+			}
+			if (depth && y < depthRegion.outputHeight()) {
+				ofxKuZedConvert::downscaleDepthRow(depthRoi.row<float>(y * depthRegion.downscale), depthRoi.step,
+					depthPixels_mm_.getData() + depthW * y, depthW, depthRegion.downscale, depthRegion.reduction);
+			}
+			if (gray && y < grayRegion.outputHeight()) {
+				const float *src = grayRoi.row<float>(y * grayRegion.downscale);
+				if (grayRegion.downscale > 1) {
+					ofxKuZedConvert::downscaleDepthRow(src, grayRoi.step, &grayRow[0], grayW, grayRegion.downscale, grayRegion.reduction);
+					src = &grayRow[0];
+				}
+				ofxKuZedConvert::depthToGrayRow(src, depthPixels_grayscale_.getData() + grayW * y, grayW, min_depth_mm, max_depth_mm);
+			}
+			if (cloud && y < cloudRegion.outputHeight()) fillPointCloudRows(cloudRoi, cloudRegion.downscale, y, y + 1);
+			if (cloudDataRows && y < dataRegion.outputHeight()) {
+				int sy = y * dataRegion.downscale;
+				ofxKuZedConvert::xyzToPointsRow(dataRoi.row<float>(sy), dataRoi.width, params, cloudDataOut,
+					dataW * y, params.indexOffset + params.indexStep * sy);
+			}
+		}
+	});
+
+	if (cloudDataRows) pointCloudData_.endFill(dataW * dataRegion.outputHeight());
+	if (cloudData && !cloudDataRows) pointCloudData_.fill(dataRoi, params);
+	if (cloudData) fillNormals(pointCloudData_, xyzView);
+
+	//Getters will return computed data
+	if (left) leftPixelsDirty_ = false;
+	if (right) rightPixelsDirty_ = false;
+	if (depth) depthPixels_mm_Dirty_ = false;
+	if (gray) {
+		depthPixels_grayscale_Dirty_ = false;
+		depthGrayscaleMin_ = min_depth_mm;
+		depthGrayscaleMax_ = max_depth_mm;
+	}
+	if (cloud) pointCloudDirty_ = false;
+	if (cloudData) pointCloudDataDirty_ = false;
+}
+
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::drawLeft(float x, float y, float w, float h)
 {
-	if (w == 0) w = w_;
-	if (h == 0) h = h_;
+	//Downscaled images are drawn in the size of their regions
+	if (w == 0) w = region(ZED_EXTRACT_LEFT).width;
+	if (h == 0) h = region(ZED_EXTRACT_LEFT).height;
 	getLeftTexture().draw(x, y, w, h);
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::drawRight(float x, float y, float w, float h)
 {
-	if (w == 0) w = w_;
-	if (h == 0) h = h_;
+	//Downscaled images are drawn in the size of their regions
+	if (w == 0) w = region(ZED_EXTRACT_RIGHT).width;
+	if (h == 0) h = region(ZED_EXTRACT_RIGHT).height;
 	getRightTexture().draw(x, y, w, h);
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::drawDepth(float x, float y, float w, float h, float min_mm, float max_mm)
 {
-	if (w == 0) w = w_;
-	if (h == 0) h = h_;
+	if (w == 0) w = region(ZED_EXTRACT_DEPTH_GRAYSCALE).width;
+	if (h == 0) h = region(ZED_EXTRACT_DEPTH_GRAYSCALE).height;
 	getDepthTexture(min_mm, max_mm).draw(x, y, w, h);
 
 }
@@ -414,18 +1009,21 @@ void ofxKuZed::drawDepth(float x, float y, float w, float h, float min_mm, float
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::drawPointCloud()
 {
-	vector<ofPoint> &points = getPointCloud();
-	vector<ofFloatColor> &colors = getPointCloudFloatColors();
-	ofMesh mesh;
-	mesh.addVertices(points);
-	if (colors.size() == points.size()) mesh.addColors(colors);
-	mesh.drawVertices();
+	if (started() && usePointCloud_ && pointCloudDrawDirty_) {
+		pointCloudDrawDirty_ = false;
+		int channel = (usePointCloudColors_) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ;
+		const ofxKuZedBuffer &xyzView = getBuffer(channel);
+		pointCloudDraw_.fill(xyzView, pointCloudParams(drawPointCloudDropInvalid_, drawPointCloudDecimate_));
+		fillNormals(pointCloudDraw_, xyzView);
+	}
+	//vbo is updated only if points were changed
+	pointCloudDraw_.draw();
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setResolution(int zed_resolution)
 {
-	resolution_ = zed_resolution;
+	cameraSettings_.resolution = zed_resolution;
 }
 
 //------------------------------------------------------------------------------------------------------
@@ -439,40 +1037,336 @@ float ofxKuZed::getFps()
 	return fps_;
 }
 
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setUseStats(bool useStats)
+{
+	stats_.setEnabled(useStats);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStats &ofxKuZed::getStats()
+{
+	return stats_;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZed::getMeasuredFps()
+{
+	return stats_.getFps();
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZed::getDroppedFrames()
+{
+	return stats_.getDroppedFrames();
+}
+
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setGpuDevice(int gpu_id)
 {
-	params_.device = gpu_id;
+	cameraSettings_.gpuDevice = gpu_id;
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setDepthModeQuality(int depth_mode)
 {
-	params_.mode = sl::zed::MODE(depth_mode);
+	cameraSettings_.depthMode = depth_mode;
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setDepthPostprocess(int postprocess_mode)
 {
-	postprocessMode_ = postprocess_mode;
+	cameraSettings_.postprocessMode = postprocess_mode;
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setDepthMinimumDistance(int min_dist)
 {
-	params_.minimumDistance = min_dist;
+	cameraSettings_.minimumDistance = min_dist;
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setVFlip(bool vflip)
 {
-	params_.vflip = vflip;
+	cameraSettings_.vflip = vflip;
 }
 
 //------------------------------------------------------------------------------------------------------
 void ofxKuZed::setVerboseOutput(bool verbose)
 {
-	params_.verbose = verbose;
+	cameraSettings_.verbose = verbose;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setThreaded(bool threaded)
+{
+	threaded_ = threaded;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setPointCloudDrawing(int decimate, bool dropInvalid)
+{
+	drawPointCloudDecimate_ = max(decimate, 1);
+	drawPointCloudDropInvalid_ = dropInvalid;
+	pointCloudDrawDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setTextureUpload(int mode, int ringSize)
+{
+	textureUpload_ = (mode == ZED_TEXTURE_UPLOAD_PBO) ? ZED_TEXTURE_UPLOAD_PBO : ZED_TEXTURE_UPLOAD_SYNC;
+	textureRingSize_ = max(ringSize, 1);
+	if (textureUpload_ == ZED_TEXTURE_UPLOAD_SYNC) {
+		leftUpload_.clear();
+		rightUpload_.clear();
+		depthUpload_.clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setThreads(int threads)
+{
+	ofxKuZedWorkers::shared().setThreads(threads);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setPointCloudClipping(float near_mm, float far_mm)
+{
+	pointCloudNear_ = near_mm;
+	pointCloudFar_ = far_mm;
+	pointCloudDataDirty_ = true;
+	pointCloudDrawDirty_ = true;
+	pointCloudLodDirty_ = true;
+	meshDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setPointCloudIndices(bool useIndices)
+{
+	pointCloudData_.setUseIndices(useIndices);
+	pointCloudDataDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setPointCloudLayout(int layout, bool dropInvalid)
+{
+	pointCloudData_.setLayout(layout);
+	pointCloudDropInvalid_ = dropInvalid;
+	pointCloudDataDirty_ = true;
+	pointCloudLodDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedVoxelGrid &ofxKuZed::getVoxelGrid()
+{
+	return voxelGrid_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setUseNormals(bool useNormals)
+{
+	useNormals_ = useNormals;
+	pointCloudData_.setUseNormals(useNormals);
+	pointCloudDraw_.setUseNormals(useNormals);
+	pointCloudDataDirty_ = true;
+	pointCloudDrawDirty_ = true;
+	meshDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedNormals &ofxKuZed::getNormals()
+{
+	return normals_;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Normals are computed once per frame from organized XYZ, and are taken by points using their source indices
+const float *ofxKuZed::pixelNormals(const ofxKuZedBuffer &xyzView)
+{
+	if (!useNormals_ || xyzView.empty()) return 0;
+	if (normalsDirty_ || normals_.getWidth() != xyzView.width || normals_.getHeight() != xyzView.height) {
+		normalsDirty_ = false;
+		normals_.compute(xyzView.row<unsigned char>(0), xyzView.step, xyzView.width, xyzView.height);
+	}
+	return normals_.getNormals();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::fillNormals(ofxKuZedPointCloud &cloud, const ofxKuZedBuffer &xyzView)
+{
+	const float *normals = pixelNormals(xyzView);
+	if (normals) cloud.fillNormals(normals, (pointCloudFlipY_) ? -1 : 1, (pointCloudFlipZ_) ? -1 : 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedMesh &ofxKuZed::getMesh()
+{
+	if (started() && usePointCloud_ && meshDirty_) {
+		ofxKuZedStats::Probe probe(stats_, ZED_STAT_MESH);
+		meshDirty_ = false;
+		int channel = (usePointCloudColors_) ? ZED_CHANNEL_XYZRGBA : ZED_CHANNEL_XYZ;
+		const ofxKuZedBuffer &xyzView = getBuffer(channel);
+		mesh_.fill(xyzView, pointCloudParams(true, 1), pixelNormals(xyzView));
+	}
+	return mesh_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::drawMesh()
+{
+	getMesh().draw();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setPlayback(string fileName, int mode, bool loop)
+{
+	playbackFile_ = fileName;
+	player_.setMode(mode);
+	player_.setLoop(loop);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPlayer &ofxKuZed::getPlayer()
+{
+	return player_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::startRecording(string fileName, int channels)
+{
+	stopRecording();
+	if (!started()) {
+		ofLogWarning() << "ZED: recording can be started only after init()" << endl;
+		return false;
+	}
+	if (!useImages_) channels &= ~(ZED_RECORD_LEFT | ZED_RECORD_RIGHT);
+	if (!useDepth_) channels &= ~ZED_RECORD_DEPTH;
+	return recorder_.open(fileName, w_, h_, source_->getIntrinsics(), channels);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::stopRecording()
+{
+	recorder_.close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::isRecording()
+{
+	return recorder_.isOpen();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setSource(ofxKuZedSource *source)
+{
+	externalSource_ = source;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setMockCamera(bool mock)
+{
+	mockCamera_ = mock;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::isMockCamera()
+{
+	return mockCamera_ || !ofxKuZedCameraSource::isAvailable();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::startStreaming(int port, int channels, int protocol)
+{
+	stopStreaming();
+	if (!streamServer_.setup(port, protocol)) {
+		return false;
+	}
+	streamServer_.setChannels(channels);
+	ofLog() << "ZED streaming on port " << port << endl;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::stopStreaming()
+{
+	streamServer_.close();
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStreamServer &ofxKuZed::getStreamServer()
+{
+	return streamServer_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZed::filterDepth() const
+{
+	return (filters_.temporal || filters_.spatial) && (useDepth_ || usePointCloud_);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::applyDepthFilters(ofxKuZedBuffer &depth)
+{
+	//Spatial filter goes first, so temporal filter gets filled holes and no speckles
+	if (filters_.spatial) {
+		filters_.spatialFilter.apply(depth.data, depth.step, depth.width, depth.height);
+	}
+	if (filters_.temporal) {
+		filters_.temporalFilter.apply(depth.data, depth.step, depth.width, depth.height);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Pass filter settings to grabbing, called on the main thread
+void ofxKuZed::shareFilterSettings()
+{
+	std::lock_guard<std::mutex> lock(filterMutex_);
+	DepthFilters &shared = filterSettings_;
+	shared.temporal = useTemporalFilter_;
+	shared.resetTemporal = shared.resetTemporal || resetTemporalFilter_;
+	shared.temporalFilter.copySettings(temporalFilter_);
+	shared.spatial = useSpatialFilter_;
+	shared.spatialFilter.copySettings(spatialFilter_);
+	resetTemporalFilter_ = false;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Take filter settings for the next grab, called by the capture thread in threaded mode
+void ofxKuZed::takeFilterSettings()
+{
+	std::lock_guard<std::mutex> lock(filterMutex_);
+	DepthFilters &shared = filterSettings_;
+	filters_.temporal = shared.temporal;
+	filters_.temporalFilter.copySettings(shared.temporalFilter);
+	if (shared.resetTemporal) filters_.temporalFilter.reset();
+	shared.resetTemporal = false;
+	filters_.spatial = shared.spatial;
+	filters_.spatialFilter.copySettings(shared.spatialFilter);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setTemporalFilter(bool enabled)
+{
+	if (enabled && !useTemporalFilter_) resetTemporalFilter_ = true;
+	useTemporalFilter_ = enabled;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedTemporalFilter &ofxKuZed::getTemporalFilter()
+{
+	return temporalFilter_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZed::setSpatialFilter(bool enabled)
+{
+	useSpatialFilter_ = enabled;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedSpatialFilter &ofxKuZed::getSpatialFilter()
+{
+	return spatialFilter_;
 }
 
 //------------------------------------------------------------------------------------------------------
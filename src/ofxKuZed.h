@@ -10,9 +10,39 @@ ZED camera is a passive stereo camera, allowing to obtain depth data on sunlight
 * It wraps all basic camera settings such as resolution, fps and depth computing quality
 * It provides CPU-access to: 
   - left and right rectified RGB images (as ofPixels, ofTexture)
-  - depth data in millimeters (as ofFloatPixels, ofPixels, ofTexture)
-  - point cloud with colors (as vectors of ofPoint and ofColor)
+  - depth data in millimeters (as ofFloatPixels, ofPixels, ofTexture, or as a zero-copy ofxKuZedDepthView)
+  - point cloud with colors (as vectors of ofPoint and ofColor, or as ofxKuZedPointCloud filled in one pass, ready for ofVbo)
 * It uses "lazy" updating of all pixel arrays and textures: they are updated only by request to save CPU resources.
+* Optional threaded mode: frames are grabbed in a separate thread, so update() never waits for the camera.
+* Frame conversions use SIMD and are split into row bands processed by a worker pool (see setThreads).
+* extractFrame() computes several outputs in one pass over rows, when most of them are used each frame.
+* Recording and playing: left and right images, depth and timestamps are written to a seekable file,
+  which can be played instead of camera in real-time, fast or step mode (see startRecording, setPlayback).
+* Long depth sequences (optionally with left RGB) can be written to a page-aligned fixed-stride file,
+  and read back through memory mapping as zero-copy views by frame index or timestamp (see ofxKuZedDepthFile.h).
+* Lossless (up to chosen precision) depth compression: ofxKuZedDepthCodec encodes ofFloatPixels or raw depth buffers.
+* Streaming frames over TCP or UDP to another computer, where ofxKuZedStreamClient is used as a source instead of camera
+  (see startStreaming, setSource and ofxKuZedStream.h). ofxKuZedSyntheticSource gives test frames without camera.
+* Depth masking on CPU: ofxKuZedMask computes a binary mask by depth range and cutting planes,
+  and masked RGB or RGBA image, in one pass into preallocated buffers.
+* Temporal depth filter against flicker, applied before all outputs (see setTemporalFilter, ofxKuZedTemporalFilter.h).
+* Spatial depth filter: edge-preserving smoothing, speckle removal and small hole filling (see setSpatialFilter, ofxKuZedSpatialFilter.h).
+* Voxel-grid downsampling of point cloud with levels of detail (see getPointCloudLod, ofxKuZedVoxelGrid.h).
+  It doesn't reach 10 ms per HD1080 frame on one core: the default 10 mm leaf takes about 20 ms, so use several threads or a bigger leaf.
+* Normals of organized point cloud from integral images, loaded into ofVbo for lighting (see setUseNormals, ofxKuZedNormals.h).
+* Triangle mesh of organized point cloud with rejection of long edges and depth jumps (see getMesh, drawMesh, ofxKuZedMesher.h).
+* Foreground extraction: learned depth background, foreground mask and blobs with bounding box, size and 3D centroid (see ofxKuZedForeground.h).
+* Asynchronous texture upload: images and depth are converted directly into a ring of pixel buffer objects (see setTextureUpload).
+* Regions of interest and integer downscaling (box/min/median for depth) of CPU outputs, point cloud included (see setOutputRegion).
+* Timing instrumentation: frame ids, camera and host timestamps, measured fps, dropped frames, and p50/p95/p99
+  of grabbing and conversion times, cheap enough to stay enabled (see getStats, ofxKuZedStats.h).
+* Standalone benchmark of all conversion kernels on synthetic SDK buffers, with ns/pixel, GB/s and checks against
+  reference implementations, quality checks of filters, time limits of voxel grid and foreground extraction, and round trips of depth files,
+  recordings, capture thread and streaming. It builds with CMake on Linux without ZED SDK, CUDA or openFrameworks,
+  see benchmark/CMakeLists.txt. The same project builds the whole addon with mock camera and checks ofxKuZed
+  through update(), getters, textures and threaded mode, and measures each getter path at all ZED resolutions.
+* Linux build without ZED SDK and CUDA (OFXKUZED_NO_SDK, see addon_config.mk): the camera is replaced by a deterministic
+  mock with stereo images and depth (see setMockCamera), so the addon and example can be developed and tested on CPU only.
 * It includes an example '''zedExample''', demonstrating work with RGB and depth images, and point cloud from camera.
 
 ![zedCamera](https://github.com/kuflex/ofxKuZed/raw/master/docs/ofxKuZed-1.jpg "zedCamera example")
@@ -49,6 +79,7 @@ ofApp::setup() {
 		zed.update();
 		//ofPixels &left = zed.getLeftPixels();	//access to left image colors
 		//ofFloatPixels &depth_mm = zed.getDepthPixels_mm(); //access to depth
+		//ofxKuZedDepthView depth = zed.getDepthView_mm(); //access to depth without copying, valid until next update()
 		//vector<ofPoint> &points = zed.getPointCloud();	//access to point cloud
 	}
 
@@ -103,6 +134,10 @@ To run the example you need:
 * ZED camera
 * USB 3.0 is preferrable (camera works with USB 2.0 too, but slower)
 
+On Linux the addon compiles without ZED SDK and CUDA with openFrameworks makefiles (zedExample/Makefile),
+and uses mock camera instead of ZED. To use the camera on Linux, remove OFXKUZED_NO_SDK
+and set ZED SDK paths in addon_config.mk.
+
 
 ##Credits
 The addon is based on 
@@ -112,32 +147,44 @@ The addon is based on
 Addon is written by Kuflex lab, https://github.com/kuflex/ofxKuZed
 
 ###TODOs: 
-* Port to Linux
+* Test Linux build with ZED SDK
 * Implement settings for RGB images (brightness, contrast)
 * Implement masking using GPU
-* Implement recording/playing SVO
 ==============================================================================*/
 
 #pragma once
 
 #include "ofMain.h"
-#include <zed/Camera.hpp>
-
-//Available ZED resolutions
-const int ZED_RESOLUTION_HD2K = sl::zed::HD2K;	//2208*1242, supported framerate : 15 fps 
-const int ZED_RESOLUTION_HD1080 = sl::zed::HD1080;	//1920*1080, supported framerates : 15, 30 fps
-const int ZED_RESOLUTION_HD720 = sl::zed::HD720; //1280*720, supported framerates : 15, 30, 60 fps
-const int ZED_RESOLUTION_VGA = sl::zed::VGA;	//672*376, supported framerates : 15, 30, 60, 100 fps
-
-//ZED depth computing quality
-const int ZED_DEPTH_MODE_PERFORMANCE = sl::zed::PERFORMANCE; //Fastest mode, also requires less GPU memory, the disparity map is less robust
-const int ZED_DEPTH_MODE_MEDIUM = sl::zed::MEDIUM; //Balanced quality mode, requires less GPU memory but the disparity map is a little less detailed
-const int ZED_DEPTH_MODE_QUALITY = sl::zed::QUALITY; //Better quality mode, the disparity map is more precise
-
-//ZED depth postprocessing mode
-const int ZED_DEPTH_POSTPROCESS_FILL = sl::zed::FILL;			//Occlusion filling, edge sharpening, advanced post-filtering.
-const int ZED_DEPTH_POSTPROCESS_STANDARD = sl::zed::STANDARD;	//No occlusion filling
-
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedCaptureThread.h"
+#include "ofxKuZedPointCloud.h"
+#include "ofxKuZedCameraSource.h"
+#include "ofxKuZedSyntheticSource.h"
+#include "ofxKuZedRecording.h"
+#include "ofxKuZedStream.h"
+#include "ofxKuZedMask.h"
+#include "ofxKuZedForeground.h"
+#include "ofxKuZedTemporalFilter.h"
+#include "ofxKuZedSpatialFilter.h"
+#include "ofxKuZedNormals.h"
+#include "ofxKuZedMesh.h"
+#include "ofxKuZedTextureUpload.h"
+#include "ofxKuZedStats.h"
+
+//Outputs for extractFrame()
+const int ZED_EXTRACT_LEFT = 1;					//getLeftPixels()
+const int ZED_EXTRACT_RIGHT = 2;				//getRightPixels()
+const int ZED_EXTRACT_DEPTH_MM = 4;				//getDepthPixels_mm()
+const int ZED_EXTRACT_DEPTH_GRAYSCALE = 8;		//getDepthPixels_grayscale()
+const int ZED_EXTRACT_POINTCLOUD = 16;			//getPointCloud(), getPointCloudColors()
+const int ZED_EXTRACT_POINTCLOUD_DATA = 32;		//getPointCloudData()
+const int ZED_EXTRACT_ALL = 63;
+
+//Reduction of depth blocks for downscaled outputs, see setOutputRegion
+const int ZED_REDUCE_SAMPLE = ofxKuZedConvert::REDUCE_SAMPLE;	//top-left pixel of block, the fastest
+const int ZED_REDUCE_BOX = ofxKuZedConvert::REDUCE_BOX;			//mean of valid pixels
+const int ZED_REDUCE_MIN = ofxKuZedConvert::REDUCE_MIN;			//nearest valid pixel
+const int ZED_REDUCE_MEDIAN = ofxKuZedConvert::REDUCE_MEDIAN;	//median of valid pixels
 
 class ofxKuZed
 {
@@ -157,13 +204,26 @@ public:
 
 	bool started();		//is ZED working now
 
-	bool isFrameNew();		//TODO will be useful for threaded implementation
+	bool isFrameNew();		//true if last update() obtained a new frame
+	unsigned long long getFrameId();		//current frame, ids start from 1 and grow by 1 for each grabbed frame
+	unsigned long long getTimestamp();		//camera time of the current frame, ns
+	unsigned long long getHostTimestamp();	//host time at the end of grabbing the current frame, ns (ofxKuZedStats::now())
 	int getWidth();
 	int getHeight();
+	ofxKuZedIntrinsics getIntrinsics();	//left camera parameters in pixels
+	//Size and camera parameters of output ZED_EXTRACT_..., they differ from the frame if setOutputRegion is used
+	int getWidth(int output);
+	int getHeight(int output);
+	ofxKuZedIntrinsics getIntrinsics(int output);
 
 	//All textures and pixels arrays are "lazy" updated,
 	//that is thay are updated only by request
 	ofFloatPixels &getDepthPixels_mm();
+	//Depth without copying: view of SDK (or capture thread) buffer, valid until next update()
+	//Use it if you only sample or threshold depth once per frame
+	ofxKuZedDepthView getDepthView_mm();
+	//Any channel (ZED_CHANNEL_LEFT, ...) without copying, in SDK layout (BGRA images), valid until next update()
+	const ofxKuZedBuffer &getChannelView(int channel);
 	ofPixels &getDepthPixels_grayscale(float min_depth_mm = 0.0, float max_depth_mm = 5000.0);
 	ofTexture &getDepthTexture(float min_depth_mm = 0.0, float max_depth_mm = 5000.0);	
 
@@ -176,10 +236,24 @@ public:
 	vector<ofColor> &getPointCloudColors();
 	vector<ofFloatColor> &getPointCloudFloatColors();	//required for ofMesh
 
+	//Point cloud in a single container, filled in one pass (see setPointCloudLayout)
+	ofxKuZedPointCloud &getPointCloudData();
+
+	//Downsampled getPointCloudData(), level of detail from 0 (leaf size, finest) to getVoxelGrid().getLevels() - 1.
+	//All levels are computed at once, in the layout of getPointCloudData()
+	ofxKuZedPointCloud &getPointCloudLod(int level = 0);
+
+	//Compute several outputs at once: SDK buffers are retrieved once, and all outputs are produced
+	//in one pass over rows. Use it after update() when most outputs are needed each frame,
+	//then getters return the computed data without converting it again.
+	//flags - combination of ZED_EXTRACT_..., min_depth_mm and max_depth_mm - range for grayscale depth.
+	//Textures are not uploaded here, they are loaded from pixels by request
+	void extractFrame(int flags = ZED_EXTRACT_ALL, float min_depth_mm = 0.0, float max_depth_mm = 5000.0);
+
 	void drawLeft( float x, float y, float w=0, float h=0 );
 	void drawRight( float x, float y, float w=0, float h=0 );
 	void drawDepth(float x, float y, float w=0, float h=0, float min_mm = 0, float max_mm = 5000);
-	void drawPointCloud();	//draws a mesh of points
+	void drawPointCloud();	//draws points using persistent vbo, see setPointCloudDrawing
 
 
 	//==== Basic settings ====
@@ -194,7 +268,7 @@ public:
 
 	//Camera FPS
 	void setFps(float fps);						//default: 0
-	float getFps();
+	float getFps();								//requested fps, see getMeasuredFps()
 
 	//==== Advanced settings ====
 	//Note: you should call set... functions before init()
@@ -228,12 +302,117 @@ public:
 	//Output some information about the current status of initialization
 	void setVerboseOutput(bool verbose);	//default: false
 
+	//Threaded mode: camera is grabbed in a separate thread,
+	//and update() just switches to the newest grabbed frame.
+	//Flags setUseImages, setUseDepth, setUsePointCloud are taken by init() in this mode, so set them before it.
+	void setThreaded(bool threaded);	//default: false
+
+	//Number of threads for converting frames (colors, depth, point cloud), rows are split into bands.
+	//0 - number of CPU cores, 1 - everything is done in the calling thread.
+	//It's a setting of the worker pool shared by all ofxKuZed objects
+	void setThreads(int threads);	//default: 0
+
+	//Uploading of getLeftTexture(), getRightTexture(), getDepthTexture():
+	//ZED_TEXTURE_UPLOAD_SYNC - pixels are converted into ofPixels and loaded into texture, GL waits for the copy;
+	//ZED_TEXTURE_UPLOAD_PBO - pixels are converted directly into a ring of ringSize pixel buffer objects
+	//and copied into texture asynchronously, so there is no stall. Pixels getters still work in this mode
+	void setTextureUpload(int mode, int ringSize = 3);	//default: ZED_TEXTURE_UPLOAD_SYNC
+
+	//Layout of getPointCloudData(): ZED_POINTCLOUD_INTERLEAVED (ready for ofVbo) or ZED_POINTCLOUD_SOA.
+	//If dropInvalid is true, points with NaN or inf coordinates are skipped
+	void setPointCloudLayout(int layout, bool dropInvalid = true);	//default: ZED_POINTCLOUD_INTERLEAVED, true
+
+	//Settings for drawPointCloud(): draw each decimate-th point in each decimate-th row,
+	//and skip invalid points
+	void setPointCloudDrawing(int decimate, bool dropInvalid = true);	//default: 1, true
+
+	//Compact point cloud: when invalid points are dropped, points with distance |z| outside [near_mm, far_mm]
+	//are dropped too. far_mm = 0 means no far limit
+	void setPointCloudClipping(float near_mm, float far_mm);	//default: 0, 0
+
+	//Store source pixel index x + w * y for each point of getPointCloudData(), see ofxKuZedPointCloud::getIndices()
+	void setPointCloudIndices(bool useIndices);	//default: false
+
+	//Region of interest and integer downscale of outputs, applied during conversion,
+	//so work and memory scale with the requested size. outputs - combination of ZED_EXTRACT_... flags:
+	//ZED_EXTRACT_LEFT and ZED_EXTRACT_RIGHT are images with textures, ZED_EXTRACT_DEPTH_GRAYSCALE is used for depth texture too,
+	//ZED_EXTRACT_POINTCLOUD_DATA for getPointCloudLod() too. w = 0 or h = 0 means up to the image border.
+	//Images are averaged over blocks, depth blocks are reduced by ZED_REDUCE_SAMPLE, ZED_REDUCE_BOX, ZED_REDUCE_MIN
+	//or ZED_REDUCE_MEDIAN, point clouds take the top-left point of blocks (indices are kept in whole frame pixels).
+	//Views, masks, drawPointCloud() and getMesh() use the whole frame
+	void setOutputRegion(int outputs, int x, int y, int w, int h, int downscale = 1, int reduction = ZED_REDUCE_BOX);
+	void resetOutputRegion(int outputs = ZED_EXTRACT_ALL);	//whole frame, default
+
+	//Settings of getPointCloudLod(): leaf size, centroid or first point, number of levels.
+	//Changes are applied from the next frame
+	ofxKuZedVoxelGrid &getVoxelGrid();
+
+	//Compute normals for getPointCloudData() and drawPointCloud(), they are loaded into vbo for lighting.
+	//Normals are estimated from neighbour pixels of organized point cloud, see ofxKuZedNormals.h
+	void setUseNormals(bool useNormals);	//default: false
+	ofxKuZedNormals &getNormals();			//settings and per-pixel normals of the current frame
+
+	//Triangle mesh of organized point cloud, built on request once per frame, with normals if setUseNormals(true).
+	//Settings are in getMesh().getMesher(): stride, edge length and depth jump limits, applied from the next frame.
+	//Clipping and flipping of point cloud are applied
+	ofxKuZedMesh &getMesh();
+	void drawMesh();	//draws triangles using persistent vbo, updated only for new frames
+
+	//==== Timing ====
+	//Durations of grabbing, update() and conversions of getters, frame intervals and dropped frames
+	//as rolling histograms with p50/p95/p99 (see ofxKuZedStats.h). Getters are measured only when they convert,
+	//not when they return data of the current frame again. Probes cost tens of nanoseconds
+	void setUseStats(bool useStats);		//default: true
+	ofxKuZedStats &getStats();				//e.g. ofLog() << zed.getStats().report();
+	float getMeasuredFps();					//from camera timestamps of grabbed frames
+	unsigned long long getDroppedFrames();	//skipped by camera, or replaced in capture thread before update()
+
+	//==== Depth filtering ====
+	//Temporal filter is applied to depth of each new frame before all outputs: pixels, textures, point cloud,
+	//recording and streaming. Point cloud is computed from filtered depth then, not by SDK.
+	//Settings are passed to grabbing by update() and used from the next grabbed frame.
+	//History is reset by init() and by enabling the filter
+	void setTemporalFilter(bool enabled);		//default: false
+	ofxKuZedTemporalFilter &getTemporalFilter();	//filter settings
+
+	//Spatial filter: edge-preserving smoothing, speckle removal and hole filling.
+	//Works the same way as temporal filter and is applied before it, settings are passed by update() too
+	void setSpatialFilter(bool enabled);		//default: false
+	ofxKuZedSpatialFilter &getSpatialFilter();	//filter settings and stages order
+
+	//==== Recording and playing ====
+	//Play recording made by startRecording() instead of camera, call it before init().
+	//Empty fileName means camera. mode: ZED_PLAYBACK_REALTIME, ZED_PLAYBACK_FAST, ZED_PLAYBACK_STEP
+	void setPlayback(string fileName, int mode = ZED_PLAYBACK_REALTIME, bool loop = true);
+	ofxKuZedPlayer &getPlayer();	//control playing: step, seek, mode
+
+	//Record each new frame in update(). channels - ZED_RECORD_LEFT, ZED_RECORD_RIGHT, ZED_RECORD_DEPTH mask,
+	//only channels enabled by setUseImages and setUseDepth are recorded
+	bool startRecording(string fileName, int channels = ZED_RECORD_ALL);
+	void stopRecording();
+	bool isRecording();
+
+	//==== Other sources and streaming ====
+	//Use external frame source instead of camera, e.g. ofxKuZedStreamClient or ofxKuZedSyntheticSource.
+	//Call it before init(), the source should be opened already. It's not closed by close(). 0 means camera
+	void setSource(ofxKuZedSource *source);
+
+	//Use mock camera instead of ZED: ofxKuZedSyntheticSource with size of setResolution() and setFps() rate.
+	//It's used anyway if the addon is built without ZED SDK (OFXKUZED_NO_SDK, e.g. on Linux without CUDA)
+	void setMockCamera(bool mock);		//default: false
+	bool isMockCamera();				//true if mock camera is used by init()
+
+	//Send each new frame to network clients (see ofxKuZedStream.h).
+	//channels - ZED_STREAM_LEFT, ZED_STREAM_RIGHT, ZED_STREAM_DEPTH mask, protocol - ZED_STREAM_TCP or ZED_STREAM_UDP
+	bool startStreaming(int port, int channels = ZED_STREAM_LEFT | ZED_STREAM_DEPTH, int protocol = ZED_STREAM_TCP);
+	void stopStreaming();
+	ofxKuZedStreamServer &getStreamServer();	//compression settings and statistics
+
 private:
 	//Settings
-	sl::zed::InitParams params_;
-	int resolution_ = ZED_RESOLUTION_HD720;
+	ofxKuZedCameraSettings cameraSettings_;
 	float fps_ = 0.0;
-	int postprocessMode_ = ZED_DEPTH_POSTPROCESS_STANDARD;
+	bool mockCamera_ = false;
 
 	bool useImages_ = true;
 	bool useDepth_ = true;
@@ -242,11 +421,76 @@ private:
 
 	bool pointCloudFlipY_ = true;
 	bool pointCloudFlipZ_ = true;
-
-	//Camera
-	sl::zed::Camera* zed_ = 0;
-	int w_;
-	int h_;
+	bool pointCloudDropInvalid_ = true;
+	int drawPointCloudDecimate_ = 1;
+	float pointCloudNear_ = 0;
+	float pointCloudFar_ = 0;
+	bool drawPointCloudDropInvalid_ = true;
+	bool useNormals_ = false;
+	ofxKuZedNormals normals_;
+	ofxKuZedMesh mesh_;
+
+	bool threaded_ = false;
+	bool useTemporalFilter_ = false;
+	bool resetTemporalFilter_ = false;
+	ofxKuZedTemporalFilter temporalFilter_;		//settings set by user
+	bool useSpatialFilter_ = false;
+	ofxKuZedSpatialFilter spatialFilter_;		//settings set by user
+
+	//Frame source: camera, player or external source
+	ofxKuZedSource *source_ = 0;
+	ofxKuZedCameraSource camera_;
+	ofxKuZedSyntheticSource mock_;
+	ofxKuZedPlayer player_;
+	string playbackFile_;
+	ofxKuZedSource *externalSource_ = 0;
+	ofxKuZedRecorder recorder_;
+	ofxKuZedStreamServer streamServer_;
+	int w_ = 0;
+	int h_ = 0;
+	bool frameNew_ = false;
+	ofxKuZedStats stats_;
+
+	//Flags of grabFrame(), copied from use..._ by init(), so the capture thread doesn't read the settings
+	struct CaptureFlags {
+		bool images = false;
+		bool depth = false;
+		bool pointCloud = false;
+		bool pointCloudColors = false;
+	};
+	CaptureFlags captureFlags_;
+
+	//Depth filters of grabbing. Settings are changed by user on the main thread, update() passes them
+	//under filterMutex_, and each grab takes them once, so the capture thread never reads the user's filters
+	struct DepthFilters {
+		bool temporal = false;
+		bool resetTemporal = false;
+		ofxKuZedTemporalFilter temporalFilter;
+		bool spatial = false;
+		ofxKuZedSpatialFilter spatialFilter;
+	};
+	std::mutex filterMutex_;
+	DepthFilters filterSettings_;	//passed by update(), protected by filterMutex_
+	DepthFilters filters_;			//used by grabbing, temporal filter keeps its history here
+	void shareFilterSettings();
+	void takeFilterSettings();
+
+	//Frame data
+	ofxKuZedFrame liveFrame_;		//views of SDK buffers, used in non-threaded mode
+	ofxKuZedCaptureThread captureThread_;	//frames copied in threaded mode
+
+	ofxKuZedFrame &frame();		//current frame
+	ofxKuZedBuffer &getBuffer(int channel);	//get channel of the current frame, retrieve it from source if required
+	bool grabFrame(ofxKuZedFrame &frame);	//grab and copy frame, called from capture thread
+	void recordFrame();
+	void streamFrame();
+	bool filterDepth() const;		//depth is filtered and point cloud is computed from it
+	void applyDepthFilters(ofxKuZedBuffer &depth);
+	void convertImage(const ofxKuZedBuffer &zedView, int output, unsigned char *dst, int dstStep);
+	void convertDepth(const ofxKuZedBuffer &zedView, float *dst, int dstStep);
+	void convertDepthGray(const ofxKuZedBuffer &zedView, unsigned char *dst, int dstStep, float min_depth_mm, float max_depth_mm);
+	ofxKuZedConvert::PointsParams pointCloudParams(bool dropInvalid, int decimate);
+	ofxKuZedConvert::PointsParams pointCloudParams(bool dropInvalid, const ofxKuZedRegion &r, int frameWidth);
 
 	//Buffers
 	ofPixels leftPixels_, rightPixels_, depthPixels_grayscale_;
@@ -255,15 +499,41 @@ private:
 	vector<ofPoint> pointCloud_;
 	vector<ofColor> pointCloudColors_;
 	vector<ofFloatColor> pointCloudFloatColors_;
+	ofxKuZedPointCloud pointCloudData_;
+	ofxKuZedPointCloud pointCloudDraw_;		//points for drawPointCloud()
+	ofxKuZedVoxelGrid voxelGrid_;
+	vector<ofxKuZedPointCloud> pointCloudLod_;
 
 	//Flags for lazy updating
 	bool leftPixelsDirty_, rightPixelsDirty_, leftTextureDirty_, rightTextureDirty_;
 	bool depthPixels_mm_Dirty_, depthPixels_grayscale_Dirty_, depthTextureDirty_;
-	bool pointCloudDirty_, pointCloudFloatColorsDirty_;
+	bool pointCloudDirty_, pointCloudFloatColorsDirty_, pointCloudDataDirty_, pointCloudDrawDirty_, pointCloudLodDirty_;
+	bool normalsDirty_, meshDirty_;
+	float depthGrayscaleMin_ = 0, depthGrayscaleMax_ = 0;	//range of depthPixels_grayscale_
+	float depthTextureMin_ = 0, depthTextureMax_ = 0;		//range of depthTexture_
+
+	//Regions of outputs, indexed by bit of ZED_EXTRACT_...
+	static const int OUTPUT_COUNT = 6;
+	ofxKuZedRegion regions_[OUTPUT_COUNT];
+	ofxKuZedRegion region(int output);		//region clamped to the frame
+	vector<float> grayDepth_;				//downscaled depth for grayscale
+
+	//Texture uploading, see setTextureUpload
+	int textureUpload_ = ZED_TEXTURE_UPLOAD_SYNC;
+	int textureRingSize_ = 3;
+	ofxKuZedTextureUpload leftUpload_, rightUpload_, depthUpload_;
+	//Write pixels by 'convert' (destination, row step) into texture through PBO, false if PBO is not available
+	bool streamTexture(ofTexture &texture, ofxKuZedTextureUpload &upload, int w, int h, int bytesPerPixel,
+		const std::function<void(unsigned char *, int)> &convert);
+	bool streamImage(ofTexture &texture, ofxKuZedTextureUpload &upload, int channel, int output, ofPixels &pixels, bool pixelsDirty);
 		
 	
 	void markBuffersDirty(bool dirty);	//Mark all buffers dirty (need to update by request)
 	void fillPointCloud();
+	void resizePointCloud(int n);
+	void fillPointCloudRows(const ofxKuZedBuffer &zedView, int decimate, int y0, int y1);
+	const float *pixelNormals(const ofxKuZedBuffer &xyzView);	//normals of the current frame, 0 if not used
+	void fillNormals(ofxKuZedPointCloud &cloud, const ofxKuZedBuffer &xyzView);
 
 };
 
@@ -0,0 +1,233 @@
+#include "ofxKuZedBackground.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OFXKUZED_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define OFXKUZED_TARGET(isa)
+#else
+#define OFXKUZED_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+typedef ofxKuZedBackground::Params Params;
+
+//------------------------------------------------------------------------------------------------------
+//Learning: background is the average of valid depths, mask is empty
+static void learnRow(const float *depth, float *background, float *samples, unsigned char *mask, int w, const Params &p)
+{
+	for (int x = 0; x < w; x++) {
+		float d = depth[x];
+		bool valid = (d > 0) & (d >= p.nearMm) & (d <= p.farMm);
+		if (valid) {
+			samples[x] += 1;
+			background[x] += (d - background[x]) / samples[x];
+		}
+	}
+	if (mask) memset(mask, 0, w);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Detection. All versions do the same operations in the same order, so they give the same results.
+//Depth is valid if it's > 0 and in range, which is false for NaN and inf (far limit is max float)
+static void detectRowScalar(const float *depth, float *background, unsigned char *mask, int w, const Params &p)
+{
+	for (int x = 0; x < w; x++) {
+		float d = depth[x];
+		float b = background[x];
+		bool valid = (d > 0) & (d >= p.nearMm) & (d <= p.farMm);
+		bool has = (b > 0);
+		float thr = p.toleranceMm + p.toleranceFraction * b;
+		bool fg = valid & (!has | (d < b - thr));
+		bool update = valid & !fg;
+		background[x] = (update) ? b + p.rate * (d - b) : b;
+		if (mask) mask[x] = (fg) ? 255 : 0;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("sse2")
+static inline __m128 detect4(__m128 d, __m128 b, const Params &p, __m128 &fg)
+{
+	__m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(d, _mm_setzero_ps()), _mm_cmpge_ps(d, _mm_set1_ps(p.nearMm))),
+		_mm_cmple_ps(d, _mm_set1_ps(p.farMm)));
+	__m128 has = _mm_cmpgt_ps(b, _mm_setzero_ps());
+	__m128 thr = _mm_add_ps(_mm_set1_ps(p.toleranceMm), _mm_mul_ps(_mm_set1_ps(p.toleranceFraction), b));
+	__m128 closer = _mm_cmplt_ps(d, _mm_sub_ps(b, thr));
+	fg = _mm_and_ps(valid, _mm_or_ps(_mm_andnot_ps(has, valid), closer));
+	__m128 update = _mm_andnot_ps(fg, valid);
+	__m128 updated = _mm_add_ps(b, _mm_mul_ps(_mm_set1_ps(p.rate), _mm_sub_ps(d, b)));
+	return _mm_or_ps(_mm_and_ps(update, updated), _mm_andnot_ps(update, b));
+}
+
+OFXKUZED_TARGET("sse2")
+static void detectRowSSE2(const float *depth, float *background, unsigned char *mask, int w, const Params &p)
+{
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i m[4];
+		for (int k = 0; k < 4; k++) {
+			__m128 fg;
+			__m128 b = detect4(_mm_loadu_ps(depth + x + 4 * k), _mm_loadu_ps(background + x + 4 * k), p, fg);
+			_mm_storeu_ps(background + x + 4 * k, b);
+			m[k] = _mm_castps_si128(fg);
+		}
+		//-1 lanes are packed into 255 bytes
+		__m128i bytes = _mm_packs_epi16(_mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3]));
+		if (mask) _mm_storeu_si128((__m128i *)(mask + x), bytes);
+	}
+	detectRowScalar(depth + x, background + x, (mask) ? mask + x : 0, w - x, p);
+}
+
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("avx2")
+static inline __m256 detect8(__m256 d, __m256 b, const Params &p, __m256 &fg)
+{
+	__m256 valid = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ),
+		_mm256_cmp_ps(d, _mm256_set1_ps(p.nearMm), _CMP_GE_OQ)), _mm256_cmp_ps(d, _mm256_set1_ps(p.farMm), _CMP_LE_OQ));
+	__m256 has = _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_GT_OQ);
+	__m256 thr = _mm256_add_ps(_mm256_set1_ps(p.toleranceMm), _mm256_mul_ps(_mm256_set1_ps(p.toleranceFraction), b));
+	__m256 closer = _mm256_cmp_ps(d, _mm256_sub_ps(b, thr), _CMP_LT_OQ);
+	fg = _mm256_and_ps(valid, _mm256_or_ps(_mm256_andnot_ps(has, valid), closer));
+	__m256 update = _mm256_andnot_ps(fg, valid);
+	__m256 updated = _mm256_add_ps(b, _mm256_mul_ps(_mm256_set1_ps(p.rate), _mm256_sub_ps(d, b)));
+	return _mm256_blendv_ps(b, updated, update);
+}
+
+OFXKUZED_TARGET("avx2")
+static void detectRowAVX2(const float *depth, float *background, unsigned char *mask, int w, const Params &p)
+{
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m256 fg0, fg1;
+		__m256 b0 = detect8(_mm256_loadu_ps(depth + x), _mm256_loadu_ps(background + x), p, fg0);
+		__m256 b1 = detect8(_mm256_loadu_ps(depth + x + 8), _mm256_loadu_ps(background + x + 8), p, fg1);
+		_mm256_storeu_ps(background + x, b0);
+		_mm256_storeu_ps(background + x + 8, b1);
+		//Packing within 128-bit halves keeps pixel order
+		__m256i m0 = _mm256_castps_si256(fg0);
+		__m256i m1 = _mm256_castps_si256(fg1);
+		__m128i lo = _mm_packs_epi32(_mm256_castsi256_si128(m0), _mm256_extracti128_si256(m0, 1));
+		__m128i hi = _mm_packs_epi32(_mm256_castsi256_si128(m1), _mm256_extracti128_si256(m1, 1));
+		if (mask) _mm_storeu_si128((__m128i *)(mask + x), _mm_packs_epi16(lo, hi));
+	}
+	detectRowScalar(depth + x, background + x, (mask) ? mask + x : 0, w - x, p);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::setLearningFrames(int frames)
+{
+	learningFrames_ = std::max(frames, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedBackground::getLearningFrames() const
+{
+	return learningFrames_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::setLearningRate(float rate)
+{
+	rate_ = std::min(std::max(rate, 0.0f), 1.0f);
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedBackground::getLearningRate() const
+{
+	return rate_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::setTolerance(float mm, float fraction)
+{
+	toleranceMm_ = mm;
+	toleranceFraction_ = fraction;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::setRange(float near_mm, float far_mm)
+{
+	near_ = near_mm;
+	far_ = far_mm;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::reset()
+{
+	frames_ = 0;
+	std::fill(state_.begin(), state_.end(), 0.0f);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedBackground::isLearning() const
+{
+	return frames_ < learningFrames_;
+}
+
+//------------------------------------------------------------------------------------------------------
+const float *ofxKuZedBackground::getBackground() const
+{
+	return (state_.empty()) ? 0 : &state_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedBackground::getStateBytes() const
+{
+	return state_.size() * sizeof(float);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBackground::apply(const unsigned char *depth, int depthStep, int w, int h, unsigned char *mask, int maskStep)
+{
+	if (!depth || w <= 0 || h <= 0) return;
+	if (w != w_ || h != h_) {
+		w_ = w;
+		h_ = h;
+		state_.assign(size_t(w) * h * 2, 0.0f);
+		frames_ = 0;
+	}
+	Params p;
+	p.rate = rate_;
+	p.toleranceMm = toleranceMm_;
+	p.toleranceFraction = toleranceFraction_;
+	p.nearMm = near_;
+	p.farMm = (far_ > 0) ? far_ : std::numeric_limits<float>::max();
+
+	float *background = &state_[0];
+	float *samples = background + size_t(w) * h;
+	bool learning = isLearning();
+	frames_ = std::min(frames_ + 1, learningFrames_);
+	int simd = ofxKuZedConvert::simd();
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			const float *d = (const float *)(depth + size_t(depthStep) * y);
+			float *b = background + size_t(w) * y;
+			unsigned char *m = (mask) ? mask + size_t(maskStep) * y : 0;
+			if (learning) {
+				learnRow(d, b, samples + size_t(w) * y, m, w, p);
+				continue;
+			}
+#ifdef OFXKUZED_X86
+			if (simd == ofxKuZedConvert::SIMD_AVX2) {
+				detectRowAVX2(d, b, m, w, p);
+				continue;
+			}
+			if (simd == ofxKuZedConvert::SIMD_SSSE3) {
+				detectRowSSE2(d, b, m, w, p);
+				continue;
+			}
+#endif
+			detectRowScalar(d, b, m, w, p);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#pragma once
+
+//Depth background model and foreground mask.
+//Background depth of each pixel is learned during the first frames after reset (average of valid depths),
+//then pixel is foreground if its depth is closer than background by more than tolerance,
+//or if background is unknown there. Background pixels keep updating the model with learning rate,
+//so slow changes of the scene (moved furniture, drift of depth) are absorbed, while foreground doesn't leak into it.
+//Rows are processed in parallel by ofxKuZedWorkers::shared() using SIMD.
+//State (background depth and number of learned samples, 8 bytes per pixel) is allocated when size is changed.
+//The model can be copied, the copy continues from the same state: settings, learned background and samples.
+
+#include <vector>
+#include <cstddef>
+
+class ofxKuZedBackground
+{
+public:
+	//Number of frames for initial learning after reset(), they give empty foreground
+	void setLearningFrames(int frames);		//default: 30
+	int getLearningFrames() const;
+
+	//EMA weight of new depth for background pixels after learning, 0 - model is frozen
+	void setLearningRate(float rate);		//default: 0.01
+	float getLearningRate() const;
+
+	//Pixel is foreground if depth < background - (mm + fraction * background)
+	void setTolerance(float mm, float fraction);	//default: 50, 0.02
+
+	//Depth range of foreground and learned pixels, far_mm = 0 means no limit
+	void setRange(float near_mm, float far_mm);		//default: 0, 0
+
+	//Forget the model and start learning
+	void reset();
+	bool isLearning() const;
+
+	//Update the model with depth in mm (float, step - row size in bytes) and write foreground mask:
+	//255 - foreground, 0 - background or invalid depth. mask can be 0 if it's not required.
+	//The model is reset if frame size is changed
+	void apply(const unsigned char *depth, int depthStep, int w, int h, unsigned char *mask, int maskStep);
+
+	const float *getBackground() const;		//w * h background depth, 0 - unknown
+	size_t getStateBytes() const;
+
+	//Parameters of one row, used by SIMD versions
+	struct Params {
+		float rate;
+		float toleranceMm;
+		float toleranceFraction;
+		float nearMm;
+		float farMm;
+	};
+
+private:
+	int learningFrames_ = 30;
+	float rate_ = 0.01f;
+	float toleranceMm_ = 50;
+	float toleranceFraction_ = 0.02f;
+	float near_ = 0;
+	float far_ = 0;
+
+	int frames_ = 0;		//frames after reset
+	int w_ = 0;
+	int h_ = 0;
+	std::vector<float> state_;	//w * h background depth, then w * h learned samples
+};
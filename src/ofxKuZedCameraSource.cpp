@@ -0,0 +1,160 @@
+#include "ofxKuZedCameraSource.h"
+
+#ifndef OFXKUZED_NO_SDK
+#include <zed/Camera.hpp>
+
+//Settings constants are SDK values
+static_assert(ZED_RESOLUTION_HD2K == sl::zed::HD2K && ZED_RESOLUTION_HD1080 == sl::zed::HD1080
+	&& ZED_RESOLUTION_HD720 == sl::zed::HD720 && ZED_RESOLUTION_VGA == sl::zed::VGA, "ZED resolution values");
+static_assert(ZED_DEPTH_MODE_PERFORMANCE == sl::zed::PERFORMANCE && ZED_DEPTH_MODE_MEDIUM == sl::zed::MEDIUM
+	&& ZED_DEPTH_MODE_QUALITY == sl::zed::QUALITY, "ZED depth mode values");
+static_assert(ZED_DEPTH_POSTPROCESS_FILL == sl::zed::FILL && ZED_DEPTH_POSTPROCESS_STANDARD == sl::zed::STANDARD,
+	"ZED sensing mode values");
+#endif
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedCameraSource::~ofxKuZedCameraSource()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedCameraSource::isAvailable()
+{
+#ifdef OFXKUZED_NO_SDK
+	return false;
+#else
+	return true;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedCameraSource::resolutionSize(int resolution, int &w, int &h)
+{
+	switch (resolution) {
+	case ZED_RESOLUTION_HD2K: w = 2208; h = 1242;
+		break;
+	case ZED_RESOLUTION_HD1080: w = 1920; h = 1080;
+		break;
+	case ZED_RESOLUTION_VGA: w = 672; h = 376;
+		break;
+	default: w = 1280; h = 720;
+	}
+}
+
+#ifdef OFXKUZED_NO_SDK
+//------------------------------------------------------------------------------------------------------
+//Without SDK the camera is never opened, so other functions see zed_ = 0
+bool ofxKuZedCameraSource::open(const ofxKuZedCameraSettings &)
+{
+	ofLogError() << "ZED: the addon is built without ZED SDK (OFXKUZED_NO_SDK), camera is not available" << endl;
+	return false;
+}
+
+void ofxKuZedCameraSource::close() {}
+int ofxKuZedCameraSource::getWidth() { return 0; }
+int ofxKuZedCameraSource::getHeight() { return 0; }
+ofxKuZedIntrinsics ofxKuZedCameraSource::getIntrinsics() { return ofxKuZedIntrinsics(); }
+bool ofxKuZedCameraSource::grab(bool, bool) { return false; }
+void ofxKuZedCameraSource::retrieve(int, ofxKuZedBuffer &buffer) { buffer.clear(); }
+unsigned long long ofxKuZedCameraSource::getTimestamp() { return 0; }
+
+#else
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedCameraSource::open(const ofxKuZedCameraSettings &settings)
+{
+	close();
+	postprocessMode_ = settings.postprocessMode;
+	sl::zed::InitParams params;
+	params.mode = sl::zed::MODE(settings.depthMode);
+	params.device = settings.gpuDevice;
+	params.minimumDistance = settings.minimumDistance;
+	params.vflip = settings.vflip;
+	params.verbose = settings.verbose;
+	zed_ = new sl::zed::Camera(sl::zed::ZEDResolution_mode(settings.resolution), settings.fps);
+	sl::zed::ERRCODE zederr = zed_->init(params);
+	if (zederr != sl::zed::SUCCESS) {
+		ofLog() << "ERROR starting ZED: " << sl::zed::errcode2str(zederr) << endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedCameraSource::close()
+{
+	if (zed_) {
+		delete zed_;
+		zed_ = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedCameraSource::getWidth()
+{
+	return (zed_) ? zed_->getImageSize().width : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedCameraSource::getHeight()
+{
+	return (zed_) ? zed_->getImageSize().height : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZedCameraSource::getIntrinsics()
+{
+	ofxKuZedIntrinsics intrinsics;
+	if (zed_) {
+		sl::zed::CamParameters &cam = zed_->getParameters()->LeftCam;
+		intrinsics.fx = cam.fx;
+		intrinsics.fy = cam.fy;
+		intrinsics.cx = cam.cx;
+		intrinsics.cy = cam.cy;
+	}
+	return intrinsics;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedCameraSource::grab(bool computeDepth, bool computeXYZ)
+{
+	if (!zed_) return false;
+	//Note: grab returns false if there was no error
+	if (zed_->grab(sl::zed::SENSING_MODE(postprocessMode_), computeDepth, computeDepth, computeXYZ)) {
+		return false;
+	}
+	timestamp_ = zed_->getCameraTimestamp();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Get view of SDK buffer. It's valid until the next grab
+void ofxKuZedCameraSource::retrieve(int channel, ofxKuZedBuffer &buffer)
+{
+	sl::zed::Mat zedView;
+	switch (channel) {
+	case ZED_CHANNEL_LEFT: zedView = zed_->retrieveImage(sl::zed::SIDE::LEFT);
+		break;
+	case ZED_CHANNEL_RIGHT: zedView = zed_->retrieveImage(sl::zed::SIDE::RIGHT);
+		break;
+	case ZED_CHANNEL_DEPTH: zedView = zed_->retrieveMeasure(sl::zed::MEASURE::DEPTH);
+		break;
+	case ZED_CHANNEL_XYZ: zedView = zed_->retrieveMeasure(sl::zed::MEASURE::XYZ);
+		//XYZ, 3D coordinates of the image points, 4 channels, FLOAT  (the 4th channel may contains the colors)
+		break;
+	case ZED_CHANNEL_XYZRGBA: zedView = zed_->retrieveMeasure(sl::zed::MEASURE::XYZRGBA);
+		//XYZRGBA, 3D coordinates and Color of the image , 4 channels, FLOAT (the 4th channel encode 4 UCHAR for color)
+		break;
+	}
+	buffer.setView(zedView.data, zedView.width, zedView.height, zedView.step, ofxKuZedChannelBytesPerPixel(channel));
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedCameraSource::getTimestamp()
+{
+	return timestamp_;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
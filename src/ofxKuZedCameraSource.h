@@ -0,0 +1,65 @@
+#pragma once
+
+//Live ZED camera as a source of frames for ofxKuZed.
+//It's the only part of the addon which uses ZED SDK, and the SDK header is included only in its .cpp,
+//so other code compiles without SDK and CUDA. With OFXKUZED_NO_SDK defined (e.g. Linux build without SDK,
+//see addon_config.mk) the camera can't be opened, and ofxKuZed uses the mock camera instead (see setMockCamera).
+
+#include "ofMain.h"
+#include "ofxKuZedSource.h"
+
+//Available ZED resolutions, values of sl::zed::ZEDResolution_mode
+const int ZED_RESOLUTION_HD2K = 0;		//2208*1242, supported framerate : 15 fps
+const int ZED_RESOLUTION_HD1080 = 1;	//1920*1080, supported framerates : 15, 30 fps
+const int ZED_RESOLUTION_HD720 = 2;		//1280*720, supported framerates : 15, 30, 60 fps
+const int ZED_RESOLUTION_VGA = 3;		//672*376, supported framerates : 15, 30, 60, 100 fps
+
+//ZED depth computing quality, values of sl::zed::MODE
+const int ZED_DEPTH_MODE_PERFORMANCE = 1;	//Fastest mode, also requires less GPU memory, the disparity map is less robust
+const int ZED_DEPTH_MODE_MEDIUM = 2;		//Balanced quality mode, requires less GPU memory but the disparity map is a little less detailed
+const int ZED_DEPTH_MODE_QUALITY = 3;		//Better quality mode, the disparity map is more precise
+
+//ZED depth postprocessing mode, values of sl::zed::SENSING_MODE
+const int ZED_DEPTH_POSTPROCESS_FILL = 0;		//Occlusion filling, edge sharpening, advanced post-filtering.
+const int ZED_DEPTH_POSTPROCESS_STANDARD = 1;	//No occlusion filling
+
+//Camera settings, they are converted to SDK parameters on opening.
+//Defaults are the ones of ofxKuZed, they differ from sl::zed::InitParams only by depthMode (SDK: PERFORMANCE)
+struct ofxKuZedCameraSettings {
+	int resolution = ZED_RESOLUTION_HD720;
+	float fps = 0;
+	int depthMode = ZED_DEPTH_MODE_QUALITY;
+	int postprocessMode = ZED_DEPTH_POSTPROCESS_STANDARD;
+	int gpuDevice = -1;
+	float minimumDistance = -1;
+	bool vflip = false;
+	bool verbose = false;
+};
+
+namespace sl { namespace zed { class Camera; } }
+
+class ofxKuZedCameraSource : public ofxKuZedSource
+{
+public:
+	~ofxKuZedCameraSource();
+
+	static bool isAvailable();		//false if the addon is built without ZED SDK
+	//Image size of resolution ZED_RESOLUTION_..., also used by mock camera
+	static void resolutionSize(int resolution, int &w, int &h);
+
+	//Start camera, returns false on error
+	bool open(const ofxKuZedCameraSettings &settings);
+
+	void close();
+	int getWidth();
+	int getHeight();
+	ofxKuZedIntrinsics getIntrinsics();
+	bool grab(bool computeDepth, bool computeXYZ);
+	void retrieve(int channel, ofxKuZedBuffer &buffer);
+	unsigned long long getTimestamp();
+
+private:
+	sl::zed::Camera* zed_ = 0;
+	int postprocessMode_ = 0;
+	unsigned long long timestamp_ = 0;
+};
@@ -0,0 +1,92 @@
+#include "ofxKuZedCaptureThread.h"
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedCaptureThread::ofxKuZedCaptureThread()
+{
+	write_ = 0;
+	ready_ = 1;
+	read_ = 2;
+	readyNew_ = false;
+	frameCounter_ = 0;
+	dropped_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedCaptureThread::~ofxKuZedCaptureThread()
+{
+	stop();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedCaptureThread::start(ofxKuZedGrabFunction grab)
+{
+	stop();
+	grab_ = grab;
+	for (int i = 0; i < 3; i++) {
+		frames_[i].clear();
+		frames_[i].id = 0;
+	}
+	readyNew_ = false;
+	frameCounter_ = 0;
+	dropped_ = 0;
+	startThread();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedCaptureThread::stop()
+{
+	if (isThreadRunning()) {
+		waitForThread(true);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedCaptureThread::threadedFunction()
+{
+	while (isThreadRunning()) {
+		//write_ is changed only by this thread, so it's safe to read it without locking
+		ofxKuZedFrame &frame = frames_[write_];
+		if (grab_ && grab_(frame)) {
+			lock();
+			frame.id = ++frameCounter_;
+			if (readyNew_) dropped_++;
+			swap(write_, ready_);
+			readyNew_ = true;
+			unlock();
+		}
+		else {
+			sleep(1);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedCaptureThread::update()
+{
+	bool isNew = false;
+	lock();
+	if (readyNew_) {
+		swap(read_, ready_);
+		readyNew_ = false;
+		isNew = true;
+	}
+	unlock();
+	return isNew;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedFrame &ofxKuZedCaptureThread::frame()
+{
+	return frames_[read_];
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedCaptureThread::droppedFrames()
+{
+	lock();
+	unsigned long long dropped = dropped_;
+	unlock();
+	return dropped;
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,40 @@
+#pragma once
+
+//Capture thread for ofxKuZed threaded mode.
+//It grabs frames using ofxKuZedGrabFunction into triple buffer:
+//one frame is written by the thread, one is the newest complete frame,
+//and one is used by the main thread for reading until the next update().
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+
+class ofxKuZedCaptureThread : public ofThread
+{
+public:
+	ofxKuZedCaptureThread();
+	~ofxKuZedCaptureThread();
+
+	void start(ofxKuZedGrabFunction grab);
+	void stop();
+
+	//Switch to the newest complete frame. Returns true if it's a new frame
+	//Call it from the main thread
+	bool update();
+
+	//Frame for reading, it's valid until next update()
+	ofxKuZedFrame &frame();
+
+	//Number of frames, which were grabbed but overwritten by the newer frame before update() call
+	unsigned long long droppedFrames();
+
+private:
+	void threadedFunction();
+
+	ofxKuZedGrabFunction grab_;
+
+	ofxKuZedFrame frames_[3];
+	int write_, ready_, read_;	//indices in frames_
+	bool readyNew_;				//frames_[ready_] is not taken by update() yet
+	unsigned long long frameCounter_;
+	unsigned long long dropped_;
+};
@@ -0,0 +1,1063 @@
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OFXKUZED_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define OFXKUZED_TARGET(isa)
+#else
+#define OFXKUZED_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+static int simd_ = -1;	//not selected yet
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedConvert::simdSupported()
+{
+#ifdef OFXKUZED_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+	bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osAvx) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool ssse3 = __builtin_cpu_supports("ssse3");
+	bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+	if (avx2) return SIMD_AVX2;
+	if (ssse3) return SIMD_SSSE3;
+#endif
+	return SIMD_SCALAR;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedConvert::simd()
+{
+	if (simd_ < 0) {
+		simd_ = simdSupported();
+	}
+	return simd_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::setSimd(int simd)
+{
+	int supported = simdSupported();
+	simd_ = (simd < supported) ? simd : supported;
+	if (simd_ < 0) simd_ = SIMD_SCALAR;
+}
+
+//------------------------------------------------------------------------------------------------------
+const char *ofxKuZedConvert::simdName(int simd)
+{
+	switch (simd) {
+	case SIMD_SSSE3: return "SSSE3";
+	case SIMD_AVX2: return "AVX2";
+	}
+	return "scalar";
+}
+
+//------------------------------------------------------------------------------------------------------
+static void bgraToRgbScalar(const unsigned char *src, unsigned char *dst, int w)
+{
+	for (int x = 0; x < w; x++) {
+		dst[0] = src[2];
+		dst[1] = src[1];
+		dst[2] = src[0];
+		src += 4;
+		dst += 3;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//16 pixels per iteration: each 4 pixels are shuffled to 12 bytes, and then packed into three 16-byte stores
+OFXKUZED_TARGET("ssse3")
+static void bgraToRgbSSSE3(const unsigned char *src, unsigned char *dst, int w)
+{
+	const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src)), shuffle);
+		__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 16)), shuffle);
+		__m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 32)), shuffle);
+		__m128i d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 48)), shuffle);
+		_mm_storeu_si128((__m128i*)(dst), _mm_or_si128(a, _mm_slli_si128(b, 12)));
+		_mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+		_mm_storeu_si128((__m128i*)(dst + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+		src += 64;
+		dst += 48;
+	}
+	bgraToRgbScalar(src, dst, w - x);
+}
+
+//------------------------------------------------------------------------------------------------------
+//32 pixels per iteration: two groups of 16 pixels are converted like in SSSE3 version,
+//one group in each 128-bit lane (AVX2 byte shuffles and shifts work inside lanes)
+static inline __m256i OFXKUZED_TARGET("avx2") loadLanes(const unsigned char *lo, const unsigned char *hi)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)lo)), _mm_loadu_si128((const __m128i*)hi), 1);
+}
+
+static inline void OFXKUZED_TARGET("avx2") storeLanes(unsigned char *lo, unsigned char *hi, __m256i v)
+{
+	_mm_storeu_si128((__m128i*)lo, _mm256_castsi256_si128(v));
+	_mm_storeu_si128((__m128i*)hi, _mm256_extracti128_si256(v, 1));
+}
+
+OFXKUZED_TARGET("avx2")
+static void bgraToRgbAVX2(const unsigned char *src, unsigned char *dst, int w)
+{
+	const __m256i shuffle = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	int x = 0;
+	for (; x + 32 <= w; x += 32) {
+		__m256i a = _mm256_shuffle_epi8(loadLanes(src, src + 64), shuffle);
+		__m256i b = _mm256_shuffle_epi8(loadLanes(src + 16, src + 80), shuffle);
+		__m256i c = _mm256_shuffle_epi8(loadLanes(src + 32, src + 96), shuffle);
+		__m256i d = _mm256_shuffle_epi8(loadLanes(src + 48, src + 112), shuffle);
+		storeLanes(dst, dst + 48, _mm256_or_si256(a, _mm256_slli_si256(b, 12)));
+		storeLanes(dst + 16, dst + 64, _mm256_or_si256(_mm256_srli_si256(b, 4), _mm256_slli_si256(c, 8)));
+		storeLanes(dst + 32, dst + 80, _mm256_or_si256(_mm256_srli_si256(c, 8), _mm256_slli_si256(d, 4)));
+		src += 128;
+		dst += 96;
+	}
+	bgraToRgbSSSE3(src, dst, w - x);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+//Depth -> grayscale. All versions compute (maxMm - d) * scale, clamp it to [0,255] and truncate,
+//so they give the same results
+static void depthToGrayScalar(const float *src, unsigned char *dst, int w, float maxMm, float scale)
+{
+	for (int x = 0; x < w; x++) {
+		float d = src[x];
+		int value = 0;
+		if (d > 0 && d <= maxMm) {	//false for NaN and inf
+			float g = (maxMm - d) * scale;
+			value = (g < 255.0f) ? int(g) : 255;
+		}
+		dst[x] = value;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//SSE2 is a part of SSSE3 level, 16 pixels per iteration
+OFXKUZED_TARGET("sse2")
+static inline __m128i depthToGray4SSE2(const float *src, __m128 zero, __m128 maxMm, __m128 scale, __m128 white)
+{
+	__m128 d = _mm_loadu_ps(src);
+	__m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_cmple_ps(d, maxMm));
+	__m128 g = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(maxMm, d), scale), white);
+	return _mm_cvttps_epi32(_mm_and_ps(g, valid));
+}
+
+OFXKUZED_TARGET("sse2")
+static void depthToGraySSE2(const float *src, unsigned char *dst, int w, float maxMm, float scale)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 vmax = _mm_set1_ps(maxMm);
+	const __m128 vscale = _mm_set1_ps(scale);
+	const __m128 white = _mm_set1_ps(255.0f);
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i a = depthToGray4SSE2(src + x, zero, vmax, vscale, white);
+		__m128i b = depthToGray4SSE2(src + x + 4, zero, vmax, vscale, white);
+		__m128i c = depthToGray4SSE2(src + x + 8, zero, vmax, vscale, white);
+		__m128i d = depthToGray4SSE2(src + x + 12, zero, vmax, vscale, white);
+		_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+	depthToGrayScalar(src + x, dst + x, w - x, maxMm, scale);
+}
+
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("avx2")
+static inline __m256i depthToGray8AVX2(const float *src, __m256 zero, __m256 maxMm, __m256 scale, __m256 white)
+{
+	__m256 d = _mm256_loadu_ps(src);
+	__m256 valid = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GT_OQ), _mm256_cmp_ps(d, maxMm, _CMP_LE_OQ));
+	__m256 g = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(maxMm, d), scale), white);
+	return _mm256_cvttps_epi32(_mm256_and_ps(g, valid));
+}
+
+OFXKUZED_TARGET("avx2")
+static void depthToGrayAVX2(const float *src, unsigned char *dst, int w, float maxMm, float scale)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vmax = _mm256_set1_ps(maxMm);
+	const __m256 vscale = _mm256_set1_ps(scale);
+	const __m256 white = _mm256_set1_ps(255.0f);
+	//packs work inside 128-bit lanes, this permutation restores order of pixels
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int x = 0;
+	for (; x + 32 <= w; x += 32) {
+		__m256i a = depthToGray8AVX2(src + x, zero, vmax, vscale, white);
+		__m256i b = depthToGray8AVX2(src + x + 8, zero, vmax, vscale, white);
+		__m256i c = depthToGray8AVX2(src + x + 16, zero, vmax, vscale, white);
+		__m256i d = depthToGray8AVX2(src + x + 24, zero, vmax, vscale, white);
+		__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+		_mm256_storeu_si256((__m256i*)(dst + x), _mm256_permutevar8x32_epi32(packed, order));
+	}
+	depthToGraySSE2(src + x, dst + x, w - x, maxMm, scale);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthToGrayRow(const float *src, unsigned char *dst, int w, float minMm, float maxMm)
+{
+	float scale = (maxMm > minMm) ? 255.0f / (maxMm - minMm) : 0;
+#ifdef OFXKUZED_X86
+	switch (simd()) {
+	case SIMD_AVX2: depthToGrayAVX2(src, dst, w, maxMm, scale);
+		return;
+	case SIMD_SSSE3: depthToGraySSE2(src, dst, w, maxMm, scale);
+		return;
+	}
+#endif
+	depthToGrayScalar(src, dst, w, maxMm, scale);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthToGray(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h, float minMm, float maxMm)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			depthToGrayRow((const float*)(src + size_t(srcStep) * y), dst + size_t(dstStep) * y, w, minMm, maxMm);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthToXyzRow(const float *depth, const unsigned char *bgra, float *dst, int w, int y,
+	float fx, float fy, float cx, float cy)
+{
+	float nan = std::numeric_limits<float>::quiet_NaN();
+	float ifx = 1.0f / fx;
+	float vy = (y - cy) / fy;
+	for (int x = 0; x < w; x++) {
+		float d = depth[x];
+		bool valid = (d > 0 && d - d == 0);	//false for NaN and inf
+		float z = (valid) ? d : nan;
+		dst[0] = (x - cx) * ifx * z;
+		dst[1] = vy * z;
+		dst[2] = z;
+		if (bgra) {
+			unsigned char *rgba = (unsigned char *)(dst + 3);
+			rgba[0] = bgra[2];
+			rgba[1] = bgra[1];
+			rgba[2] = bgra[0];
+			rgba[3] = bgra[3];
+			bgra += 4;
+		}
+		else {
+			dst[3] = 0;
+		}
+		dst += 4;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthToXyz(const unsigned char *depth, int depthStep, const unsigned char *bgra, int bgraStep,
+	unsigned char *dst, int dstStep, int w, int h, float fx, float fy, float cx, float cy)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			depthToXyzRow((const float*)(depth + size_t(depthStep) * y), (bgra) ? bgra + size_t(bgraStep) * y : 0,
+				(float*)(dst + size_t(dstStep) * y), w, y, fx, fy, cx, cy);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+//Far clipping distance, farMm = 0 means no limit
+static inline float farLimit(float farMm)
+{
+	return (farMm > 0) ? farMm : 3.4e38f;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Depth range mask. All versions keep d > 0 && d >= nearMm && d <= farMm, which is false for NaN and inf
+static void depthRangeMaskScalar(const float *src, unsigned char *dst, int w, float nearMm, float farMm)
+{
+	for (int x = 0; x < w; x++) {
+		float d = src[x];
+		int keep = (d > 0) & (d >= nearMm) & (d <= farMm);
+		dst[x] = (unsigned char)(-keep);
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("sse2")
+static inline __m128i depthRangeMask4SSE2(const float *src, __m128 zero, __m128 nearMm, __m128 farMm)
+{
+	__m128 d = _mm_loadu_ps(src);
+	__m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_and_ps(_mm_cmpge_ps(d, nearMm), _mm_cmple_ps(d, farMm)));
+	return _mm_castps_si128(valid);
+}
+
+//Comparison results are -1 or 0, signed packing keeps them, so -1 becomes 255
+OFXKUZED_TARGET("sse2")
+static void depthRangeMaskSSE2(const float *src, unsigned char *dst, int w, float nearMm, float farMm)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 vnear = _mm_set1_ps(nearMm);
+	const __m128 vfar = _mm_set1_ps(farMm);
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i a = depthRangeMask4SSE2(src + x, zero, vnear, vfar);
+		__m128i b = depthRangeMask4SSE2(src + x + 4, zero, vnear, vfar);
+		__m128i c = depthRangeMask4SSE2(src + x + 8, zero, vnear, vfar);
+		__m128i d = depthRangeMask4SSE2(src + x + 12, zero, vnear, vfar);
+		_mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+	depthRangeMaskScalar(src + x, dst + x, w - x, nearMm, farMm);
+}
+
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("avx2")
+static inline __m256i depthRangeMask8AVX2(const float *src, __m256 zero, __m256 nearMm, __m256 farMm)
+{
+	__m256 d = _mm256_loadu_ps(src);
+	__m256 valid = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GT_OQ),
+		_mm256_and_ps(_mm256_cmp_ps(d, nearMm, _CMP_GE_OQ), _mm256_cmp_ps(d, farMm, _CMP_LE_OQ)));
+	return _mm256_castps_si256(valid);
+}
+
+OFXKUZED_TARGET("avx2")
+static void depthRangeMaskAVX2(const float *src, unsigned char *dst, int w, float nearMm, float farMm)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vnear = _mm256_set1_ps(nearMm);
+	const __m256 vfar = _mm256_set1_ps(farMm);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int x = 0;
+	for (; x + 32 <= w; x += 32) {
+		__m256i a = depthRangeMask8AVX2(src + x, zero, vnear, vfar);
+		__m256i b = depthRangeMask8AVX2(src + x + 8, zero, vnear, vfar);
+		__m256i c = depthRangeMask8AVX2(src + x + 16, zero, vnear, vfar);
+		__m256i d = depthRangeMask8AVX2(src + x + 24, zero, vnear, vfar);
+		__m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+		_mm256_storeu_si256((__m256i*)(dst + x), _mm256_permutevar8x32_epi32(packed, order));
+	}
+	depthRangeMaskSSE2(src + x, dst + x, w - x, nearMm, farMm);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+//Plane test in a row is linear in x: n.p + d = depth * (a * x + b) + d,
+//so the loop is branchless and is vectorized by compiler
+static void planeMaskRow(const float *src, unsigned char *dst, int x0, int x1, float a, float b, float d)
+{
+	for (int x = x0; x < x1; x++) {
+		int keep = (src[x] * (a * x + b) + d >= 0);
+		dst[x] &= (unsigned char)(-keep);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthMaskRow(const float *depth, unsigned char *mask, int w, int y, const MaskParams &params)
+{
+	float farMm = farLimit(params.farMm);
+#ifdef OFXKUZED_X86
+	switch (simd()) {
+	case SIMD_AVX2: depthRangeMaskAVX2(depth, mask, w, params.nearMm, farMm);
+		break;
+	case SIMD_SSSE3: depthRangeMaskSSE2(depth, mask, w, params.nearMm, farMm);
+		break;
+	default: depthRangeMaskScalar(depth, mask, w, params.nearMm, farMm);
+	}
+#else
+	depthRangeMaskScalar(depth, mask, w, params.nearMm, farMm);
+#endif
+	for (int i = 0; i < params.planeCount; i++) {
+		const MaskPlane &plane = params.planes[i];
+		int y1 = (plane.y1 > 0) ? plane.y1 : y + 1;
+		if (y < plane.y0 || y >= y1) continue;
+		int x0 = std::max(plane.x0, 0);
+		int x1 = (plane.x1 > 0) ? std::min(plane.x1, w) : w;
+		//p = ((x - cx) / fx * depth, (y - cy) / fy * depth, depth)
+		float a = plane.nx / params.fx;
+		float b = plane.ny * (y - params.cy) / params.fy + plane.nz - plane.nx * params.cx / params.fx;
+		planeMaskRow(depth, mask, x0, x1, a, b, plane.d);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static void applyMaskRgbScalar(const unsigned char *mask, unsigned char *dst, int w)
+{
+	for (int x = 0; x < w; x++) {
+		unsigned char m = mask[x];
+		dst[0] &= m;
+		dst[1] &= m;
+		dst[2] &= m;
+		dst += 3;
+	}
+}
+
+static void applyMaskRgbaScalar(const unsigned char *bgra, const unsigned char *mask, unsigned char *dst, int w)
+{
+	for (int x = 0; x < w; x++) {
+		unsigned char m = mask[x];
+		dst[0] = bgra[2] & m;
+		dst[1] = bgra[1] & m;
+		dst[2] = bgra[0] & m;
+		dst[3] = m;
+		bgra += 4;
+		dst += 4;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//16 pixels per iteration: mask bytes are repeated 3 times by shuffles and applied to 48 bytes of RGB
+OFXKUZED_TARGET("ssse3")
+static void applyMaskRgbSSSE3(const unsigned char *mask, unsigned char *dst, int w)
+{
+	const __m128i spread0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+	const __m128i spread1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+	const __m128i spread2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + x));
+		__m128i *d = (__m128i*)(dst + 3 * x);
+		_mm_storeu_si128(d, _mm_and_si128(_mm_loadu_si128(d), _mm_shuffle_epi8(m, spread0)));
+		_mm_storeu_si128(d + 1, _mm_and_si128(_mm_loadu_si128(d + 1), _mm_shuffle_epi8(m, spread1)));
+		_mm_storeu_si128(d + 2, _mm_and_si128(_mm_loadu_si128(d + 2), _mm_shuffle_epi8(m, spread2)));
+	}
+	applyMaskRgbScalar(mask + x, dst + 3 * x, w - x);
+}
+
+//------------------------------------------------------------------------------------------------------
+//4 pixels per shuffle: BGRA -> RGB with alpha 255, then AND with mask bytes repeated 4 times
+OFXKUZED_TARGET("ssse3")
+static void applyMaskRgbaSSSE3(const unsigned char *bgra, const unsigned char *mask, unsigned char *dst, int w)
+{
+	const __m128i order = _mm_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+	const __m128i alpha = _mm_set1_epi32(int(0xff000000));
+	const __m128i spread[4] = {
+		_mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3),
+		_mm_setr_epi8(4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7),
+		_mm_setr_epi8(8, 8, 8, 8, 9, 9, 9, 9, 10, 10, 10, 10, 11, 11, 11, 11),
+		_mm_setr_epi8(12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15)
+	};
+	int x = 0;
+	for (; x + 16 <= w; x += 16) {
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + x));
+		for (int k = 0; k < 4; k++) {
+			__m128i p = _mm_loadu_si128((const __m128i*)(bgra + 4 * (x + 4 * k)));
+			p = _mm_or_si128(_mm_shuffle_epi8(p, order), alpha);
+			_mm_storeu_si128((__m128i*)(dst + 4 * (x + 4 * k)), _mm_and_si128(p, _mm_shuffle_epi8(m, spread[k])));
+		}
+	}
+	applyMaskRgbaScalar(bgra + 4 * x, mask + x, dst + 4 * x, w - x);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::applyMaskRow(const unsigned char *bgra, const unsigned char *mask, unsigned char *dst, int w, int channels)
+{
+	if (channels == 3) {
+		bgraToRgbRow(bgra, dst, w);
+#ifdef OFXKUZED_X86
+		if (simd() >= SIMD_SSSE3) {
+			applyMaskRgbSSSE3(mask, dst, w);
+			return;
+		}
+#endif
+		applyMaskRgbScalar(mask, dst, w);
+	}
+	else {
+#ifdef OFXKUZED_X86
+		if (simd() >= SIMD_SSSE3) {
+			applyMaskRgbaSSSE3(bgra, mask, dst, w);
+			return;
+		}
+#endif
+		applyMaskRgbaScalar(bgra, mask, dst, w);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::depthMask(const unsigned char *depth, int depthStep, const unsigned char *bgra, int bgraStep,
+	unsigned char *mask, int maskStep, unsigned char *dst, int dstStep, int dstChannels, int w, int h, const MaskParams &params)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		std::vector<unsigned char> maskRow((mask) ? 0 : w);	//if mask is not required, it's computed by rows
+		for (int y = y0; y < y1; y++) {
+			unsigned char *m = (mask) ? mask + size_t(maskStep) * y : &maskRow[0];
+			depthMaskRow((const float*)(depth + size_t(depthStep) * y), m, w, y, params);
+			if (dst) {
+				applyMaskRow(bgra + size_t(bgraStep) * y, m, dst + size_t(dstStep) * y, w, dstChannels);
+			}
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+//Point is kept in compact point cloud if it's finite and its |z| is in [nearMm, farMm].
+//Returns 0 or 1 without branches
+static inline int pointValid(float vx, float vy, float vz, float nearMm, float farMm)
+{
+	float sum = vx + vy + vz;
+	float az = fabsf(vz);
+	//sum - sum is NaN for NaN or inf in any coordinate
+	return (sum - sum == 0) & (az >= nearMm) & (az <= farMm);
+}
+
+//Number of points which will be written from the row
+static int countPointsRow(const float *src, int w, const ofxKuZedConvert::PointsParams &params)
+{
+	if (!params.dropInvalid) return (w + params.decimate - 1) / params.decimate;
+	const float farMm = farLimit(params.farMm);
+	int n = 0;
+	for (int x = 0; x < w; x += params.decimate, src += 4 * params.decimate) {
+		n += pointValid(src[0], src[1], src[2], params.nearMm, farMm);
+	}
+	return n;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Point cloud row, specialized by outputs so the loop has no per-point checks.
+//Compaction is branchless: point is always written to slot n, and n is advanced only for valid points
+template<bool dropInvalid, bool writeRgba, bool writeFloat, bool writeIndex>
+static int xyzToPointsRowT(const float *src, int w, const ofxKuZedConvert::PointsParams &params,
+	const ofxKuZedConvert::PointsOutput &out, int outIndex, int srcIndex, int maxPoints)
+{
+	const float toFloat = 1.0f / 255.0f;
+	const unsigned int white = 0xffffffff;
+	const float signY = params.signY;
+	const float signZ = params.signZ;
+	const float nearMm = params.nearMm;
+	const float farMm = farLimit(params.farMm);
+	const bool hasColors = params.hasColors;
+	const int decimate = params.decimate;
+
+	float *px = out.x + size_t(outIndex) * out.xyzStride;
+	float *py = out.y + size_t(outIndex) * out.xyzStride;
+	float *pz = out.z + size_t(outIndex) * out.xyzStride;
+	unsigned char *rgba = (writeRgba) ? out.rgba + size_t(outIndex) * out.rgbaStride : 0;
+	float *rgbaFloat = (writeFloat) ? out.rgbaFloat + size_t(outIndex) * out.rgbaFloatStride : 0;
+	int *index = (writeIndex) ? out.index + outIndex : 0;
+	int n = 0;
+	int srcAdvance = 4 * decimate;
+	for (int x = 0; x < w; x += decimate, src += srcAdvance) {
+		//Compaction writes each point to slot n before checking it,
+		//so stop when the slot would be out of the given range
+		if (dropInvalid && n == maxPoints) break;
+		float vx = src[0];
+		float vy = src[1];
+		float vz = src[2];
+		px[0] = vx;
+		py[0] = vy * signY;
+		pz[0] = vz * signZ;
+		const unsigned char *c = (hasColors) ? (const unsigned char *)(src + 3) : (const unsigned char *)&white;
+		if (writeRgba) {
+			memcpy(rgba, c, 4);
+		}
+		if (writeFloat) {
+			rgbaFloat[0] = c[0] * toFloat;
+			rgbaFloat[1] = c[1] * toFloat;
+			rgbaFloat[2] = c[2] * toFloat;
+			rgbaFloat[3] = c[3] * toFloat;
+		}
+		if (writeIndex) {
+			index[0] = srcIndex + x;
+		}
+		int advance = (dropInvalid) ? pointValid(vx, vy, vz, nearMm, farMm) : 1;
+		n += advance;
+		px += advance * out.xyzStride;
+		py += advance * out.xyzStride;
+		pz += advance * out.xyzStride;
+		if (writeRgba) rgba += advance * out.rgbaStride;
+		if (writeFloat) rgbaFloat += advance * out.rgbaFloatStride;
+		if (writeIndex) index += advance;
+	}
+	return n;
+}
+
+template<bool dropInvalid, bool writeIndex>
+static int xyzToPointsRowColors(const float *src, int w, const ofxKuZedConvert::PointsParams &params,
+	const ofxKuZedConvert::PointsOutput &out, int outIndex, int srcIndex, int maxPoints)
+{
+	if (out.rgba && out.rgbaFloat) return xyzToPointsRowT<dropInvalid, true, true, writeIndex>(src, w, params, out, outIndex, srcIndex, maxPoints);
+	if (out.rgba) return xyzToPointsRowT<dropInvalid, true, false, writeIndex>(src, w, params, out, outIndex, srcIndex, maxPoints);
+	if (out.rgbaFloat) return xyzToPointsRowT<dropInvalid, false, true, writeIndex>(src, w, params, out, outIndex, srcIndex, maxPoints);
+	return xyzToPointsRowT<dropInvalid, false, false, writeIndex>(src, w, params, out, outIndex, srcIndex, maxPoints);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedConvert::xyzToPointsRow(const float *src, int w, const PointsParams &params, const PointsOutput &out, int outIndex, int srcIndex,
+	int maxPoints)
+{
+	if (!out.x || params.decimate < 1) return 0;
+	if (params.dropInvalid) {
+		return (out.index) ? xyzToPointsRowColors<true, true>(src, w, params, out, outIndex, srcIndex, maxPoints)
+			: xyzToPointsRowColors<true, false>(src, w, params, out, outIndex, srcIndex, maxPoints);
+	}
+	return (out.index) ? xyzToPointsRowColors<false, true>(src, w, params, out, outIndex, srcIndex, maxPoints)
+		: xyzToPointsRowColors<false, false>(src, w, params, out, outIndex, srcIndex, maxPoints);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedConvert::xyzToPoints(const unsigned char *src, int srcStep, int w, int h, const PointsParams &params, const PointsOutput &out)
+{
+	if (params.decimate < 1) return 0;
+	int rows = (h + params.decimate - 1) / params.decimate;
+	const int minBandRows = 4;
+	const int indexOffset = params.indexOffset;
+	const int indexStep = (params.indexStep > 0) ? params.indexStep : w;
+
+	if (params.dropInvalid && ofxKuZedWorkers::shared().getThreads() <= 1) {
+		//Single pass, each row continues from the end of the previous one
+		int n = 0;
+		for (int y = 0; y < h; y += params.decimate) {
+			n += xyzToPointsRow((const float*)(src + size_t(srcStep) * y), w, params, out, n, indexOffset + indexStep * y);
+		}
+		return n;
+	}
+
+	//Output index of each row: for compact cloud it's computed by counting pass, which only reads xyz
+	std::vector<int> offsets(rows + 1);
+	if (params.dropInvalid) {
+		ofxKuZedWorkers::shared().parallelRows(rows, [&](int r0, int r1) {
+			for (int r = r0; r < r1; r++) {
+				offsets[r + 1] = countPointsRow((const float*)(src + size_t(srcStep) * r * params.decimate), w, params);
+			}
+		}, minBandRows);
+		for (int r = 0; r < rows; r++) {
+			offsets[r + 1] += offsets[r];
+		}
+	}
+	else {
+		int perRow = (w + params.decimate - 1) / params.decimate;
+		for (int r = 0; r <= rows; r++) {
+			offsets[r] = r * perRow;
+		}
+	}
+
+	ofxKuZedWorkers::shared().parallelRows(rows, [&](int r0, int r1) {
+		for (int r = r0; r < r1; r++) {
+			int y = r * params.decimate;
+			xyzToPointsRow((const float*)(src + size_t(srcStep) * y), w, params, out, offsets[r], indexOffset + indexStep * y,
+				offsets[r + 1] - offsets[r]);
+		}
+	}, minBandRows);
+	return offsets[rows];
+}
+
+//------------------------------------------------------------------------------------------------------
+//Plain loop over components is vectorized by compiler, bands are 1024 colors
+void ofxKuZedConvert::rgbaToFloat(const unsigned char *src, float *dst, int n)
+{
+	const float toFloat = 1.0f / 255.0f;
+	const int band = 1024;
+	ofxKuZedWorkers::shared().parallelRows((n + band - 1) / band, [&](int b0, int b1) {
+		int end = 4 * std::min(b1 * band, n);
+		for (int i = 4 * b0 * band; i < end; i++) {
+			dst[i] = src[i] * toFloat;
+		}
+	}, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::bgraToRgbRow(const unsigned char *src, unsigned char *dst, int w)
+{
+#ifdef OFXKUZED_X86
+	switch (simd()) {
+	case SIMD_AVX2: bgraToRgbAVX2(src, dst, w);
+		return;
+	case SIMD_SSSE3: bgraToRgbSSSE3(src, dst, w);
+		return;
+	}
+#endif
+	bgraToRgbScalar(src, dst, w);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::bgraToRgb(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			bgraToRgbRow(src + size_t(srcStep) * y, dst + size_t(dstStep) * y, w);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::rgbToBgra(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			const unsigned char *s = src + size_t(srcStep) * y;
+			unsigned char *d = dst + size_t(dstStep) * y;
+			for (int x = 0; x < w; x++) {
+				d[0] = s[2];
+				d[1] = s[1];
+				d[2] = s[0];
+				d[3] = 255;
+				s += 3;
+				d += 4;
+			}
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::copyRows(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int rowBytes, int h)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		if (srcStep == rowBytes && dstStep == rowBytes) {
+			memcpy(dst + size_t(dstStep) * y0, src + size_t(srcStep) * y0, size_t(rowBytes) * (y1 - y0));
+			return;
+		}
+		for (int y = y0; y < y1; y++) {
+			memcpy(dst + size_t(dstStep) * y, src + size_t(srcStep) * y, rowBytes);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+static inline bool depthValid(float d)
+{
+	return (d > 0) & (d <= std::numeric_limits<float>::max());
+}
+
+//------------------------------------------------------------------------------------------------------
+//Generic reductions work by chunks of output pixels: columns of the chunk are reduced first over factor rows
+//(plain loops over consecutive values, vectorized by compiler), then each block over its factor columns
+static const int DOWNSCALE_CHUNK = 64;	//output pixels
+
+static void downscaleDepthBox(const float *src, int srcStep, float *dst, int w, int factor)
+{
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	float sums[DOWNSCALE_CHUNK * ofxKuZedConvert::DOWNSCALE_MAX];
+	int counts[DOWNSCALE_CHUNK * ofxKuZedConvert::DOWNSCALE_MAX];
+	for (int x0 = 0; x0 < w; x0 += DOWNSCALE_CHUNK) {
+		int n = std::min(DOWNSCALE_CHUNK, w - x0);
+		int columns = n * factor;
+		const float *chunk = src + x0 * factor;
+		for (int i = 0; i < columns; i++) {
+			sums[i] = 0;
+			counts[i] = 0;
+		}
+		for (int j = 0; j < factor; j++) {
+			const float *p = (const float*)((const unsigned char*)chunk + size_t(srcStep) * j);
+			for (int i = 0; i < columns; i++) {
+				float d = p[i];
+				int valid = depthValid(d);
+				sums[i] += (valid) ? d : 0.0f;
+				counts[i] += valid;
+			}
+		}
+		for (int x = 0; x < n; x++) {
+			float sum = 0;
+			int count = 0;
+			for (int i = x * factor; i < (x + 1) * factor; i++) {
+				sum += sums[i];
+				count += counts[i];
+			}
+			dst[x0 + x] = (count > 0) ? sum / count : nan;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static void downscaleDepthMin(const float *src, int srcStep, float *dst, int w, int factor)
+{
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	float mins[DOWNSCALE_CHUNK * ofxKuZedConvert::DOWNSCALE_MAX];
+	for (int x0 = 0; x0 < w; x0 += DOWNSCALE_CHUNK) {
+		int n = std::min(DOWNSCALE_CHUNK, w - x0);
+		int columns = n * factor;
+		const float *chunk = src + x0 * factor;
+		for (int i = 0; i < columns; i++) {
+			mins[i] = inf;
+		}
+		for (int j = 0; j < factor; j++) {
+			const float *p = (const float*)((const unsigned char*)chunk + size_t(srcStep) * j);
+			for (int i = 0; i < columns; i++) {
+				float d = (depthValid(p[i])) ? p[i] : inf;
+				mins[i] = (d < mins[i]) ? d : mins[i];
+			}
+		}
+		for (int x = 0; x < n; x++) {
+			float m = inf;
+			for (int i = x * factor; i < (x + 1) * factor; i++) {
+				m = (mins[i] < m) ? mins[i] : m;
+			}
+			dst[x0 + x] = (m < inf) ? m : nan;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Blocks up to 4 x 4: the median is the value with rank (n - 1) / 2 among n valid values, ranks are counted
+//without branches (ties are ordered by index, invalid values are inf so they are after all valid ones).
+//Larger blocks: valid values are sorted by insertion
+static const int MEDIAN_RANK_MAX = 16;	//values in block
+
+static void downscaleDepthMedian(const float *src, int srcStep, float *dst, int w, int factor)
+{
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	const int area = factor * factor;
+	float values[ofxKuZedConvert::DOWNSCALE_MAX * ofxKuZedConvert::DOWNSCALE_MAX];
+	for (int x = 0; x < w; x++) {
+		int n = 0;
+		const float *block = src + x * factor;
+		if (area <= MEDIAN_RANK_MAX) {
+			for (int j = 0; j < factor; j++) {
+				const float *p = (const float*)((const unsigned char*)block + size_t(srcStep) * j);
+				for (int i = 0; i < factor; i++) {
+					int valid = depthValid(p[i]);
+					values[j * factor + i] = (valid) ? p[i] : inf;
+					n += valid;
+				}
+			}
+			float median = nan;
+			int k = (n - 1) / 2;
+			for (int i = 0; i < area; i++) {
+				int rank = 0;
+				for (int j = 0; j < area; j++) {
+					rank += (values[j] < values[i]) | ((values[j] == values[i]) & (j < i));
+				}
+				median = (rank == k) ? values[i] : median;
+			}
+			dst[x] = (n > 0) ? median : nan;
+			continue;
+		}
+		for (int j = 0; j < factor; j++) {
+			const float *p = (const float*)((const unsigned char*)block + size_t(srcStep) * j);
+			for (int i = 0; i < factor; i++) {
+				float d = p[i];
+				if (!depthValid(d)) continue;
+				int k = n++;
+				for (; k > 0 && values[k - 1] > d; k--) values[k] = values[k - 1];
+				values[k] = d;
+			}
+		}
+		dst[x] = (n > 0) ? values[(n - 1) / 2] : nan;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//2 x 2 blocks, 4 output pixels per iteration. Invalid depth is replaced by inf, so minimum and median
+//are found by min/max network: the lower median of n valid values is the smallest one for n <= 2,
+//and the second smallest for n = 3, 4. Sums are made by columns like in scalar version, so results are equal
+OFXKUZED_TARGET("sse2")
+static int downscaleDepth2SSE2(const float *src, int srcStep, float *dst, int w, int reduction)
+{
+	const float *src1 = (const float*)((const unsigned char*)src + srcStep);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 maxFloat = _mm_set1_ps(std::numeric_limits<float>::max());
+	const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+	const __m128 nan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+	int x = 0;
+	for (; x + 4 <= w; x += 4) {
+		__m128 a0 = _mm_loadu_ps(src + 2 * x), a1 = _mm_loadu_ps(src + 2 * x + 4);
+		__m128 b0 = _mm_loadu_ps(src1 + 2 * x), b1 = _mm_loadu_ps(src1 + 2 * x + 4);
+		__m128 p[4] = {
+			_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)),
+			_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1))
+		};
+		if (reduction == ofxKuZedConvert::REDUCE_SAMPLE) {
+			_mm_storeu_ps(dst + x, p[0]);
+			continue;
+		}
+		__m128 q[4], ones[4];
+		for (int i = 0; i < 4; i++) {
+			__m128 valid = _mm_and_ps(_mm_cmpgt_ps(p[i], zero), _mm_cmple_ps(p[i], maxFloat));
+			ones[i] = _mm_and_ps(valid, one);
+			p[i] = _mm_and_ps(valid, p[i]);
+			q[i] = _mm_or_ps(p[i], _mm_andnot_ps(valid, inf));
+		}
+		//Columns (even, odd) first
+		__m128 n = _mm_add_ps(_mm_add_ps(ones[0], ones[2]), _mm_add_ps(ones[1], ones[3]));
+		__m128 sum = _mm_add_ps(_mm_add_ps(p[0], p[2]), _mm_add_ps(p[1], p[3]));
+		__m128 result;
+		if (reduction == ofxKuZedConvert::REDUCE_BOX) {
+			result = _mm_div_ps(sum, n);
+		}
+		else {
+			__m128 lo0 = _mm_min_ps(q[0], q[1]), hi0 = _mm_max_ps(q[0], q[1]);
+			__m128 lo1 = _mm_min_ps(q[2], q[3]), hi1 = _mm_max_ps(q[2], q[3]);
+			__m128 first = _mm_min_ps(lo0, lo1);
+			result = first;
+			if (reduction == ofxKuZedConvert::REDUCE_MEDIAN) {
+				__m128 second = _mm_min_ps(_mm_max_ps(lo0, lo1), _mm_min_ps(hi0, hi1));
+				__m128 useSecond = _mm_cmpgt_ps(n, two);
+				result = _mm_or_ps(_mm_and_ps(useSecond, second), _mm_andnot_ps(useSecond, first));
+			}
+		}
+		__m128 empty = _mm_cmpeq_ps(n, zero);
+		_mm_storeu_ps(dst + x, _mm_or_ps(_mm_and_ps(empty, nan), _mm_andnot_ps(empty, result)));
+	}
+	return x;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::downscaleDepthRow(const float *src, int srcStep, float *dst, int w, int factor, int reduction)
+{
+	if (factor < 1 || factor > DOWNSCALE_MAX) return;
+	if (factor == 1) {
+		memcpy(dst, src, w * sizeof(float));
+		return;
+	}
+#ifdef OFXKUZED_X86
+	if (factor == 2 && simd() >= SIMD_SSSE3) {
+		int x = downscaleDepth2SSE2(src, srcStep, dst, w, reduction);
+		src += 2 * x;
+		dst += x;
+		w -= x;
+	}
+#endif
+	switch (reduction) {
+	case REDUCE_BOX: downscaleDepthBox(src, srcStep, dst, w, factor);
+		return;
+	case REDUCE_MIN: downscaleDepthMin(src, srcStep, dst, w, factor);
+		return;
+	case REDUCE_MEDIAN: downscaleDepthMedian(src, srcStep, dst, w, factor);
+		return;
+	}
+	for (int x = 0; x < w; x++) {
+		dst[x] = src[x * factor];
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::downscaleDepth(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h,
+	int factor, int reduction)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			downscaleDepthRow((const float*)(src + size_t(srcStep) * y * factor), srcStep, (float*)(dst + size_t(dstStep) * y),
+				w, factor, reduction);
+		}
+	});
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//2 x 2 blocks, 4 output pixels per iteration: rows are added as 16-bit values, then neighbour pixels,
+//and the rounded means are shuffled to RGB like in bgraToRgbSSSE3
+OFXKUZED_TARGET("ssse3")
+static inline __m128i blockSums2SSSE3(__m128i a, __m128i b, __m128i zero)
+{
+	__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));	//pixels 0, 1
+	__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));	//pixels 2, 3
+	return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));		//blocks 0, 1
+}
+
+OFXKUZED_TARGET("ssse3")
+static int bgraToRgbDownscale2SSSE3(const unsigned char *src, int srcStep, unsigned char *dst, int w)
+{
+	const unsigned char *src1 = src + srcStep;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(2);
+	const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	int x = 0;
+	//The last 16-byte store writes 4 bytes after 4 pixels, so it stops before the last pixels
+	for (; x + 6 <= w; x += 4) {
+		__m128i s01 = blockSums2SSSE3(_mm_loadu_si128((const __m128i*)(src + 8 * x)), _mm_loadu_si128((const __m128i*)(src1 + 8 * x)), zero);
+		__m128i s23 = blockSums2SSSE3(_mm_loadu_si128((const __m128i*)(src + 8 * x + 16)), _mm_loadu_si128((const __m128i*)(src1 + 8 * x + 16)), zero);
+		s01 = _mm_srli_epi16(_mm_add_epi16(s01, round), 2);
+		s23 = _mm_srli_epi16(_mm_add_epi16(s23, round), 2);
+		_mm_storeu_si128((__m128i*)(dst + 3 * x), _mm_shuffle_epi8(_mm_packus_epi16(s01, s23), shuffle));
+	}
+	return x;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+//Columns of chunk are summed over factor rows, then blocks over factor columns.
+//Division by area <= 256 is exact multiplication by 2^24 / area rounded up, for sums < 256 * area
+static void bgraToRgbDownscaleScalar(const unsigned char *src, int srcStep, unsigned char *dst, int w, int factor)
+{
+	int sums[DOWNSCALE_CHUNK * ofxKuZedConvert::DOWNSCALE_MAX * 4];
+	const unsigned int area = factor * factor;
+	const unsigned int scale = ((1u << 24) + area - 1) / area;
+	for (int x0 = 0; x0 < w; x0 += DOWNSCALE_CHUNK) {
+		int n = std::min(DOWNSCALE_CHUNK, w - x0);
+		int values = n * factor * 4;
+		const unsigned char *chunk = src + 4 * factor * x0;
+		for (int i = 0; i < values; i++) {
+			sums[i] = chunk[i];
+		}
+		for (int j = 1; j < factor; j++) {
+			const unsigned char *p = chunk + size_t(srcStep) * j;
+			for (int i = 0; i < values; i++) {
+				sums[i] += p[i];
+			}
+		}
+		unsigned char *d = dst + 3 * x0;
+		for (int x = 0; x < n; x++) {
+			const int *c = sums + 4 * factor * x;
+			unsigned int b = area / 2, g = area / 2, r = area / 2;
+			for (int i = 0; i < factor; i++, c += 4) {
+				b += c[0];
+				g += c[1];
+				r += c[2];
+			}
+			d[0] = (unsigned char)((r * scale) >> 24);
+			d[1] = (unsigned char)((g * scale) >> 24);
+			d[2] = (unsigned char)((b * scale) >> 24);
+			d += 3;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::bgraToRgbDownscaleRow(const unsigned char *src, int srcStep, unsigned char *dst, int w, int factor)
+{
+	if (factor < 1 || factor > DOWNSCALE_MAX) return;
+	if (factor == 1) {
+		bgraToRgbRow(src, dst, w);
+		return;
+	}
+#ifdef OFXKUZED_X86
+	if (factor == 2 && simd() >= SIMD_SSSE3) {
+		int x = bgraToRgbDownscale2SSSE3(src, srcStep, dst, w);
+		src += 8 * x;
+		dst += 3 * x;
+		w -= x;
+	}
+#endif
+	bgraToRgbDownscaleScalar(src, srcStep, dst, w, factor);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedConvert::bgraToRgbDownscale(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h, int factor)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			bgraToRgbDownscaleRow(src + size_t(srcStep) * y * factor, srcStep, dst + size_t(dstStep) * y, w, factor);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+#pragma once
+
+//Pixel conversion kernels used by ofxKuZed.
+//They work with raw strided buffers in ZED SDK layout and don't depend on openFrameworks,
+//so they can be benchmarked and checked without camera. Other classes of the addon that process
+//raw buffers follow the same rule and include only standard headers.
+//SIMD version is selected at runtime: AVX2, SSSE3 or scalar fallback.
+//Whole-image functions split rows into bands processed by ofxKuZedWorkers::shared().
+
+#include <cstddef>
+
+class ofxKuZedConvert
+{
+public:
+	enum Simd {
+		SIMD_SCALAR = 0,
+		SIMD_SSSE3 = 1,
+		SIMD_AVX2 = 2
+	};
+	static int simdSupported();		//the best SIMD level supported by CPU
+	static int simd();				//SIMD level used now
+	static void setSimd(int simd);	//limit SIMD level, useful for comparing results and benchmarking
+	static const char *simdName(int simd);
+
+	//Copy rows of rowBytes bytes
+	static void copyRows(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int rowBytes, int h);
+
+	//BGRA (4 x uchar) -> RGB (3 x uchar), steps are row sizes in bytes
+	static void bgraToRgb(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h);
+	static void bgraToRgbRow(const unsigned char *src, unsigned char *dst, int w);
+
+	//RGB (3 x uchar) -> BGRA (4 x uchar) with alpha 255, used for images received from stream
+	static void rgbToBgra(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h);
+
+	//Depth in mm (float) -> grayscale (uchar): minMm is 255, maxMm is 0.
+	//Invalid depth (NaN, inf, <= 0) and depth farther than maxMm are 0
+	static void depthToGray(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h, float minMm, float maxMm);
+	static void depthToGrayRow(const float *src, unsigned char *dst, int w, float minMm, float maxMm);
+
+	//Downscaling by integer factor (1..DOWNSCALE_MAX): each output pixel is made from factor x factor block of source,
+	//w and h are output size. Depth blocks are reduced by one of Reduction methods, invalid depth (NaN, inf, <= 0)
+	//is skipped, and a block without valid depth gives NaN. Images are averaged
+	enum Reduction {
+		REDUCE_SAMPLE = 0,		//top-left pixel of block, the fastest
+		REDUCE_BOX = 1,			//mean of valid pixels
+		REDUCE_MIN = 2,			//nearest valid pixel, keeps thin foreground objects
+		REDUCE_MEDIAN = 3		//median of valid pixels (the lower one for even count), keeps edges without mixing depths
+	};
+	enum { DOWNSCALE_MAX = 16 };
+	static void downscaleDepth(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h,
+		int factor, int reduction);
+	static void downscaleDepthRow(const float *src, int srcStep, float *dst, int w, int factor, int reduction);
+	//BGRA (4 x uchar) -> RGB (3 x uchar), mean of each block
+	static void bgraToRgbDownscale(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h, int factor);
+	static void bgraToRgbDownscaleRow(const unsigned char *src, int srcStep, unsigned char *dst, int w, int factor);
+
+	//Depth in mm (float) and optional BGRA image -> XYZ or XYZRGBA (4 x float per pixel) using pinhole camera
+	//parameters, in SDK coordinates (y down, z forward). Invalid depth gives NaN point.
+	//If bgra is 0, the 4th float is 0, else it contains color as 4 x uchar RGBA, like in ZED XYZRGBA
+	static void depthToXyz(const unsigned char *depth, int depthStep, const unsigned char *bgra, int bgraStep,
+		unsigned char *dst, int dstStep, int w, int h, float fx, float fy, float cx, float cy);
+	static void depthToXyzRow(const float *depth, const unsigned char *bgra, float *dst, int w, int y,
+		float fx, float fy, float cx, float cy);
+
+	//Plane for depth masking: keeps points p (camera coordinates in mm: x right, y down, z forward)
+	//with nx * p.x + ny * p.y + nz * p.z + d >= 0. It's applied only inside its pixel region [x0, x1) x [y0, y1),
+	//x1 = 0 or y1 = 0 means image border
+	struct MaskPlane {
+		float nx = 0, ny = 0, nz = 1, d = 0;
+		int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	};
+
+	//Parameters of depth masking
+	struct MaskParams {
+		float nearMm = 0;			//depth range of kept pixels,
+		float farMm = 0;			//farMm = 0 means no limit
+		float fx = 1, fy = 1, cx = 0, cy = 0;	//camera parameters, required for planes
+		const MaskPlane *planes = 0;
+		int planeCount = 0;
+	};
+
+	//Depth (float) -> mask (uchar): 255 for pixels with valid depth in range, kept by all planes, else 0
+	static void depthMaskRow(const float *depth, unsigned char *mask, int w, int y, const MaskParams &params);
+	//BGRA + mask -> masked image: RGB with black masked out pixels (channels = 3),
+	//or RGBA with black masked out pixels and alpha = mask (channels = 4)
+	static void applyMaskRow(const unsigned char *bgra, const unsigned char *mask, unsigned char *dst, int w, int channels);
+	//Mask and masked image in one pass over rows. mask or dst can be 0 if not required, bgra is used only for dst
+	static void depthMask(const unsigned char *depth, int depthStep, const unsigned char *bgra, int bgraStep,
+		unsigned char *mask, int maskStep, unsigned char *dst, int dstStep, int dstChannels, int w, int h, const MaskParams &params);
+
+	//Output of point cloud conversion. Components which are not required should be 0.
+	//x, y, z can be separate arrays (xyzStride = 1) or fields of interleaved vertices (xyzStride = vertex size in floats)
+	struct PointsOutput {
+		float *x = 0, *y = 0, *z = 0;
+		int xyzStride = 1;				//in floats
+		unsigned char *rgba = 0;		//colors as 4 x uchar
+		int rgbaStride = 4;				//in bytes
+		float *rgbaFloat = 0;			//colors as 4 x float in [0,1]
+		int rgbaFloatStride = 4;		//in floats
+		int *index = 0;					//source pixel index x + w * y
+	};
+
+	//Parameters of point cloud conversion
+	struct PointsParams {
+		bool hasColors = false;		//source is XYZRGBA
+		float signY = 1;			//1 or -1 for flipping
+		float signZ = 1;
+		bool dropInvalid = false;	//skip invalid points (NaN, inf, clipped), so output is dense
+		float nearMm = 0;			//clipping by distance along camera axis |z|,
+		float farMm = 0;			//farMm = 0 means no limit
+		int decimate = 1;			//take each decimate-th pixel in each decimate-th row
+		int indexOffset = 0;		//out.index of the first source pixel,
+		int indexStep = 0;			//and difference of out.index between rows, 0 means w (for regions of larger image)
+	};
+
+	//XYZ or XYZRGBA (4 x float per pixel, 4th float contains color) -> points, in one pass.
+	//Returns number of written points
+	static int xyzToPoints(const unsigned char *src, int srcStep, int w, int h, const PointsParams &params, const PointsOutput &out);
+	//srcIndex is the pixel index of src[0], it's used for out.index.
+	//If maxPoints >= 0, conversion stops after maxPoints points, so it never touches output after them
+	static int xyzToPointsRow(const float *src, int w, const PointsParams &params, const PointsOutput &out, int outIndex, int srcIndex,
+		int maxPoints = -1);
+
+	//Colors (4 x uchar) -> 4 x float in [0,1], n colors. Layouts are the same as of ofColor and ofFloatColor
+	static void rgbaToFloat(const unsigned char *src, float *dst, int n);
+};
@@ -0,0 +1,334 @@
+#include "ofxKuZedDepthCodec.h"
+#include "ofxKuZedWorkers.h"
+#include <cstring>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const char codecMagic[4] = { 'K', 'Z', 'D', '1' };
+static const int riceLimit = 24;		//longer unary codes are escaped
+static const int escapeBits = 17;		//residuals are in [0, 2^17)
+static const int maxK = 16;
+
+static_assert(sizeof(ofxKuZedDepthCodec::Header) == 24, "ofxKuZedDepthCodec::Header must be 24 bytes");
+
+//------------------------------------------------------------------------------------------------------
+static inline int countLeadingZeros(uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+#ifdef _M_X64
+	_BitScanReverse64(&index, v);
+	return 63 - int(index);
+#else
+	if (v >> 32) {
+		_BitScanReverse(&index, (unsigned long)(v >> 32));
+		return 31 - int(index);
+	}
+	_BitScanReverse(&index, (unsigned long)v);
+	return 63 - int(index);
+#endif
+#else
+	return __builtin_clzll(v);
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------
+//MSB-first bit writer, output buffer should be large enough (see bandBound)
+struct BitWriter {
+	unsigned char *p;
+	uint64_t acc = 0;
+	int bits = 0;
+
+	BitWriter(unsigned char *data) : p(data) {}
+	inline void put(uint32_t v, int n) {	//n <= 32
+		acc = (acc << n) | v;
+		bits += n;
+		while (bits >= 8) {
+			bits -= 8;
+			*p++ = (unsigned char)(acc >> bits);
+		}
+	}
+	void flush() {
+		if (bits > 0) {
+			*p++ = (unsigned char)(acc << (8 - bits));
+			bits = 0;
+		}
+	}
+};
+
+//------------------------------------------------------------------------------------------------------
+//MSB-first bit reader, bits are left-aligned in acc. Reading after the end gives zeros
+struct BitReader {
+	const unsigned char *p, *end;
+	uint64_t acc = 0;
+	int bits = 0;
+
+	BitReader(const unsigned char *data, size_t size) : p(data), end(data + size) {}
+	inline void refill() {
+		while (bits <= 56) {
+			uint64_t byte = (p < end) ? *p++ : 0;
+			acc |= byte << (56 - bits);
+			bits += 8;
+		}
+	}
+	inline uint32_t get(int n) {	//0 < n <= 32
+		uint32_t v = uint32_t(acc >> (64 - n));
+		acc <<= n;
+		bits -= n;
+		return v;
+	}
+	inline void skip(int n) {
+		acc <<= n;
+		bits -= n;
+	}
+};
+
+//------------------------------------------------------------------------------------------------------
+//Adaptive Rice parameter, as in LOCO-I: k is the smallest with count * 2^k >= sum of residuals
+struct RiceState {
+	uint32_t sum = 4;
+	uint32_t count = 1;
+
+	inline int k() const {
+		int k = 0;
+		while ((count << k) < sum && k < maxK) k++;
+		return k;
+	}
+	inline void update(uint32_t u) {
+		sum += u;
+		if (++count == 64) {
+			sum >>= 1;
+			count >>= 1;
+		}
+	}
+};
+
+//------------------------------------------------------------------------------------------------------
+static inline int predictMed(int a, int b, int c)
+{
+	int mn = std::min(a, b);
+	int mx = std::max(a, b);
+	if (c >= mx) return mn;
+	if (c <= mn) return mx;
+	return a + b - c;
+}
+
+//------------------------------------------------------------------------------------------------------
+static inline void quantizeRow(const float *src, uint16_t *dst, int w, float scale)
+{
+	for (int x = 0; x < w; x++) {
+		float d = src[x] * scale + 0.5f;
+		//false for NaN, inf and d <= 0
+		dst[x] = (d >= 1.0f && d - d == 0) ? uint16_t(std::min(d, 65535.0f)) : 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Rows of band: first row is predicted from the left pixel, other rows use MED predictor
+template<typename F>
+static inline void bandPixels(const uint16_t *prev, const uint16_t *cur, int w, bool firstRow, F f)
+{
+	if (firstRow) {
+		int a = 0;
+		for (int x = 0; x < w; x++) {
+			f(x, a);
+			a = cur[x];
+		}
+		return;
+	}
+	int a = prev[0];
+	int c = prev[0];
+	for (int x = 0; x < w; x++) {
+		int b = prev[x];
+		f(x, predictMed(a, b, c));
+		a = cur[x];
+		c = b;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static inline size_t bandBound(int w, int rows)
+{
+	return size_t(w) * rows * (riceLimit + 1 + escapeBits + 7) / 8 + 16;
+}
+
+static inline int bandRow(int band, int bands, int h)
+{
+	return int((long long)(band) * h / bands);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthCodec::setPrecision(float mm)
+{
+	precision_ = (mm > 0) ? mm : 1;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedDepthCodec::getPrecision() const
+{
+	return precision_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthCodec::setBands(int bands)
+{
+	bands_ = std::max(bands, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthCodec::getBands() const
+{
+	return bands_;
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedDepthCodec::encode(const unsigned char *depth, int depthStep, int w, int h, std::vector<unsigned char> &out)
+{
+	int bands = std::max(std::min(bands_, h), 1);
+	bandData_.resize(bands);
+	bandSize_.resize(bands);
+	bandRows_.resize(bands);
+	float scale = 1.0f / precision_;
+
+	ofxKuZedWorkers::shared().parallelRows(bands, [&](int b0, int b1) {
+		for (int b = b0; b < b1; b++) {
+			int y0 = bandRow(b, bands, h);
+			int y1 = bandRow(b + 1, bands, h);
+			std::vector<unsigned char> &data = bandData_[b];
+			size_t bound = bandBound(w, y1 - y0);
+			if (data.size() < bound) data.resize(bound);
+			std::vector<uint16_t> &rows = bandRows_[b];
+			rows.resize(size_t(w) * 2);
+			uint16_t *prev = &rows[0];
+			uint16_t *cur = &rows[w];
+
+			BitWriter writer(&data[0]);
+			RiceState state;
+			for (int y = y0; y < y1; y++) {
+				quantizeRow((const float *)(depth + size_t(depthStep) * y), cur, w, scale);
+				bandPixels(prev, cur, w, y == y0, [&](int x, int pred) {
+					int r = int(cur[x]) - pred;
+					uint32_t u = (uint32_t(r) << 1) ^ uint32_t(r >> 31);	//zigzag: 0, -1, 1, -2, ...
+					int k = state.k();
+					uint32_t q = u >> k;
+					if (q < uint32_t(riceLimit)) {
+						writer.put(1, q + 1);
+						if (k > 0) writer.put(u & ((1u << k) - 1), k);
+					}
+					else {
+						writer.put(1, riceLimit + 1);
+						writer.put(u, escapeBits);
+					}
+					state.update(u);
+				});
+				std::swap(prev, cur);
+			}
+			writer.flush();
+			bandSize_[b] = writer.p - &data[0];
+		}
+	}, 1);
+
+	//Header, band sizes and band data
+	size_t size = sizeof(Header) + bands * sizeof(uint32_t);
+	for (int b = 0; b < bands; b++) size += bandSize_[b];
+	out.resize(size);
+	Header header;
+	memcpy(header.magic, codecMagic, sizeof(codecMagic));
+	header.width = w;
+	header.height = h;
+	header.precision = precision_;
+	header.bands = bands;
+	header.reserved = 0;
+	memcpy(&out[0], &header, sizeof(header));
+	unsigned char *p = &out[sizeof(header)];
+	for (int b = 0; b < bands; b++) {
+		uint32_t bandSize = uint32_t(bandSize_[b]);
+		memcpy(p, &bandSize, sizeof(bandSize));
+		p += sizeof(bandSize);
+	}
+	for (int b = 0; b < bands; b++) {
+		memcpy(p, &bandData_[b][0], bandSize_[b]);
+		p += bandSize_[b];
+	}
+	return size;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthCodec::getSize(const unsigned char *data, size_t size, int &w, int &h)
+{
+	Header header;
+	if (!data || size < sizeof(header)) return false;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, codecMagic, sizeof(codecMagic)) != 0) return false;
+	w = header.width;
+	h = header.height;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthCodec::decode(const unsigned char *data, size_t size, unsigned char *depth, int depthStep, int w, int h)
+{
+	Header header;
+	int w0, h0;
+	if (!getSize(data, size, w0, h0) || w0 != w || h0 != h) return false;
+	memcpy(&header, data, sizeof(header));
+	int bands = header.bands;
+	if (bands < 1 || bands > h || size < sizeof(header) + bands * sizeof(uint32_t)) return false;
+
+	//Band offsets
+	std::vector<size_t> offsets(bands + 1);
+	offsets[0] = sizeof(header) + bands * sizeof(uint32_t);
+	for (int b = 0; b < bands; b++) {
+		uint32_t bandSize;
+		memcpy(&bandSize, data + sizeof(header) + b * sizeof(uint32_t), sizeof(bandSize));
+		offsets[b + 1] = offsets[b] + bandSize;
+	}
+	if (offsets[bands] > size) return false;
+
+	bandRows_.resize(std::max(int(bandRows_.size()), bands));
+	float precision = header.precision;
+
+	ofxKuZedWorkers::shared().parallelRows(bands, [&](int b0, int b1) {
+		for (int b = b0; b < b1; b++) {
+			int y0 = bandRow(b, bands, h);
+			int y1 = bandRow(b + 1, bands, h);
+			std::vector<uint16_t> &rows = bandRows_[b];
+			rows.resize(size_t(w) * 2);
+			uint16_t *prev = &rows[0];
+			uint16_t *cur = &rows[w];
+
+			BitReader reader(data + offsets[b], offsets[b + 1] - offsets[b]);
+			RiceState state;
+			for (int y = y0; y < y1; y++) {
+				float *dst = (float *)(depth + size_t(depthStep) * y);
+				bandPixels(prev, cur, w, y == y0, [&](int x, int pred) {
+					reader.refill();
+					int k = state.k();
+					int zeros = (reader.acc) ? countLeadingZeros(reader.acc) : 64;
+					uint32_t u;
+					if (zeros < riceLimit) {
+						reader.skip(zeros + 1);
+						u = (uint32_t(zeros) << k) | ((k > 0) ? reader.get(k) : 0);
+					}
+					else {
+						//Escape, or corrupted data
+						reader.skip(riceLimit + 1);
+						u = reader.get(escapeBits);
+					}
+					state.update(u);
+					int r = int(u >> 1) ^ -int(u & 1);
+					uint16_t q = uint16_t(pred + r);
+					cur[x] = q;
+					dst[x] = q * precision;
+				});
+				std::swap(prev, cur);
+			}
+		}
+	}, 1);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+#pragma once
+
+//Compression of depth maps for recording and streaming.
+//Depth in mm is quantized to 16 bit with given precision (so it's lossless up to quantization),
+//each pixel is predicted from its left, upper and upper-left neighbours (LOCO-I median predictor),
+//and residuals are coded with adaptive Rice codes.
+//Rows are split into bands coded independently, so encoding and decoding use ofxKuZedWorkers::shared().
+//Invalid depth (NaN, inf, <= 0) is decoded as 0.
+//ofFloatPixels are accepted by template functions.
+//
+//Encoded data: ofxKuZedDepthCodec::Header, bands x uint32 band size in bytes, band data.
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class ofxKuZedDepthCodec
+{
+public:
+	struct Header {
+		char magic[4];		//"KZD1"
+		uint32_t width;
+		uint32_t height;
+		float precision;	//mm
+		uint32_t bands;
+		uint32_t reserved;
+	};
+
+	//Quantization step in mm, 1 means depth is stored in whole mm, up to 65 m
+	void setPrecision(float mm);	//default: 1
+	float getPrecision() const;
+
+	//Number of independently coded row bands, it limits the number of threads for encoding and decoding
+	void setBands(int bands);		//default: 16
+	int getBands() const;
+
+	//Encode depth (float mm, step - row size in bytes) into 'out', returns encoded size
+	size_t encode(const unsigned char *depth, int depthStep, int w, int h, std::vector<unsigned char> &out);
+
+	//Size of encoded depth, returns false if data is not encoded depth
+	static bool getSize(const unsigned char *data, size_t size, int &w, int &h);
+
+	//Decode depth into buffer of size w x h, returns false if data is corrupted or has a different size
+	bool decode(const unsigned char *data, size_t size, unsigned char *depth, int depthStep, int w, int h);
+
+	//ofFloatPixels versions
+	template<typename Pixels> size_t encode(const Pixels &depth, std::vector<unsigned char> &out) {
+		return encode((const unsigned char *)depth.getData(), depth.getWidth() * sizeof(float), depth.getWidth(), depth.getHeight(), out);
+	}
+	template<typename Pixels> bool decode(const unsigned char *data, size_t size, Pixels &depth) {
+		int w, h;
+		if (!getSize(data, size, w, h)) return false;
+		if (int(depth.getWidth()) != w || int(depth.getHeight()) != h || depth.getNumChannels() != 1) {
+			depth.allocate(w, h, 1);
+		}
+		return decode(data, size, (unsigned char *)depth.getData(), w * sizeof(float), w, h);
+	}
+
+private:
+	float precision_ = 1;
+	int bands_ = 16;
+
+	//Band buffers, kept between calls
+	std::vector<std::vector<unsigned char> > bandData_;
+	std::vector<size_t> bandSize_;
+	std::vector<std::vector<uint16_t> > bandRows_;
+};
@@ -0,0 +1,428 @@
+#include "ofxKuZedDepthFile.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char depthFileMagic[8] = { 'K', 'U', 'Z', 'E', 'D', 'D', 'E', 'P' };
+static const char slotMagic[4] = { 'D', 'F', 'R', 'M' };
+static const uint32_t depthFileVersion = 1;
+
+static_assert(sizeof(ofxKuZedDepthFileHeader) == 64, "ofxKuZedDepthFileHeader must be 64 bytes");
+static_assert(sizeof(ofxKuZedDepthFileSlot) == 64, "ofxKuZedDepthFileSlot must be 64 bytes");
+
+//------------------------------------------------------------------------------------------------------
+static uint64_t depthFileFrameStride(uint64_t w, uint64_t h, bool hasLeft)
+{
+	uint64_t size = sizeof(ofxKuZedDepthFileSlot) + w * h * sizeof(float) + ((hasLeft) ? w * h * 3 : 0);
+	return (size + ZED_DEPTHFILE_PAGE - 1) / ZED_DEPTHFILE_PAGE * ZED_DEPTHFILE_PAGE;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedDepthFileWriter::~ofxKuZedDepthFileWriter()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileWriter::open(string fileName, int width, int height, bool hasLeft)
+{
+	close();
+	file_.open(ofToDataPath(fileName).c_str(), ios::binary | ios::trunc);
+	if (!file_.is_open()) {
+		ofLogError() << "ofxKuZedDepthFileWriter: can't create file " << fileName << endl;
+		return false;
+	}
+	memset(&header_, 0, sizeof(header_));
+	memcpy(header_.magic, depthFileMagic, sizeof(depthFileMagic));
+	header_.version = depthFileVersion;
+	header_.width = width;
+	header_.height = height;
+	header_.hasLeft = hasLeft;
+	header_.frameStride = depthFileFrameStride(width, height, hasLeft);
+	index_.clear();
+	padding_.assign(ZED_DEPTHFILE_PAGE, 0);
+
+	//Header without index, it's rewritten by close()
+	file_.write((const char*)&header_, sizeof(header_));
+	file_.write(&padding_[0], ZED_DEPTHFILE_PAGE - sizeof(header_));
+	return file_.good();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthFileWriter::close()
+{
+	if (!file_.is_open()) return;
+	header_.frameCount = index_.size();
+	header_.indexOffset = ZED_DEPTHFILE_PAGE + header_.frameCount * header_.frameStride;
+	if (!index_.empty()) {
+		file_.write((const char*)&index_[0], index_.size() * sizeof(ofxKuZedDepthFileIndexItem));
+	}
+	file_.seekp(0);
+	file_.write((const char*)&header_, sizeof(header_));
+	file_.close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileWriter::isOpen()
+{
+	return file_.is_open();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthFileWriter::getFrameCount()
+{
+	return index_.size();
+}
+
+//------------------------------------------------------------------------------------------------------
+//Left image should be RGB of file size, e.g. not a region or downscaled getLeftPixels()
+bool ofxKuZedDepthFileWriter::checkLeft(const ofPixels *left)
+{
+	if (!left || !header_.hasLeft) return true;
+	if (left->getWidth() != int(header_.width) || left->getHeight() != int(header_.height) || left->getNumChannels() != 3) {
+		ofLogError() << "ofxKuZedDepthFileWriter: left image should be RGB " << header_.width << " x " << header_.height
+			<< ", got " << left->getWidth() << " x " << left->getHeight() << " x " << left->getNumChannels() << endl;
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileWriter::write(const ofxKuZedDepthView &depth, const ofPixels *left)
+{
+	if (depth.empty() || depth.width != int(header_.width) || depth.height != int(header_.height)) {
+		ofLogError() << "ofxKuZedDepthFileWriter: depth size differs from " << header_.width << " x " << header_.height << endl;
+		return false;
+	}
+	if (!checkLeft(left)) return false;
+	return writeFrame(depth.data, depth.step, (left) ? left->getData() : 0, depth.frameId, depth.timestamp);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileWriter::write(const ofFloatPixels &depth, const ofPixels *left, unsigned long long id, unsigned long long timestamp)
+{
+	if (depth.getWidth() != int(header_.width) || depth.getHeight() != int(header_.height) || depth.getNumChannels() != 1) {
+		ofLogError() << "ofxKuZedDepthFileWriter: depth size differs from " << header_.width << " x " << header_.height << endl;
+		return false;
+	}
+	if (!checkLeft(left)) return false;
+	return writeFrame(depth.getData(), header_.width * sizeof(float), (left) ? left->getData() : 0, id, timestamp);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileWriter::writeFrame(const float *depth, int depthStep, const unsigned char *left,
+	unsigned long long id, unsigned long long timestamp)
+{
+	if (!file_.is_open()) return false;
+	int w = header_.width;
+	int h = header_.height;
+
+	ofxKuZedDepthFileSlot slot;
+	memset(&slot, 0, sizeof(slot));
+	memcpy(slot.magic, slotMagic, sizeof(slotMagic));
+	slot.id = id;
+	slot.timestamp = timestamp;
+	file_.write((const char*)&slot, sizeof(slot));
+
+	uint64_t written = sizeof(slot);
+	int rowBytes = w * sizeof(float);
+	if (depthStep == rowBytes) {
+		file_.write((const char*)depth, size_t(rowBytes) * h);
+	}
+	else {
+		for (int y = 0; y < h; y++) {
+			file_.write((const char*)depth + size_t(depthStep) * y, rowBytes);
+		}
+	}
+	written += uint64_t(rowBytes) * h;
+
+	if (header_.hasLeft) {
+		size_t leftBytes = size_t(w) * h * 3;
+		if (left) {
+			file_.write((const char*)left, leftBytes);
+		}
+		else {
+			//Frame without image, keep stride
+			for (size_t i = 0; i < leftBytes; i += padding_.size()) {
+				file_.write(&padding_[0], min(padding_.size(), leftBytes - i));
+			}
+		}
+		written += leftBytes;
+	}
+	file_.write(&padding_[0], header_.frameStride - written);
+
+	if (!file_.good()) {
+		ofLogError() << "ofxKuZedDepthFileWriter: error writing frame" << endl;
+		return false;
+	}
+	ofxKuZedDepthFileIndexItem item;
+	item.id = id;
+	item.timestamp = timestamp;
+	index_.push_back(item);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedDepthFileReader::ofxKuZedDepthFileReader()
+{
+	memset(&header_, 0, sizeof(header_));
+#ifdef TARGET_WIN32
+	file_ = INVALID_HANDLE_VALUE;
+	mapping_ = 0;
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	granularity_ = info.dwAllocationGranularity;
+#else
+	file_ = -1;
+	granularity_ = sysconf(_SC_PAGESIZE);
+#endif
+	windowSize_ = (sizeof(void*) >= 8) ? 0 : 256 << 20;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedDepthFileReader::~ofxKuZedDepthFileReader()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthFileReader::setWindowSize(uint64_t bytes)
+{
+	windowSize_ = bytes;
+	unmap();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileReader::open(string fileName)
+{
+	close();
+	string path = ofToDataPath(fileName);
+#ifdef TARGET_WIN32
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file_ == INVALID_HANDLE_VALUE) {
+		ofLogError() << "ofxKuZedDepthFileReader: can't open file " << fileName << endl;
+		return false;
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(file_, &size);
+	fileSize_ = size.QuadPart;
+	mapping_ = CreateFileMappingA(file_, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping_) {
+		ofLogError() << "ofxKuZedDepthFileReader: can't map file " << fileName << endl;
+		close();
+		return false;
+	}
+#else
+	file_ = ::open(path.c_str(), O_RDONLY);
+	if (file_ < 0) {
+		ofLogError() << "ofxKuZedDepthFileReader: can't open file " << fileName << endl;
+		return false;
+	}
+	struct stat st;
+	fstat(file_, &st);
+	fileSize_ = st.st_size;
+#endif
+
+	const unsigned char *header = map(0, sizeof(header_));
+	if (!header) {
+		ofLogError() << "ofxKuZedDepthFileReader: " << fileName << " is not a ZED depth file" << endl;
+		close();
+		return false;
+	}
+	memcpy(&header_, header, sizeof(header_));
+	if (memcmp(header_.magic, depthFileMagic, sizeof(depthFileMagic)) != 0 || header_.version != depthFileVersion
+		|| header_.frameStride != depthFileFrameStride(header_.width, header_.height, header_.hasLeft != 0)) {
+		ofLogError() << "ofxKuZedDepthFileReader: " << fileName << " is not a ZED depth file" << endl;
+		close();
+		return false;
+	}
+
+	//Index
+	uint64_t n = 0;
+	if (header_.indexOffset > 0) {
+		n = header_.frameCount;
+		const unsigned char *index = (n > 0) ? map(header_.indexOffset, n * sizeof(ofxKuZedDepthFileIndexItem)) : 0;
+		if (index) {
+			index_.resize(size_t(n));
+			memcpy(&index_[0], index, size_t(n) * sizeof(ofxKuZedDepthFileIndexItem));
+		}
+	}
+	else {
+		//Restore index from frame slots of the file which was not closed properly
+		n = (fileSize_ - ZED_DEPTHFILE_PAGE) / header_.frameStride;
+		for (uint64_t i = 0; i < n; i++) {
+			const ofxKuZedDepthFileSlot *slot = (const ofxKuZedDepthFileSlot *)map(ZED_DEPTHFILE_PAGE + i * header_.frameStride, sizeof(ofxKuZedDepthFileSlot));
+			if (!slot || memcmp(slot->magic, slotMagic, sizeof(slotMagic)) != 0) break;
+			ofxKuZedDepthFileIndexItem item;
+			item.id = slot->id;
+			item.timestamp = slot->timestamp;
+			index_.push_back(item);
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthFileReader::close()
+{
+	unmap();
+#ifdef TARGET_WIN32
+	if (mapping_) {
+		CloseHandle(mapping_);
+		mapping_ = 0;
+	}
+	if (file_ != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_);
+		file_ = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (file_ >= 0) {
+		::close(file_);
+		file_ = -1;
+	}
+#endif
+	index_.clear();
+	memset(&header_, 0, sizeof(header_));
+	fileSize_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileReader::isOpen()
+{
+	return fileSize_ > 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Pointer to size bytes of the file at offset. If they are not in the current window, the window is remapped
+const unsigned char *ofxKuZedDepthFileReader::map(uint64_t offset, uint64_t size)
+{
+	if (offset + size > fileSize_) return 0;
+	if (window_ && offset >= windowOffset_ && offset + size <= windowOffset_ + windowLength_) {
+		return window_ + (offset - windowOffset_);
+	}
+	unmap();
+
+	uint64_t start = 0;
+	uint64_t length = fileSize_;
+	if (windowSize_ > 0 && windowSize_ < fileSize_) {
+		start = offset / granularity_ * granularity_;
+		length = min(max(windowSize_, offset + size - start), fileSize_ - start);
+	}
+#ifdef TARGET_WIN32
+	window_ = (unsigned char *)MapViewOfFile(mapping_, FILE_MAP_READ, DWORD(start >> 32), DWORD(start & 0xFFFFFFFF), SIZE_T(length));
+#else
+	void *data = mmap(0, size_t(length), PROT_READ, MAP_SHARED, file_, off_t(start));
+	window_ = (data == MAP_FAILED) ? 0 : (unsigned char *)data;
+#endif
+	if (!window_) {
+		ofLogError() << "ofxKuZedDepthFileReader: can't map " << length << " bytes" << endl;
+		return 0;
+	}
+	windowOffset_ = start;
+	windowLength_ = length;
+	return window_ + (offset - windowOffset_);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedDepthFileReader::unmap()
+{
+	if (window_) {
+#ifdef TARGET_WIN32
+		UnmapViewOfFile(window_);
+#else
+		munmap(window_, size_t(windowLength_));
+#endif
+		window_ = 0;
+		windowOffset_ = windowLength_ = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+const unsigned char *ofxKuZedDepthFileReader::frameData(int index)
+{
+	if (index < 0 || index >= int(index_.size())) return 0;
+	//Frame is at fixed position, so no search is required
+	const unsigned char *slot = map(ZED_DEPTHFILE_PAGE + uint64_t(index) * header_.frameStride, header_.frameStride);
+	return (slot) ? slot + sizeof(ofxKuZedDepthFileSlot) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedDepthView ofxKuZedDepthFileReader::getDepth(int index)
+{
+	ofxKuZedDepthView view;
+	const unsigned char *data = frameData(index);
+	if (data) {
+		view.data = (const float *)data;
+		view.width = header_.width;
+		view.height = header_.height;
+		view.step = header_.width * sizeof(float);
+		view.frameId = index_[index].id;
+		view.timestamp = index_[index].timestamp;
+	}
+	return view;
+}
+
+//------------------------------------------------------------------------------------------------------
+const unsigned char *ofxKuZedDepthFileReader::getLeft(int index)
+{
+	if (!header_.hasLeft) return 0;
+	const unsigned char *data = frameData(index);
+	return (data) ? data + size_t(header_.width) * header_.height * sizeof(float) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedDepthFileReader::getTimestamp(int index)
+{
+	return (index >= 0 && index < int(index_.size())) ? index_[index].timestamp : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedDepthFileReader::getFrameId(int index)
+{
+	return (index >= 0 && index < int(index_.size())) ? index_[index].id : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthFileReader::findFrame(unsigned long long timestamp)
+{
+	if (index_.empty()) return -1;
+	ofxKuZedDepthFileIndexItem item;
+	item.timestamp = timestamp;
+	int index = std::lower_bound(index_.begin(), index_.end(), item,
+		[](const ofxKuZedDepthFileIndexItem &a, const ofxKuZedDepthFileIndexItem &b) {
+		return a.timestamp < b.timestamp;
+	}) - index_.begin();
+	return min(index, int(index_.size()) - 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthFileReader::getFrameCount()
+{
+	return index_.size();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthFileReader::getWidth()
+{
+	return header_.width;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedDepthFileReader::getHeight()
+{
+	return header_.height;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedDepthFileReader::hasLeft()
+{
+	return header_.hasLeft != 0;
+}
+
+//------------------------------------------------------------------------------------------------------
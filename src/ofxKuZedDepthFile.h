@@ -0,0 +1,122 @@
+#pragma once
+
+//Memory-mapped recording of depth sequences (optionally with left RGB image) for offline analysis.
+//Frames have fixed size and are page-aligned, so any frame is found in O(1) without parsing,
+//and ofxKuZedDepthFileReader gives zero-copy views of mapped file memory.
+//
+//File format (little-endian):
+//  header - ofxKuZedDepthFileHeader, padded to ZED_DEPTHFILE_PAGE bytes
+//  frames - header.frameStride bytes each: ofxKuZedDepthFileSlot (64 bytes), depth (w*h floats),
+//           left image (w*h*3 bytes, RGB) if header.hasLeft, zero padding to page size
+//  index  - frameCount x ofxKuZedDepthFileIndexItem, written by close(), header.indexOffset points to it.
+//           If the file was not closed properly, indexOffset is 0 and the reader restores index from frame slots.
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+#include <cstdint>
+
+const int ZED_DEPTHFILE_PAGE = 4096;
+
+struct ofxKuZedDepthFileHeader {
+	char magic[8];			//"KUZEDDEP"
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t hasLeft;
+	uint64_t frameStride;	//bytes, multiple of ZED_DEPTHFILE_PAGE
+	uint64_t frameCount;
+	uint64_t indexOffset;	//0 if there is no index
+	uint8_t reserved[16];
+};
+
+struct ofxKuZedDepthFileSlot {
+	char magic[4];			//"DFRM"
+	uint32_t reserved0;
+	uint64_t id;
+	uint64_t timestamp;		//ns
+	uint8_t reserved[40];
+};
+
+struct ofxKuZedDepthFileIndexItem {
+	uint64_t id;
+	uint64_t timestamp;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofxKuZedDepthFileWriter
+{
+public:
+	~ofxKuZedDepthFileWriter();
+
+	bool open(string fileName, int width, int height, bool hasLeft);	//returns false on error
+	void close();	//writes index
+	bool isOpen();
+
+	//Write frame. left is RGB image of file size (for example ofxKuZed::getLeftPixels() without region),
+	//it's ignored if the file has no left images. Returns false if sizes differ
+	bool write(const ofxKuZedDepthView &depth, const ofPixels *left = 0);
+	bool write(const ofFloatPixels &depth, const ofPixels *left, unsigned long long id, unsigned long long timestamp);
+	int getFrameCount();
+
+private:
+	bool checkLeft(const ofPixels *left);
+	bool writeFrame(const float *depth, int depthStep, const unsigned char *left, unsigned long long id, unsigned long long timestamp);
+	ofstream file_;
+	ofxKuZedDepthFileHeader header_;
+	vector<ofxKuZedDepthFileIndexItem> index_;
+	vector<char> padding_;
+};
+
+//------------------------------------------------------------------------------------------------------
+//Views point into mapped file memory. If the file is larger than mapping window (see setWindowSize),
+//only part of the file is mapped, and views are valid until a frame outside of the window is requested.
+//Otherwise they are valid until close()
+class ofxKuZedDepthFileReader
+{
+public:
+	ofxKuZedDepthFileReader();
+	~ofxKuZedDepthFileReader();
+
+	//Maximal size of mapped part of file in bytes, 0 - whole file.
+	//Default is 0 for 64-bit build and 256 Mb for 32-bit build, where address space is small
+	void setWindowSize(uint64_t bytes);
+
+	bool open(string fileName);		//returns false on error
+	void close();
+	bool isOpen();
+
+	int getFrameCount();
+	int getWidth();
+	int getHeight();
+	bool hasLeft();
+
+	ofxKuZedDepthView getDepth(int index);		//depth of frame, empty view if index is out of range
+	const unsigned char *getLeft(int index);	//left RGB image of frame, rows are packed, 0 if there is no image
+	unsigned long long getTimestamp(int index);
+	unsigned long long getFrameId(int index);
+
+	//Index of the first frame with timestamp >= given, or the last frame
+	int findFrame(unsigned long long timestamp);
+
+private:
+	ofxKuZedDepthFileHeader header_;
+	vector<ofxKuZedDepthFileIndexItem> index_;
+	uint64_t fileSize_ = 0;
+	uint64_t windowSize_ = 0;
+
+	//Mapping
+#ifdef TARGET_WIN32
+	void *file_;
+	void *mapping_;
+#else
+	int file_;
+#endif
+	unsigned char *window_ = 0;
+	uint64_t windowOffset_ = 0;
+	uint64_t windowLength_ = 0;
+	uint64_t granularity_ = ZED_DEPTHFILE_PAGE;
+
+	const unsigned char *map(uint64_t offset, uint64_t size);	//pointer to file data, remaps window if required
+	void unmap();
+	const unsigned char *frameData(int index);
+};
@@ -0,0 +1,75 @@
+#include "ofxKuZedForeground.h"
+#include "ofxKuZed.h"
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedBackground &ofxKuZedForeground::getBackground()
+{
+	return background_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedLabeler &ofxKuZedForeground::getLabeler()
+{
+	return labeler_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedForeground::reset()
+{
+	background_.reset();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedForeground::isLearning() const
+{
+	return background_.isLearning();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedForeground::update(ofxKuZed &zed)
+{
+	ofxKuZedDepthView depth = zed.getDepthView_mm();
+	if (depth.empty() || depth.frameId == frameId_) return;
+	update(depth, zed.getIntrinsics());
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedForeground::update(const ofxKuZedDepthView &depth, ofxKuZedIntrinsics intrinsics)
+{
+	if (depth.empty()) return;
+	frameId_ = depth.frameId;
+	int w = depth.width;
+	int h = depth.height;
+
+	//Mask is reallocated only if size is changed
+	if (mask_.getWidth() != w || mask_.getHeight() != h) {
+		mask_.allocate(w, h, 1);
+	}
+	background_.apply((const unsigned char *)depth.data, depth.step, w, h, mask_.getData(), w);
+	labeler_.process(mask_.getData(), w, w, h, depth.data, depth.step, intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy);
+	maskTextureDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+const vector<ofxKuZedLabeler::Blob> &ofxKuZedForeground::getBlobs() const
+{
+	return labeler_.getBlobs();
+}
+
+//------------------------------------------------------------------------------------------------------
+ofPixels &ofxKuZedForeground::getMask()
+{
+	return mask_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofTexture &ofxKuZedForeground::getMaskTexture()
+{
+	if (maskTextureDirty_) {
+		maskTextureDirty_ = false;
+		maskTexture_.loadData(mask_);
+	}
+	return maskTexture_;
+}
+
+//------------------------------------------------------------------------------------------------------
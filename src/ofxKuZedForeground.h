@@ -0,0 +1,49 @@
+#pragma once
+
+//Foreground extraction from depth: learned background model, foreground mask and blobs
+//with bounding box, pixel count and 3D centroid. Typical use is people detection in front of a wall:
+//	foreground.getBackground().setRange(500, 4000);
+//	foreground.getLabeler().setMinPixels(500);
+//	...
+//	zed.update();
+//	foreground.update(zed);
+//	for (auto &blob : foreground.getBlobs()) ofDrawRectangle(blob.x0, blob.y0, blob.x1 - blob.x0, blob.y1 - blob.y0);
+//Background is learned during the first frames (see ofxKuZedBackground), so the scene should be empty then.
+//All buffers are allocated once.
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedSource.h"
+#include "ofxKuZedBackground.h"
+#include "ofxKuZedLabeler.h"
+
+class ofxKuZed;
+
+class ofxKuZedForeground
+{
+public:
+	ofxKuZedBackground &getBackground();	//model settings: learning, tolerance, depth range
+	ofxKuZedLabeler &getLabeler();			//blob settings: connectivity, minimal size, label image
+
+	//Learn background again
+	void reset();
+	bool isLearning() const;
+
+	//Process the current frame of zed. Does nothing if the frame was processed already
+	void update(ofxKuZed &zed);
+	//Process depth, camera parameters are used for centroids of blobs
+	void update(const ofxKuZedDepthView &depth, ofxKuZedIntrinsics intrinsics);
+
+	const vector<ofxKuZedLabeler::Blob> &getBlobs() const;
+	ofPixels &getMask();			//255 - foreground
+	ofTexture &getMaskTexture();	//it's loaded by request
+
+private:
+	ofxKuZedBackground background_;
+	ofxKuZedLabeler labeler_;
+
+	unsigned long long frameId_ = 0;	//last processed frame
+	ofPixels mask_;
+	ofTexture maskTexture_;
+	bool maskTextureDirty_ = false;
+};
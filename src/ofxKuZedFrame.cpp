@@ -0,0 +1,96 @@
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedConvert.h"
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedChannelBytesPerPixel(int channel) {
+	switch (channel) {
+	case ZED_CHANNEL_LEFT:
+	case ZED_CHANNEL_RIGHT:
+	case ZED_CHANNEL_DEPTH:
+		return 4;
+	case ZED_CHANNEL_XYZ:
+	case ZED_CHANNEL_XYZRGBA:
+		return 16;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBuffer::setView(unsigned char *data0, int width0, int height0, int step0, int bytesPerPixel0) {
+	data = data0;
+	width = width0;
+	height = height0;
+	step = step0;
+	bytesPerPixel = bytesPerPixel0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBuffer::allocate(int width0, int height0, int bytesPerPixel0) {
+	storage_.resize(size_t(width0) * height0 * bytesPerPixel0);
+	setView((storage_.empty()) ? 0 : &storage_[0], width0, height0, width0 * bytesPerPixel0, bytesPerPixel0);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBuffer::copyFrom(const ofxKuZedBuffer &buffer) {
+	if (buffer.empty()) {
+		clear();
+		return;
+	}
+	allocate(buffer.width, buffer.height, buffer.bytesPerPixel);
+	ofxKuZedConvert::copyRows(buffer.data, buffer.step, data, step, width * bytesPerPixel, height);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedBuffer::clear() {
+	data = 0;
+	width = height = step = bytesPerPixel = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedFrame::clear() {
+	for (int i = 0; i < ZED_CHANNEL_COUNT; i++) {
+		buffers[i].clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedFrame::computeXyz(int channel, float fx, float fy, float cx, float cy) {
+	const ofxKuZedBuffer &depth = buffers[ZED_CHANNEL_DEPTH];
+	const ofxKuZedBuffer &left = buffers[ZED_CHANNEL_LEFT];
+	if (depth.empty() || fx <= 0 || fy <= 0) return false;
+	bool colors = (channel == ZED_CHANNEL_XYZRGBA && !left.empty());
+	ofxKuZedBuffer &xyz = buffers[channel];
+	xyz.allocate(depth.width, depth.height, ofxKuZedChannelBytesPerPixel(channel));
+	ofxKuZedConvert::depthToXyz(depth.data, depth.step, (colors) ? left.data : 0, left.step,
+		xyz.data, xyz.step, depth.width, depth.height, fx, fy, cx, cy);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedRegion ofxKuZedRegion::clamped(int w, int h) const {
+	ofxKuZedRegion r = *this;
+	r.downscale = max(1, min(downscale, int(ofxKuZedConvert::DOWNSCALE_MAX)));
+	r.x = max(0, min(x, w));
+	r.y = max(0, min(y, h));
+	int x1 = (width > 0) ? min(x + width, w) : w;
+	int y1 = (height > 0) ? min(y + height, h) : h;
+	r.width = max(x1 - r.x, 0) / r.downscale * r.downscale;
+	r.height = max(y1 - r.y, 0) / r.downscale * r.downscale;
+	return r;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedRegion::isFull(int w, int h) const {
+	return x == 0 && y == 0 && width == w && height == h && downscale == 1;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedRegion::view(const ofxKuZedBuffer &buffer, ofxKuZedBuffer &roi) const {
+	if (buffer.empty() || width == 0 || height == 0) {
+		roi.clear();
+		return;
+	}
+	roi.setView(buffer.data + size_t(buffer.step) * y + x * buffer.bytesPerPixel, width, height, buffer.step, buffer.bytesPerPixel);
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,103 @@
+#pragma once
+
+//CPU-side frame data of ofxKuZed.
+//ofxKuZedBuffer has the same layout as sl::zed::Mat (width, height, step in bytes, data),
+//so all conversions work the same way both for SDK memory and for frames copied by the capture thread.
+
+#include "ofMain.h"
+#include "ofxKuZedConvert.h"
+
+//Channels of the frame
+enum ofxKuZedChannel {
+	ZED_CHANNEL_LEFT = 0,		//left image, BGRA, 4 x uchar
+	ZED_CHANNEL_RIGHT = 1,		//right image, BGRA, 4 x uchar
+	ZED_CHANNEL_DEPTH = 2,		//depth in mm, 1 x float
+	ZED_CHANNEL_XYZ = 3,		//point cloud, 4 x float, 4th is unused
+	ZED_CHANNEL_XYZRGBA = 4,	//point cloud, 4 x float, 4th float contains 4 x uchar of color
+	ZED_CHANNEL_COUNT = 5
+};
+
+int ofxKuZedChannelBytesPerPixel(int channel);
+
+//Image buffer: either a view of external memory (valid until next grab),
+//or own copy of data
+struct ofxKuZedBuffer {
+	unsigned char *data = 0;
+	int width = 0;
+	int height = 0;
+	int step = 0;		//row size in bytes
+	int bytesPerPixel = 0;
+
+	ofxKuZedBuffer() {}
+
+	bool empty() const { return data == 0; }
+	void setView(unsigned char *data, int width, int height, int step, int bytesPerPixel);
+	void copyFrom(const ofxKuZedBuffer &buffer);	//copy data into own storage
+	void allocate(int width, int height, int bytesPerPixel);	//allocate own storage, rows are packed
+	void clear();			//forget view, storage is kept for reusing
+
+	template<typename T> T *row(int y) { return (T*)(data + step * y); }
+	template<typename T> const T *row(int y) const { return (const T*)(data + step * y); }
+
+private:
+	vector<unsigned char> storage_;
+
+	//Buffer can point to own storage, so copying is not allowed
+	ofxKuZedBuffer(const ofxKuZedBuffer &);
+	ofxKuZedBuffer &operator=(const ofxKuZedBuffer &);
+};
+
+//All channels of one frame
+struct ofxKuZedFrame {
+	ofxKuZedBuffer buffers[ZED_CHANNEL_COUNT];
+	unsigned long long id = 0;	//frame number, starting from 1
+	unsigned long long timestamp = 0;	//camera timestamp, ns
+	unsigned long long hostTime = 0;	//host time at the end of grab, ns (ofxKuZedStats::now())
+	unsigned long long grabTime = 0;	//duration of grab, ns
+
+	ofxKuZedBuffer &operator[](int channel) { return buffers[channel]; }
+	const ofxKuZedBuffer &operator[](int channel) const { return buffers[channel]; }
+	void clear();	//forget all buffers, id is kept
+
+	//Fill ZED_CHANNEL_XYZ or ZED_CHANNEL_XYZRGBA from depth (and left image for colors) using camera parameters,
+	//for sources without SDK point cloud. Returns false if there is no depth
+	bool computeXyz(int channel, float fx, float fy, float cx, float cy);
+};
+
+//Non-owning view of depth map in mm, without copying.
+//It's valid until the next ofxKuZed::update()
+struct ofxKuZedDepthView {
+	const float *data = 0;
+	int width = 0;
+	int height = 0;
+	int step = 0;		//row size in bytes, can be larger than width * sizeof(float)
+	unsigned long long frameId = 0;
+	unsigned long long timestamp = 0;	//camera time, ns
+	unsigned long long hostTime = 0;	//host time at the end of grab, ns (ofxKuZedStats::now())
+
+	bool empty() const { return data == 0; }
+	const float *row(int y) const { return (const float*)((const unsigned char*)data + size_t(step) * y); }
+	float at(int x, int y) const { return row(y)[x]; }
+};
+
+//Region of interest of an output with integer downscale, see ofxKuZed::setOutputRegion.
+//Output pixel (u, v) is made from block of source pixels starting at (x + u * downscale, y + v * downscale)
+struct ofxKuZedRegion {
+	int x = 0, y = 0;				//in source pixels
+	int width = 0, height = 0;		//0 means up to the image border
+	int downscale = 1;				//1..ofxKuZedConvert::DOWNSCALE_MAX
+	int reduction = ofxKuZedConvert::REDUCE_BOX;	//for depth, see ofxKuZedConvert::Reduction
+
+	//Region inside w x h image, with size divisible by downscale
+	ofxKuZedRegion clamped(int w, int h) const;
+	bool isFull(int w, int h) const;	//whole image without downscaling
+	int outputWidth() const { return width / downscale; }
+	int outputHeight() const { return height / downscale; }
+	//View of the region of buffer (clamped region is expected)
+	void view(const ofxKuZedBuffer &buffer, ofxKuZedBuffer &roi) const;
+};
+
+//Frame grabber, used by ofxKuZedCaptureThread.
+//Should wait for a new frame, fill required channels of 'frame' and return true,
+//or return false if no frame was obtained.
+typedef std::function<bool(ofxKuZedFrame &frame)> ofxKuZedGrabFunction;
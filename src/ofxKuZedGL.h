@@ -0,0 +1,15 @@
+#pragma once
+
+//OpenGL declarations for GL code of ofxKuZed which doesn't need the rest of openFrameworks.
+//In openFrameworks they come from ofMain.h (GLEW), in standalone builds (OFXKUZED_NO_OF, such as the benchmark)
+//from system headers, with entry points of OpenGL 2.1+ linked directly.
+
+#ifdef OFXKUZED_NO_OF
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+#else
+#include "ofMain.h"
+#endif
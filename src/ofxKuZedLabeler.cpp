@@ -0,0 +1,222 @@
+#include "ofxKuZedLabeler.h"
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------
+//8 mask bytes at once, for skipping long spans of background and foreground
+static inline uint64_t load8(const unsigned char *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+static inline bool hasZeroByte(uint64_t v)
+{
+	return ((v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL) != 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedLabeler::setConnectivity(int connectivity)
+{
+	connectivity_ = (connectivity == 4) ? 4 : 8;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedLabeler::getConnectivity() const
+{
+	return connectivity_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedLabeler::setMinPixels(int pixels)
+{
+	minPixels_ = std::max(pixels, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedLabeler::getMinPixels() const
+{
+	return minPixels_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedLabeler::setUseLabels(bool useLabels)
+{
+	useLabels_ = useLabels;
+	if (!useLabels_) labels_.clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedLabeler::find(int i)
+{
+	while (parent_[i] != i) {
+		parent_[i] = parent_[parent_[i]];	//path halving
+		i = parent_[i];
+	}
+	return i;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedLabeler::unite(int a, int b)
+{
+	a = find(a);
+	b = find(b);
+	//The earliest run is the root, so components are numbered in order of appearance
+	if (a < b) parent_[b] = a;
+	else if (b < a) parent_[a] = b;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedLabeler::process(const unsigned char *mask, int maskStep, int w, int h,
+	const float *depth, int depthStep, float fx, float fy, float cx, float cy)
+{
+	runs_.clear();
+	parent_.clear();
+	blobs_.clear();
+	if (!mask || w <= 0 || h <= 0) return;
+	rowRuns_.resize(h + 1);
+	const int extend = (connectivity_ == 8) ? 1 : 0;	//diagonal neighbours
+	const float maxFloat = std::numeric_limits<float>::max();
+
+	//Runs of rows, connected with runs of the previous row
+	for (int y = 0; y < h; y++) {
+		const unsigned char *row = mask + size_t(maskStep) * y;
+		const float *depthRow = (depth) ? (const float *)((const unsigned char *)depth + size_t(depthStep) * y) : 0;
+		rowRuns_[y] = int(runs_.size());
+		int prev = (y > 0) ? rowRuns_[y - 1] : 0;
+		int prevEnd = rowRuns_[y];
+		int x = 0;
+		while (x < w) {
+			while (x + 8 <= w && load8(row + x) == 0) x += 8;
+			while (x < w && row[x] == 0) x++;
+			if (x == w) break;
+			Run run;
+			run.x0 = x;
+			while (x + 8 <= w && !hasZeroByte(load8(row + x))) x += 8;
+			while (x < w && row[x] != 0) x++;
+			run.x1 = x;
+			run.y = y;
+			run.depthPixels = 0;
+			run.sumD = 0;
+			run.sumXD = 0;
+			if (depthRow) {
+				float sumD = 0, sumXD = 0;
+				int n = 0;
+				for (int i = run.x0; i < run.x1; i++) {
+					float d = depthRow[i];
+					bool valid = (d > 0) & (d <= maxFloat);
+					d = (valid) ? d : 0;
+					sumD += d;
+					sumXD += d * i;
+					n += valid;
+				}
+				run.depthPixels = n;
+				run.sumD = sumD;
+				run.sumXD = sumXD;
+			}
+			int index = int(runs_.size());
+			runs_.push_back(run);
+			parent_.push_back(index);
+
+			//Runs of the previous row are sorted, skip ones which end before this run
+			while (prev < prevEnd && runs_[prev].x1 + extend <= run.x0) prev++;
+			for (int k = prev; k < prevEnd && runs_[k].x0 < run.x1 + extend; k++) {
+				unite(k, index);
+			}
+			//The last overlapping run can touch the next run too
+			while (prev + 1 < prevEnd && runs_[prev + 1].x0 < run.x1 + extend) prev++;
+		}
+	}
+	rowRuns_[h] = int(runs_.size());
+
+	//Statistics of components, numbered in order of appearance
+	int runCount = int(runs_.size());
+	component_.resize(runCount);
+	components_.clear();
+	for (int i = 0; i < runCount; i++) {
+		const Run &run = runs_[i];
+		int root = find(i);
+		if (root == i) {
+			component_[i] = int(components_.size());
+			Component c;
+			c.blob.x0 = run.x0;
+			c.blob.y0 = run.y;
+			c.blob.x1 = run.x1;
+			c.blob.y1 = run.y + 1;
+			c.blob.pixels = 0;
+			c.blob.depthPixels = 0;
+			c.sumD = c.sumXD = c.sumYD = 0;
+			components_.push_back(c);
+		}
+		int ci = component_[root];
+		component_[i] = ci;
+		Component &c = components_[ci];
+		c.blob.x0 = std::min(c.blob.x0, run.x0);
+		c.blob.x1 = std::max(c.blob.x1, run.x1);
+		c.blob.y1 = run.y + 1;
+		c.blob.pixels += run.x1 - run.x0;
+		c.blob.depthPixels += run.depthPixels;
+		c.sumD += run.sumD;
+		c.sumXD += run.sumXD;
+		c.sumYD += run.sumD * run.y;
+	}
+
+	//Blobs which are large enough, the largest first
+	order_.clear();
+	for (size_t i = 0; i < components_.size(); i++) {
+		components_[i].index = -1;
+		if (components_[i].blob.pixels >= minPixels_) order_.push_back(int(i));
+	}
+	std::stable_sort(order_.begin(), order_.end(), [this](int a, int b) {
+		return components_[a].blob.pixels > components_[b].blob.pixels;
+	});
+	for (size_t i = 0; i < order_.size(); i++) {
+		Component &c = components_[order_[i]];
+		c.index = int(i);
+		Blob blob = c.blob;
+		blob.x = blob.y = blob.z = 0;
+		if (blob.depthPixels > 0) {
+			double n = blob.depthPixels;
+			blob.z = float(c.sumD / n);
+			if (fx > 0 && fy > 0) {
+				//x = (u - cx) * d / fx, summed over pixels
+				blob.x = float((c.sumXD - cx * c.sumD) / (fx * n));
+				blob.y = float((c.sumYD - cy * c.sumD) / (fy * n));
+			}
+		}
+		blobs_.push_back(blob);
+	}
+
+	if (useLabels_) {
+		labels_.assign(size_t(w) * h, 0);
+		for (int i = 0; i < runCount; i++) {
+			const Run &run = runs_[i];
+			int label = components_[component_[i]].index + 1;
+			if (label == 0) continue;
+			std::fill(labels_.begin() + size_t(w) * run.y + run.x0, labels_.begin() + size_t(w) * run.y + run.x1, label);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+const std::vector<ofxKuZedLabeler::Blob> &ofxKuZedLabeler::getBlobs() const
+{
+	return blobs_;
+}
+
+//------------------------------------------------------------------------------------------------------
+const int *ofxKuZedLabeler::getLabels() const
+{
+	return (labels_.empty()) ? 0 : &labels_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedLabeler::getRunCount() const
+{
+	return int(runs_.size());
+}
+
+//------------------------------------------------------------------------------------------------------
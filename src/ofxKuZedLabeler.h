@@ -0,0 +1,68 @@
+#pragma once
+
+//Connected components of binary mask with statistics of blobs: bounding box, pixel count and 3D centroid.
+//Labeling works on runs of mask pixels instead of pixels: runs of each row are connected with overlapping runs
+//of the previous row by union-find (with path halving and union by smaller index), so time is linear
+//in the number of pixels plus runs. Statistics are summed per run while scanning, then per component.
+//Buffers only grow, so labeling doesn't allocate after the first frames.
+
+#include <vector>
+#include <cstddef>
+
+class ofxKuZedLabeler
+{
+public:
+	struct Blob {
+		int x0, y0, x1, y1;		//bounding box in pixels, [x0, x1) x [y0, y1)
+		int pixels;				//number of mask pixels
+		int depthPixels;		//pixels with valid depth, used for centroid
+		float x, y, z;			//centroid in camera coordinates, mm (x right, y down, z forward), 0 if no depth
+	};
+
+	void setConnectivity(int connectivity);	//4 or 8, default: 8
+	int getConnectivity() const;
+	void setMinPixels(int pixels);			//smaller blobs are dropped, default: 100
+	int getMinPixels() const;
+
+	//Write label image: index of blob in getBlobs() + 1 for each pixel, 0 for background and dropped blobs
+	void setUseLabels(bool useLabels);		//default: false
+
+	//Find blobs of mask (non-zero pixels, step - row size in bytes). Depth (float mm) and camera parameters
+	//are optional, they are used for centroids. Blobs are sorted by pixel count, the largest first
+	void process(const unsigned char *mask, int maskStep, int w, int h,
+		const float *depth = 0, int depthStep = 0, float fx = 0, float fy = 0, float cx = 0, float cy = 0);
+
+	const std::vector<Blob> &getBlobs() const;
+	const int *getLabels() const;	//w * h, if setUseLabels(true)
+	int getRunCount() const;		//number of runs in the last frame, for statistics
+
+private:
+	int connectivity_ = 8;
+	int minPixels_ = 100;
+	bool useLabels_ = false;
+
+	//Run of mask pixels [x0, x1) in row y with its statistics
+	struct Run {
+		int x0, x1, y;
+		int depthPixels;
+		double sumD, sumXD;		//sums of depth and x * depth
+	};
+	std::vector<Run> runs_;
+	std::vector<int> rowRuns_;		//first run of each row, h + 1
+	std::vector<int> parent_;		//union-find over runs
+	std::vector<int> component_;	//component of each run
+
+	//Connected component with sums for centroid
+	struct Component {
+		Blob blob;
+		double sumD, sumXD, sumYD;
+		int index;				//in blobs_, -1 for dropped
+	};
+	std::vector<Component> components_;
+	std::vector<int> order_;		//components sorted by size
+	std::vector<Blob> blobs_;
+	std::vector<int> labels_;
+
+	int find(int i);
+	void unite(int a, int b);
+};
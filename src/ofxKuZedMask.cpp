@@ -0,0 +1,145 @@
+#include "ofxKuZedMask.h"
+#include "ofxKuZed.h"
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::setRange(float near_mm, float far_mm)
+{
+	if (near_mm == near_ && far_mm == far_) return;
+	near_ = near_mm;
+	far_ = far_mm;
+	changed_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMask::addPlane(ofVec3f normal, float offset_mm, ofRectangle region)
+{
+	planes_.push_back(ofxKuZedConvert::MaskPlane());
+	setPlane(int(planes_.size()) - 1, normal, offset_mm, region);
+	return int(planes_.size()) - 1;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::setPlane(int index, ofVec3f normal, float offset_mm, ofRectangle region)
+{
+	if (index < 0 || index >= int(planes_.size())) {
+		ofLogWarning() << "ofxKuZedMask: bad plane index " << index << endl;
+		return;
+	}
+	ofxKuZedConvert::MaskPlane &plane = planes_[index];
+	plane.nx = normal.x;
+	plane.ny = normal.y;
+	plane.nz = normal.z;
+	plane.d = offset_mm;
+	bool whole = (region.getWidth() <= 0 || region.getHeight() <= 0);
+	plane.x0 = (whole) ? 0 : int(region.x);
+	plane.y0 = (whole) ? 0 : int(region.y);
+	plane.x1 = (whole) ? 0 : int(region.x + region.getWidth());
+	plane.y1 = (whole) ? 0 : int(region.y + region.getHeight());
+	changed_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::clearPlanes()
+{
+	planes_.clear();
+	changed_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMask::getPlaneCount()
+{
+	return int(planes_.size());
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::setMaskedChannels(int channels)
+{
+	if (channels == maskedChannels_) return;
+	maskedChannels_ = channels;
+	changed_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::update(ofxKuZed &zed)
+{
+	ofxKuZedDepthView depth = zed.getDepthView_mm();
+	if (depth.empty() || (depth.frameId == frameId_ && !changed_)) return;
+	if (maskedChannels_ > 0) {
+		update(depth, zed.getChannelView(ZED_CHANNEL_LEFT), zed.getIntrinsics());
+	}
+	else {
+		update(depth, ofxKuZedBuffer(), zed.getIntrinsics());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMask::update(const ofxKuZedDepthView &depth, const ofxKuZedBuffer &bgra, ofxKuZedIntrinsics intrinsics)
+{
+	if (depth.empty()) return;
+	frameId_ = depth.frameId;
+	changed_ = false;
+	int w = depth.width;
+	int h = depth.height;
+
+	//Buffers are reallocated only if size is changed
+	if (mask_.getWidth() != w || mask_.getHeight() != h) {
+		mask_.allocate(w, h, 1);
+	}
+	bool useMasked = (maskedChannels_ > 0 && !bgra.empty() && bgra.width == w && bgra.height == h);
+	if (useMasked && (masked_.getWidth() != w || masked_.getHeight() != h || masked_.getNumChannels() != maskedChannels_)) {
+		masked_.allocate(w, h, maskedChannels_);
+	}
+
+	ofxKuZedConvert::MaskParams params;
+	params.nearMm = near_;
+	params.farMm = far_;
+	params.fx = intrinsics.fx;
+	params.fy = intrinsics.fy;
+	params.cx = intrinsics.cx;
+	params.cy = intrinsics.cy;
+	params.planes = (planes_.empty()) ? 0 : &planes_[0];
+	params.planeCount = int(planes_.size());
+	if (params.planeCount > 0 && (params.fx <= 0 || params.fy <= 0)) {
+		ofLogWarning() << "ofxKuZedMask: no camera parameters, planes are ignored" << endl;
+		params.planeCount = 0;
+	}
+
+	ofxKuZedConvert::depthMask((const unsigned char *)depth.data, depth.step, (useMasked) ? bgra.data : 0, bgra.step,
+		mask_.getData(), w, (useMasked) ? masked_.getData() : 0, w * maskedChannels_, maskedChannels_, w, h, params);
+	maskTextureDirty_ = true;
+	maskedTextureDirty_ = useMasked;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofPixels &ofxKuZedMask::getMask()
+{
+	return mask_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofPixels &ofxKuZedMask::getMaskedPixels()
+{
+	return masked_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofTexture &ofxKuZedMask::getMaskedTexture()
+{
+	if (maskedTextureDirty_) {
+		maskedTextureDirty_ = false;
+		maskedTexture_.loadData(masked_);
+	}
+	return maskedTexture_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofTexture &ofxKuZedMask::getMaskTexture()
+{
+	if (maskTextureDirty_) {
+		maskTextureDirty_ = false;
+		maskTexture_.loadData(mask_);
+	}
+	return maskTexture_;
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+#pragma once
+
+//Depth-based masking: binary mask of pixels with depth in [near, far] range, optionally cut by planes,
+//and masked left image (RGB with black background, or RGBA with alpha = mask).
+//Mask and masked image are computed in one pass over rows, using SIMD and the worker pool,
+//into buffers which are allocated once:
+//	mask.setRange(0, 2000);
+//	...
+//	zed.update();
+//	mask.update(zed);
+//	mask.getMaskedTexture().draw(0, 0);
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedSource.h"
+#include "ofxKuZedConvert.h"
+
+class ofxKuZed;
+
+class ofxKuZedMask
+{
+public:
+	//Depth range of kept pixels. far_mm = 0 means no limit
+	void setRange(float near_mm, float far_mm);	//default: 0, 2000
+
+	//Plane cutting the scene: keeps points p (camera coordinates in mm: x right, y down, z forward)
+	//with dot(normal, p) + offset_mm >= 0. Region limits the plane to a part of the image in pixels,
+	//empty region means the whole image. Returns plane index
+	int addPlane(ofVec3f normal, float offset_mm, ofRectangle region = ofRectangle());
+	void setPlane(int index, ofVec3f normal, float offset_mm, ofRectangle region = ofRectangle());
+	void clearPlanes();
+	int getPlaneCount();
+
+	//Channels of masked image: 3 - RGB, 4 - RGBA, 0 - compute only mask
+	void setMaskedChannels(int channels);	//default: 3
+
+	//Compute mask from the current frame of zed. Does nothing if the frame was processed already
+	//and settings were not changed
+	void update(ofxKuZed &zed);
+	//Compute mask from depth and BGRA image (can be empty if masked image is not required)
+	void update(const ofxKuZedDepthView &depth, const ofxKuZedBuffer &bgra, ofxKuZedIntrinsics intrinsics);
+
+	ofPixels &getMask();			//255 - kept pixel, 0 - masked out
+	ofPixels &getMaskedPixels();
+	ofTexture &getMaskedTexture();	//it's loaded by request
+	ofTexture &getMaskTexture();
+
+private:
+	float near_ = 0;
+	float far_ = 2000;
+	vector<ofxKuZedConvert::MaskPlane> planes_;
+	int maskedChannels_ = 3;
+
+	unsigned long long frameId_ = 0;	//last processed frame
+	bool changed_ = true;				//settings were changed
+
+	ofPixels mask_;
+	ofPixels masked_;
+	ofTexture maskTexture_;
+	ofTexture maskedTexture_;
+	bool maskTextureDirty_ = false;
+	bool maskedTextureDirty_ = false;
+};
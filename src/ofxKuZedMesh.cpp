@@ -0,0 +1,136 @@
+#include "ofxKuZedMesh.h"
+
+//ofVbo indices are ofIndexType, mesher writes unsigned int
+static_assert(sizeof(ofIndexType) == sizeof(unsigned int), "ofxKuZedMesh requires 32-bit ofIndexType");
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedMesh::ofxKuZedMesh()
+{
+	empty_ = true;
+	vertexCapacity_ = 0;
+	normalCapacity_ = 0;
+	indexCapacity_ = 0;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedMesher &ofxKuZedMesh::getMesher()
+{
+	return mesher_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesh::fill(const ofxKuZedBuffer &xyz, const ofxKuZedConvert::PointsParams &params, const float *pixelNormals)
+{
+	if (xyz.empty()) {
+		clear();
+		return;
+	}
+	mesher_.process(xyz.row<unsigned char>(0), xyz.step, xyz.width, xyz.height, params, pixelNormals);
+	empty_ = false;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesh::clear()
+{
+	empty_ = true;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesh::getNumVertices() const
+{
+	return (empty_) ? 0 : mesher_.getNumVertices();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesh::getNumIndices() const
+{
+	return (empty_) ? 0 : mesher_.getNumIndices();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesh::getNumTriangles() const
+{
+	return getNumIndices() / 3;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesh::uploadTo(ofVbo &vbo, int usage)
+{
+	int n = getNumVertices();
+	if (n == 0 || getNumIndices() == 0) {
+		vbo.clear();
+		return;
+	}
+	const ofxKuZedMesher::Vertex &v = mesher_.getVertices()[0];
+	vbo.setVertexData(&v.x, 3, n, usage, sizeof(ofxKuZedMesher::Vertex));
+	if (mesher_.hasColors()) {
+		vbo.setColorData(&v.r, n, usage, sizeof(ofxKuZedMesher::Vertex));
+	}
+	else {
+		vbo.disableColors();
+	}
+	if (mesher_.hasNormals()) {
+		vbo.setNormalData(mesher_.getNormals(), n, usage, 3 * sizeof(float));
+	}
+	else {
+		vbo.disableNormals();
+	}
+	vbo.setIndexData((const ofIndexType *)mesher_.getIndices(), getNumIndices(), usage);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesh::updateVbo()
+{
+	if (!vboDirty_) return;
+	vboDirty_ = false;
+	int n = getNumVertices();
+	int indices = getNumIndices();
+	if (n == 0 || indices == 0) return;
+
+	//Buffers are allocated with a margin, so next frames with a bit more triangles just update them
+	const int stride = sizeof(ofxKuZedMesher::Vertex);
+	if (n > vertexCapacity_) {
+		vertexCapacity_ = n + n / 4;
+		vertexBuffer_.allocate(GLsizeiptr(vertexCapacity_) * stride, GL_STREAM_DRAW);
+		vbo_.setVertexBuffer(vertexBuffer_, 3, stride, offsetof(ofxKuZedMesher::Vertex, x));
+		vbo_.setColorBuffer(vertexBuffer_, stride, offsetof(ofxKuZedMesher::Vertex, r));
+	}
+	vertexBuffer_.updateData(0, GLsizeiptr(n) * stride, mesher_.getVertices());
+	if (mesher_.hasColors()) vbo_.enableColors();
+	else vbo_.disableColors();
+
+	const int normalStride = 3 * sizeof(float);
+	if (mesher_.hasNormals()) {
+		if (n > normalCapacity_) {
+			normalCapacity_ = n + n / 4;
+			normalBuffer_.allocate(GLsizeiptr(normalCapacity_) * normalStride, GL_STREAM_DRAW);
+			vbo_.setNormalBuffer(normalBuffer_, normalStride, 0);
+		}
+		normalBuffer_.updateData(0, GLsizeiptr(n) * normalStride, mesher_.getNormals());
+		vbo_.enableNormals();
+	}
+	else {
+		vbo_.disableNormals();
+	}
+
+	if (indices > indexCapacity_) {
+		indexCapacity_ = indices + indices / 4;
+		indexBuffer_.allocate(GLsizeiptr(indexCapacity_) * sizeof(ofIndexType), GL_STREAM_DRAW);
+		vbo_.setIndexBuffer(indexBuffer_);
+	}
+	indexBuffer_.updateData(0, GLsizeiptr(indices) * sizeof(ofIndexType), mesher_.getIndices());
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesh::draw()
+{
+	updateVbo();
+	if (getNumIndices() > 0) {
+		vbo_.drawElements(GL_TRIANGLES, getNumIndices());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,42 @@
+#pragma once
+
+//Triangle mesh container of ofxKuZed: ofxKuZedMesher output with persistent vbo for drawing.
+//Vertices, normals and indices are loaded into GL buffers which are reallocated only when they grow,
+//and the vbo is updated only if the mesh was changed after the last drawing.
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedMesher.h"
+
+class ofxKuZedMesh
+{
+public:
+	ofxKuZedMesh();
+
+	//Settings: stride, edge length and depth jump limits
+	ofxKuZedMesher &getMesher();
+
+	//Build from XYZ or XYZRGBA buffer, pixelNormals are optional (see ofxKuZedMesher::process)
+	void fill(const ofxKuZedBuffer &xyz, const ofxKuZedConvert::PointsParams &params, const float *pixelNormals = 0);
+	void clear();
+
+	int getNumVertices() const;
+	int getNumIndices() const;
+	int getNumTriangles() const;
+
+	//Load mesh into vbo, without intermediate arrays
+	void uploadTo(ofVbo &vbo, int usage = GL_STREAM_DRAW);
+
+	//Draw triangles using own persistent vbo
+	void draw();
+
+private:
+	ofxKuZedMesher mesher_;
+	bool empty_;
+
+	ofVbo vbo_;
+	ofBufferObject vertexBuffer_, normalBuffer_, indexBuffer_;
+	int vertexCapacity_, normalCapacity_, indexCapacity_;
+	bool vboDirty_;
+	void updateVbo();
+};
@@ -0,0 +1,305 @@
+#include "ofxKuZedMesher.h"
+#include "ofxKuZedWorkers.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+//Triangles of a cell with corners a (x, y), b (x + 1, y), c (x, y + 1), d (x + 1, y + 1).
+//All of them have the same winding in the image
+enum {
+	TRIANGLE_ACB = 1,	//diagonal bc
+	TRIANGLE_BCD = 2,
+	TRIANGLE_ACD = 4,	//diagonal ad
+	TRIANGLE_ADB = 8
+};
+
+static const int minBandRows = 4;
+
+//------------------------------------------------------------------------------------------------------
+//The same test as ofxKuZedConvert::xyzToPointsRow uses for dropping points, so vertex numbering matches it
+static inline bool vertexValid(const float *p, float nearMm, float farMm)
+{
+	float sum = p[0] + p[1] + p[2];
+	float az = fabsf(p[2]);
+	return (sum - sum == 0) & (az >= nearMm) & (az <= farMm);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Edge between two vertices, without branches: limits are infinite when they are not used,
+//and comparisons with NaN of invalid vertices are false
+static inline bool edgeGood(const float *p, const float *q, float maxEdge2, float maxJump)
+{
+	float dx = p[0] - q[0];
+	float dy = p[1] - q[1];
+	float dz = p[2] - q[2];
+	return (fabsf(dz) <= maxJump * std::max(fabsf(p[2]), fabsf(q[2]))) & (dx * dx + dy * dy + dz * dz <= maxEdge2);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesher::setStride(int stride)
+{
+	stride_ = std::max(stride, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesher::getStride() const
+{
+	return stride_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesher::setMaxEdgeLength(float mm)
+{
+	maxEdge_ = mm;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedMesher::getMaxEdgeLength() const
+{
+	return maxEdge_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesher::setMaxDepthJump(float fraction)
+{
+	maxJump_ = fraction;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedMesher::getMaxDepthJump() const
+{
+	return maxJump_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedMesher::process(const unsigned char *xyz, int xyzStep, int w, int h, const ofxKuZedConvert::PointsParams &params,
+	const float *pixelNormals)
+{
+	vertexCount_ = 0;
+	indexCount_ = 0;
+	hasColors_ = params.hasColors;
+	hasNormals_ = (pixelNormals != 0);
+	if (!xyz || w <= 0 || h <= 0) return;
+
+	const int s = stride_;
+	const int cols = (w + s - 1) / s;
+	const int rows = (h + s - 1) / s;
+	const size_t grid = size_t(cols) * rows;
+	//Arrays only grow
+	if (local_.size() < grid) {
+		local_.resize(grid);
+		cells_.resize(grid);
+		vertices_.resize(grid);
+	}
+	if (hasNormals_ && normals_.size() < grid * 3) {
+		normals_.resize(grid * 3);
+	}
+	if (indices_.size() < grid * 6) {
+		indices_.resize(grid * 6);
+	}
+	vertexOffsets_.assign(rows + 1, 0);
+	triangleOffsets_.assign(rows + 1, 0);
+
+	const float nearMm = params.nearMm;
+	const float farMm = (params.farMm > 0) ? params.farMm : 3.4e38f;
+	const float noLimit = std::numeric_limits<float>::infinity();
+	const float maxEdge2 = (maxEdge_ > 0) ? maxEdge_ * maxEdge_ : noLimit;
+	const float maxJump = (maxJump_ > 0) ? maxJump_ * s : noLimit;		//jump is allowed per pixel step
+
+	//Pass 1: numbering of vertices in rows and triangles of cells
+	ofxKuZedWorkers::shared().parallelRows(rows, [&](int r0, int r1) {
+		for (int r = r0; r < r1; r++) {
+			const float *row = (const float *)(xyz + size_t(xyzStep) * r * s);
+			int *local = &local_[size_t(cols) * r];
+			if (r + 1 == rows) {
+				int n = 0;
+				for (int c = 0; c < cols; c++) {
+					bool valid = vertexValid(row + 4 * s * c, nearMm, farMm);
+					local[c] = (valid) ? n : -1;
+					n += valid;
+				}
+				vertexOffsets_[r + 1] = n;
+				continue;
+			}
+
+			//Cells between this row and the next one, vertices of this row are numbered in the same loop.
+			//Validity and the left edge ac are carried from the previous cell
+			const float *next = (const float *)(xyz + size_t(xyzStep) * (r + 1) * s);
+			unsigned char *cells = &cells_[size_t(cols) * r];
+			int n = 0;
+			int triangles = 0;
+			const float *a = row;
+			const float *c = next;
+			bool va = vertexValid(a, nearMm, farMm);
+			bool vc = vertexValid(c, nearMm, farMm);
+			bool ac = va & vc & edgeGood(a, c, maxEdge2, maxJump);
+			for (int x = 0; x + 1 < cols; x++) {
+				local[x] = (va) ? n : -1;
+				n += va;
+				const float *b = a + 4 * s;
+				const float *d = c + 4 * s;
+				bool vb = vertexValid(b, nearMm, farMm);
+				bool vd = vertexValid(d, nearMm, farMm);
+				bool bd = vb & vd & edgeGood(b, d, maxEdge2, maxJump);
+				bool ab = va & vb & edgeGood(a, b, maxEdge2, maxJump);
+				bool cd = vc & vd & edgeGood(c, d, maxEdge2, maxJump);
+				bool bc = vb & vc & edgeGood(b, c, maxEdge2, maxJump);
+				int acb = ac & bc & ab;
+				int bcd = bc & cd & bd;
+				unsigned char mask;
+				if (acb & bcd) {
+					//Usual case: all edges are good
+					mask = TRIANGLE_ACB | TRIANGLE_BCD;
+					triangles += 2;
+				}
+				else {
+					//Diagonal which keeps more triangles, bc if equal
+					bool ad = va & vd & edgeGood(a, d, maxEdge2, maxJump);
+					int acd = ac & cd & ad;
+					int adb = ad & bd & ab;
+					if (acb + bcd >= acd + adb) {
+						mask = (acb ? TRIANGLE_ACB : 0) | (bcd ? TRIANGLE_BCD : 0);
+						triangles += acb + bcd;
+					}
+					else {
+						mask = (acd ? TRIANGLE_ACD : 0) | (adb ? TRIANGLE_ADB : 0);
+						triangles += acd + adb;
+					}
+				}
+				cells[x] = mask;
+				a = b;
+				c = d;
+				va = vb;
+				vc = vd;
+				ac = bd;
+			}
+			local[cols - 1] = (va) ? n : -1;
+			n += va;
+			vertexOffsets_[r + 1] = n;
+			triangleOffsets_[r + 1] = triangles;
+		}
+	}, minBandRows);
+
+	for (int r = 0; r < rows; r++) {
+		vertexOffsets_[r + 1] += vertexOffsets_[r];
+		triangleOffsets_[r + 1] += triangleOffsets_[r];
+	}
+	vertexCount_ = vertexOffsets_[rows];
+	indexCount_ = triangleOffsets_[rows] * 3;
+
+	//Pass 2: vertices, normals and indices at offsets of rows
+	ofxKuZedConvert::PointsParams vertexParams = params;
+	vertexParams.decimate = s;
+	vertexParams.dropInvalid = true;
+	ofxKuZedConvert::PointsOutput out;
+	Vertex &v = vertices_[0];
+	out.x = &v.x;
+	out.y = &v.y;
+	out.z = &v.z;
+	out.xyzStride = sizeof(Vertex) / sizeof(float);
+	out.rgbaFloat = &v.r;
+	out.rgbaFloatStride = sizeof(Vertex) / sizeof(float);
+	ofxKuZedWorkers::shared().parallelRows(rows, [&](int r0, int r1) {
+		for (int r = r0; r < r1; r++) {
+			int y = r * s;
+			int first = vertexOffsets_[r];
+			const int *local = &local_[size_t(cols) * r];
+			ofxKuZedConvert::xyzToPointsRow((const float *)(xyz + size_t(xyzStep) * y), w, vertexParams, out,
+				first, w * y, vertexOffsets_[r + 1] - first);
+			if (hasNormals_) {
+				const float *src = pixelNormals + size_t(w) * 3 * y;
+				for (int c = 0; c < cols; c++) {
+					if (local[c] < 0) continue;
+					float *dst = &normals_[size_t(first + local[c]) * 3];
+					const float *n = src + 3 * s * c;
+					dst[0] = n[0];
+					dst[1] = n[1] * params.signY;
+					dst[2] = n[2] * params.signZ;
+				}
+			}
+			if (r + 1 == rows) continue;
+
+			const unsigned char *cells = &cells_[size_t(cols) * r];
+			const int *localNext = local + cols;
+			unsigned int top = first;
+			unsigned int bottom = vertexOffsets_[r + 1];
+			unsigned int *index = &indices_[size_t(triangleOffsets_[r]) * 3];
+			for (int x = 0; x + 1 < cols; x++) {
+				unsigned char mask = cells[x];
+				if (!mask) continue;
+				unsigned int a = top + local[x];
+				unsigned int b = top + local[x + 1];
+				unsigned int c = bottom + localNext[x];
+				unsigned int d = bottom + localNext[x + 1];
+				if (mask & TRIANGLE_ACB) {
+					index[0] = a; index[1] = c; index[2] = b;
+					index += 3;
+				}
+				if (mask & TRIANGLE_BCD) {
+					index[0] = b; index[1] = c; index[2] = d;
+					index += 3;
+				}
+				if (mask & TRIANGLE_ACD) {
+					index[0] = a; index[1] = c; index[2] = d;
+					index += 3;
+				}
+				if (mask & TRIANGLE_ADB) {
+					index[0] = a; index[1] = d; index[2] = b;
+					index += 3;
+				}
+			}
+		}
+	}, minBandRows);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesher::getNumVertices() const
+{
+	return vertexCount_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedMesher::getNumIndices() const
+{
+	return indexCount_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedMesher::hasColors() const
+{
+	return hasColors_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedMesher::hasNormals() const
+{
+	return hasNormals_;
+}
+
+//------------------------------------------------------------------------------------------------------
+const ofxKuZedMesher::Vertex *ofxKuZedMesher::getVertices() const
+{
+	return (vertices_.empty()) ? 0 : &vertices_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+const float *ofxKuZedMesher::getNormals() const
+{
+	return (normals_.empty()) ? 0 : &normals_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+const unsigned int *ofxKuZedMesher::getIndices() const
+{
+	return (indices_.empty()) ? 0 : &indices_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedMesher::getMemoryBytes() const
+{
+	return vertices_.capacity() * sizeof(Vertex) + normals_.capacity() * sizeof(float)
+		+ indices_.capacity() * sizeof(unsigned int) + local_.capacity() * sizeof(int) + cells_.capacity()
+		+ (vertexOffsets_.capacity() + triangleOffsets_.capacity()) * sizeof(int);
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,69 @@
+#pragma once
+
+//Triangle mesh of organized point cloud (SDK XYZ or XYZRGBA buffer).
+//Pixels of the grid, optionally decimated by stride, are vertices, and each cell of 2x2 neighbour pixels
+//gives up to two triangles. Triangle is rejected if it has an invalid vertex, an edge longer than the limit,
+//or an edge with depth jump larger than fraction of depth (per pixel step). If one diagonal of a cell
+//loses a triangle, the other diagonal is used, so cells with 3 good vertices are still covered.
+//
+//Two passes over grid rows, both split into ofxKuZedWorkers::shared() bands:
+//the first one numbers valid vertices and selects triangles of each cell, the second one writes vertices
+//by ofxKuZedConvert::xyzToPointsRow and indices at row offsets computed from counts of the first pass.
+//Buffers only grow, so meshing doesn't allocate after the first frames.
+
+#include "ofxKuZedConvert.h"
+#include <vector>
+#include <cstddef>
+
+class ofxKuZedMesher
+{
+public:
+	//Vertex, the same as ofxKuZedPointCloud::Vertex, so it can be loaded into ofVbo directly
+	struct Vertex {
+		float x, y, z;
+		float r, g, b, a;
+	};
+
+	void setStride(int stride);				//default: 1, use each stride-th pixel in each stride-th row
+	int getStride() const;
+	void setMaxEdgeLength(float mm);		//default: 0 - no limit
+	float getMaxEdgeLength() const;
+	void setMaxDepthJump(float fraction);	//default: 0.03 of depth per pixel step, 0 - no limit
+	float getMaxDepthJump() const;
+
+	//Build mesh of XYZ or XYZRGBA (4 floats per pixel, step - row size in bytes).
+	//params give colors, flipping and clipping, their decimate and dropInvalid are not used.
+	//pixelNormals (3 floats per pixel, see ofxKuZedNormals) are optional, they are flipped like points
+	void process(const unsigned char *xyz, int xyzStep, int w, int h, const ofxKuZedConvert::PointsParams &params,
+		const float *pixelNormals = 0);
+
+	int getNumVertices() const;
+	int getNumIndices() const;				//3 per triangle
+	bool hasColors() const;
+	bool hasNormals() const;
+	const Vertex *getVertices() const;
+	const float *getNormals() const;		//3 floats per vertex
+	const unsigned int *getIndices() const;
+
+	size_t getMemoryBytes() const;
+
+private:
+	int stride_ = 1;
+	float maxEdge_ = 0;
+	float maxJump_ = 0.03f;
+
+	int vertexCount_ = 0;
+	int indexCount_ = 0;
+	bool hasColors_ = false;
+	bool hasNormals_ = false;
+
+	std::vector<Vertex> vertices_;
+	std::vector<float> normals_;
+	std::vector<unsigned int> indices_;
+
+	//Buffers of passes
+	std::vector<int> local_;				//index of vertex in its grid row, -1 for invalid pixels
+	std::vector<unsigned char> cells_;		//selected triangles of each cell
+	std::vector<int> vertexOffsets_;		//first vertex of each grid row
+	std::vector<int> triangleOffsets_;		//first triangle of each row of cells
+};
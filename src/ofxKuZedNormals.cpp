@@ -0,0 +1,216 @@
+#include "ofxKuZedNormals.h"
+#include "ofxKuZedWorkers.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+typedef ofxKuZedNormals::Sum Sum;
+
+static const int blockRows = 32;	//rows of a block, which has its own integral images
+
+//------------------------------------------------------------------------------------------------------
+static inline bool validPoint(const float *p)
+{
+	//false for NaN and inf
+	return (p[0] - p[0] == 0) & (p[1] - p[1] == 0) & (p[2] - p[2] == 0) & (p[2] != 0);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Sum over columns [c0, c1) between integral rows top and bottom
+static inline Sum boxSum(const Sum *top, const Sum *bottom, int c0, int c1)
+{
+	Sum s;
+	s.x = bottom[c1].x - top[c1].x - bottom[c0].x + top[c0].x;
+	s.y = bottom[c1].y - top[c1].y - bottom[c0].y + top[c0].y;
+	s.z = bottom[c1].z - top[c1].z - bottom[c0].z + top[c0].z;
+	s.n = bottom[c1].n - top[c1].n - bottom[c0].n + top[c0].n;
+	return s;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedNormals::setRadius(int radius)
+{
+	radius_ = std::max(radius, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedNormals::getRadius() const
+{
+	return radius_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedNormals::setDiscontinuity(float mm, float fraction)
+{
+	discontinuityMm_ = mm;
+	discontinuityFraction_ = fraction;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Integral images of image rows [r0, r1): integral row k + 1 contains sums over rows [r0, r0 + k]
+static void integrate(const unsigned char *xyz, int xyzStep, int w, int h, int r0, int r1, float mm, float fraction,
+	Sum *sums, int *edges)
+{
+	const size_t stride = w + 1;
+	Sum zero = { 0, 0, 0, 0 };
+	std::fill(sums, sums + stride, zero);
+	std::fill(edges, edges + stride, 0);
+	for (int y = r0; y < r1; y++) {
+		const float *row = (const float *)(xyz + size_t(xyzStep) * y);
+		const float *below = (y + 1 < h) ? (const float *)(xyz + size_t(xyzStep) * (y + 1)) : 0;
+		Sum *s = sums + stride * (y - r0 + 1);
+		const Sum *prev = s - stride;
+		int *e = edges + stride * (y - r0 + 1);
+		const int *prevEdges = e - stride;
+		Sum acc = zero;
+		int edgeCount = 0;
+		s[0] = zero;
+		e[0] = 0;
+		//Validity of the right and the lower neighbours is carried to the next pixel
+		bool valid = validPoint(row);
+		bool validBelow = below && validPoint(below);
+		for (int x = 0; x < w; x++) {
+			const float *p = row + 4 * x;
+			bool validRight = (x + 1 < w) && validPoint(p + 4);
+			bool validNextBelow = below && (x + 1 < w) && validPoint(below + 4 * x + 4);
+			//Discontinuity with the right or the lower neighbour
+			float thr = mm + fraction * fabsf(p[2]);
+			bool edgeRight = validRight && fabsf(p[6] - p[2]) > thr;
+			bool edgeBelow = validBelow && fabsf(below[4 * x + 2] - p[2]) > thr;
+			edgeCount += valid & (edgeRight | edgeBelow);
+			acc.x += (valid) ? p[0] : 0;
+			acc.y += (valid) ? p[1] : 0;
+			acc.z += (valid) ? p[2] : 0;
+			acc.n += (valid) ? 1 : 0;
+			s[x + 1].x = prev[x + 1].x + acc.x;
+			s[x + 1].y = prev[x + 1].y + acc.y;
+			s[x + 1].z = prev[x + 1].z + acc.z;
+			s[x + 1].n = prev[x + 1].n + acc.n;
+			e[x + 1] = prevEdges[x + 1] + edgeCount;
+			valid = validRight;
+			validBelow = validNextBelow;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedNormals::compute(const unsigned char *xyz, int xyzStep, int w, int h)
+{
+	if (w <= 0 || h <= 0 || !xyz) return;
+	if (w != w_ || h != h_) {
+		w_ = w;
+		h_ = h;
+		normals_.resize(size_t(w) * h * 3);
+	}
+	const size_t stride = w + 1;
+	const int r = radius_;
+	const float mm = discontinuityMm_;
+	const float fraction = discontinuityFraction_;
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int ya, int yb) {
+		//Integral images of a block of rows with its window margins, kept by each thread between frames
+		static thread_local std::vector<Sum> sums;
+		static thread_local std::vector<int> edges;
+		for (int b0 = ya; b0 < yb; b0 += blockRows) {
+			int b1 = std::min(b0 + blockRows, yb);
+			int r0 = std::max(b0 - r, 0);
+			int r1 = std::min(b1 + r, h);
+			size_t size = stride * (r1 - r0 + 1);
+			if (sums.size() < size) {
+				sums.resize(size);
+				edges.resize(size);
+			}
+			integrate(xyz, xyzStep, w, h, r0, r1, mm, fraction, &sums[0], &edges[0]);
+
+			for (int y = b0; y < b1; y++) {
+				const float *row = (const float *)(xyz + size_t(xyzStep) * y);
+				float *out = &normals_[size_t(w) * 3 * y];
+				int y0 = std::max(y - r, 0);
+				int y1 = std::min(y + r, h - 1);
+				//Integral rows: window top, the pixel row, the next row, window bottom
+				const Sum *sTop = &sums[stride * (y0 - r0)];
+				const Sum *sMid0 = &sums[stride * (y - r0)];
+				const Sum *sMid1 = &sums[stride * (y + 1 - r0)];
+				const Sum *sBottom = &sums[stride * (y1 + 1 - r0)];
+				const int *eTop = &edges[stride * (y0 - r0)];
+				const int *eBottom = &edges[stride * (y1 + 1 - r0)];
+				for (int x = 0; x < w; x++) {
+					float *n = out + 3 * x;
+					n[0] = n[1] = n[2] = nan;
+					const float *p = row + 4 * x;
+					int x0 = std::max(x - r, 0);
+					int x1 = std::min(x + r, w - 1);
+					//Halves of window are empty at the frame border
+					if (x0 == x || x1 == x || y0 == y || y1 == y || !validPoint(p)) continue;
+					if (eBottom[x1 + 1] - eTop[x1 + 1] - eBottom[x0] + eTop[x0] > 0) continue;
+
+					Sum left = boxSum(sTop, sBottom, x0, x);
+					Sum right = boxSum(sTop, sBottom, x + 1, x1 + 1);
+					Sum top = boxSum(sTop, sMid0, x0, x1 + 1);
+					Sum bottom = boxSum(sMid1, sBottom, x0, x1 + 1);
+					int rows = y1 - y0 + 1;
+					int cols = x1 - x0 + 1;
+					if (2 * left.n < (x - x0) * rows || 2 * right.n < (x1 - x) * rows
+						|| 2 * top.n < (y - y0) * cols || 2 * bottom.n < (y1 - y) * cols) continue;
+
+					//Means in float, their differences are small relative to distance
+					float il = float(1 / left.n), ir = float(1 / right.n), it = float(1 / top.n), ib = float(1 / bottom.n);
+					float hx = float(right.x) * ir - float(left.x) * il;
+					float hy = float(right.y) * ir - float(left.y) * il;
+					float hz = float(right.z) * ir - float(left.z) * il;
+					float vx = float(bottom.x) * ib - float(top.x) * it;
+					float vy = float(bottom.y) * ib - float(top.y) * it;
+					float vz = float(bottom.z) * ib - float(top.z) * it;
+					float nx = hy * vz - hz * vy;
+					float ny = hz * vx - hx * vz;
+					float nz = hx * vy - hy * vx;
+					float length = sqrtf(nx * nx + ny * ny + nz * nz);
+					if (!(length > 0)) continue;
+					//Towards the camera, which is at the origin
+					if (nx * p[0] + ny * p[1] + nz * p[2] > 0) length = -length;
+					float k = 1 / length;
+					n[0] = nx * k;
+					n[1] = ny * k;
+					n[2] = nz * k;
+				}
+			}
+		}
+	}, blockRows);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedNormals::getWidth() const
+{
+	return w_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedNormals::getHeight() const
+{
+	return h_;
+}
+
+//------------------------------------------------------------------------------------------------------
+const float *ofxKuZedNormals::getNormals() const
+{
+	return (normals_.empty()) ? 0 : &normals_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedNormals::countValid() const
+{
+	int count = 0;
+	for (size_t i = 0; i < normals_.size(); i += 3) {
+		count += (normals_[i] == normals_[i]);
+	}
+	return count;
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedNormals::getMemoryBytes() const
+{
+	return normals_.capacity() * sizeof(float);
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,47 @@
+#pragma once
+
+//Normals of organized point cloud (SDK XYZ or XYZRGBA buffer), computed from image-space neighbourhoods.
+//Normal of a pixel is the cross product of horizontal and vertical 3D gradients: differences of mean points
+//of the right and left halves, and of the lower and upper halves of (2 * radius + 1)^2 window.
+//Means are taken from integral images of x, y, z and number of valid points, so time per pixel doesn't depend
+//on the window size. Integral images are in double, because sums over many rows exceed float precision.
+//They are built for blocks of rows plus window margins, so they stay in cache; each worker thread keeps its buffers.
+//
+//Normal is invalid (NaN) if the pixel is invalid, a half of the window has less than a half of valid points,
+//or the window crosses a depth discontinuity: neighbour pixels with |dz| > mm + fraction * z.
+//Discontinuities are counted by their own integral image, so this check is constant time too.
+//Normals are oriented towards the camera. Rows are processed by ofxKuZedWorkers::shared().
+
+#include <vector>
+#include <cstddef>
+
+class ofxKuZedNormals
+{
+public:
+	void setRadius(int radius);		//default: 4, window 9x9
+	int getRadius() const;
+	void setDiscontinuity(float mm, float fraction);	//default: 30, 0.03
+
+	//Compute normals of XYZ (4 floats per pixel, step - row size in bytes), in coordinates of the buffer
+	void compute(const unsigned char *xyz, int xyzStep, int w, int h);
+
+	int getWidth() const;
+	int getHeight() const;
+	const float *getNormals() const;	//3 floats per pixel, w * h, NaN for invalid
+	int countValid() const;				//number of valid normals, for statistics
+	size_t getMemoryBytes() const;		//normals, without buffers of threads
+
+	//Element of integral image
+	struct Sum {
+		double x, y, z, n;
+	};
+
+private:
+	int radius_ = 4;
+	float discontinuityMm_ = 30;
+	float discontinuityFraction_ = 0.03f;
+
+	int w_ = 0;
+	int h_ = 0;
+	std::vector<float> normals_;	//w * h * 3
+};
@@ -0,0 +1,330 @@
+#include "ofxKuZedPointCloud.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPointCloud::ofxKuZedPointCloud()
+{
+	layout_ = ZED_POINTCLOUD_INTERLEAVED;
+	size_ = 0;
+	hasColors_ = false;
+	useIndices_ = false;
+	useNormals_ = false;
+	hasNormals_ = false;
+	vboCapacity_ = 0;
+	normalCapacity_ = 0;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::setLayout(int layout)
+{
+	if (layout != layout_) {
+		clear();
+		x_.clear();
+		y_.clear();
+		z_.clear();
+		colors_.clear();
+		vertices_.clear();
+		layout_ = layout;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPointCloud::getLayout() const
+{
+	return layout_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::setUseIndices(bool useIndices)
+{
+	useIndices_ = useIndices;
+	if (!useIndices_ && !useNormals_) indices_.clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::setUseNormals(bool useNormals)
+{
+	useNormals_ = useNormals;
+	if (!useNormals_) {
+		normals_.clear();
+		hasNormals_ = false;
+		if (!useIndices_) indices_.clear();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::fill(const ofxKuZedBuffer &xyz, const ofxKuZedConvert::PointsParams &params)
+{
+	int decimate = max(params.decimate, 1);
+	int n = ((xyz.width + decimate - 1) / decimate) * ((xyz.height + decimate - 1) / decimate);
+	if (xyz.empty()) {
+		hasColors_ = params.hasColors;
+		clear();
+		return;
+	}
+	ofxKuZedConvert::PointsOutput out = beginFill(n, params.hasColors);
+	ofxKuZedConvert::PointsParams p = params;
+	p.decimate = decimate;
+	endFill(ofxKuZedConvert::xyzToPoints(xyz.data, xyz.step, xyz.width, xyz.height, p, out));
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::fill(const ofxKuZedVoxelGrid &grid, int level)
+{
+	int n = grid.size(level);
+	if (n == 0) {
+		hasColors_ = grid.hasColors();
+		clear();
+		return;
+	}
+	endFill(grid.write(level, beginFill(n, grid.hasColors())));
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedConvert::PointsOutput ofxKuZedPointCloud::beginFill(int n, bool hasColors)
+{
+	hasColors_ = hasColors;
+	hasNormals_ = false;
+	vboDirty_ = true;
+
+	//Arrays only grow, so memory is allocated once
+	ofxKuZedConvert::PointsOutput out;
+	if (n <= 0) return out;
+	if (layout_ == ZED_POINTCLOUD_SOA) {
+		if (int(x_.size()) < n) {
+			x_.resize(n);
+			y_.resize(n);
+			z_.resize(n);
+			colors_.resize(n * 4);
+		}
+		out.x = &x_[0];
+		out.y = &y_[0];
+		out.z = &z_[0];
+		out.xyzStride = 1;
+		out.rgba = &colors_[0];
+		out.rgbaStride = 4;
+	}
+	else {
+		if (int(vertices_.size()) < n) {
+			vertices_.resize(n);
+		}
+		Vertex &v = vertices_[0];
+		out.x = &v.x;
+		out.y = &v.y;
+		out.z = &v.z;
+		out.xyzStride = sizeof(Vertex) / sizeof(float);
+		out.rgbaFloat = &v.r;
+		out.rgbaFloatStride = sizeof(Vertex) / sizeof(float);
+	}
+	if (useIndices_ || useNormals_) {
+		if (int(indices_.size()) < n) {
+			indices_.resize(n);
+		}
+		out.index = &indices_[0];
+	}
+	return out;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::endFill(int size)
+{
+	size_ = size;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::fillNormals(const float *pixelNormals, float signY, float signZ)
+{
+	if (!useNormals_ || !pixelNormals || size_ == 0 || indices_.empty()) return;
+	if (normals_.size() < indices_.size() * 3) {
+		normals_.resize(indices_.size() * 3);
+	}
+	const int *index = &indices_[0];
+	float *normals = &normals_[0];
+	ofxKuZedWorkers::shared().parallelRows(size_, [&](int i0, int i1) {
+		for (int i = i0; i < i1; i++) {
+			const float *src = pixelNormals + size_t(index[i]) * 3;
+			float *dst = normals + size_t(i) * 3;
+			dst[0] = src[0];
+			dst[1] = src[1] * signY;
+			dst[2] = src[2] * signZ;
+		}
+	}, 4096);
+	hasNormals_ = true;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::clear()
+{
+	size_ = 0;
+	vboDirty_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPointCloud::size() const
+{
+	return size_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPointCloud::hasColors() const
+{
+	return hasColors_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPointCloud::hasNormals() const
+{
+	return hasNormals_;
+}
+
+//------------------------------------------------------------------------------------------------------
+float *ofxKuZedPointCloud::getX()
+{
+	return (x_.empty()) ? 0 : &x_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+float *ofxKuZedPointCloud::getY()
+{
+	return (y_.empty()) ? 0 : &y_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+float *ofxKuZedPointCloud::getZ()
+{
+	return (z_.empty()) ? 0 : &z_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned char *ofxKuZedPointCloud::getColors()
+{
+	return (colors_.empty()) ? 0 : &colors_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPointCloud::Vertex *ofxKuZedPointCloud::getVertices()
+{
+	return (vertices_.empty()) ? 0 : &vertices_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+int *ofxKuZedPointCloud::getIndices()
+{
+	return (indices_.empty()) ? 0 : &indices_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+float *ofxKuZedPointCloud::getNormals()
+{
+	return (normals_.empty()) ? 0 : &normals_[0];
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedConvert::PointsOutput ofxKuZedPointCloud::getData()
+{
+	ofxKuZedConvert::PointsOutput data;
+	if (size_ == 0) return data;
+	if (layout_ == ZED_POINTCLOUD_SOA) {
+		data.x = &x_[0];
+		data.y = &y_[0];
+		data.z = &z_[0];
+		if (hasColors_) data.rgba = &colors_[0];
+	}
+	else {
+		Vertex &v = vertices_[0];
+		data.x = &v.x;
+		data.y = &v.y;
+		data.z = &v.z;
+		data.xyzStride = sizeof(Vertex) / sizeof(float);
+		if (hasColors_) {
+			data.rgbaFloat = &v.r;
+			data.rgbaFloatStride = sizeof(Vertex) / sizeof(float);
+		}
+	}
+	return data;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::uploadTo(ofVbo &vbo, int usage)
+{
+	if (layout_ != ZED_POINTCLOUD_INTERLEAVED) {
+		ofLogWarning() << "ofxKuZedPointCloud: uploadTo() requires ZED_POINTCLOUD_INTERLEAVED layout" << endl;
+		return;
+	}
+	if (size_ == 0) {
+		vbo.clear();
+		return;
+	}
+	const Vertex &v = vertices_[0];
+	vbo.setVertexData(&v.x, 3, size_, usage, sizeof(Vertex));
+	if (hasColors_) {
+		vbo.setColorData(&v.r, size_, usage, sizeof(Vertex));
+	}
+	else {
+		vbo.disableColors();
+	}
+	if (hasNormals_) {
+		vbo.setNormalData(&normals_[0], size_, usage, 3 * sizeof(float));
+	}
+	else {
+		vbo.disableNormals();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::updateVbo()
+{
+	if (!vboDirty_) return;
+	vboDirty_ = false;
+	if (size_ == 0) return;
+
+	const int stride = sizeof(Vertex);
+	if (size_ > vboCapacity_) {
+		//Allocate with capacity for the whole frame, so next frames just update the buffer
+		vboCapacity_ = int(vertices_.size());
+		vboBuffer_.allocate(GLsizeiptr(vboCapacity_) * stride, &vertices_[0], GL_STREAM_DRAW);
+		vbo_.setVertexBuffer(vboBuffer_, 3, stride, offsetof(Vertex, x));
+		vbo_.setColorBuffer(vboBuffer_, stride, offsetof(Vertex, r));
+	}
+	else {
+		vboBuffer_.updateData(0, GLsizeiptr(size_) * stride, &vertices_[0]);
+	}
+	if (hasColors_) vbo_.enableColors();
+	else vbo_.disableColors();
+
+	//Normals are in a separate buffer, which is allocated when they are used for the first time
+	const int normalStride = 3 * sizeof(float);
+	if (hasNormals_) {
+		if (size_ > normalCapacity_) {
+			normalCapacity_ = int(normals_.size() / 3);
+			normalBuffer_.allocate(GLsizeiptr(normalCapacity_) * normalStride, &normals_[0], GL_STREAM_DRAW);
+			vbo_.setNormalBuffer(normalBuffer_, normalStride, 0);
+		}
+		else {
+			normalBuffer_.updateData(0, GLsizeiptr(size_) * normalStride, &normals_[0]);
+		}
+		vbo_.enableNormals();
+	}
+	else {
+		vbo_.disableNormals();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPointCloud::draw()
+{
+	if (layout_ != ZED_POINTCLOUD_INTERLEAVED) {
+		ofLogWarning() << "ofxKuZedPointCloud: draw() requires ZED_POINTCLOUD_INTERLEAVED layout" << endl;
+		return;
+	}
+	updateVbo();
+	if (size_ > 0) {
+		vbo_.draw(GL_POINTS, 0, size_);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
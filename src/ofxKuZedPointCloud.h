@@ -0,0 +1,104 @@
+#pragma once
+
+//Point cloud container of ofxKuZed, filled from SDK XYZ/XYZRGBA buffer in one pass:
+//flipping, skipping invalid points and color conversion are done in the same loop.
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedVoxelGrid.h"
+
+//Point cloud layouts
+const int ZED_POINTCLOUD_SOA = 0;			//separate arrays x[], y[], z[] and colors as 4 x uchar
+const int ZED_POINTCLOUD_INTERLEAVED = 1;	//array of ofxKuZedPointCloud::Vertex, ready for ofVbo
+
+class ofxKuZedPointCloud
+{
+public:
+	//Vertex of interleaved layout.
+	//Color is float, because ofVbo expects float colors
+	struct Vertex {
+		float x, y, z;
+		float r, g, b, a;
+	};
+
+	ofxKuZedPointCloud();
+
+	void setLayout(int layout);	//default: ZED_POINTCLOUD_INTERLEAVED
+	int getLayout() const;
+
+	//Store source pixel index of each point, see getIndices()
+	void setUseIndices(bool useIndices);	//default: false
+
+	//Keep normals of points, filled by fillNormals(). Source pixel indices are stored for it too
+	void setUseNormals(bool useNormals);	//default: false
+
+	//Fill from XYZ or XYZRGBA buffer
+	void fill(const ofxKuZedBuffer &xyz, const ofxKuZedConvert::PointsParams &params);
+	void clear();
+
+	//Fill with points of a level of voxel grid, indices get number of source points in voxels
+	void fill(const ofxKuZedVoxelGrid &grid, int level = 0);
+
+	//Filling by rows, used by ofxKuZed::extractFrame(): beginFill allocates arrays for n points and returns
+	//output pointers for ofxKuZedConvert::xyzToPointsRow, then endFill sets the number of written points
+	ofxKuZedConvert::PointsOutput beginFill(int n, bool hasColors);
+	void endFill(int size);
+
+	//Take normals of points from normals of source pixels (3 floats per pixel, see ofxKuZedNormals),
+	//flipped like points. Call it after filling from XYZ buffer
+	void fillNormals(const float *pixelNormals, float signY, float signZ);
+
+	int size() const;			//number of points
+	bool hasColors() const;
+	bool hasNormals() const;
+
+	//ZED_POINTCLOUD_SOA data
+	float *getX();
+	float *getY();
+	float *getZ();
+	unsigned char *getColors();	//4 x uchar per point
+
+	//ZED_POINTCLOUD_INTERLEAVED data
+	Vertex *getVertices();
+
+	//Source pixel index x + w * y of each point, allows to map compacted points back to the image
+	int *getIndices();
+
+	//Normals, 3 floats per point, in any layout
+	float *getNormals();
+
+	//Pointers to points and colors of any layout, as input for ofxKuZedVoxelGrid
+	ofxKuZedConvert::PointsOutput getData();
+
+	//Load ZED_POINTCLOUD_INTERLEAVED data and normals into vbo, without intermediate arrays
+	void uploadTo(ofVbo &vbo, int usage = GL_STREAM_DRAW);
+
+	//Draw ZED_POINTCLOUD_INTERLEAVED points using own persistent vbo.
+	//The vbo is updated in place only if the cloud was changed after the last drawing
+	void draw();
+
+private:
+	int layout_;
+	int size_;
+	bool hasColors_;
+	bool useIndices_;
+	bool useNormals_;
+	bool hasNormals_;
+
+	vector<float> x_, y_, z_;
+	vector<unsigned char> colors_;
+	vector<Vertex> vertices_;
+	vector<int> indices_;
+	vector<float> normals_;
+
+	//Persistent vbo for draw(): one GL buffer with interleaved vertices,
+	//reallocated only when the number of points exceeds its capacity
+	ofVbo vbo_;
+	ofBufferObject vboBuffer_;
+	ofBufferObject normalBuffer_;
+	int vboCapacity_;
+	int normalCapacity_;
+	bool vboDirty_;
+	void updateVbo();
+};
@@ -0,0 +1,408 @@
+#include "ofxKuZedRecording.h"
+
+static const char recordingMagic[8] = { 'K', 'U', 'Z', 'E', 'D', 'R', 'E', 'C' };
+static const char chunkMagic[4] = { 'F', 'R', 'M', 'E' };
+static const uint32_t recordingVersion = 1;
+static const int recordedChannels[3] = { ZED_CHANNEL_LEFT, ZED_CHANNEL_RIGHT, ZED_CHANNEL_DEPTH };
+
+static_assert(sizeof(ofxKuZedRecordingHeader) == 64, "ofxKuZedRecordingHeader must be 64 bytes");
+static_assert(sizeof(ofxKuZedRecordingChunk) == 32, "ofxKuZedRecordingChunk must be 32 bytes");
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedRecorder::~ofxKuZedRecorder()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedRecorder::open(string fileName, int width, int height, ofxKuZedIntrinsics intrinsics, int channels)
+{
+	close();
+	file_.open(ofToDataPath(fileName).c_str(), ios::binary | ios::trunc);
+	if (!file_.is_open()) {
+		ofLogError() << "ofxKuZedRecorder: can't create file " << fileName << endl;
+		return false;
+	}
+	memset(&header_, 0, sizeof(header_));
+	memcpy(header_.magic, recordingMagic, sizeof(recordingMagic));
+	header_.version = recordingVersion;
+	header_.width = width;
+	header_.height = height;
+	header_.channels = channels & ZED_RECORD_ALL;
+	header_.fx = intrinsics.fx;
+	header_.fy = intrinsics.fy;
+	header_.cx = intrinsics.cx;
+	header_.cy = intrinsics.cy;
+	index_.clear();
+
+	//Header without index, it's rewritten by close()
+	file_.write((const char*)&header_, sizeof(header_));
+	offset_ = sizeof(header_);
+	return file_.good();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedRecorder::close()
+{
+	if (!file_.is_open()) return;
+	header_.indexOffset = offset_;
+	header_.frameCount = index_.size();
+	if (!index_.empty()) {
+		file_.write((const char*)&index_[0], index_.size() * sizeof(ofxKuZedRecordingIndexItem));
+	}
+	file_.seekp(0);
+	file_.write((const char*)&header_, sizeof(header_));
+	file_.close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedRecorder::isOpen()
+{
+	return file_.is_open();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedRecorder::write(const ofxKuZedFrame &frame)
+{
+	if (!file_.is_open()) return false;
+
+	ofxKuZedRecordingChunk chunk;
+	memcpy(chunk.magic, chunkMagic, sizeof(chunkMagic));
+	chunk.channels = 0;
+	chunk.id = frame.id;
+	chunk.timestamp = frame.timestamp;
+	chunk.dataSize = 0;
+	int w = header_.width;
+	int h = header_.height;
+	for (int i = 0; i < 3; i++) {
+		int c = recordedChannels[i];
+		const ofxKuZedBuffer &buffer = frame[c];
+		if ((header_.channels & (1 << c)) && !buffer.empty()) {
+			if (buffer.width != w || buffer.height != h) {
+				ofLogError() << "ofxKuZedRecorder: frame size differs from " << w << " x " << h << endl;
+				return false;
+			}
+			chunk.channels |= 1 << c;
+			chunk.dataSize += uint64_t(w) * h * ofxKuZedChannelBytesPerPixel(c);
+		}
+	}
+
+	ofxKuZedRecordingIndexItem item;
+	item.offset = offset_;
+	item.timestamp = frame.timestamp;
+
+	file_.write((const char*)&chunk, sizeof(chunk));
+	for (int i = 0; i < 3; i++) {
+		int c = recordedChannels[i];
+		if (chunk.channels & (1 << c)) {
+			const ofxKuZedBuffer &buffer = frame[c];
+			int rowBytes = w * buffer.bytesPerPixel;
+			if (buffer.step == rowBytes) {
+				file_.write((const char*)buffer.data, size_t(rowBytes) * h);
+			}
+			else {
+				for (int y = 0; y < h; y++) {
+					file_.write((const char*)buffer.row<unsigned char>(y), rowBytes);
+				}
+			}
+		}
+	}
+	if (!file_.good()) {
+		ofLogError() << "ofxKuZedRecorder: error writing frame" << endl;
+		return false;
+	}
+	offset_ += sizeof(chunk) + chunk.dataSize;
+	index_.push_back(item);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedRecorder::getFrameCount()
+{
+	return index_.size();
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedPlayer::~ofxKuZedPlayer()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPlayer::open(string fileName)
+{
+	close();
+	std::lock_guard<std::mutex> lock(mutex_);
+	file_.open(ofToDataPath(fileName).c_str(), ios::binary);
+	if (!file_.is_open()) {
+		ofLogError() << "ofxKuZedPlayer: can't open file " << fileName << endl;
+		return false;
+	}
+	file_.read((char*)&header_, sizeof(header_));
+	if (!file_.good() || memcmp(header_.magic, recordingMagic, sizeof(recordingMagic)) != 0
+		|| header_.version != recordingVersion) {
+		ofLogError() << "ofxKuZedPlayer: " << fileName << " is not a ZED recording" << endl;
+		file_.close();
+		return false;
+	}
+
+	index_.clear();
+	if (header_.indexOffset > 0) {
+		index_.resize(size_t(header_.frameCount));
+		file_.seekg(std::streamoff(header_.indexOffset));
+		if (!index_.empty()) {
+			file_.read((char*)&index_[0], index_.size() * sizeof(ofxKuZedRecordingIndexItem));
+		}
+		if (!file_.good()) {
+			index_.clear();
+		}
+	}
+	if (index_.empty() && !restoreIndex()) {
+		ofLogError() << "ofxKuZedPlayer: " << fileName << " has no frames" << endl;
+		file_.close();
+		return false;
+	}
+
+	next_ = 0;
+	current_ = -1;
+	steps_ = 0;
+	restartTiming_ = true;
+	frame_.clear();
+	frame_.id = 0;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Scan chunks of the file which was not closed properly
+bool ofxKuZedPlayer::restoreIndex()
+{
+	file_.clear();
+	uint64_t offset = sizeof(header_);
+	ofxKuZedRecordingChunk chunk;
+	while (true) {
+		file_.seekg(std::streamoff(offset));
+		file_.read((char*)&chunk, sizeof(chunk));
+		if (!file_.good() || memcmp(chunk.magic, chunkMagic, sizeof(chunkMagic)) != 0) break;
+		//Skip the last frame if it's incomplete
+		file_.seekg(std::streamoff(offset + sizeof(chunk) + chunk.dataSize - 1));
+		if (chunk.dataSize > 0 && file_.get() == EOF) break;
+		ofxKuZedRecordingIndexItem item;
+		item.offset = offset;
+		item.timestamp = chunk.timestamp;
+		index_.push_back(item);
+		offset += sizeof(chunk) + chunk.dataSize;
+	}
+	file_.clear();
+	return !index_.empty();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPlayer::isOpen()
+{
+	return file_.is_open();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::close()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.is_open()) {
+		file_.close();
+	}
+	index_.clear();
+	frame_.clear();
+	current_ = -1;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::setMode(int mode)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	mode_ = mode;
+	steps_ = 0;
+	restartTiming_ = true;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPlayer::getMode()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return mode_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::setLoop(bool loop)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	loop_ = loop;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::step()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	steps_++;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::seek(int index)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	next_ = ofClamp(index, 0, max(int(index_.size()) - 1, 0));
+	restartTiming_ = true;
+	if (mode_ == ZED_PLAYBACK_STEP) steps_ = 1;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::seekTime(unsigned long long timestamp)
+{
+	int index;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		ofxKuZedRecordingIndexItem item;
+		item.timestamp = timestamp;
+		index = std::lower_bound(index_.begin(), index_.end(), item,
+			[](const ofxKuZedRecordingIndexItem &a, const ofxKuZedRecordingIndexItem &b) {
+			return a.timestamp < b.timestamp;
+		}) - index_.begin();
+	}
+	seek(index);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPlayer::getFrameCount()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return index_.size();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPlayer::getFrameIndex()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return current_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPlayer::isFinished()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !loop_ && next_ >= int(index_.size());
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedPlayer::getFrameTimestamp(int index)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return (index >= 0 && index < int(index_.size())) ? index_[index].timestamp : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPlayer::getWidth()
+{
+	return (file_.is_open()) ? header_.width : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedPlayer::getHeight()
+{
+	return (file_.is_open()) ? header_.height : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZedPlayer::getIntrinsics()
+{
+	ofxKuZedIntrinsics intrinsics;
+	intrinsics.fx = header_.fx;
+	intrinsics.fy = header_.fy;
+	intrinsics.cx = header_.cx;
+	intrinsics.cy = header_.cy;
+	return intrinsics;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPlayer::grab(bool computeDepth, bool computeXYZ)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	int n = index_.size();
+	if (n == 0) return false;
+	if (next_ >= n) {
+		if (!loop_) return false;
+		next_ = 0;
+		restartTiming_ = true;
+	}
+
+	if (mode_ == ZED_PLAYBACK_STEP) {
+		if (steps_ <= 0) return false;
+		steps_--;
+	}
+	if (mode_ == ZED_PLAYBACK_REALTIME) {
+		auto now = std::chrono::steady_clock::now();
+		if (restartTiming_) {
+			restartTiming_ = false;
+			startTime_ = now;
+			startTimestamp_ = index_[next_].timestamp;
+		}
+		//Frame time relative to the playback start, ns
+		long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - startTime_).count();
+		auto due = [&](int i) { return (long long)(index_[i].timestamp - startTimestamp_) <= elapsed; };
+		if (!due(next_)) return false;
+		//Skip late frames
+		while (next_ + 1 < n && due(next_ + 1)) next_++;
+	}
+
+	if (!readFrame(next_)) return false;
+	current_ = next_;
+	next_++;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedPlayer::readFrame(int index)
+{
+	ofxKuZedRecordingChunk chunk;
+	file_.clear();
+	file_.seekg(std::streamoff(index_[index].offset));
+	file_.read((char*)&chunk, sizeof(chunk));
+	if (!file_.good() || memcmp(chunk.magic, chunkMagic, sizeof(chunkMagic)) != 0) {
+		ofLogError() << "ofxKuZedPlayer: can't read frame " << index << endl;
+		return false;
+	}
+	frame_.clear();
+	int w = header_.width;
+	int h = header_.height;
+	for (int i = 0; i < 3; i++) {
+		int c = recordedChannels[i];
+		if (chunk.channels & (1 << c)) {
+			frame_[c].allocate(w, h, ofxKuZedChannelBytesPerPixel(c));
+			file_.read((char*)frame_[c].data, size_t(frame_[c].step) * h);
+		}
+	}
+	if (!file_.good()) {
+		ofLogError() << "ofxKuZedPlayer: can't read frame " << index << endl;
+		frame_.clear();
+		return false;
+	}
+	frame_.id = chunk.id;
+	frame_.timestamp = chunk.timestamp;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedPlayer::retrieve(int channel, ofxKuZedBuffer &buffer)
+{
+	ofxKuZedBuffer &data = frame_[channel];
+	if (data.empty() && (channel == ZED_CHANNEL_XYZ || channel == ZED_CHANNEL_XYZRGBA)) {
+		//Point cloud is computed from depth and left image
+		frame_.computeXyz(channel, header_.fx, header_.fy, header_.cx, header_.cy);
+	}
+	buffer.setView(data.data, data.width, data.height, data.step, data.bytesPerPixel);
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedPlayer::getTimestamp()
+{
+	return frame_.timestamp;
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+#pragma once
+
+//Recording and playing ZED frames: left and right images, depth in mm and timestamps.
+//ofxKuZedPlayer is a frame source, so recorded data goes through all ofxKuZed conversions
+//without camera and GPU. Point cloud is computed from depth using recorded camera parameters.
+//
+//File format (little-endian):
+//  header - ofxKuZedRecordingHeader, 64 bytes
+//  frames - each frame is ofxKuZedRecordingChunk, 32 bytes, followed by its channels
+//           in order left (BGRA), right (BGRA), depth (float), rows are packed
+//  index  - frameCount x ofxKuZedRecordingIndexItem, written by close(), header.indexOffset points to it.
+//           If the file was not closed properly, indexOffset is 0 and the player restores index by scanning chunks.
+
+#include "ofMain.h"
+#include "ofxKuZedSource.h"
+#include <cstdint>
+#include <mutex>
+#include <chrono>
+
+//Playback modes
+const int ZED_PLAYBACK_REALTIME = 0;	//frames are given with recorded timing, late frames are skipped
+const int ZED_PLAYBACK_FAST = 1;		//each grab gives the next frame
+const int ZED_PLAYBACK_STEP = 2;		//frames are given only after step() or seek()
+
+//Channels which can be recorded, as bit mask
+const int ZED_RECORD_LEFT = 1 << ZED_CHANNEL_LEFT;
+const int ZED_RECORD_RIGHT = 1 << ZED_CHANNEL_RIGHT;
+const int ZED_RECORD_DEPTH = 1 << ZED_CHANNEL_DEPTH;
+const int ZED_RECORD_ALL = ZED_RECORD_LEFT | ZED_RECORD_RIGHT | ZED_RECORD_DEPTH;
+
+struct ofxKuZedRecordingHeader {
+	char magic[8];			//"KUZEDREC"
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;		//ZED_RECORD_... mask
+	float fx, fy, cx, cy;	//left camera parameters
+	uint64_t indexOffset;	//0 if there is no index
+	uint64_t frameCount;
+	uint8_t reserved[8];
+};
+
+struct ofxKuZedRecordingChunk {
+	char magic[4];			//"FRME"
+	uint32_t channels;		//channels stored in this frame
+	uint64_t id;
+	uint64_t timestamp;		//ns
+	uint64_t dataSize;		//bytes after the chunk header
+};
+
+struct ofxKuZedRecordingIndexItem {
+	uint64_t offset;		//chunk position in file
+	uint64_t timestamp;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofxKuZedRecorder
+{
+public:
+	~ofxKuZedRecorder();
+
+	//Create file, channels - ZED_RECORD_... mask. Returns false on error
+	bool open(string fileName, int width, int height, ofxKuZedIntrinsics intrinsics, int channels = ZED_RECORD_ALL);
+	void close();	//writes index
+	bool isOpen();
+
+	//Write recorded channels of the frame, empty channels are skipped
+	bool write(const ofxKuZedFrame &frame);
+	int getFrameCount();
+
+private:
+	ofstream file_;
+	ofxKuZedRecordingHeader header_;
+	vector<ofxKuZedRecordingIndexItem> index_;
+	uint64_t offset_ = 0;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofxKuZedPlayer : public ofxKuZedSource
+{
+public:
+	~ofxKuZedPlayer();
+
+	bool open(string fileName);		//returns false on error
+	bool isOpen();
+
+	//Playback control, can be called while the capture thread grabs frames
+	void setMode(int mode);		//ZED_PLAYBACK_REALTIME, ZED_PLAYBACK_FAST, ZED_PLAYBACK_STEP
+	int getMode();
+	void setLoop(bool loop);	//default: true
+	void step();				//give the next frame in ZED_PLAYBACK_STEP mode
+	void seek(int index);		//the next grab gives this frame
+	void seekTime(unsigned long long timestamp);	//seek to the first frame with timestamp >= given, ns
+	int getFrameCount();
+	int getFrameIndex();		//index of the last grabbed frame, -1 if no frames were grabbed
+	bool isFinished();			//the last frame is reached and looping is off
+	unsigned long long getFrameTimestamp(int index);
+
+	//ofxKuZedSource
+	void close();
+	int getWidth();
+	int getHeight();
+	ofxKuZedIntrinsics getIntrinsics();
+	bool grab(bool computeDepth, bool computeXYZ);
+	void retrieve(int channel, ofxKuZedBuffer &buffer);
+	unsigned long long getTimestamp();
+
+private:
+	ifstream file_;
+	ofxKuZedRecordingHeader header_;
+	vector<ofxKuZedRecordingIndexItem> index_;
+	bool restoreIndex();
+	bool readFrame(int index);
+
+	std::mutex mutex_;
+	int mode_ = ZED_PLAYBACK_REALTIME;
+	bool loop_ = true;
+	int next_ = 0;			//frame for the next grab
+	int current_ = -1;		//last grabbed frame
+	int steps_ = 0;			//requested steps in ZED_PLAYBACK_STEP mode
+
+	//Timing of ZED_PLAYBACK_REALTIME: frame with timestamp startTimestamp_ is played at startTime_
+	bool restartTiming_ = true;
+	std::chrono::steady_clock::time_point startTime_;
+	unsigned long long startTimestamp_ = 0;
+
+	ofxKuZedFrame frame_;	//left, right, depth are read from file, XYZ are computed by request
+};
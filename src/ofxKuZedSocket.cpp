@@ -0,0 +1,267 @@
+#include "ofxKuZedSocket.h"
+
+#ifdef TARGET_WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef SOCKET SocketHandle;
+typedef int SocketLength;
+static const intptr_t noSocket = intptr_t(INVALID_SOCKET);
+static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+typedef int SocketHandle;
+typedef socklen_t SocketLength;
+static const intptr_t noSocket = -1;
+static void closeSocket(SocketHandle s) { ::close(s); }
+#endif
+
+//------------------------------------------------------------------------------------------------------
+static void initSockets()
+{
+#ifdef TARGET_WIN32
+	static bool initialized = false;
+	if (!initialized) {
+		WSADATA data;
+		WSAStartup(MAKEWORD(2, 2), &data);
+		initialized = true;
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------------------------------
+static bool waitSocket(intptr_t s, bool write, int timeoutMs)
+{
+	fd_set set;
+	FD_ZERO(&set);
+	FD_SET(SocketHandle(s), &set);
+	timeval tv;
+	tv.tv_sec = timeoutMs / 1000;
+	tv.tv_usec = (timeoutMs % 1000) * 1000;
+	int n = select(int(s) + 1, (write) ? 0 : &set, (write) ? &set : 0, 0, &tv);
+	return n > 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+static sockaddr_in toSockaddr(const ofxKuZedAddress &address)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = address.ip;
+	addr.sin_port = htons(address.port);
+	return addr;
+}
+
+//------------------------------------------------------------------------------------------------------
+string ofxKuZedAddress::toString() const
+{
+	const unsigned char *b = (const unsigned char *)&ip;
+	return ofToString(int(b[0])) + "." + ofToString(int(b[1])) + "." + ofToString(int(b[2])) + "." + ofToString(int(b[3]))
+		+ ":" + ofToString(port);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedSocket::ofxKuZedSocket()
+{
+	socket_ = noSocket;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedSocket::~ofxKuZedSocket()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::listen(int port, bool udp)
+{
+	close();
+	initSockets();
+	udp_ = udp;
+	SocketHandle s = socket(AF_INET, (udp) ? SOCK_DGRAM : SOCK_STREAM, (udp) ? IPPROTO_UDP : IPPROTO_TCP);
+	if (intptr_t(s) == noSocket) return false;
+	int reuse = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+	ofxKuZedAddress any;
+	any.ip = htonl(INADDR_ANY);
+	any.port = port;
+	sockaddr_in addr = toSockaddr(any);
+	if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0 || (!udp && ::listen(s, 8) != 0)) {
+		closeSocket(s);
+		return false;
+	}
+	socket_ = intptr_t(s);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::connect(string host, int port, bool udp, int timeoutMs)
+{
+	close();
+	initSockets();
+	udp_ = udp;
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = (udp) ? SOCK_DGRAM : SOCK_STREAM;
+	addrinfo *info = 0;
+	if (getaddrinfo(host.c_str(), ofToString(port).c_str(), &hints, &info) != 0 || !info) {
+		return false;
+	}
+	SocketHandle s = socket(AF_INET, hints.ai_socktype, (udp) ? IPPROTO_UDP : IPPROTO_TCP);
+	if (intptr_t(s) == noSocket) {
+		freeaddrinfo(info);
+		return false;
+	}
+
+	//Non-blocking connect with timeout
+#ifdef TARGET_WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	bool ok = (::connect(s, info->ai_addr, SocketLength(info->ai_addrlen)) == 0);
+	freeaddrinfo(info);
+	if (!ok && waitSocket(intptr_t(s), true, timeoutMs)) {
+		int error = 0;
+		SocketLength length = sizeof(error);
+		getsockopt(s, SOL_SOCKET, SO_ERROR, (char *)&error, &length);
+		ok = (error == 0);
+	}
+#ifdef TARGET_WIN32
+	nonBlocking = 0;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) & ~O_NONBLOCK);
+#endif
+	if (!ok) {
+		closeSocket(s);
+		return false;
+	}
+	socket_ = intptr_t(s);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::accept(ofxKuZedSocket &client)
+{
+	if (!isOpen()) return false;
+	client.close();
+	SocketHandle s = ::accept(SocketHandle(socket_), 0, 0);
+	if (intptr_t(s) == noSocket) return false;
+	client.socket_ = intptr_t(s);
+	client.udp_ = false;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSocket::close()
+{
+	if (isOpen()) {
+		closeSocket(SocketHandle(socket_));
+		socket_ = noSocket;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::isOpen() const
+{
+	return socket_ != noSocket;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::wait(int timeoutMs)
+{
+	return isOpen() && waitSocket(socket_, false, timeoutMs);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::sendAll(const void *data, size_t size)
+{
+	const char *p = (const char *)data;
+	while (size > 0 && isOpen()) {
+		int chunk = int(min(size, size_t(1 << 20)));
+#ifdef MSG_NOSIGNAL
+		int n = ::send(SocketHandle(socket_), p, chunk, MSG_NOSIGNAL);
+#else
+		int n = ::send(SocketHandle(socket_), p, chunk, 0);
+#endif
+		if (n <= 0) return false;
+		p += n;
+		size -= n;
+	}
+	return size == 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::receiveAll(void *data, size_t size, int timeoutMs)
+{
+	char *p = (char *)data;
+	while (size > 0 && isOpen()) {
+		if (!waitSocket(socket_, false, timeoutMs)) return false;
+		int n = recv(SocketHandle(socket_), p, int(min(size, size_t(1 << 20))), 0);
+		if (n <= 0) return false;	//closed or error
+		p += n;
+		size -= n;
+	}
+	return size == 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::send(const void *data, size_t size)
+{
+	return isOpen() && ::send(SocketHandle(socket_), (const char *)data, int(size), 0) == int(size);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSocket::sendTo(const void *data, size_t size, const ofxKuZedAddress &address)
+{
+	if (!isOpen()) return false;
+	sockaddr_in addr = toSockaddr(address);
+	return sendto(SocketHandle(socket_), (const char *)data, int(size), 0, (sockaddr *)&addr, sizeof(addr)) == int(size);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedSocket::receiveFrom(void *data, size_t size, ofxKuZedAddress &address)
+{
+	if (!isOpen()) return -1;
+	sockaddr_in addr;
+	SocketLength length = sizeof(addr);
+	int n = recvfrom(SocketHandle(socket_), (char *)data, int(size), 0, (sockaddr *)&addr, &length);
+	if (n < 0) return -1;
+	address.ip = addr.sin_addr.s_addr;
+	address.port = ntohs(addr.sin_port);
+	return n;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSocket::setBufferSizes(int bytes)
+{
+	if (!isOpen()) return;
+	setsockopt(SocketHandle(socket_), SOL_SOCKET, SO_SNDBUF, (const char *)&bytes, sizeof(bytes));
+	setsockopt(SocketHandle(socket_), SOL_SOCKET, SO_RCVBUF, (const char *)&bytes, sizeof(bytes));
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSocket::setNoDelay(bool noDelay)
+{
+	if (!isOpen() || udp_) return;
+	int value = noDelay;
+	setsockopt(SocketHandle(socket_), IPPROTO_TCP, TCP_NODELAY, (const char *)&value, sizeof(value));
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+#pragma once
+
+//Minimal IPv4 TCP/UDP socket for ofxKuZedStream, on Winsock or BSD sockets.
+//Sockets are blocking, waiting is done with wait() and timeouts, so threads can check if they should stop.
+
+#include "ofMain.h"
+#include <cstdint>
+
+struct ofxKuZedAddress {
+	uint32_t ip = 0;	//network byte order
+	uint16_t port = 0;	//host byte order
+
+	bool operator==(const ofxKuZedAddress &a) const { return ip == a.ip && port == a.port; }
+	string toString() const;
+};
+
+class ofxKuZedSocket
+{
+public:
+	ofxKuZedSocket();
+	~ofxKuZedSocket();
+
+	bool listen(int port, bool udp);		//TCP: bind and listen, UDP: bind
+	bool connect(string host, int port, bool udp, int timeoutMs = 2000);	//UDP: set default destination
+	bool accept(ofxKuZedSocket &client);	//call after wait() returned true
+	void close();
+	bool isOpen() const;
+
+	//Wait until data (or connection for listening socket) is available
+	bool wait(int timeoutMs);
+
+	//TCP: send or receive all bytes. Receiving fails if nothing arrives during timeoutMs
+	bool sendAll(const void *data, size_t size);
+	bool receiveAll(void *data, size_t size, int timeoutMs);
+
+	//UDP
+	bool send(const void *data, size_t size);	//to connected address
+	bool sendTo(const void *data, size_t size, const ofxKuZedAddress &address);
+	int receiveFrom(void *data, size_t size, ofxKuZedAddress &address);	//returns size or -1
+
+	void setBufferSizes(int bytes);		//kernel send and receive buffers
+	void setNoDelay(bool noDelay);		//TCP_NODELAY
+
+private:
+	intptr_t socket_;
+	bool udp_ = false;
+
+	ofxKuZedSocket(const ofxKuZedSocket &);
+	ofxKuZedSocket &operator=(const ofxKuZedSocket &);
+};
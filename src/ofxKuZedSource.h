@@ -0,0 +1,38 @@
+#pragma once
+
+//Source of frames for ofxKuZed: live ZED camera (ofxKuZedCameraSource), recording (ofxKuZedPlayer),
+//network stream (ofxKuZedStreamClient) or synthetic scene (ofxKuZedSyntheticSource).
+//ofxKuZed grabs frames and retrieves channels only through this interface,
+//so conversions work the same way for camera and for recorded data.
+
+#include "ofMain.h"
+#include "ofxKuZedFrame.h"
+
+//Pinhole parameters of the left camera, in pixels
+struct ofxKuZedIntrinsics {
+	float fx = 0;
+	float fy = 0;
+	float cx = 0;
+	float cy = 0;
+};
+
+class ofxKuZedSource
+{
+public:
+	virtual ~ofxKuZedSource() {}
+
+	virtual void close() = 0;
+	virtual int getWidth() = 0;
+	virtual int getHeight() = 0;
+	virtual ofxKuZedIntrinsics getIntrinsics() = 0;
+
+	//Grab the next frame. Returns true if a new frame was obtained.
+	//It can be called from the capture thread
+	virtual bool grab(bool computeDepth, bool computeXYZ) = 0;
+
+	//View of channel of the last grabbed frame, valid until the next grab
+	virtual void retrieve(int channel, ofxKuZedBuffer &buffer) = 0;
+
+	//Timestamp of the last grabbed frame, ns
+	virtual unsigned long long getTimestamp() = 0;
+};
@@ -0,0 +1,328 @@
+#include "ofxKuZedSpatialFilter.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OFXKUZED_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define OFXKUZED_TARGET(isa)
+#else
+#define OFXKUZED_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+typedef ofxKuZedSpatialFilter::WindowParams WindowParams;
+typedef ofxKuZedSpatialFilter::Tap Tap;
+
+static const int columnBlock = 64;	//columns in a block of vertical hole filling
+
+//------------------------------------------------------------------------------------------------------
+static inline bool validDepth(float d)
+{
+	return (d > 0) & (d <= std::numeric_limits<float>::max());	//false for NaN and inf
+}
+
+//------------------------------------------------------------------------------------------------------
+//Window pass for pixels [x0, x1) of a row. All versions do the same operations in the same order,
+//so they give the same results. Taps outside the row are skipped
+static void windowScalar(const float *center, const Tap *taps, int tapCount, float *dst, int x0, int x1, int w,
+	const WindowParams &p)
+{
+	for (int x = x0; x < x1; x++) {
+		float c = center[x];
+		if (!validDepth(c)) {
+			dst[x] = 0;
+			continue;
+		}
+		float thr = p.mm + p.fraction * c;
+		float sum = 0;
+		float n = 0;
+		for (int i = 0; i < tapCount; i++) {
+			int xx = x + taps[i].dx;
+			if (xx < 0 || xx >= w) continue;
+			float v = taps[i].row[xx];
+			bool ok = validDepth(v) & (fabsf(v - c) <= thr);
+			sum += (ok) ? v : 0;
+			n += (ok) ? 1 : 0;
+		}
+		if (p.average) dst[x] = sum / n;	//n >= 1, because center is a tap
+		else dst[x] = (n >= p.minNeighbours) ? c : 0;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//Pixels [x0, x1) for which all taps are inside the row, returns the first unprocessed x
+OFXKUZED_TARGET("sse2")
+static int windowSSE2(const float *center, const Tap *taps, int tapCount, float *dst, int x0, int x1, const WindowParams &p)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 maxFloat = _mm_set1_ps(std::numeric_limits<float>::max());
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 mm = _mm_set1_ps(p.mm);
+	const __m128 fraction = _mm_set1_ps(p.fraction);
+	const __m128 minNeighbours = _mm_set1_ps(p.minNeighbours);
+	int x = x0;
+	for (; x + 4 <= x1; x += 4) {
+		__m128 c = _mm_loadu_ps(center + x);
+		__m128 valid = _mm_and_ps(_mm_cmpgt_ps(c, zero), _mm_cmple_ps(c, maxFloat));
+		__m128 thr = _mm_add_ps(mm, _mm_mul_ps(fraction, c));
+		__m128 sum = zero;
+		__m128 n = zero;
+		for (int i = 0; i < tapCount; i++) {
+			__m128 v = _mm_loadu_ps(taps[i].row + x + taps[i].dx);
+			__m128 ok = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(v, zero), _mm_cmple_ps(v, maxFloat)),
+				_mm_cmple_ps(_mm_and_ps(_mm_sub_ps(v, c), absMask), thr));
+			sum = _mm_add_ps(sum, _mm_and_ps(ok, v));
+			n = _mm_add_ps(n, _mm_and_ps(ok, one));
+		}
+		__m128 result = (p.average) ? _mm_div_ps(sum, n) : _mm_and_ps(_mm_cmpge_ps(n, minNeighbours), c);
+		_mm_storeu_ps(dst + x, _mm_and_ps(valid, result));
+	}
+	return x;
+}
+
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("avx2")
+static int windowAVX2(const float *center, const Tap *taps, int tapCount, float *dst, int x0, int x1, const WindowParams &p)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 maxFloat = _mm256_set1_ps(std::numeric_limits<float>::max());
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 mm = _mm256_set1_ps(p.mm);
+	const __m256 fraction = _mm256_set1_ps(p.fraction);
+	const __m256 minNeighbours = _mm256_set1_ps(p.minNeighbours);
+	int x = x0;
+	for (; x + 8 <= x1; x += 8) {
+		__m256 c = _mm256_loadu_ps(center + x);
+		__m256 valid = _mm256_and_ps(_mm256_cmp_ps(c, zero, _CMP_GT_OQ), _mm256_cmp_ps(c, maxFloat, _CMP_LE_OQ));
+		__m256 thr = _mm256_add_ps(mm, _mm256_mul_ps(fraction, c));
+		__m256 sum = zero;
+		__m256 n = zero;
+		for (int i = 0; i < tapCount; i++) {
+			__m256 v = _mm256_loadu_ps(taps[i].row + x + taps[i].dx);
+			__m256 ok = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GT_OQ), _mm256_cmp_ps(v, maxFloat, _CMP_LE_OQ)),
+				_mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(v, c), absMask), thr, _CMP_LE_OQ));
+			sum = _mm256_add_ps(sum, _mm256_and_ps(ok, v));
+			n = _mm256_add_ps(n, _mm256_and_ps(ok, one));
+		}
+		__m256 result = (p.average) ? _mm256_div_ps(sum, n) : _mm256_and_ps(_mm256_cmp_ps(n, minNeighbours, _CMP_GE_OQ), c);
+		_mm256_storeu_ps(dst + x, _mm256_and_ps(valid, result));
+	}
+	return windowSSE2(center, taps, tapCount, dst, x, x1, p);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+//Border pixels are processed by scalar version, inner ones by SIMD
+static void windowRow(const float *center, const Tap *taps, int tapCount, int rx, float *dst, int w, const WindowParams &p)
+{
+	int x0 = std::min(rx, w);
+	int x1 = std::max(w - rx, x0);
+	windowScalar(center, taps, tapCount, dst, 0, x0, w, p);
+	int x = x0;
+#ifdef OFXKUZED_X86
+	switch (ofxKuZedConvert::simd()) {
+	case ofxKuZedConvert::SIMD_AVX2: x = windowAVX2(center, taps, tapCount, dst, x0, x1, p);
+		break;
+	case ofxKuZedConvert::SIMD_SSSE3: x = windowSSE2(center, taps, tapCount, dst, x0, x1, p);
+		break;
+	}
+#endif
+	windowScalar(center, taps, tapCount, dst, x, w, w, p);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Fill run of invalid pixels between valid a and b (indices with stride)
+static inline void fillRun(float *data, int stride, int a, int b, float mm, float fraction)
+{
+	float l = data[a * stride];
+	float r = data[b * stride];
+	bool close = fabsf(l - r) <= mm + fraction * std::min(l, r);
+	float farther = std::max(l, r);
+	float k = (r - l) / (b - a);
+	for (int i = a + 1; i < b; i++) {
+		data[i * stride] = (close) ? l + k * (i - a) : farther;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::setStages(const std::vector<int> &stages)
+{
+	stages_ = stages;
+}
+
+//------------------------------------------------------------------------------------------------------
+const std::vector<int> &ofxKuZedSpatialFilter::getStages() const
+{
+	return stages_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::setEdgeThreshold(float mm, float fraction)
+{
+	edgeMm_ = mm;
+	edgeFraction_ = fraction;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::setSmoothing(int radius)
+{
+	smoothRadius_ = std::max(radius, 0);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::setSpeckles(int radius, int minNeighbours)
+{
+	speckleRadius_ = std::max(radius, 0);
+	speckleMinNeighbours_ = minNeighbours;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::setHoleFilling(int maxHole)
+{
+	maxHole_ = std::max(maxHole, 0);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::copySettings(const ofxKuZedSpatialFilter &filter)
+{
+	stages_ = filter.stages_;	//keeps capacity, so it doesn't allocate each frame
+	edgeMm_ = filter.edgeMm_;
+	edgeFraction_ = filter.edgeFraction_;
+	smoothRadius_ = filter.smoothRadius_;
+	speckleRadius_ = filter.speckleRadius_;
+	speckleMinNeighbours_ = filter.speckleMinNeighbours_;
+	maxHole_ = filter.maxHole_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::windowPass(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h,
+	int rx, int ry, bool skipCenter, const WindowParams &params)
+{
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		std::vector<Tap> taps;
+		taps.reserve((2 * rx + 1) * (2 * ry + 1));
+		for (int y = y0; y < y1; y++) {
+			taps.clear();
+			for (int dy = -ry; dy <= ry; dy++) {
+				int yy = y + dy;
+				if (yy < 0 || yy >= h) continue;
+				for (int dx = -rx; dx <= rx; dx++) {
+					if (skipCenter && dx == 0 && dy == 0) continue;
+					Tap tap;
+					tap.row = (const float *)(src + size_t(srcStep) * yy);
+					tap.dx = dx;
+					taps.push_back(tap);
+				}
+			}
+			windowRow((const float *)(src + size_t(srcStep) * y), (taps.empty()) ? 0 : &taps[0], int(taps.size()), rx,
+				(float *)(dst + size_t(dstStep) * y), w, params);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::fillHoles(unsigned char *depth, int depthStep, int w, int h)
+{
+	int maxHole = maxHole_;
+	float mm = edgeMm_;
+	float fraction = edgeFraction_;
+
+	//Horizontal runs
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			float *row = (float *)(depth + size_t(depthStep) * y);
+			int last = -1;
+			for (int x = 0; x < w; x++) {
+				if (!validDepth(row[x])) continue;
+				int run = x - last - 1;
+				if (last >= 0 && run > 0 && run <= maxHole) fillRun(row, 1, last, x, mm, fraction);
+				last = x;
+			}
+		}
+	});
+
+	//Vertical runs, by blocks of columns so rows are read sequentially.
+	//Step in floats is used as stride, depth rows are float-aligned
+	int stride = depthStep / sizeof(float);
+	int blocks = (w + columnBlock - 1) / columnBlock;
+	ofxKuZedWorkers::shared().parallelRows(blocks, [&](int b0, int b1) {
+		std::vector<int> last(columnBlock);
+		for (int b = b0; b < b1; b++) {
+			int x0 = b * columnBlock;
+			int x1 = std::min(x0 + columnBlock, w);
+			std::fill(last.begin(), last.end(), -1);
+			for (int y = 0; y < h; y++) {
+				float *row = (float *)(depth + size_t(depthStep) * y);
+				for (int x = x0; x < x1; x++) {
+					if (!validDepth(row[x])) continue;
+					int &l = last[x - x0];
+					int run = y - l - 1;
+					if (l >= 0 && run > 0 && run <= maxHole) {
+						fillRun((float *)depth + x, stride, l, y, mm, fraction);
+					}
+					l = y;
+				}
+			}
+		}
+	}, 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSpatialFilter::apply(unsigned char *depth, int depthStep, int w, int h)
+{
+	if (!depth || w <= 0 || h <= 0) return;
+	if (w != w_ || h != h_) {
+		w_ = w;
+		h_ = h;
+		buffer_.assign(size_t(w) * h, 0.0f);
+	}
+
+	//Passes go between depth and buffer_, cur is the current result
+	unsigned char *cur = depth;
+	int curStep = depthStep;
+	unsigned char *other = (unsigned char *)&buffer_[0];
+	int otherStep = w * sizeof(float);
+
+	WindowParams params;
+	params.mm = edgeMm_;
+	params.fraction = edgeFraction_;
+	params.minNeighbours = float(speckleMinNeighbours_);
+
+	for (size_t i = 0; i < stages_.size(); i++) {
+		switch (stages_[i]) {
+		case SMOOTH:
+			if (smoothRadius_ > 0) {
+				params.average = true;
+				windowPass(cur, curStep, other, otherStep, w, h, smoothRadius_, 0, false, params);
+				windowPass(other, otherStep, cur, curStep, w, h, 0, smoothRadius_, false, params);
+			}
+			break;
+		case REMOVE_SPECKLES:
+			if (speckleRadius_ > 0) {
+				params.average = false;
+				windowPass(cur, curStep, other, otherStep, w, h, speckleRadius_, speckleRadius_, true, params);
+				std::swap(cur, other);
+				std::swap(curStep, otherStep);
+			}
+			break;
+		case FILL_HOLES:
+			if (maxHole_ > 0) {
+				fillHoles(cur, curStep, w, h);
+			}
+			break;
+		}
+	}
+	if (cur != depth) {
+		ofxKuZedConvert::copyRows(cur, curStep, depth, depthStep, w * sizeof(float), h);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
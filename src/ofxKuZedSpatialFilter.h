@@ -0,0 +1,72 @@
+#pragma once
+
+//Spatial post-processing of depth on CPU, an alternative to SDK postprocessing mode FILL:
+//- SMOOTH: separable edge-preserving smoothing. Horizontal and then vertical average over radius,
+//  taking only neighbours which are close to the center by depth, so object borders are not blurred.
+//- REMOVE_SPECKLES: pixel is removed (set to 0) if it has less than minNeighbours close neighbours
+//  in its (2 * radius + 1)^2 window. It removes small isolated blobs, typical for stereo matching errors.
+//- FILL_HOLES: horizontal and then vertical runs of invalid pixels not longer than maxHole, bounded by valid pixels,
+//  are filled: linearly if both ends are close by depth, else with the farther value, so foreground is not extended.
+//Stages are applied in selectable order. Neighbours are close if |d - center| <= mm + fraction * center.
+//Window passes use SIMD, rows are split into bands by ofxKuZedWorkers::shared(), each band keeps its
+//window rows in cache; vertical hole filling is done in blocks of columns.
+//Filtering is in-place, intermediate buffer is allocated when frame size is changed.
+//Invalid depth (NaN, inf, <= 0) can become 0.
+
+#include <vector>
+
+class ofxKuZedSpatialFilter
+{
+public:
+	enum Stage {
+		SMOOTH = 0,
+		REMOVE_SPECKLES = 1,
+		FILL_HOLES = 2
+	};
+
+	//Order of stages, a stage can be used several times
+	void setStages(const std::vector<int> &stages);	//default: REMOVE_SPECKLES, FILL_HOLES, SMOOTH
+	const std::vector<int> &getStages() const;
+
+	//Depth difference for neighbours treated as the same surface
+	void setEdgeThreshold(float mm, float fraction);	//default: 30, 0.02
+
+	void setSmoothing(int radius);						//default: 2, 0 - stage is skipped
+	void setSpeckles(int radius, int minNeighbours);	//default: 1, 3
+	void setHoleFilling(int maxHole);					//default: 8 pixels, 0 - stage is skipped
+
+	//Take settings and stages of another filter, e.g. for passing settings to another thread
+	void copySettings(const ofxKuZedSpatialFilter &filter);
+
+	//Filter depth in mm (float, step - row size in bytes) in-place
+	void apply(unsigned char *depth, int depthStep, int w, int h);
+
+	//Parameters of window passes, used by SIMD versions
+	struct WindowParams {
+		float mm;
+		float fraction;
+		bool average;			//true - average of close neighbours, false - count them and remove speckles
+		float minNeighbours;
+	};
+	struct Tap {
+		const float *row;
+		int dx;
+	};
+
+private:
+	std::vector<int> stages_ = { REMOVE_SPECKLES, FILL_HOLES, SMOOTH };
+	float edgeMm_ = 30;
+	float edgeFraction_ = 0.02f;
+	int smoothRadius_ = 2;
+	int speckleRadius_ = 1;
+	int speckleMinNeighbours_ = 3;
+	int maxHole_ = 8;
+
+	int w_ = 0;
+	int h_ = 0;
+	std::vector<float> buffer_;		//intermediate image, w * h
+
+	void windowPass(const unsigned char *src, int srcStep, unsigned char *dst, int dstStep, int w, int h,
+		int rx, int ry, bool skipCenter, const WindowParams &params);
+	void fillHoles(unsigned char *depth, int depthStep, int w, int h);
+};
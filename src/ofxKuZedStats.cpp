@@ -0,0 +1,238 @@
+#include "ofxKuZedStats.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedHistogram::ofxKuZedHistogram()
+{
+	samples_.resize(WINDOW, 0);
+	bins_.resize(BINS, 0);
+}
+
+//------------------------------------------------------------------------------------------------------
+//Bin of value: octave by exponent, then SUBBINS linear steps inside the octave
+int ofxKuZedHistogram::bin(unsigned long long ns)
+{
+	int e = 0;
+	double m = std::frexp(double(std::max(ns, 1ULL)), &e);	//ns = m * 2^e, m in [0.5, 1)
+	int b = e * SUBBINS + int((m - 0.5) * (2 * SUBBINS));
+	return std::min(b, BINS - 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+double ofxKuZedHistogram::binCenter(int bin)
+{
+	int e = bin / SUBBINS;
+	int sub = bin % SUBBINS;
+	return std::ldexp(1.0 + (sub + 0.5) / SUBBINS, e - 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedHistogram::add(unsigned long long ns)
+{
+	if (count_ == WINDOW) {
+		unsigned long long old = samples_[next_];
+		bins_[bin(old)]--;
+		sum_ -= old;
+	}
+	else {
+		count_++;
+	}
+	samples_[next_] = ns;
+	bins_[bin(ns)]++;
+	sum_ += ns;
+	next_ = (next_ + 1) % WINDOW;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedHistogram::clear()
+{
+	std::fill(bins_.begin(), bins_.end(), 0);
+	next_ = 0;
+	count_ = 0;
+	sum_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedHistogram::size() const
+{
+	return count_;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Center of bin containing sample of rank ceil(p * count)
+double ofxKuZedHistogram::percentile(double p) const
+{
+	if (count_ == 0) return 0;
+	int rank = std::max(1, std::min(count_, int(std::ceil(p * count_))));
+	int seen = 0;
+	for (int i = 0; i < BINS; i++) {
+		seen += bins_[i];
+		if (seen >= rank) return binCenter(i) * 1e-6;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedHistogram::Summary ofxKuZedHistogram::summary() const
+{
+	Summary s;
+	s.count = count_;
+	if (count_ == 0) return s;
+	s.mean = double(sum_) / count_ * 1e-6;
+	s.p50 = percentile(0.50);
+	s.p95 = percentile(0.95);
+	s.p99 = percentile(0.99);
+	unsigned long long maxNs = 0;
+	for (int i = 0; i < count_; i++) maxNs = std::max(maxNs, samples_[i]);
+	s.max = maxNs * 1e-6;
+	return s;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStats::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStats::setEnabled(bool enabled)
+{
+	enabled_ = enabled;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStats::isEnabled() const
+{
+	return enabled_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStats::reset()
+{
+	for (int i = 0; i < ZED_STAT_COUNT; i++) stats_[i].clear();
+	period_ = 0;
+	frames_ = 0;
+	dropped_ = 0;
+	lastId_ = 0;
+	lastTimestamp_ = 0;
+	lastHostTime_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStats::setNominalFps(float fps)
+{
+	nominalFps_ = std::max(fps, 0.0f);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStats::add(int stat, unsigned long long ns)
+{
+	if (enabled_ && stat >= 0 && stat < ZED_STAT_COUNT) stats_[stat].add(ns);
+}
+
+//------------------------------------------------------------------------------------------------------
+const ofxKuZedHistogram &ofxKuZedStats::get(int stat) const
+{
+	return stats_[std::max(0, std::min(stat, ZED_STAT_COUNT - 1))];
+}
+
+//------------------------------------------------------------------------------------------------------
+const char *ofxKuZedStats::name(int stat)
+{
+	static const char *names[ZED_STAT_COUNT] = {
+		"frame interval", "grab", "frame age", "update", "extractFrame",
+		"depth mm", "depth grayscale", "depth texture", "left pixels", "left texture",
+		"right pixels", "right texture", "point cloud", "point cloud data", "point cloud lod", "mesh"
+	};
+	return (stat >= 0 && stat < ZED_STAT_COUNT) ? names[stat] : "";
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStats::addFrame(unsigned long long id, unsigned long long timestamp, unsigned long long hostTime)
+{
+	if (!enabled_) return;
+	frames_++;
+	//Frames grabbed since the previous one, more than 1 if capture thread replaced frames
+	unsigned long long grabbed = (lastId_ > 0 && id > lastId_) ? id - lastId_ : 1;
+	dropped_ += grabbed - 1;
+
+	bool camera = (timestamp > lastTimestamp_ && lastTimestamp_ > 0);
+	unsigned long long interval = 0;
+	if (camera) interval = timestamp - lastTimestamp_;
+	else if (timestamp == 0 && hostTime > lastHostTime_ && lastHostTime_ > 0) interval = hostTime - lastHostTime_;
+	if (interval > 0) {
+		//Frames expected by camera period, missing ones are skipped by camera or SDK.
+		//Estimated period follows intervals which are not gaps
+		unsigned long long frames = grabbed;
+		if (camera) {
+			double period = (nominalFps_ > 0) ? 1e9 / nominalFps_ : period_;
+			long long expected = (period > 0) ? std::llround(interval / period) : 0;
+			if (expected > (long long)grabbed) {
+				dropped_ += expected - grabbed;
+				frames = expected;
+			}
+			double perFrame = double(interval) / grabbed;
+			if (period_ == 0) period_ = perFrame;
+			else if (perFrame < 1.5 * period_) period_ += 0.1 * (perFrame - period_);
+		}
+		stats_[ZED_STAT_FRAME_INTERVAL].add(interval / frames);
+	}
+	lastId_ = id;
+	lastTimestamp_ = timestamp;
+	lastHostTime_ = hostTime;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStats::getFrames() const
+{
+	return frames_;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStats::getDroppedFrames() const
+{
+	return dropped_;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedStats::getFps() const
+{
+	double mean = stats_[ZED_STAT_FRAME_INTERVAL].summary().mean;
+	return (mean > 0) ? float(1000.0 / mean) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+std::string ofxKuZedStats::report() const
+{
+	char line[200];
+	snprintf(line, sizeof(line), "fps %.1f, frames %llu, dropped %llu\n", getFps(), frames_, dropped_);
+	std::string s = line;
+	snprintf(line, sizeof(line), "%-18s %6s %9s %9s %9s %9s %9s\n", "ms", "count", "mean", "p50", "p95", "p99", "max");
+	s += line;
+	for (int i = 0; i < ZED_STAT_COUNT; i++) {
+		ofxKuZedHistogram::Summary h = stats_[i].summary();
+		if (h.count == 0) continue;
+		snprintf(line, sizeof(line), "%-18s %6d %9.3f %9.3f %9.3f %9.3f %9.3f\n", name(i), h.count, h.mean, h.p50, h.p95, h.p99, h.max);
+		s += line;
+	}
+	return s;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStats::Probe::Probe(ofxKuZedStats &stats, int stat)
+{
+	stats_ = (stats.isEnabled()) ? &stats : 0;
+	stat_ = stat;
+	start_ = (stats_) ? now() : 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStats::Probe::~Probe()
+{
+	if (stats_) stats_->add(stat_, now() - start_);
+}
+
+//------------------------------------------------------------------------------------------------------
@@ -0,0 +1,117 @@
+#pragma once
+
+//Timing instrumentation of ofxKuZed: durations of grabbing and conversions, frame intervals, measured fps
+//and dropped frames. Each measured value keeps the last WINDOW samples in a ring, together with their
+//histogram with 8 logarithmic bins per octave, so adding a sample is O(1) and percentiles are read
+//from the histogram with relative error below 1/16. A probe is two reads of steady clock and one
+//add() (tens of nanoseconds), so stats can stay enabled in production.
+//Samples should be added from one thread: ofxKuZed stores grab time of the capture thread in the frame
+//and adds it in update().
+
+#include <vector>
+#include <string>
+
+//Measured values, see ofxKuZed::getStats()
+enum ofxKuZedStat {
+	ZED_STAT_FRAME_INTERVAL = 0,	//between camera timestamps of consecutive frames (host times if there are no timestamps)
+	ZED_STAT_GRAB,					//grab() of the source: waiting for frame and computing depth
+	ZED_STAT_FRAME_AGE,				//from the end of grab() to update() which takes the frame
+	ZED_STAT_UPDATE,				//update(): grabbing in non-threaded mode, filters, recording and streaming
+	ZED_STAT_EXTRACT,				//extractFrame()
+	ZED_STAT_DEPTH_MM,				//getDepthPixels_mm()
+	ZED_STAT_DEPTH_GRAYSCALE,		//getDepthPixels_grayscale()
+	ZED_STAT_DEPTH_TEXTURE,			//getDepthTexture()
+	ZED_STAT_LEFT_PIXELS,			//getLeftPixels()
+	ZED_STAT_LEFT_TEXTURE,			//getLeftTexture()
+	ZED_STAT_RIGHT_PIXELS,			//getRightPixels()
+	ZED_STAT_RIGHT_TEXTURE,			//getRightTexture()
+	ZED_STAT_POINTCLOUD,			//getPointCloud(), getPointCloudColors()
+	ZED_STAT_POINTCLOUD_DATA,		//getPointCloudData()
+	ZED_STAT_POINTCLOUD_LOD,		//getPointCloudLod()
+	ZED_STAT_MESH,					//getMesh()
+	ZED_STAT_COUNT
+};
+
+//Rolling window of durations with histogram
+class ofxKuZedHistogram
+{
+public:
+	static const int WINDOW = 512;		//samples
+	struct Summary {
+		int count = 0;				//samples in window
+		double mean = 0;			//ms
+		double p50 = 0, p95 = 0, p99 = 0;	//ms, from histogram
+		double max = 0;				//ms
+	};
+
+	ofxKuZedHistogram();
+	void add(unsigned long long ns);
+	void clear();
+	int size() const;
+	double percentile(double p) const;	//p in [0, 1], ms
+	Summary summary() const;
+
+private:
+	static const int SUBBINS = 8;	//bins per octave
+	static const int BINS = 65 * SUBBINS;
+	std::vector<unsigned long long> samples_;	//ring of WINDOW samples, ns
+	std::vector<int> bins_;
+	int next_ = 0;
+	int count_ = 0;
+	unsigned long long sum_ = 0;	//of samples in window, ns
+
+	static int bin(unsigned long long ns);
+	static double binCenter(int bin);	//ns
+};
+
+class ofxKuZedStats
+{
+public:
+	static unsigned long long now();	//steady clock, ns
+
+	void setEnabled(bool enabled);		//default: true
+	bool isEnabled() const;
+	void reset();						//clear all samples and frame counters
+
+	//Expected frame period for counting frames dropped by camera, 0 - estimated from intervals
+	void setNominalFps(float fps);		//default: 0
+
+	void add(int stat, unsigned long long ns);
+	const ofxKuZedHistogram &get(int stat) const;
+	static const char *name(int stat);
+
+	//New frame taken by update(): id grows by 1 for each grabbed frame, timestamp - camera time (0 if unknown),
+	//hostTime - end of grab, by now(). Gaps in ids (frames replaced in capture thread) and in timestamps
+	//(frames skipped by camera) are counted as dropped
+	void addFrame(unsigned long long id, unsigned long long timestamp, unsigned long long hostTime);
+	unsigned long long getFrames() const;			//frames taken by update()
+	unsigned long long getDroppedFrames() const;
+	float getFps() const;	//measured, from mean frame interval in window
+
+	//Table of all values with samples: count, mean, p50, p95, p99, max in ms
+	std::string report() const;
+
+	//Measure a scope:
+	//	ofxKuZedStats::Probe probe(stats, ZED_STAT_LEFT_PIXELS);
+	class Probe {
+	public:
+		Probe(ofxKuZedStats &stats, int stat);
+		~Probe();
+	private:
+		ofxKuZedStats *stats_;
+		int stat_;
+		unsigned long long start_;
+	};
+
+private:
+	bool enabled_ = true;
+	ofxKuZedHistogram stats_[ZED_STAT_COUNT];
+
+	float nominalFps_ = 0;
+	double period_ = 0;		//estimated frame period, ns
+	unsigned long long frames_ = 0;
+	unsigned long long dropped_ = 0;
+	unsigned long long lastId_ = 0;
+	unsigned long long lastTimestamp_ = 0;
+	unsigned long long lastHostTime_ = 0;
+};
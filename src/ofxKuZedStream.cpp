@@ -0,0 +1,661 @@
+#include "ofxKuZedStream.h"
+#include "ofxKuZedConvert.h"
+
+static const char frameMagic[4] = { 'K', 'Z', 'S', 'F' };
+static const char packetMagic[4] = { 'K', 'Z', 'S', 'P' };
+static const char helloMagic[4] = { 'K', 'Z', 'S', 'H' };
+static const int streamChannels[3] = { ZED_CHANNEL_LEFT, ZED_CHANNEL_RIGHT, ZED_CHANNEL_DEPTH };
+static const uint64_t udpClientTimeoutUs = 3000000;	//client is forgotten if it doesn't send hello
+static const uint64_t helloPeriodUs = 500000;
+static const uint64_t reconnectPeriodUs = 500000;
+static const int receiveTimeoutMs = 2000;		//for the rest of message after its beginning came
+static const uint32_t maxMessageSize = 256 << 20;
+static const uint32_t minPayload = 256;		//packet data size limits, so a packet header can't ask for huge packet count
+static const uint32_t maxPacketSize = 65507;	//UDP limit
+
+static_assert(sizeof(ofxKuZedStreamFrameHeader) == 56, "ofxKuZedStreamFrameHeader must be 56 bytes");
+static_assert(sizeof(ofxKuZedStreamPacketHeader) == 32, "ofxKuZedStreamPacketHeader must be 32 bytes");
+
+//------------------------------------------------------------------------------------------------------
+//System time for latency measuring between computers
+static uint64_t systemMicros()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------
+//Bytes per second, updated each second
+static void updateBandwidth(uint64_t bytes, uint64_t &secondStart, uint64_t &bytesThisSecond, float &bandwidth)
+{
+	uint64_t now = systemMicros();
+	if (secondStart == 0) secondStart = now;
+	bytesThisSecond += bytes;
+	if (now - secondStart >= 1000000) {
+		bandwidth = bytesThisSecond * 1e6f / (now - secondStart);
+		secondStart = now;
+		bytesThisSecond = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+static void appendData(vector<unsigned char> &message, const void *data, size_t size)
+{
+	size_t n = message.size();
+	message.resize(n + size);
+	if (size > 0) memcpy(&message[n], data, size);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStreamServer::~ofxKuZedStreamServer()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamServer::setup(int port, int protocol)
+{
+	close();
+	protocol_ = protocol;
+	if (!socket_.listen(port, protocol == ZED_STREAM_UDP)) {
+		ofLogError() << "ofxKuZedStreamServer: can't listen port " << port << endl;
+		return false;
+	}
+	socket_.setBufferSizes(4 << 20);
+	pendingNew_ = false;
+	sent_ = dropped_ = 0;
+	bytesSecondStart_ = bytesThisSecond_ = 0;
+	bandwidth_ = 0;
+	startThread();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::close()
+{
+	if (isThreadRunning()) {
+		waitForThread(true);
+	}
+	socket_.close();
+	clients_.clear();
+	udpClients_.clear();
+	clientCount_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamServer::isStarted()
+{
+	return socket_.isOpen();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::setChannels(int channels)
+{
+	lock();
+	channels_ = channels;
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::setImageFormat(int format, ofImageQualityType quality)
+{
+	lock();
+	imageFormat_ = format;
+	imageQuality_ = quality;
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::setDepthFormat(int format, float precisionMm)
+{
+	lock();
+	depthFormat_ = format;
+	depthPrecision_ = precisionMm;
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::setUdpPacketSize(int bytes)
+{
+	lock();
+	udpPacketSize_ = ofClamp(bytes, int(sizeof(ofxKuZedStreamPacketHeader) + minPayload), int(maxPacketSize));
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::send(const ofxKuZedFrame &frame, ofxKuZedIntrinsics intrinsics)
+{
+	if (!isStarted()) return;
+	lock();
+	if (pendingNew_) dropped_++;
+	ofxKuZedFrame &pending = frames_[pending_];
+	for (int i = 0; i < 3; i++) {
+		int c = streamChannels[i];
+		if ((channels_ & (1 << c)) && !frame[c].empty()) pending[c].copyFrom(frame[c]);
+		else pending[c].clear();
+	}
+	pending.id = frame.id;
+	pending.timestamp = frame.timestamp;
+	intrinsics_[pending_] = intrinsics;
+	sendTime_[pending_] = systemMicros();
+	pendingNew_ = true;
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::threadedFunction()
+{
+	while (isThreadRunning()) {
+		//Waiting for clients also gives time for send() calls
+		if (socket_.wait(1)) {
+			acceptClients();
+		}
+		bool isNew = false;
+		lock();
+		if (pendingNew_) {
+			swap(pending_, sending_);
+			pendingNew_ = false;
+			isNew = true;
+		}
+		unlock();
+		if (isNew) {
+			encodeFrame(frames_[sending_]);
+			sendMessage();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//New TCP connections, or hello packets from UDP clients
+void ofxKuZedStreamServer::acceptClients()
+{
+	if (protocol_ == ZED_STREAM_TCP) {
+		shared_ptr<ofxKuZedSocket> client(new ofxKuZedSocket());
+		if (socket_.accept(*client)) {
+			client->setNoDelay(true);
+			client->setBufferSizes(4 << 20);
+			clients_.push_back(client);
+		}
+	}
+	else {
+		ofxKuZedStreamPacketHeader hello;
+		ofxKuZedAddress address;
+		while (socket_.wait(0)) {
+			int n = socket_.receiveFrom(&hello, sizeof(hello), address);
+			if (n < 4 || memcmp(hello.magic, helloMagic, sizeof(helloMagic)) != 0) continue;
+			bool found = false;
+			for (size_t i = 0; i < udpClients_.size(); i++) {
+				if (udpClients_[i].address == address) {
+					udpClients_[i].lastHello = systemMicros();
+					found = true;
+				}
+			}
+			if (!found) {
+				UdpClient client;
+				client.address = address;
+				client.lastHello = systemMicros();
+				udpClients_.push_back(client);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::encodeFrame(const ofxKuZedFrame &frame)
+{
+	lock();
+	int imageFormat = imageFormat_;
+	ofImageQualityType imageQuality = imageQuality_;
+	int depthFormat = depthFormat_;
+	codec_.setPrecision(depthPrecision_);
+	unlock();
+
+	const ofxKuZedIntrinsics &intrinsics = intrinsics_[sending_];
+	ofxKuZedStreamFrameHeader header;
+	memcpy(header.magic, frameMagic, sizeof(frameMagic));
+	header.channels = 0;
+	header.id = frame.id;
+	header.timestamp = frame.timestamp;
+	header.sendTime = sendTime_[sending_];
+	header.width = header.height = 0;
+	header.fx = intrinsics.fx;
+	header.fy = intrinsics.fy;
+	header.cx = intrinsics.cx;
+	header.cy = intrinsics.cy;
+	for (int i = 0; i < 3; i++) {
+		const ofxKuZedBuffer &buffer = frame[streamChannels[i]];
+		if (!buffer.empty()) {
+			header.channels++;
+			header.width = buffer.width;
+			header.height = buffer.height;
+		}
+	}
+	message_.clear();
+	appendData(message_, &header, sizeof(header));
+
+	for (int i = 0; i < 3; i++) {
+		int c = streamChannels[i];
+		const ofxKuZedBuffer &buffer = frame[c];
+		if (buffer.empty()) continue;
+		int w = buffer.width;
+		int h = buffer.height;
+		ofxKuZedStreamChannelHeader channel;
+		channel.channel = c;
+		channel.reserved = 0;
+		const void *data = 0;
+		size_t size = 0;
+		if (c == ZED_CHANNEL_DEPTH) {
+			channel.format = depthFormat;
+			if (depthFormat == ZED_STREAM_FORMAT_DEPTH) {
+				size = codec_.encode(buffer.data, buffer.step, w, h, depthData_);
+			}
+			else {
+				depthData_.resize(size_t(w) * h * sizeof(float));
+				size = depthData_.size();
+				ofxKuZedConvert::copyRows(buffer.data, buffer.step, &depthData_[0], w * sizeof(float), w * sizeof(float), h);
+			}
+			data = &depthData_[0];
+		}
+		else {
+			channel.format = imageFormat;
+			rgb_.allocate(w, h, 3);
+			ofxKuZedConvert::bgraToRgb(buffer.data, buffer.step, rgb_.getData(), w * 3, w, h);
+			if (imageFormat == ZED_STREAM_FORMAT_JPEG) {
+				ofSaveImage(rgb_, jpeg_, OF_IMAGE_FORMAT_JPEG, imageQuality);
+				data = jpeg_.getData();
+				size = jpeg_.size();
+			}
+			else {
+				data = rgb_.getData();
+				size = size_t(w) * h * 3;
+			}
+		}
+		channel.size = uint32_t(size);
+		appendData(message_, &channel, sizeof(channel));
+		appendData(message_, data, size);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamServer::sendMessage()
+{
+	uint32_t size = uint32_t(message_.size());
+	uint64_t bytes = 0;
+	if (protocol_ == ZED_STREAM_TCP) {
+		for (size_t i = 0; i < clients_.size(); ) {
+			ofxKuZedSocket &client = *clients_[i];
+			if (client.sendAll(&size, sizeof(size)) && client.sendAll(&message_[0], size)) {
+				bytes += sizeof(size) + size;
+				i++;
+			}
+			else {
+				clients_.erase(clients_.begin() + i);	//disconnected
+			}
+		}
+	}
+	else {
+		uint64_t now = systemMicros();
+		for (size_t i = 0; i < udpClients_.size(); ) {
+			if (now - udpClients_[i].lastHello > udpClientTimeoutUs) udpClients_.erase(udpClients_.begin() + i);
+			else i++;
+		}
+		lock();
+		int packetSize = udpPacketSize_;
+		unlock();
+		uint32_t payload = packetSize - sizeof(ofxKuZedStreamPacketHeader);
+		uint32_t count = (size + payload - 1) / payload;
+		vector<unsigned char> packet(packetSize);
+		ofxKuZedStreamPacketHeader header;
+		memcpy(header.magic, packetMagic, sizeof(packetMagic));
+		header.count = count;
+		header.messageSize = size;
+		header.payload = payload;
+		header.message = ++messageCounter_;
+		for (uint32_t k = 0; k < count; k++) {
+			header.index = k;
+			header.offset = k * payload;
+			uint32_t n = min(payload, size - header.offset);
+			memcpy(&packet[0], &header, sizeof(header));
+			memcpy(&packet[sizeof(header)], &message_[header.offset], n);
+			for (size_t i = 0; i < udpClients_.size(); i++) {
+				if (socket_.sendTo(&packet[0], sizeof(header) + n, udpClients_[i].address)) {
+					bytes += sizeof(header) + n;
+				}
+			}
+		}
+	}
+
+	lock();
+	clientCount_ = int((protocol_ == ZED_STREAM_TCP) ? clients_.size() : udpClients_.size());
+	if (clientCount_ > 0) sent_++;
+	updateBandwidth(bytes, bytesSecondStart_, bytesThisSecond_, bandwidth_);
+	unlock();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedStreamServer::getClientCount()
+{
+	lock();
+	int count = clientCount_;
+	unlock();
+	return count;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStreamServer::getSentFrames()
+{
+	lock();
+	unsigned long long sent = sent_;
+	unlock();
+	return sent;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStreamServer::getDroppedFrames()
+{
+	lock();
+	unsigned long long dropped = dropped_;
+	unlock();
+	return dropped;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedStreamServer::getBandwidth()
+{
+	lock();
+	float bandwidth = bandwidth_;
+	unlock();
+	return bandwidth;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedStreamClient::~ofxKuZedStreamClient()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamClient::setup(string host, int port, int protocol, int timeoutMs)
+{
+	close();
+	host_ = host;
+	port_ = port;
+	protocol_ = protocol;
+	lastConnect_ = lastHello_ = 0;
+	assembling_ = 0;
+	thread_.start([this](ofxKuZedFrame &frame) { return receiveFrame(frame); });
+
+	//Wait for the first frame to know frame size
+	uint64_t start = systemMicros();
+	while (systemMicros() - start < uint64_t(timeoutMs) * 1000) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (received_ > 0) return true;
+		}
+		ofSleepMillis(5);
+	}
+	ofLogError() << "ofxKuZedStreamClient: no frames from " << host << ":" << port << endl;
+	close();
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamClient::close()
+{
+	thread_.stop();
+	socket_.close();
+	std::lock_guard<std::mutex> lock(mutex_);
+	width_ = height_ = 0;
+	connected_ = false;
+	received_ = dropped_ = 0;
+	lastId_ = 0;
+	latencyMs_ = 0;
+	bytesSecondStart_ = bytesThisSecond_ = 0;
+	bandwidth_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+//Receive and decode frame, called from the receiving thread. Returns false if no frame came
+bool ofxKuZedStreamClient::receiveFrame(ofxKuZedFrame &frame)
+{
+	return receiveMessage() && decodeMessage(frame);
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamClient::receiveMessage()
+{
+	uint64_t now = systemMicros();
+	bool udp = (protocol_ == ZED_STREAM_UDP);
+	if (!socket_.isOpen()) {
+		if (now - lastConnect_ < reconnectPeriodUs) return false;
+		lastConnect_ = now;
+		bool ok = socket_.connect(host_, port_, udp);
+		if (ok) {
+			socket_.setBufferSizes(4 << 20);
+			socket_.setNoDelay(true);
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		connected_ = ok;
+		if (!ok) return false;
+	}
+
+	if (!udp) {
+		if (!socket_.wait(100)) return false;
+		uint32_t size = 0;
+		bool ok = socket_.receiveAll(&size, sizeof(size), receiveTimeoutMs) && size <= maxMessageSize;
+		message_.resize(size);
+		if (ok && size > 0) {
+			ok = socket_.receiveAll(&message_[0], size, receiveTimeoutMs);
+		}
+		if (!ok) {
+			//Connection is lost, it will be restored
+			socket_.close();
+			std::lock_guard<std::mutex> lock(mutex_);
+			connected_ = false;
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		updateBandwidth(sizeof(size) + size, bytesSecondStart_, bytesThisSecond_, bandwidth_);
+		return true;
+	}
+
+	//UDP: say hello to server, so it sends frames to us
+	if (now - lastHello_ >= helloPeriodUs) {
+		lastHello_ = now;
+		ofxKuZedStreamPacketHeader hello;
+		memset(&hello, 0, sizeof(hello));
+		memcpy(hello.magic, helloMagic, sizeof(helloMagic));
+		socket_.send(&hello, sizeof(hello));
+	}
+	packet_.resize(65536);
+	ofxKuZedAddress address;
+	while (socket_.wait(100)) {
+		int n = socket_.receiveFrom(&packet_[0], packet_.size(), address);
+		if (n < int(sizeof(ofxKuZedStreamPacketHeader))) return false;
+		ofxKuZedStreamPacketHeader header;
+		memcpy(&header, &packet_[0], sizeof(header));
+		uint32_t payload = n - sizeof(header);
+		//Header comes from network: packet count and position must agree with message size and packet size
+		if (memcmp(header.magic, packetMagic, sizeof(packetMagic)) != 0
+			|| header.messageSize == 0 || header.messageSize > maxMessageSize
+			|| header.payload < minPayload || header.payload > maxPacketSize
+			|| header.count != (uint64_t(header.messageSize) + header.payload - 1) / header.payload
+			|| header.index >= header.count || header.offset != uint64_t(header.index) * header.payload
+			|| payload != min(header.payload, header.messageSize - header.offset)) {
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		updateBandwidth(n, bytesSecondStart_, bytesThisSecond_, bandwidth_);
+		if (header.message < assembling_) continue;	//packet of an old frame
+		if (header.message > assembling_) {
+			//Start new message, incomplete one is dropped
+			assembling_ = header.message;
+			assembledPackets_ = 0;
+			message_.resize(header.messageSize);
+			packetReceived_.assign(header.count, false);
+		}
+		if (packetReceived_.size() != header.count || message_.size() != header.messageSize) continue;
+		if (!packetReceived_[header.index]) {
+			packetReceived_[header.index] = true;
+			assembledPackets_++;
+			if (payload > 0) memcpy(&message_[header.offset], &packet_[sizeof(header)], payload);
+		}
+		if (assembledPackets_ == header.count) {
+			assembling_++;	//ignore the rest packets of this message
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamClient::decodeMessage(ofxKuZedFrame &frame)
+{
+	ofxKuZedStreamFrameHeader header;
+	if (message_.size() < sizeof(header)) return false;
+	memcpy(&header, &message_[0], sizeof(header));
+	if (memcmp(header.magic, frameMagic, sizeof(frameMagic)) != 0) return false;
+	//Size comes from network: decoded channels (BGRA images, float depth) should fit the message limit
+	if (header.width == 0 || header.height == 0 || uint64_t(header.width) * header.height * 4 > maxMessageSize) return false;
+	int w = header.width;
+	int h = header.height;
+
+	frame.clear();
+	size_t pos = sizeof(header);
+	for (uint32_t i = 0; i < header.channels; i++) {
+		ofxKuZedStreamChannelHeader channel;
+		if (pos + sizeof(channel) > message_.size()) return false;
+		memcpy(&channel, &message_[pos], sizeof(channel));
+		pos += sizeof(channel);
+		if (pos + channel.size > message_.size()) return false;
+		const unsigned char *data = &message_[pos];
+		pos += channel.size;
+
+		int c = channel.channel;
+		if (c == ZED_CHANNEL_DEPTH) {
+			ofxKuZedBuffer &depth = frame[c];
+			depth.allocate(w, h, sizeof(float));
+			if (channel.format == ZED_STREAM_FORMAT_DEPTH) {
+				if (!codec_.decode(data, channel.size, depth.data, depth.step, w, h)) return false;
+			}
+			else {
+				if (channel.size != size_t(w) * h * sizeof(float)) return false;
+				memcpy(depth.data, data, channel.size);
+			}
+		}
+		else if (c == ZED_CHANNEL_LEFT || c == ZED_CHANNEL_RIGHT) {
+			const unsigned char *rgb = data;
+			if (channel.format == ZED_STREAM_FORMAT_JPEG) {
+				ofBuffer buffer((const char *)data, channel.size);
+				if (!ofLoadImage(rgb_, buffer) || int(rgb_.getWidth()) != w || int(rgb_.getHeight()) != h
+					|| rgb_.getNumChannels() != 3) {
+					return false;
+				}
+				rgb = rgb_.getData();
+			}
+			else if (channel.size != size_t(w) * h * 3) {
+				return false;
+			}
+			ofxKuZedBuffer &image = frame[c];
+			image.allocate(w, h, 4);
+			ofxKuZedConvert::rgbToBgra(rgb, w * 3, image.data, image.step, w, h);
+		}
+	}
+	frame.timestamp = header.timestamp;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	width_ = w;
+	height_ = h;
+	intrinsics_.fx = header.fx;
+	intrinsics_.fy = header.fy;
+	intrinsics_.cx = header.cx;
+	intrinsics_.cy = header.cy;
+	if (lastId_ > 0 && header.id > lastId_ + 1) dropped_ += header.id - lastId_ - 1;
+	lastId_ = header.id;
+	received_++;
+	float latency = (systemMicros() - header.sendTime) / 1000.0f;
+	latencyMs_ = (received_ == 1) ? latency : latencyMs_ * 0.9f + latency * 0.1f;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamClient::isConnected()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return connected_;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedStreamClient::getLatencyMs()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return latencyMs_;
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedStreamClient::getBandwidth()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return bandwidth_;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStreamClient::getReceivedFrames()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return received_;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStreamClient::getDroppedFrames()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return dropped_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedStreamClient::getWidth()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return width_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedStreamClient::getHeight()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return height_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZedStreamClient::getIntrinsics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return intrinsics_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedStreamClient::grab(bool computeDepth, bool computeXYZ)
+{
+	return thread_.update();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedStreamClient::retrieve(int channel, ofxKuZedBuffer &buffer)
+{
+	ofxKuZedFrame &frame = thread_.frame();
+	ofxKuZedBuffer &data = frame[channel];
+	if (data.empty() && (channel == ZED_CHANNEL_XYZ || channel == ZED_CHANNEL_XYZRGBA)) {
+		//Point cloud is computed from depth and left image
+		ofxKuZedIntrinsics intrinsics = getIntrinsics();
+		frame.computeXyz(channel, intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy);
+	}
+	buffer.setView(data.data, data.width, data.height, data.step, data.bytesPerPixel);
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedStreamClient::getTimestamp()
+{
+	return thread_.frame().timestamp;
+}
+
+//------------------------------------------------------------------------------------------------------
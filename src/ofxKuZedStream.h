@@ -0,0 +1,207 @@
+#pragma once
+
+//Streaming ZED frames over network.
+//ofxKuZedStreamServer sends selected channels of frames to all connected clients.
+//ofxKuZedStreamClient receives them and is a frame source, so ofxKuZed on the remote computer
+//gives the same pixels, textures and point cloud as with camera:
+//	client.setup("192.168.0.10", 9000);
+//	zed.setSource(&client);
+//	zed.init();
+//
+//Point cloud is not sent: the client computes it from depth using camera parameters sent with each frame,
+//which is much smaller than points.
+//Images are compressed with JPEG, depth with ofxKuZedDepthCodec (both can be switched to raw data).
+//Server keeps only the newest frame not sent yet, so slow network drops old frames instead of adding latency.
+//
+//Message: ofxKuZedStreamFrameHeader, then for each channel ofxKuZedStreamChannelHeader and data.
+//TCP: each message is prefixed by its size (uint32).
+//UDP: message is split into packets with ofxKuZedStreamPacketHeader. Client sends hello packets to server,
+//and server sends frames to clients which sent hello during the last seconds. Incomplete frames are dropped.
+
+#include "ofMain.h"
+#include "ofxKuZedSource.h"
+#include "ofxKuZedCaptureThread.h"
+#include "ofxKuZedSocket.h"
+#include "ofxKuZedDepthCodec.h"
+#include <cstdint>
+
+const int ZED_STREAM_TCP = 0;
+const int ZED_STREAM_UDP = 1;
+
+//Channels for streaming, as bit mask
+const int ZED_STREAM_LEFT = 1 << ZED_CHANNEL_LEFT;
+const int ZED_STREAM_RIGHT = 1 << ZED_CHANNEL_RIGHT;
+const int ZED_STREAM_DEPTH = 1 << ZED_CHANNEL_DEPTH;
+const int ZED_STREAM_ALL = ZED_STREAM_LEFT | ZED_STREAM_RIGHT | ZED_STREAM_DEPTH;
+
+//Channel data formats
+const int ZED_STREAM_FORMAT_RAW = 0;		//images: RGB, depth: float
+const int ZED_STREAM_FORMAT_JPEG = 1;		//images
+const int ZED_STREAM_FORMAT_DEPTH = 2;		//depth, ofxKuZedDepthCodec
+
+struct ofxKuZedStreamFrameHeader {
+	char magic[4];			//"KZSF"
+	uint32_t channels;		//number of channels in message
+	uint64_t id;			//frame id on server
+	uint64_t timestamp;		//camera timestamp, ns
+	uint64_t sendTime;		//server system time when frame was queued, microseconds
+	uint32_t width;
+	uint32_t height;
+	float fx, fy, cx, cy;	//left camera parameters
+};
+
+struct ofxKuZedStreamChannelHeader {
+	uint32_t channel;		//ZED_CHANNEL_...
+	uint32_t format;		//ZED_STREAM_FORMAT_...
+	uint32_t size;			//data size in bytes
+	uint32_t reserved;
+};
+
+struct ofxKuZedStreamPacketHeader {
+	char magic[4];			//"KZSP" - frame packet, "KZSH" - hello from client
+	uint32_t index;			//packet index in message
+	uint32_t count;			//number of packets in message
+	uint32_t offset;		//position of packet data in message
+	uint32_t messageSize;
+	uint32_t payload;		//data size of each packet except the last one
+	uint64_t message;		//message number
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofxKuZedStreamServer : public ofThread
+{
+public:
+	~ofxKuZedStreamServer();
+
+	bool setup(int port, int protocol = ZED_STREAM_TCP);	//returns false on error
+	void close();
+	bool isStarted();
+
+	//Settings, can be changed while streaming
+	void setChannels(int channels);		//ZED_STREAM_... mask, default: ZED_STREAM_LEFT | ZED_STREAM_DEPTH
+	void setImageFormat(int format, ofImageQualityType quality = OF_IMAGE_QUALITY_HIGH);	//default: ZED_STREAM_FORMAT_JPEG
+	void setDepthFormat(int format, float precisionMm = 1);	//default: ZED_STREAM_FORMAT_DEPTH
+	void setUdpPacketSize(int bytes);	//default: 1400, suitable for Ethernet MTU, 288..65507
+
+	//Queue frame for sending, it's copied. If the previous frame is not sent yet, it's dropped
+	void send(const ofxKuZedFrame &frame, ofxKuZedIntrinsics intrinsics);
+
+	//Statistics
+	int getClientCount();
+	unsigned long long getSentFrames();
+	unsigned long long getDroppedFrames();	//frames replaced by newer ones before sending
+	float getBandwidth();					//bytes per second, averaged over the last second
+
+private:
+	void threadedFunction();
+	void acceptClients();
+	void encodeFrame(const ofxKuZedFrame &frame);
+	void sendMessage();
+
+	int protocol_ = ZED_STREAM_TCP;
+	ofxKuZedSocket socket_;			//listening TCP socket or UDP socket
+	vector<shared_ptr<ofxKuZedSocket> > clients_;	//TCP clients
+	struct UdpClient {
+		ofxKuZedAddress address;
+		uint64_t lastHello;
+	};
+	vector<UdpClient> udpClients_;
+	int udpPacketSize_ = 1400;
+	uint64_t messageCounter_ = 0;
+
+	//Settings, protected by lock()
+	int channels_ = ZED_STREAM_LEFT | ZED_STREAM_DEPTH;
+	int imageFormat_ = ZED_STREAM_FORMAT_JPEG;
+	ofImageQualityType imageQuality_ = OF_IMAGE_QUALITY_HIGH;
+	int depthFormat_ = ZED_STREAM_FORMAT_DEPTH;
+	float depthPrecision_ = 1;
+
+	//Double buffer: the newest frame queued by send(), and the frame which is being sent
+	ofxKuZedFrame frames_[2];
+	ofxKuZedIntrinsics intrinsics_[2];
+	uint64_t sendTime_[2];
+	int pending_ = 0;
+	int sending_ = 1;
+	bool pendingNew_ = false;
+
+	//Encoding
+	ofxKuZedDepthCodec codec_;
+	ofPixels rgb_;
+	ofBuffer jpeg_;
+	vector<unsigned char> depthData_;
+	vector<unsigned char> message_;
+
+	//Statistics
+	unsigned long long sent_ = 0;
+	unsigned long long dropped_ = 0;
+	int clientCount_ = 0;
+	uint64_t bytesSecondStart_ = 0;
+	uint64_t bytesThisSecond_ = 0;
+	float bandwidth_ = 0;
+};
+
+//------------------------------------------------------------------------------------------------------
+class ofxKuZedStreamClient : public ofxKuZedSource
+{
+public:
+	~ofxKuZedStreamClient();
+
+	//Connect to server and wait for the first frame to know frame size. Returns false if no frame came.
+	//TCP connection is restored automatically if it's lost
+	bool setup(string host, int port, int protocol = ZED_STREAM_TCP, int timeoutMs = 5000);
+	bool isConnected();
+
+	//Statistics
+	float getLatencyMs();		//from queuing frame on server till decoding on client, averaged.
+								//Computers should have synchronized clocks
+	float getBandwidth();		//bytes per second, averaged over the last second
+	unsigned long long getReceivedFrames();
+	unsigned long long getDroppedFrames();	//frames lost on server or in network, found by id gaps
+
+	//ofxKuZedSource
+	void close();
+	int getWidth();
+	int getHeight();
+	ofxKuZedIntrinsics getIntrinsics();
+	bool grab(bool computeDepth, bool computeXYZ);
+	void retrieve(int channel, ofxKuZedBuffer &buffer);
+	unsigned long long getTimestamp();
+
+private:
+	bool receiveFrame(ofxKuZedFrame &frame);	//called from receiving thread
+	bool receiveMessage();
+	bool decodeMessage(ofxKuZedFrame &frame);
+
+	string host_;
+	int port_ = 0;
+	int protocol_ = ZED_STREAM_TCP;
+	ofxKuZedSocket socket_;
+	uint64_t lastConnect_ = 0;
+	uint64_t lastHello_ = 0;
+
+	//UDP packets assembling
+	vector<unsigned char> packet_;
+	uint64_t assembling_ = 0;	//message number
+	uint32_t assembledPackets_ = 0;
+	vector<bool> packetReceived_;
+
+	vector<unsigned char> message_;
+	ofxKuZedDepthCodec codec_;
+	ofPixels rgb_;
+
+	ofxKuZedCaptureThread thread_;	//receives and decodes frames into triple buffer
+
+	//Written by receiving thread
+	std::mutex mutex_;
+	int width_ = 0;
+	int height_ = 0;
+	ofxKuZedIntrinsics intrinsics_;
+	bool connected_ = false;
+	unsigned long long received_ = 0;
+	unsigned long long dropped_ = 0;
+	uint64_t lastId_ = 0;
+	float latencyMs_ = 0;
+	uint64_t bytesSecondStart_ = 0;
+	uint64_t bytesThisSecond_ = 0;
+	float bandwidth_ = 0;
+};
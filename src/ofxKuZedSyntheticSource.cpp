@@ -0,0 +1,167 @@
+#include "ofxKuZedSyntheticSource.h"
+#include "ofxKuZedWorkers.h"
+
+static const float wallNearMm = 2000;	//wall depth at the left border
+static const float wallFarMm = 4000;	//wall depth at the right border
+static const float sphereDepthMm = 1500;
+static const float sphereRadiusMm = 300;
+static const float baselineMm = 120;	//for disparity of the right image
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedSyntheticSource::~ofxKuZedSyntheticSource()
+{
+	close();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSyntheticSource::open(int w, int h, float fps)
+{
+	close();
+	w_ = w;
+	h_ = h;
+	fps_ = fps;
+	intrinsics_.fx = intrinsics_.fy = w * 0.55f;
+	intrinsics_.cx = w * 0.5f;
+	intrinsics_.cy = h * 0.5f;
+	frameNumber_ = 0;
+	nextTime_ = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSyntheticSource::isOpen()
+{
+	return w_ > 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSyntheticSource::close()
+{
+	w_ = h_ = 0;
+	frame_.clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedSyntheticSource::getWidth()
+{
+	return w_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedSyntheticSource::getHeight()
+{
+	return h_;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedIntrinsics ofxKuZedSyntheticSource::getIntrinsics()
+{
+	return intrinsics_;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedSyntheticSource::grab(bool computeDepth, bool computeXYZ)
+{
+	if (!isOpen()) return false;
+	if (fps_ > 0) {
+		std::this_thread::sleep_until(nextTime_);
+		nextTime_ += std::chrono::microseconds((long long)(1000000 / fps_));
+	}
+	computeDepth_ = computeDepth;
+	frameNumber_++;
+	frame_.id = frameNumber_;
+	frame_.timestamp = (unsigned long long)(frameNumber_ * 1e9 / ((fps_ > 0) ? fps_ : 30));
+
+	//Point cloud is computed from depth on retrieve, buffers of views are restored here
+	frame_[ZED_CHANNEL_LEFT].allocate(w_, h_, 4);
+	frame_[ZED_CHANNEL_RIGHT].allocate(w_, h_, 4);
+	frame_[ZED_CHANNEL_DEPTH].allocate(w_, h_, sizeof(float));
+	frame_[ZED_CHANNEL_XYZ].clear();
+	frame_[ZED_CHANNEL_XYZRGBA].clear();
+
+	ofxKuZedWorkers::shared().parallelRows(h_, [this](int y0, int y1) {
+		render(y0, y1);
+	});
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSyntheticSource::render(int y0, int y1)
+{
+	//Sphere moves along ellipse, one turn in 4 seconds of timestamps
+	float t = float(frame_.timestamp * 1e-9) * float(TWO_PI) / 4;
+	float sphereX = cos(t) * 600;
+	float sphereY = sin(t) * 300;
+	float tint = 0.5f + 0.5f * sin(t);
+
+	float fx = intrinsics_.fx;
+	float fy = intrinsics_.fy;
+	float cx = intrinsics_.cx;
+	float cy = intrinsics_.cy;
+	int disparity = int(baselineMm * fx / ((wallNearMm + wallFarMm) / 2));
+
+	for (int y = y0; y < y1; y++) {
+		unsigned char *left = frame_[ZED_CHANNEL_LEFT].row<unsigned char>(y);
+		unsigned char *right = frame_[ZED_CHANNEL_RIGHT].row<unsigned char>(y);
+		float *depth = frame_[ZED_CHANNEL_DEPTH].row<float>(y);
+		float ry = (y - cy) / fy;
+		for (int x = 0; x < w_; x++) {
+			float rx = (x - cx) / fx;
+			float z = wallNearMm + (wallFarMm - wallNearMm) * x / w_;
+			bool onSphere = false;
+
+			//Ray (rx, ry, 1) * z intersection with sphere
+			float ox = sphereX, oy = sphereY, oz = sphereDepthMm;
+			float a = rx * rx + ry * ry + 1;
+			float b = rx * ox + ry * oy + oz;
+			float c = ox * ox + oy * oy + oz * oz - sphereRadiusMm * sphereRadiusMm;
+			float d = b * b - a * c;
+			if (d >= 0) {
+				z = (b - sqrt(d)) / a;
+				onSphere = true;
+			}
+			depth[x] = (computeDepth_) ? z : 0;
+
+			unsigned char *p = left + 4 * x;
+			if (onSphere) {
+				p[0] = (unsigned char)(255 * tint);
+				p[1] = (unsigned char)(z / 8);
+				p[2] = 255;
+			}
+			else {
+				p[0] = (unsigned char)(x * 255 / w_);
+				p[1] = (unsigned char)(y * 255 / h_);
+				p[2] = (unsigned char)(((x / 32 + y / 32) & 1) ? 200 : 60);
+			}
+			p[3] = 255;
+		}
+		//Right image is the left one, shifted by disparity
+		for (int x = 0; x < w_; x++) {
+			int xl = min(x + disparity, w_ - 1);
+			memcpy(right + 4 * x, left + 4 * xl, 4);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedSyntheticSource::retrieve(int channel, ofxKuZedBuffer &buffer)
+{
+	ofxKuZedBuffer &data = frame_[channel];
+	if (data.empty() && (channel == ZED_CHANNEL_XYZ || channel == ZED_CHANNEL_XYZRGBA)) {
+		frame_.computeXyz(channel, intrinsics_.fx, intrinsics_.fy, intrinsics_.cx, intrinsics_.cy);
+	}
+	buffer.setView(data.data, data.width, data.height, data.step, data.bytesPerPixel);
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedSyntheticSource::getTimestamp()
+{
+	return frame_.timestamp;
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned long long ofxKuZedSyntheticSource::getFrameNumber()
+{
+	return frameNumber_;
+}
+
+//------------------------------------------------------------------------------------------------------
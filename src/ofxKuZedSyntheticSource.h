@@ -0,0 +1,42 @@
+#pragma once
+
+//Synthetic frame source for running ofxKuZed without camera: tests, streaming over loopback, profiling.
+//The scene is deterministic: frame N is always the same for given size.
+//It's a tilted wall with a sphere moving in front of it, colored by gradients;
+//the right image is the left one shifted by disparity of the wall.
+
+#include "ofMain.h"
+#include "ofxKuZedSource.h"
+
+class ofxKuZedSyntheticSource : public ofxKuZedSource
+{
+public:
+	~ofxKuZedSyntheticSource();
+
+	//fps > 0: grab() waits to give frames with this rate, fps = 0: frames are given as fast as possible.
+	//Timestamps always go with 'fps' rate (30 if fps = 0), so they don't depend on computer speed
+	void open(int w = 1280, int h = 720, float fps = 30);
+	bool isOpen();
+
+	void close();
+	int getWidth();
+	int getHeight();
+	ofxKuZedIntrinsics getIntrinsics();
+	bool grab(bool computeDepth, bool computeXYZ);
+	void retrieve(int channel, ofxKuZedBuffer &buffer);
+	unsigned long long getTimestamp();
+
+	unsigned long long getFrameNumber();	//number of frames grabbed
+
+private:
+	void render(int y0, int y1);
+
+	int w_ = 0;
+	int h_ = 0;
+	float fps_ = 30;
+	ofxKuZedIntrinsics intrinsics_;
+	ofxKuZedFrame frame_;
+	bool computeDepth_ = true;
+	unsigned long long frameNumber_ = 0;
+	std::chrono::steady_clock::time_point nextTime_;
+};
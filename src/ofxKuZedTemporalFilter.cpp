@@ -0,0 +1,215 @@
+#include "ofxKuZedTemporalFilter.h"
+#include "ofxKuZedConvert.h"
+#include "ofxKuZedWorkers.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OFXKUZED_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define OFXKUZED_TARGET(isa)
+#else
+#define OFXKUZED_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+typedef ofxKuZedTemporalFilter::Params Params;
+
+//------------------------------------------------------------------------------------------------------
+//All versions do the same operations in the same order, so they give the same results.
+//Depth is valid if d > 0 and d <= max float, which is false for NaN and inf
+static void filterRowScalar(float *depth, float *state, float *age, int w, const Params &p)
+{
+	const float maxFloat = std::numeric_limits<float>::max();
+	for (int x = 0; x < w; x++) {
+		float d = depth[x];
+		float s = state[x];
+		float a = age[x];
+		bool valid = (d > 0) & (d <= maxFloat);
+		bool has = (s > 0);
+		float diff = d - s;
+		bool close = has & (fabsf(diff) <= p.motionMm + p.motionFraction * s);
+		float filtered = (close) ? s + p.alpha * diff : d;
+		bool hold = has & (a < p.holdFrames);
+		s = (valid) ? filtered : ((hold) ? s : 0);
+		a = (valid) ? 0 : std::min(a + 1, p.holdFrames + 1);	//age is bounded, so it never overflows
+		state[x] = s;
+		age[x] = a;
+		depth[x] = s;
+	}
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("sse2")
+static inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+OFXKUZED_TARGET("sse2")
+static void filterRowSSE2(float *depth, float *state, float *age, int w, const Params &p)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 maxFloat = _mm_set1_ps(std::numeric_limits<float>::max());
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 alpha = _mm_set1_ps(p.alpha);
+	const __m128 hold = _mm_set1_ps(p.holdFrames);
+	const __m128 maxAge = _mm_set1_ps(p.holdFrames + 1);
+	const __m128 motionMm = _mm_set1_ps(p.motionMm);
+	const __m128 motionFraction = _mm_set1_ps(p.motionFraction);
+	int x = 0;
+	for (; x + 4 <= w; x += 4) {
+		__m128 d = _mm_loadu_ps(depth + x);
+		__m128 s = _mm_loadu_ps(state + x);
+		__m128 a = _mm_loadu_ps(age + x);
+		__m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_cmple_ps(d, maxFloat));
+		__m128 has = _mm_cmpgt_ps(s, zero);
+		__m128 diff = _mm_sub_ps(d, s);
+		__m128 close = _mm_and_ps(has, _mm_cmple_ps(_mm_and_ps(diff, absMask), _mm_add_ps(motionMm, _mm_mul_ps(motionFraction, s))));
+		__m128 filtered = select4(close, _mm_add_ps(s, _mm_mul_ps(alpha, diff)), d);
+		__m128 held = _mm_and_ps(_mm_and_ps(has, _mm_cmplt_ps(a, hold)), s);
+		s = select4(valid, filtered, held);
+		a = _mm_andnot_ps(valid, _mm_min_ps(_mm_add_ps(a, one), maxAge));
+		_mm_storeu_ps(state + x, s);
+		_mm_storeu_ps(age + x, a);
+		_mm_storeu_ps(depth + x, s);
+	}
+	filterRowScalar(depth + x, state + x, age + x, w - x, p);
+}
+
+//------------------------------------------------------------------------------------------------------
+OFXKUZED_TARGET("avx2")
+static inline __m256 select8(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+OFXKUZED_TARGET("avx2")
+static void filterRowAVX2(float *depth, float *state, float *age, int w, const Params &p)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 maxFloat = _mm256_set1_ps(std::numeric_limits<float>::max());
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 alpha = _mm256_set1_ps(p.alpha);
+	const __m256 hold = _mm256_set1_ps(p.holdFrames);
+	const __m256 maxAge = _mm256_set1_ps(p.holdFrames + 1);
+	const __m256 motionMm = _mm256_set1_ps(p.motionMm);
+	const __m256 motionFraction = _mm256_set1_ps(p.motionFraction);
+	int x = 0;
+	for (; x + 8 <= w; x += 8) {
+		__m256 d = _mm256_loadu_ps(depth + x);
+		__m256 s = _mm256_loadu_ps(state + x);
+		__m256 a = _mm256_loadu_ps(age + x);
+		__m256 valid = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GT_OQ), _mm256_cmp_ps(d, maxFloat, _CMP_LE_OQ));
+		__m256 has = _mm256_cmp_ps(s, zero, _CMP_GT_OQ);
+		__m256 diff = _mm256_sub_ps(d, s);
+		__m256 thr = _mm256_add_ps(motionMm, _mm256_mul_ps(motionFraction, s));
+		__m256 close = _mm256_and_ps(has, _mm256_cmp_ps(_mm256_and_ps(diff, absMask), thr, _CMP_LE_OQ));
+		__m256 filtered = select8(close, _mm256_add_ps(s, _mm256_mul_ps(alpha, diff)), d);
+		__m256 held = _mm256_and_ps(_mm256_and_ps(has, _mm256_cmp_ps(a, hold, _CMP_LT_OQ)), s);
+		s = select8(valid, filtered, held);
+		a = _mm256_andnot_ps(valid, _mm256_min_ps(_mm256_add_ps(a, one), maxAge));
+		_mm256_storeu_ps(state + x, s);
+		_mm256_storeu_ps(age + x, a);
+		_mm256_storeu_ps(depth + x, s);
+	}
+	filterRowSSE2(depth + x, state + x, age + x, w - x, p);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::setHistory(float frames)
+{
+	history_ = std::max(frames, 1.0f);
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedTemporalFilter::getHistory() const
+{
+	return history_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::setHoldFrames(int frames)
+{
+	holdFrames_ = std::max(frames, 0);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedTemporalFilter::getHoldFrames() const
+{
+	return holdFrames_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::setMotionThreshold(float mm, float fraction)
+{
+	motionMm_ = mm;
+	motionFraction_ = fraction;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::reset()
+{
+	std::fill(state_.begin(), state_.end(), 0.0f);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::copySettings(const ofxKuZedTemporalFilter &filter)
+{
+	history_ = filter.history_;
+	holdFrames_ = filter.holdFrames_;
+	motionMm_ = filter.motionMm_;
+	motionFraction_ = filter.motionFraction_;
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedTemporalFilter::getStateBytes() const
+{
+	return state_.size() * sizeof(float);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTemporalFilter::apply(unsigned char *depth, int depthStep, int w, int h)
+{
+	if (!depth || w <= 0 || h <= 0) return;
+	if (w != w_ || h != h_) {
+		w_ = w;
+		h_ = h;
+		state_.assign(size_t(w) * h * 2, 0.0f);
+	}
+	Params p;
+	p.alpha = 2.0f / (history_ + 1);
+	p.holdFrames = float(holdFrames_);
+	p.motionMm = motionMm_;
+	p.motionFraction = motionFraction_;
+
+	float *filtered = &state_[0];
+	float *age = filtered + size_t(w) * h;
+	int simd = ofxKuZedConvert::simd();
+	ofxKuZedWorkers::shared().parallelRows(h, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			float *d = (float *)(depth + size_t(depthStep) * y);
+			float *s = filtered + size_t(w) * y;
+			float *a = age + size_t(w) * y;
+#ifdef OFXKUZED_X86
+			if (simd == ofxKuZedConvert::SIMD_AVX2) {
+				filterRowAVX2(d, s, a, w, p);
+				continue;
+			}
+			if (simd == ofxKuZedConvert::SIMD_SSSE3) {
+				filterRowSSE2(d, s, a, w, p);
+				continue;
+			}
+#endif
+			filterRowScalar(d, s, a, w, p);
+		}
+	});
+}
+
+//------------------------------------------------------------------------------------------------------
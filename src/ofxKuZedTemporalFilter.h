@@ -0,0 +1,59 @@
+#pragma once
+
+//Temporal filtering of depth: exponential moving average per pixel, which removes flicker of stereo depth
+//on textureless surfaces.
+//- A pixel which becomes invalid (hole) keeps its filtered value for a few frames.
+//- If new depth differs from the filtered value more than motion threshold, the pixel is reset to the new depth,
+//  so moving objects don't leave trails.
+//Filtering is done in-place, rows are processed in parallel by ofxKuZedWorkers::shared() using SIMD.
+//State (filtered depth and hole age, 8 bytes per pixel) is kept in one buffer, allocated when size is changed.
+//Output depth is the filtered value, or 0 for holes.
+
+#include <vector>
+#include <cstddef>
+
+class ofxKuZedTemporalFilter
+{
+public:
+	//Number of frames for averaging, EMA weight of new depth is 2 / (history + 1). 1 means no averaging
+	void setHistory(float frames);	//default: 4
+	float getHistory() const;
+
+	//Number of frames to keep value of the pixel when its depth is invalid, 0 - holes are not filled
+	void setHoldFrames(int frames);	//default: 3
+	int getHoldFrames() const;
+
+	//Pixel is reset when |depth - filtered| > mm + fraction * filtered.
+	//Stereo depth error grows with distance, so the fractional part is useful
+	void setMotionThreshold(float mm, float fraction);	//default: 30, 0.03
+
+	//Forget history, the next frame is taken as is
+	void reset();
+
+	//Take settings of another filter and keep own history, e.g. for passing settings to another thread
+	void copySettings(const ofxKuZedTemporalFilter &filter);
+
+	//Filter depth in mm (float, step - row size in bytes) in-place.
+	//History is reset if frame size is changed
+	void apply(unsigned char *depth, int depthStep, int w, int h);
+
+	size_t getStateBytes() const;
+
+	//Parameters of one row, used by SIMD versions
+	struct Params {
+		float alpha;
+		float holdFrames;
+		float motionMm;
+		float motionFraction;
+	};
+
+private:
+	float history_ = 4;
+	int holdFrames_ = 3;
+	float motionMm_ = 30;
+	float motionFraction_ = 0.03f;
+
+	int w_ = 0;
+	int h_ = 0;
+	std::vector<float> state_;	//w * h filtered depth, then w * h hole ages
+};
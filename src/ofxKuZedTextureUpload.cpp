@@ -0,0 +1,118 @@
+#include "ofxKuZedTextureUpload.h"
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedTextureUpload::ofxKuZedTextureUpload()
+{
+	w_ = h_ = step_ = 0;
+	format_ = GL_RGB;
+	slot_ = 0;
+	mapped_ = false;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedTextureUpload::~ofxKuZedTextureUpload()
+{
+	clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedTextureUpload::setup(int w, int h, int bytesPerPixel, GLenum format, int ringSize)
+{
+	clear();
+	if (w <= 0 || h <= 0 || bytesPerPixel <= 0 || ringSize <= 0) return false;
+	w_ = w;
+	h_ = h;
+	step_ = (w * bytesPerPixel + 3) / 4 * 4;
+	format_ = format;
+
+	pbo_.resize(ringSize, 0);
+	glGenBuffers(ringSize, &pbo_[0]);
+	GLsizeiptr size = GLsizeiptr(step_) * h_;
+	for (int i = 0; i < ringSize; i++) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[i]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	slot_ = ringSize - 1;	//the first begin() uses slot 0
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTextureUpload::clear()
+{
+	if (!pbo_.empty()) {
+		if (mapped_) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[slot_]);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		glDeleteBuffers(GLsizei(pbo_.size()), &pbo_[0]);
+		pbo_.clear();
+	}
+	mapped_ = false;
+	w_ = h_ = step_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedTextureUpload::isAllocated() const
+{
+	return !pbo_.empty();
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedTextureUpload::getWidth() const
+{
+	return w_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedTextureUpload::getHeight() const
+{
+	return h_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedTextureUpload::getStep() const
+{
+	return step_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedTextureUpload::getRingSize() const
+{
+	return int(pbo_.size());
+}
+
+//------------------------------------------------------------------------------------------------------
+unsigned char *ofxKuZedTextureUpload::begin()
+{
+	if (pbo_.empty() || mapped_) return 0;
+	slot_ = (slot_ + 1) % int(pbo_.size());
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[slot_]);
+	//Invalidating lets the driver give new memory if GPU still reads this buffer, instead of waiting for it
+	void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(step_) * h_,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	mapped_ = (data != 0);
+	return (unsigned char *)data;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedTextureUpload::end(GLuint texture, GLenum target)
+{
+	if (!mapped_) return;
+	mapped_ = false;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[slot_]);
+	if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+		//Data pointer is an offset in the bound PBO
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glBindTexture(target, texture);
+		glTexSubImage2D(target, 0, 0, 0, w_, h_, format_, GL_UNSIGNED_BYTE, 0);
+		glBindTexture(target, 0);
+	}
+	//Otherwise buffer contents were lost (e.g. video mode change), the frame is skipped
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+//------------------------------------------------------------------------------------------------------
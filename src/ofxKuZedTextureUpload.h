@@ -0,0 +1,53 @@
+#pragma once
+
+//Streaming texture upload through a ring of pixel buffer objects (PBO).
+//Pixels are written by CPU directly into mapped PBO memory, and glTexSubImage2D copies them
+//from PBO to texture asynchronously: the call returns immediately, and the driver transfers data
+//while CPU converts the next image. With several PBOs in the ring, CPU never writes into the buffer
+//which GPU may still read from. Usage:
+//	upload.setup(w, h, 3, GL_RGB);
+//	...
+//	unsigned char *dst = upload.begin();
+//	if (dst) {
+//		ofxKuZedConvert::bgraToRgb(src, srcStep, dst, upload.getStep(), w, h);
+//		upload.end(textureId, GL_TEXTURE_2D);
+//	}
+//It requires current GL context, and doesn't depend on the rest of openFrameworks (see ofxKuZedGL.h).
+
+#include "ofxKuZedGL.h"
+#include <vector>
+
+//Texture upload modes, see ofxKuZed::setTextureUpload
+const int ZED_TEXTURE_UPLOAD_SYNC = 0;	//ofTexture::loadData from pixels
+const int ZED_TEXTURE_UPLOAD_PBO = 1;	//conversion into ring of PBOs, asynchronous copy to texture
+
+class ofxKuZedTextureUpload
+{
+public:
+	ofxKuZedTextureUpload();
+	~ofxKuZedTextureUpload();
+
+	//Allocate ringSize PBOs for w x h image, format - GL format of pixels (GL_RGB, GL_LUMINANCE, GL_RED...),
+	//type is GL_UNSIGNED_BYTE. Rows are aligned to 4 bytes
+	bool setup(int w, int h, int bytesPerPixel, GLenum format, int ringSize = 3);
+	void clear();		//delete PBOs, GL context should be current
+	bool isAllocated() const;
+
+	int getWidth() const;
+	int getHeight() const;
+	int getStep() const;		//row size in mapped memory, bytes
+	int getRingSize() const;
+
+	//Map the next PBO of the ring for writing. Returns 0 if mapping failed,
+	//then nothing should be uploaded (use synchronous loading instead)
+	unsigned char *begin();
+	//Unmap PBO and start copying it into texture (target - GL_TEXTURE_2D or GL_TEXTURE_RECTANGLE)
+	void end(GLuint texture, GLenum target);
+
+private:
+	int w_, h_, step_;
+	GLenum format_;
+	std::vector<GLuint> pbo_;
+	int slot_;			//PBO used by the last begin()
+	bool mapped_;
+};
@@ -0,0 +1,461 @@
+#include "ofxKuZedVoxelGrid.h"
+#include "ofxKuZedWorkers.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OFXKUZED_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define OFXKUZED_TARGET(isa)
+#else
+#define OFXKUZED_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+typedef ofxKuZedVoxelGrid::Voxel Voxel;
+
+static const int coordBits = 21;				//bits of each voxel coordinate in key
+//Offset which makes coordinates non-negative. Coordinates are in [0, 2^17) voxels, so float coordinate
+//has 7 bits of fraction: voxel borders are exact to 1/128 of leaf size
+static const int coordOffset = 1 << 16;
+static const int minChunkPoints = 1 << 16;		//points per thread
+static const int recentSize = 4096;				//voxels in cache of recently used ones
+
+//Key of the parent voxel is (key >> 1) & parentMask: each coordinate is halved,
+//and the lowest bit of the next coordinate is removed
+static const uint64_t fieldMask = (uint64_t(1) << (coordBits - 1)) - 1;
+static const uint64_t parentMask = fieldMask | (fieldMask << coordBits) | (fieldMask << (2 * coordBits));
+
+//------------------------------------------------------------------------------------------------------
+//Hash is linear in voxel coordinates, so neighbour voxels along x get neighbour slots: new voxels of a row
+//and voxels of the previous rows are found in the same cache lines of the table
+static inline size_t keyHash(uint64_t key)
+{
+	uint32_t x = uint32_t(key) & uint32_t(fieldMask * 2 + 1);
+	uint32_t y = uint32_t(key >> coordBits) & uint32_t(fieldMask * 2 + 1);
+	uint32_t z = uint32_t(key >> (2 * coordBits));
+	return size_t(x + y * 0x9E3779B1u + z * 0x85EBCA77u);
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::Grid::clear()
+{
+	voxels.clear();
+	keys.clear();
+	generation++;
+	if (generation == 0) {
+		//Generation counter wrapped, slots of old frames could look used
+		for (size_t i = 0; i < table.size(); i++) table[i].generation = 0;
+		for (size_t i = 0; i < recent.size(); i++) recent[i].generation = 0;
+		generation = 1;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::Grid::grow()
+{
+	//Load factor is kept below 1/2, so probing sequences are short
+	size_t size = std::max(table.size() * 2, size_t(1024));
+	Slot empty = { 0, 0, 0 };
+	table.assign(size, empty);
+	size_t mask = size - 1;
+	for (size_t j = 0; j < keys.size(); j++) {
+		size_t i = keyHash(keys[j]) & mask;
+		while (table[i].generation == generation) i = (i + 1) & mask;
+		table[i].key = keys[j];
+		table[i].voxel = int(j);
+		table[i].generation = generation;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedVoxelGrid::Grid::find(uint64_t key)
+{
+	size_t hash = keyHash(key);
+
+	//Recently used voxels, it saves cache misses in a big table:
+	//rows of organized cloud mostly fall into voxels of the previous rows
+	if (recent.empty()) {
+		Slot empty = { 0, 0, 0 };
+		recent.assign(recentSize, empty);
+	}
+	Slot &r = recent[hash & (recentSize - 1)];
+	if (r.generation == generation && r.key == key) return r.voxel;
+
+	if (voxels.size() * 2 >= table.size()) grow();
+	size_t mask = table.size() - 1;
+	size_t i = hash & mask;
+	while (true) {
+		Slot &slot = table[i];
+		if (slot.generation != generation) {
+			slot.key = key;
+			slot.voxel = int(voxels.size());
+			slot.generation = generation;
+			Voxel v = { 0, 0, 0, 0, 0, 0, 0, 0 };
+			voxels.push_back(v);
+			keys.push_back(key);
+			r = slot;
+			return slot.voxel;
+		}
+		if (slot.key == key) {
+			r = slot;
+			return slot.voxel;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Accumulate points [i0, i1) into grid. COLORS: 0 - no colors, 1 - uchar, 2 - float.
+//Sums of a run of points in the same voxel are kept in registers and added to the voxel when the run ends
+template<bool FIRST_POINT, int COLORS, class Grid>
+static void accumulate(Grid &grid, const ofxKuZedConvert::PointsOutput &points, int i0, int i1, float leaf)
+{
+	const float inv = 1 / leaf;
+	const float offset = float(coordOffset);
+	const float hi = float(2 * coordOffset);
+	const int s = points.xyzStride;
+	uint64_t runKey = 0;
+	float x0 = 0, y0 = 0, z0 = 0;	//the first point of run
+	float sx = 0, sy = 0, sz = 0, sr = 0, sg = 0, sb = 0, sa = 0;
+	int count = 0;
+	auto endRun = [&]() {
+		if (count == 0) return;
+		Voxel &v = grid.voxels[grid.find(runKey)];
+		if (!FIRST_POINT) {
+			v.x += sx;
+			v.y += sy;
+			v.z += sz;
+		}
+		else if (v.count == 0) {
+			v.x = x0;
+			v.y = y0;
+			v.z = z0;
+		}
+		v.r += sr;
+		v.g += sg;
+		v.b += sb;
+		v.a += sa;
+		v.count += count;
+	};
+
+	for (int i = i0; i < i1; i++) {
+		float x = points.x[i * s];
+		float y = points.y[i * s];
+		float z = points.z[i * s];
+		//Coordinates are shifted to positive values, so truncation is floor.
+		//Points out of [0, 2 * coordOffset) voxels and NaN are invalid
+		float tx = x * inv + offset;
+		float ty = y * inv + offset;
+		float tz = z * inv + offset;
+		if (!(tx >= 0 && tx < hi && ty >= 0 && ty < hi && tz >= 0 && tz < hi)) continue;
+		unsigned int ix = (unsigned int)tx;
+		unsigned int iy = (unsigned int)ty;
+		unsigned int iz = (unsigned int)tz;
+
+		uint64_t key = uint64_t(ix) | (uint64_t(iy) << coordBits) | (uint64_t(iz) << (2 * coordBits));
+		if (key != runKey || count == 0) {
+			endRun();
+			runKey = key;
+			x0 = x;
+			y0 = y;
+			z0 = z;
+			sx = sy = sz = sr = sg = sb = sa = 0;
+			count = 0;
+		}
+		sx += x;
+		sy += y;
+		sz += z;
+		if (COLORS == 1) {
+			const unsigned char *c = points.rgba + size_t(i) * points.rgbaStride;
+			sr += c[0];
+			sg += c[1];
+			sb += c[2];
+			sa += c[3];
+		}
+		if (COLORS == 2) {
+			const float *c = points.rgbaFloat + size_t(i) * points.rgbaFloatStride;
+			sr += c[0];
+			sg += c[1];
+			sb += c[2];
+			sa += c[3];
+		}
+		count++;
+	}
+	endRun();
+}
+
+#ifdef OFXKUZED_X86
+//------------------------------------------------------------------------------------------------------
+//SSE2 version for interleaved x, y, z: coordinates of a point are converted together and compared with the run
+//by one instruction. Sums are added in the same order as in the scalar version, so results are equal
+template<bool FIRST_POINT, int COLORS, class Grid>
+OFXKUZED_TARGET("sse2")
+static void accumulateSSE2(Grid &grid, const ofxKuZedConvert::PointsOutput &points, int i0, int i1, float leaf)
+{
+	const __m128 inv = _mm_set1_ps(1 / leaf);
+	const __m128 offset = _mm_set1_ps(float(coordOffset));
+	const __m128 hi = _mm_set1_ps(float(2 * coordOffset));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128i zeroi = _mm_setzero_si128();
+	const int s = points.xyzStride;
+	__m128i run = _mm_set1_epi32(-1);		//voxel coordinates of run, the 4th is coordOffset
+	__m128 first = zero, sum = zero, sumColor = zero;
+	int count = 0;
+	auto endRun = [&]() {
+		if (count == 0) return;
+		int c[4];
+		float xyz[4], rgba[4];
+		_mm_storeu_si128((__m128i *)c, run);
+		_mm_storeu_ps(xyz, (FIRST_POINT) ? first : sum);
+		_mm_storeu_ps(rgba, sumColor);
+		uint64_t key = uint64_t(c[0]) | (uint64_t(c[1]) << coordBits) | (uint64_t(c[2]) << (2 * coordBits));
+		Voxel &v = grid.voxels[grid.find(key)];
+		if (!FIRST_POINT) {
+			v.x += xyz[0];
+			v.y += xyz[1];
+			v.z += xyz[2];
+		}
+		else if (v.count == 0) {
+			v.x = xyz[0];
+			v.y = xyz[1];
+			v.z = xyz[2];
+		}
+		v.r += rgba[0];
+		v.g += rgba[1];
+		v.b += rgba[2];
+		v.a += rgba[3];
+		v.count += count;
+	};
+
+	for (int i = i0; i < i1; i++) {
+		const float *p = points.x + size_t(i) * s;
+		__m128 xyz = _mm_movelh_ps(_mm_loadl_pi(zero, (const __m64 *)p), _mm_load_ss(p + 2));
+		__m128 t = _mm_add_ps(_mm_mul_ps(xyz, inv), offset);
+		if (_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, hi))) != 15) continue;
+		__m128i c = _mm_cvttps_epi32(t);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(c, run)) != 0xFFFF) {
+			endRun();
+			run = c;
+			first = xyz;
+			sum = sumColor = zero;
+			count = 0;
+		}
+		sum = _mm_add_ps(sum, xyz);
+		if (COLORS == 1) {
+			__m128i c8 = _mm_cvtsi32_si128(*(const int *)(points.rgba + size_t(i) * points.rgbaStride));
+			__m128i c32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(c8, zeroi), zeroi);
+			sumColor = _mm_add_ps(sumColor, _mm_cvtepi32_ps(c32));
+		}
+		if (COLORS == 2) {
+			sumColor = _mm_add_ps(sumColor, _mm_loadu_ps(points.rgbaFloat + size_t(i) * points.rgbaFloatStride));
+		}
+		count++;
+	}
+	endRun();
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::setLeafSize(float mm)
+{
+	leaf_ = std::max(mm, 0.001f);
+}
+
+//------------------------------------------------------------------------------------------------------
+float ofxKuZedVoxelGrid::getLeafSize() const
+{
+	return leaf_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::setPolicy(int policy)
+{
+	policy_ = policy;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedVoxelGrid::getPolicy() const
+{
+	return policy_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::setLevels(int levels)
+{
+	levels_ = std::max(std::min(levels, coordBits - 1), 1);
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedVoxelGrid::getLevels() const
+{
+	return levels_;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::processChunk(Grid &grid, const ofxKuZedConvert::PointsOutput &points, int i0, int i1)
+{
+	bool first = (policy_ == FIRST_POINT);
+	int colors = (points.rgbaFloat) ? 2 : ((points.rgba) ? 1 : 0);
+#ifdef OFXKUZED_X86
+	//Interleaved coordinates are read by one load
+	if (ofxKuZedConvert::simd() != ofxKuZedConvert::SIMD_SCALAR && points.y == points.x + 1 && points.z == points.x + 2) {
+		if (first) {
+			if (colors == 2) accumulateSSE2<true, 2>(grid, points, i0, i1, leaf_);
+			else if (colors == 1) accumulateSSE2<true, 1>(grid, points, i0, i1, leaf_);
+			else accumulateSSE2<true, 0>(grid, points, i0, i1, leaf_);
+		}
+		else {
+			if (colors == 2) accumulateSSE2<false, 2>(grid, points, i0, i1, leaf_);
+			else if (colors == 1) accumulateSSE2<false, 1>(grid, points, i0, i1, leaf_);
+			else accumulateSSE2<false, 0>(grid, points, i0, i1, leaf_);
+		}
+		return;
+	}
+#endif
+	if (first) {
+		if (colors == 2) accumulate<true, 2>(grid, points, i0, i1, leaf_);
+		else if (colors == 1) accumulate<true, 1>(grid, points, i0, i1, leaf_);
+		else accumulate<true, 0>(grid, points, i0, i1, leaf_);
+	}
+	else {
+		if (colors == 2) accumulate<false, 2>(grid, points, i0, i1, leaf_);
+		else if (colors == 1) accumulate<false, 1>(grid, points, i0, i1, leaf_);
+		else accumulate<false, 0>(grid, points, i0, i1, leaf_);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+//Add voxels of src to dst in src order, so the first point of merged voxel is the first of the earliest source.
+//parentKeys - dst is the next level of src
+void ofxKuZedVoxelGrid::merge(Grid &dst, const Grid &src, bool parentKeys)
+{
+	bool first = (policy_ == FIRST_POINT);
+	uint64_t lastKey = ~uint64_t(0);
+	int last = -1;
+	for (size_t j = 0; j < src.voxels.size(); j++) {
+		uint64_t key = src.keys[j];
+		if (parentKeys) key = (key >> 1) & parentMask;
+		if (key != lastKey) {
+			last = dst.find(key);
+			lastKey = key;
+		}
+		Voxel &d = dst.voxels[last];
+		const Voxel &s = src.voxels[j];
+		if (d.count == 0) {
+			d = s;
+			continue;
+		}
+		if (!first) {
+			d.x += s.x;
+			d.y += s.y;
+			d.z += s.z;
+		}
+		d.r += s.r;
+		d.g += s.g;
+		d.b += s.b;
+		d.a += s.a;
+		d.count += s.count;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedVoxelGrid::process(const ofxKuZedConvert::PointsOutput &points, int n)
+{
+	hasColors_ = (points.rgba || points.rgbaFloat);
+	colorUnit_ = (points.rgbaFloat) ? 1.0f : 255.0f;
+	grids_.resize(levels_);
+	for (size_t i = 0; i < grids_.size(); i++) {
+		grids_[i].clear();
+	}
+	if (n <= 0 || !points.x || !points.y || !points.z) return;
+
+	int chunks = std::max(std::min(ofxKuZedWorkers::shared().getThreads(), n / minChunkPoints), 1);
+	if (int(chunks_.size()) < chunks - 1) chunks_.resize(chunks - 1);
+	for (int c = 1; c < chunks; c++) {
+		chunks_[c - 1].clear();
+	}
+	ofxKuZedWorkers::shared().parallelRows(chunks, [&](int c0, int c1) {
+		for (int c = c0; c < c1; c++) {
+			Grid &grid = (c == 0) ? grids_[0] : chunks_[c - 1];
+			processChunk(grid, points, int(int64_t(n) * c / chunks), int(int64_t(n) * (c + 1) / chunks));
+		}
+	}, 1);
+	for (int c = 1; c < chunks; c++) {
+		merge(grids_[0], chunks_[c - 1], false);
+	}
+
+	//Levels of detail from voxels of previous level
+	for (int l = 1; l < levels_; l++) {
+		merge(grids_[l], grids_[l - 1], true);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedVoxelGrid::size(int level) const
+{
+	if (level < 0 || level >= int(grids_.size())) return 0;
+	return int(grids_[level].voxels.size());
+}
+
+//------------------------------------------------------------------------------------------------------
+bool ofxKuZedVoxelGrid::hasColors() const
+{
+	return hasColors_;
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedVoxelGrid::write(int level, const ofxKuZedConvert::PointsOutput &out) const
+{
+	int n = size(level);
+	if (n == 0) return 0;
+	const Voxel *voxels = &grids_[level].voxels[0];
+	bool first = (policy_ == FIRST_POINT);
+	bool colors = hasColors_;
+	float unit = colorUnit_;
+	ofxKuZedWorkers::shared().parallelRows(n, [&](int i0, int i1) {
+		for (int i = i0; i < i1; i++) {
+			const Voxel &v = voxels[i];
+			float k = 1.0f / v.count;
+			float kPoint = (first) ? 1.0f : k;
+			if (out.x) out.x[size_t(i) * out.xyzStride] = v.x * kPoint;
+			if (out.y) out.y[size_t(i) * out.xyzStride] = v.y * kPoint;
+			if (out.z) out.z[size_t(i) * out.xyzStride] = v.z * kPoint;
+			if (colors && out.rgbaFloat) {
+				float kColor = k / unit;
+				float *c = out.rgbaFloat + size_t(i) * out.rgbaFloatStride;
+				c[0] = v.r * kColor;
+				c[1] = v.g * kColor;
+				c[2] = v.b * kColor;
+				c[3] = v.a * kColor;
+			}
+			if (colors && out.rgba) {
+				float kColor = k * 255 / unit;
+				unsigned char *c = out.rgba + size_t(i) * out.rgbaStride;
+				c[0] = (unsigned char)(v.r * kColor + 0.5f);
+				c[1] = (unsigned char)(v.g * kColor + 0.5f);
+				c[2] = (unsigned char)(v.b * kColor + 0.5f);
+				c[3] = (unsigned char)(v.a * kColor + 0.5f);
+			}
+			if (out.index) out.index[i] = v.count;
+		}
+	}, 4096);
+	return n;
+}
+
+//------------------------------------------------------------------------------------------------------
+size_t ofxKuZedVoxelGrid::getMemoryBytes() const
+{
+	size_t bytes = 0;
+	for (int k = 0; k < 2; k++) {
+		const std::vector<Grid> &grids = (k == 0) ? grids_ : chunks_;
+		for (size_t i = 0; i < grids.size(); i++) {
+			bytes += (grids[i].table.capacity() + grids[i].recent.capacity()) * sizeof(Slot) + grids[i].voxels.capacity() * sizeof(Voxel)
+				+ grids[i].keys.capacity() * sizeof(uint64_t);
+		}
+	}
+	return bytes;
+}
+
+//------------------------------------------------------------------------------------------------------
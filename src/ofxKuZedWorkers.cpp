@@ -0,0 +1,160 @@
+#include "ofxKuZedWorkers.h"
+
+//Set while a thread processes bands, to run nested calls inline
+static thread_local bool insideJob_ = false;
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedWorkers &ofxKuZedWorkers::shared()
+{
+	static ofxKuZedWorkers workers;
+	return workers;
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedWorkers::ofxKuZedWorkers(int threads)
+{
+	threads_ = 1;
+	generation_ = 0;
+	quit_ = false;
+	working_ = 0;
+	nextBand_ = 0;
+	setThreads(threads);
+}
+
+//------------------------------------------------------------------------------------------------------
+ofxKuZedWorkers::~ofxKuZedWorkers()
+{
+	std::lock_guard<std::mutex> call(callMutex_);
+	stopWorkers();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedWorkers::setThreads(int threads)
+{
+	if (threads <= 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads <= 0) threads = 1;
+	}
+	std::lock_guard<std::mutex> call(callMutex_);
+	if (threads != threads_) {
+		stopWorkers();	//workers are started on demand by the next call
+		threads_ = threads;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+int ofxKuZedWorkers::getThreads() const
+{
+	return threads_;
+}
+
+//------------------------------------------------------------------------------------------------------
+//New workers wait for the next generation: the current one can be left from workers stopped by setThreads()
+void ofxKuZedWorkers::startWorkers()
+{
+	unsigned long long seen;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = false;
+		seen = generation_;
+	}
+	for (int i = 1; i < threads_; i++) {
+		workers_.push_back(std::thread(&ofxKuZedWorkers::workerLoop, this, seen));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedWorkers::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	wake_.notify_all();
+	for (size_t i = 0; i < workers_.size(); i++) {
+		workers_[i].join();
+	}
+	workers_.clear();
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedWorkers::workerLoop(unsigned long long seen)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		while (!quit_ && generation_ == seen) {
+			wake_.wait(lock);
+		}
+		if (quit_) return;
+		seen = generation_;
+		Job job = job_;
+		lock.unlock();
+		runBands(job);
+		lock.lock();
+		if (--working_ == 0) {
+			done_.notify_all();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedWorkers::runBands(const Job &job)
+{
+	insideJob_ = true;
+	int band;
+	while ((band = nextBand_++) < job.bands) {
+		int y0 = band * job.bandRows;
+		int y1 = y0 + job.bandRows;
+		if (y1 > job.rows) y1 = job.rows;
+		(*job.f)(y0, y1);
+	}
+	insideJob_ = false;
+}
+
+//------------------------------------------------------------------------------------------------------
+void ofxKuZedWorkers::parallelRows(int h, const RowsFunction &f, int minBandRows)
+{
+	if (h <= 0) return;
+	if (minBandRows < 1) minBandRows = 1;
+	if (threads_ <= 1 || h < 2 * minBandRows || insideJob_) {
+		f(0, h);
+		return;
+	}
+	std::unique_lock<std::mutex> call(callMutex_, std::try_to_lock);
+	if (!call.owns_lock()) {
+		//Pool is busy with another thread
+		f(0, h);
+		return;
+	}
+	if (workers_.empty()) {
+		startWorkers();
+	}
+
+	//A few bands per thread for balancing
+	int bands = threads_ * 4;
+	int bandRows = (h + bands - 1) / bands;
+	if (bandRows < minBandRows) bandRows = minBandRows;
+	Job job;
+	job.f = &f;
+	job.rows = h;
+	job.bandRows = bandRows;
+	job.bands = (h + bandRows - 1) / bandRows;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		job_ = job;
+		nextBand_ = 0;
+		working_ = int(workers_.size());
+		generation_++;
+	}
+	wake_.notify_all();
+
+	runBands(job);
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (working_ > 0) {
+		done_.wait(lock);
+	}
+	job_ = Job();
+}
+
+//------------------------------------------------------------------------------------------------------
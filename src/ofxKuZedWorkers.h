@@ -0,0 +1,63 @@
+#pragma once
+
+//Fixed-size worker pool for splitting frame conversions into row bands.
+//It doesn't depend on openFrameworks, so conversion kernels can use it in the benchmark too.
+//
+//parallelRows() is not reentrant: if it's called from a band, or while the pool is busy
+//with a call from another thread (e.g. capture thread), the work is done in the calling thread.
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+class ofxKuZedWorkers
+{
+public:
+	typedef std::function<void(int y0, int y1)> RowsFunction;	//process rows [y0, y1)
+
+	//Pool used by ofxKuZed and ofxKuZedConvert
+	static ofxKuZedWorkers &shared();
+
+	ofxKuZedWorkers(int threads = 0);
+	~ofxKuZedWorkers();
+
+	//Number of threads including the calling one. 0 - number of CPU cores, 1 - no parallelism
+	void setThreads(int threads);
+	int getThreads() const;
+
+	//Split rows [0, h) into bands, process them in parallel and wait for completion
+	void parallelRows(int h, const RowsFunction &f, int minBandRows = 8);
+
+private:
+	int threads_;
+	std::vector<std::thread> workers_;
+
+	std::mutex callMutex_;		//one parallelRows() at a time
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	unsigned long long generation_;	//incremented for each job
+	bool quit_;
+	int working_;				//workers which didn't finish current job
+
+	//Current job, protected by mutex_. Workers copy it when they see a new generation
+	struct Job {
+		const RowsFunction *f = 0;
+		int rows = 0;
+		int bandRows = 0;
+		int bands = 0;
+	};
+	Job job_;
+	std::atomic<int> nextBand_;
+
+	void startWorkers();
+	void stopWorkers();
+	void workerLoop(unsigned long long seen);
+	void runBands(const Job &job);
+
+	ofxKuZedWorkers(const ofxKuZedWorkers &);
+	ofxKuZedWorkers &operator=(const ofxKuZedWorkers &);
+};
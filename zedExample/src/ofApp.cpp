@@ -13,7 +13,14 @@ void ofApp::setup()
 	bool flipY = true;
 	bool flipZ = true;
 	zed.setUsePointCloud(true, true, flipY, flipZ);	//points, colors, flipY, flipZ
+	zed.setTextureUpload(ZED_TEXTURE_UPLOAD_PBO);	//left, right and depth textures are streamed without stalls
+	//zed.setMockCamera(true);		//synthetic frames instead of camera, always used if built without ZED SDK
 	zed.init();
+
+	mask.setMaskedChannels(3);	//RGB masked image, 4 - RGBA with alpha = mask
+
+	foreground.getBackground().setRange(300, 8000);
+	foreground.getLabeler().setMinPixels(1000);
 }
 
 //--------------------------------------------------------------
@@ -21,21 +28,18 @@ void ofApp::update()
 {
 	zed.update();
 
+	//Compute outputs used in this frame in one pass, getters below just return them
+	if (drawing_page == 1) {
+		zed.extractFrame(ZED_EXTRACT_LEFT | ZED_EXTRACT_RIGHT | ZED_EXTRACT_DEPTH_GRAYSCALE, 0, view_range_mm);
+	}
+
 	//Compute masked image by combining left color image and thresholded depth values
-	ofPixels &left = zed.getLeftPixels();
-	ofFloatPixels &depth_mm = zed.getDepthPixels_mm();
-	
-	int w = zed.getWidth();
-	int h = zed.getHeight();
-	masked.allocate(w, h, 3);
-	for (int y = 0; y < h; y++) {
-		for (int x = 0; x < w; x++) {
-			float depth_value = depth_mm.getData()[x + w*y];
-			ofColor color = (depth_value <= threshold_mm && depth_value > 0) ? left.getColor(x, y) : ofColor(0);
-			masked.setColor(x, y, color);
-		}
+	mask.setRange(0, threshold_mm);
+	mask.update(zed);
+
+	if (drawing_page == 3) {
+		foreground.update(zed);
 	}
-	maskedTexture.loadData(masked);
 }
 
 //--------------------------------------------------------------
@@ -50,7 +54,7 @@ void ofApp::draw()
 		zed.drawRight(W / 2, 0, W / 2, H / 2);
 		zed.drawDepth(0, H / 2, W / 2, H / 2, 0, view_range_mm);
 
-		maskedTexture.draw(W / 2, H / 2, W / 2, H / 2);
+		mask.getMaskedTexture().draw(W / 2, H / 2, W / 2, H / 2);
 	}
 	if (drawing_page == 2) {	//draw point cloud
 		ofEnableDepthTest();
@@ -63,13 +67,28 @@ void ofApp::draw()
 		easyCam.end();
 		ofDisableDepthTest();
 	}
+	if (drawing_page == 3) {	//draw foreground mask and blobs
+		ofSetColor(255);
+		foreground.getMaskTexture().draw(0, 0, W, H);
+		float sx = W / max(zed.getWidth(), 1);
+		float sy = H / max(zed.getHeight(), 1);
+		ofNoFill();
+		ofSetColor(255, 0, 0);
+		for (auto &blob : foreground.getBlobs()) {
+			ofDrawRectangle(blob.x0 * sx, blob.y0 * sy, (blob.x1 - blob.x0) * sx, (blob.y1 - blob.y0) * sy);
+			ofDrawBitmapString(ofToString(blob.z, 0) + " mm", blob.x0 * sx, blob.y0 * sy - 4);
+		}
+		ofFill();
+		if (foreground.isLearning()) ofDrawBitmapStringHighlight("Learning background...", 20, 80);
+	}
 	string info;
 	if (zed.started()) info += "ZED started"; 
 	else info += "ZED not started";
 	info += ", " + ofToString(zed.getWidth()) + " x " + ofToString(zed.getHeight());
-	info += ", camera fps " + ofToString(zed.getFps()) + ", keys: 1,2 switch page, 9,0 adjust view_range_mm, -,= adjust threshold_mm";
+	info += ", camera fps " + ofToString(zed.getMeasuredFps(), 1) + ", dropped " + ofToString(zed.getDroppedFrames()) + ", keys: 1,2,3 switch page, 9,0 adjust view_range_mm, -,= adjust threshold_mm, b learn background, r record";
 	info += "\nview_range_mm: " + ofToString(view_range_mm) + ", threshold_mm: " + ofToString(threshold_mm)
 		+ "    FPS: " + ofToString(ofGetFrameRate());
+	if (zed.isRecording()) info += "    RECORDING";
 	ofDrawBitmapStringHighlight(info, 20, 20);
 }
 
@@ -77,10 +96,16 @@ void ofApp::draw()
 void ofApp::keyPressed(int key){
 	if (key == '1') drawing_page = 1;
 	if (key == '2') drawing_page = 2;
+	if (key == '3') drawing_page = 3;
+	if (key == 'b') foreground.reset();
 	if (key == '9') view_range_mm -= 1000;
 	if (key == '0') view_range_mm += 1000;
 	if (key == '-') threshold_mm -= 100;
 	if (key == '=') threshold_mm += 100;
+	if (key == 'r') {	//start/stop recording to data/zed.rec, play it with zed.setPlayback("zed.rec") before init()
+		if (zed.isRecording()) zed.stopRecording();
+		else zed.startRecording("zed.rec");
+	}
 }
 
 //--------------------------------------------------------------
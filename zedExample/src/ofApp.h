@@ -16,8 +16,12 @@ Double click to reset view.
 
 Press '1' to switch back to images view.
 
+Press '3' to see foreground: depth pixels closer than learned background, and blobs in it.
+Background is learned during the first second after start, or after pressing 'b'.
+
 Keys:
-* '1','2' - select page (images and depth / point cloud)
+* '1','2','3' - select page (images and depth / point cloud / foreground blobs)
+* 'b' - learn background again
 * '9','0' - adjust depth view range.
 * '-','=' - adjust depth threshold
 
@@ -40,10 +44,11 @@ public:
 	float view_range_mm = 5000;		//depth view range
 
 	float threshold_mm = 2000;	//depth threshold
-	ofPixels masked;			//masked image
-	ofTexture maskedTexture;	//masked texture
+	ofxKuZedMask mask;			//masked image
+
+	ofxKuZedForeground foreground;	//foreground mask and blobs
 
-	//drawing_page: 1 - images, depth, masked, 2 - point cloud
+	//drawing_page: 1 - images, depth, masked, 2 - point cloud, 3 - foreground
 	int drawing_page = 1;
 
 	ofEasyCam easyCam;